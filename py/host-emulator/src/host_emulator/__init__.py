@@ -1,18 +1,24 @@
 """Host emulator for embedded C++ applications."""
 
+from .clock import Clock
+from .codec import WireFormat
 from .common import Status, UnhandledMessageError
 from .emulator import DeviceEmulator
 from .i2c import I2C
 from .pin import Pin, PinDirection, PinState
+from .port import Port
 from .uart import Uart
 
 __all__ = [
     "I2C",
+    "Clock",
     "DeviceEmulator",
     "Pin",
     "PinDirection",
     "PinState",
+    "Port",
     "Status",
     "Uart",
     "UnhandledMessageError",
+    "WireFormat",
 ]
@@ -0,0 +1,84 @@
+"""Simulated time shared with a device that runs in simulated time."""
+
+from __future__ import annotations
+
+import heapq
+import itertools
+import logging
+from threading import Condition
+from typing import TYPE_CHECKING, Any
+
+from .common import Status
+
+if TYPE_CHECKING:
+    from collections.abc import Callable
+
+logger = logging.getLogger(__name__)
+
+
+class Clock:
+    """Follows the device's simulated clock.
+
+    A device started with ``EMULATOR_TIME=simulated`` reports every step its
+    clock takes with an Advance request. Callbacks scheduled with
+    ``call_at`` run as time passes their deadline, before the device gets
+    its reply, so their effects (a button press, UART input) reach the
+    device at the simulated time they were scheduled for.
+    """
+
+    def __init__(self, name: str = "Clock") -> None:
+        self.name = name
+        self.now_us = 0
+        self._timers: list[tuple[int, int, Callable[[], None]]] = []
+        self._sequence = itertools.count()
+        self._changed = Condition()
+
+    def call_at(self, time_us: int, callback: Callable[[], None]) -> None:
+        """Run callback once simulated time reaches time_us."""
+        with self._changed:
+            heapq.heappush(self._timers, (time_us, next(self._sequence), callback))
+
+    def call_later(self, delay_us: int, callback: Callable[[], None]) -> None:
+        """Run callback once delay_us of simulated time has passed."""
+        self.call_at(self.now_us + delay_us, callback)
+
+    def advance(self, advance_us: int) -> None:
+        """Move time forward, running the callbacks that fall due on the way."""
+        target = self.now_us + advance_us
+        while True:
+            with self._changed:
+                if not self._timers or self._timers[0][0] > target:
+                    break
+                time_us, _, callback = heapq.heappop(self._timers)
+                self.now_us = max(self.now_us, time_us)
+            callback()
+        with self._changed:
+            self.now_us = target
+            self._changed.notify_all()
+        logger.debug("[Clock %s] Now: %d us", self.name, self.now_us)
+
+    def wait_until(self, time_us: int, timeout: float) -> bool:
+        """Wait up to timeout real seconds for simulated time to reach time_us."""
+        with self._changed:
+            return self._changed.wait_for(lambda: self.now_us >= time_us, timeout)
+
+    def handle_request(self, message: dict[str, Any]) -> dict[str, Any]:
+        response: dict[str, Any] = {
+            "type": "Response",
+            "object": "Clock",
+            "name": self.name,
+            "status": Status.InvalidOperation.name,
+        }
+        if message["operation"] == "Advance":
+            self.advance(message.get("advance_us", 0))
+            response["status"] = Status.Ok.name
+        return response
+
+    def handle_message(self, message: dict[str, Any]) -> dict[str, Any] | None:
+        if message["object"] != "Clock":
+            return None
+        if message["name"] != self.name:
+            return None
+        if message["type"] == "Request":
+            return self.handle_request(message)
+        return None
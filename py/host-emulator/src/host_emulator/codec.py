@@ -0,0 +1,183 @@
+"""Wire codecs for messages exchanged with the device.
+
+Two formats are supported and can be mixed on the same socket:
+
+* JSON - a UTF-8 JSON object (always starts with ``{``)
+* Binary - a fixed 32-byte little-endian header followed by the name and
+  the raw payload bytes. The layout matches
+  ``src/libs/mcu/host/emulator_message_binary_encoder.hpp``.
+
+Messages are represented as dictionaries with the same keys as the JSON
+format, so peripherals do not need to know which format was used.
+"""
+
+from __future__ import annotations
+
+import json
+import struct
+from enum import Enum
+from typing import Any
+
+BINARY_FRAME_MAGIC = 0xEB
+
+# magic, type, object, operation, status, state, name size, address,
+# reserved, size, timeout_ms, bytes_transferred, data size, id. Ports carry
+# their mask in the size slot and their value in the timeout_ms slot; the
+# clock carries advance_us in the timeout_ms slot.
+_HEADER = struct.Struct("<BBBBBBHHHIIIII")
+
+_MESSAGE_TYPES = ["Request", "Response"]
+_OBJECT_TYPES = ["Pin", "Uart", "I2C", "Port", "Clock"]
+_OPERATIONS = [
+    "Set",
+    "Get",
+    "Send",
+    "Receive",
+    "Transfer",
+    "Transaction",
+    "Advance",
+]
+_PIN_STATES = ["Low", "High", "Hi_Z"]
+_STATUSES = [
+    "Ok",
+    "Unknown",
+    "InvalidArgument",
+    "InvalidState",
+    "InvalidOperation",
+    "OperationFailed",
+    "Unhandled",
+    "ConnectionRefused",
+    "ConnectionClosed",
+    "Timeout",
+    "WouldBlock",
+    "MessageTooLarge",
+]
+
+# Fields carried by each (object, type) pair, mirroring the C++ structs
+_FIELDS: dict[tuple[str, str], tuple[str, ...]] = {
+    ("Pin", "Request"): ("operation", "state"),
+    ("Pin", "Response"): ("state", "status"),
+    ("Uart", "Request"): ("operation", "data", "size", "timeout_ms"),
+    ("Uart", "Response"): ("data", "bytes_transferred", "status"),
+    ("I2C", "Request"): ("operation", "address", "data", "size"),
+    ("I2C", "Response"): ("address", "data", "bytes_transferred", "status"),
+    ("Port", "Request"): ("operation", "mask", "value"),
+    ("Port", "Response"): ("value", "status"),
+    ("Clock", "Request"): ("operation", "advance_us"),
+    ("Clock", "Response"): ("status",),
+}
+
+
+class WireFormat(Enum):
+    """Encoding used on the wire."""
+
+    JSON = "json"
+    BINARY = "binary"
+
+
+def _to_code(names: list[str], value: str | None) -> int:
+    """Map an enum name to its 1-based C++ value (0 when absent)."""
+    if value is None:
+        return 0
+    return names.index(value) + 1
+
+
+def _from_code(names: list[str], code: int) -> str | None:
+    if code == 0 or code > len(names):
+        return None
+    return names[code - 1]
+
+
+def is_binary_frame(frame: bytes) -> bool:
+    return len(frame) > 0 and frame[0] == BINARY_FRAME_MAGIC
+
+
+def format_of(frame: bytes) -> WireFormat:
+    return WireFormat.BINARY if is_binary_frame(frame) else WireFormat.JSON
+
+
+def encode_binary(message: dict[str, Any]) -> bytes:
+    name = str(message.get("name", "")).encode()
+    data = bytes(message.get("data", []))
+    header = _HEADER.pack(
+        BINARY_FRAME_MAGIC,
+        _to_code(_MESSAGE_TYPES, message.get("type")),
+        _to_code(_OBJECT_TYPES, message.get("object")),
+        _to_code(_OPERATIONS, message.get("operation")),
+        _to_code(_STATUSES, message.get("status")),
+        _to_code(_PIN_STATES, message.get("state")),
+        len(name),
+        message.get("address", 0),
+        0,
+        message.get("size", message.get("mask", 0)),
+        message.get(
+            "timeout_ms", message.get("value", message.get("advance_us", 0))
+        ),
+        message.get("bytes_transferred", 0),
+        len(data),
+        message.get("id", 0),
+    )
+    return header + name + data
+
+
+def decode_binary(frame: bytes) -> dict[str, Any]:
+    if len(frame) < _HEADER.size or not is_binary_frame(frame):
+        raise ValueError("Not a binary frame")
+    (
+        _magic,
+        message_type,
+        object_type,
+        operation,
+        status,
+        state,
+        name_size,
+        address,
+        _reserved,
+        size,
+        timeout_ms,
+        bytes_transferred,
+        data_size,
+        correlation_id,
+    ) = _HEADER.unpack_from(frame)
+    if len(frame) != _HEADER.size + name_size + data_size:
+        raise ValueError("Binary frame size mismatch")
+
+    body = frame[_HEADER.size :]
+    decoded: dict[str, Any] = {
+        "type": _from_code(_MESSAGE_TYPES, message_type),
+        "object": _from_code(_OBJECT_TYPES, object_type),
+        "name": body[:name_size].decode(),
+    }
+    values: dict[str, Any] = {
+        "operation": _from_code(_OPERATIONS, operation),
+        "state": _from_code(_PIN_STATES, state),
+        "status": _from_code(_STATUSES, status),
+        "address": address,
+        "data": list(body[name_size:]),
+        "size": size,
+        "timeout_ms": timeout_ms,
+        "bytes_transferred": bytes_transferred,
+        "mask": size,
+        "value": timeout_ms,
+        "advance_us": timeout_ms,
+    }
+    fields = _FIELDS.get((decoded["object"], decoded["type"]), tuple(values))
+    decoded.update({field: values[field] for field in fields})
+    # Like JSON, the correlation id is only present when the sender set one
+    if correlation_id:
+        decoded["id"] = correlation_id
+    return decoded
+
+
+def encode(message: dict[str, Any], wire_format: WireFormat) -> bytes:
+    if wire_format == WireFormat.BINARY:
+        return encode_binary(message)
+    return json.dumps(message).encode()
+
+
+def decode(frame: bytes) -> dict[str, Any]:
+    """Decode a frame in either format."""
+    if is_binary_frame(frame):
+        return decode_binary(frame)
+    decoded: dict[str, Any] = json.loads(frame)
+    return decoded
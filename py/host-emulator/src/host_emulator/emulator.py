@@ -3,7 +3,6 @@
 
 from __future__ import annotations
 
-import json
 import logging
 import sys
 import time
@@ -13,9 +12,21 @@ from typing import Any, NoReturn
 
 import zmq
 
+from .clock import Clock
+from .codec import WireFormat, decode, encode, format_of
 from .common import UnhandledMessageError
 from .i2c import I2C
 from .pin import Pin, PinDirection, PinState
+from .port import Port
+from .shm import (
+    DEVICE_REPLY,
+    DEVICE_REQUEST,
+    EMULATOR_REPLY,
+    EMULATOR_REQUEST,
+    DeviceSocket,
+    ShmSegment,
+    is_shm_endpoint,
+)
 from .uart import Uart
 
 logger = logging.getLogger(__name__)
@@ -39,19 +50,26 @@ class DeviceEmulator:
         self,
         from_device_endpoint: str | None = None,
         to_device_endpoint: str | None = None,
+        wire_format: WireFormat = WireFormat.JSON,
     ) -> None:
         """Initialize the device emulator.
 
         Args:
             from_device_endpoint: ZMQ endpoint to bind for receiving from device.
                                  Default: "ipc:///tmp/device_emulator.ipc"
+                                 "shm://<name>" creates a shared-memory
+                                 segment instead, and to_device_endpoint is
+                                 then unused.
             to_device_endpoint: ZMQ endpoint to connect for sending to device.
                                Default: "ipc:///tmp/emulator_device.ipc"
+            wire_format: Encoding for messages initiated by the emulator.
+                         Replies always use the format of the request.
         """
         self.from_device_endpoint = (
             from_device_endpoint or self.DEFAULT_FROM_DEVICE_ENDPOINT
         )
         self.to_device_endpoint = to_device_endpoint or self.DEFAULT_TO_DEVICE_ENDPOINT
+        self.wire_format = wire_format
 
         logger.info("Creating DeviceEmulator")
         logger.debug("  from_device: %s", self.from_device_endpoint)
@@ -60,28 +78,55 @@ class DeviceEmulator:
         self.running = False
 
         self.context: zmq.Context[zmq.Socket[bytes]] = zmq.Context()
-
-        self.to_device_socket: zmq.Socket[bytes] = self.context.socket(zmq.PAIR)
-        self.from_device_socket: zmq.Socket[bytes] = self.context.socket(zmq.PAIR)
-
-        self.to_device_socket.setsockopt(zmq.LINGER, 0)
-        self.to_device_socket.setsockopt(zmq.SNDTIMEO, 1000)
-        self.from_device_socket.setsockopt(zmq.LINGER, 0)
-        self.from_device_socket.setsockopt(zmq.RCVTIMEO, 500)
-
-        self.led_1 = Pin("LED 1", PinDirection.OUT, PinState.Low, self.to_device_socket)
-        self.led_2 = Pin("LED 2", PinDirection.OUT, PinState.Low, self.to_device_socket)
+        self.shm_segment: ShmSegment | None = None
+
+        self.to_device_socket: DeviceSocket
+        self.from_device_socket: DeviceSocket
+        if is_shm_endpoint(self.from_device_endpoint):
+            self.shm_segment = ShmSegment(self.from_device_endpoint)
+            self.to_device_socket = self.shm_segment.channel(
+                EMULATOR_REQUEST, DEVICE_REPLY
+            )
+            self.from_device_socket = self.shm_segment.channel(
+                EMULATOR_REPLY, DEVICE_REQUEST, recv_timeout=0.5
+            )
+        else:
+            to_device_socket = self.context.socket(zmq.PAIR)
+            from_device_socket = self.context.socket(zmq.PAIR)
+            to_device_socket.setsockopt(zmq.LINGER, 0)
+            to_device_socket.setsockopt(zmq.SNDTIMEO, 1000)
+            from_device_socket.setsockopt(zmq.LINGER, 0)
+            from_device_socket.setsockopt(zmq.RCVTIMEO, 500)
+            self.to_device_socket = to_device_socket
+            self.from_device_socket = from_device_socket
+
+        self.led_1 = Pin(
+            "LED 1", PinDirection.OUT, PinState.Low, self.to_device_socket, wire_format
+        )
+        self.led_2 = Pin(
+            "LED 2", PinDirection.OUT, PinState.Low, self.to_device_socket, wire_format
+        )
         self.button_1 = Pin(
-            "Button 1", PinDirection.IN, PinState.Low, self.to_device_socket
+            "Button 1",
+            PinDirection.IN,
+            PinState.Low,
+            self.to_device_socket,
+            wire_format,
         )
         self.pins = [self.led_1, self.led_2, self.button_1]
 
-        self.uart_1 = Uart("UART 1", self.to_device_socket)
+        self.uart_1 = Uart("UART 1", self.to_device_socket, wire_format)
         self.uarts = [self.uart_1]
 
         self.i2c_1 = I2C("I2C 1")
         self.i2cs = [self.i2c_1]
 
+        self.port_a = Port("Port A")
+        self.ports = [self.port_a]
+
+        # Only moves when the device runs in simulated time
+        self.clock = Clock("Clock")
+
         self.emulator_thread = Thread(target=self.run)
         self._ready = False
 
@@ -100,6 +145,12 @@ class DeviceEmulator:
     def i2c1(self) -> I2C:
         return self.i2c_1
 
+    def gpio_port_a(self) -> Port:
+        return self.port_a
+
+    def simulation_clock(self) -> Clock:
+        return self.clock
+
     def run(self) -> None:
         """Main emulator thread - BIND first, then signal ready."""
         logger.debug("Starting emulator thread")
@@ -112,33 +163,30 @@ class DeviceEmulator:
                 except FileNotFoundError:
                     pass
 
-            self.from_device_socket.bind(self.from_device_endpoint)
-            logger.debug("Bound to %s", self.from_device_endpoint)
+            # The shared-memory segment was created in __init__
+            if isinstance(self.from_device_socket, zmq.Socket):
+                self.from_device_socket.bind(self.from_device_endpoint)
+                logger.debug("Bound to %s", self.from_device_endpoint)
 
             self.running = True
             self._ready = True
 
             while self.running:
                 try:
-                    message = self.from_device_socket.recv()
-
-                    if not (message.startswith(b"{") and message.endswith(b"}")):
-                        logger.warning("Received non-JSON message: %s", message)
+                    # A batch from the device arrives as one multipart message
+                    # and is answered with one reply frame per request frame.
+                    frames = self.from_device_socket.recv_multipart()
+                    # The device ends a batch it could not finish sending
+                    # with an empty frame; none of it is answered.
+                    if not frames[-1]:
+                        logger.warning("Dropped abandoned batch: %s", frames)
                         continue
-
-                    json_message: dict[str, Any] = json.loads(message)
-                    object_type = json_message.get("object")
-
-                    if object_type == "Pin":
-                        self._handle_pin_message(json_message)
-                    elif object_type == "Uart":
-                        self._handle_uart_message(json_message)
-                    elif object_type == "I2C":
-                        self._handle_i2c_message(json_message)
-                    else:
-                        raise UnhandledMessageError(
-                            f"Unknown object type: {object_type}"
-                        )
+                    try:
+                        replies = [self._handle_frame(frame) for frame in frames]
+                    except ValueError:
+                        logger.warning("Received malformed message: %s", frames)
+                        continue
+                    self.from_device_socket.send_multipart(replies)
 
                 except zmq.Again:
                     if not self.running:
@@ -151,29 +199,60 @@ class DeviceEmulator:
             self.from_device_socket.close()
             logger.debug("Emulator thread exiting")
 
-    def _handle_pin_message(self, json_message: dict[str, Any]) -> None:
+    def _handle_frame(self, frame: bytes) -> bytes:
+        """Handle one request frame and return the encoded reply."""
+        message = decode(frame)
+        object_type = message.get("object")
+        if object_type == "Pin":
+            response = self._handle_pin_message(message)
+        elif object_type == "Uart":
+            response = self._handle_uart_message(message)
+        elif object_type == "I2C":
+            response = self._handle_i2c_message(message)
+        elif object_type == "Port":
+            response = self._handle_port_message(message)
+        elif object_type == "Clock":
+            response = self._handle_clock_message(message)
+        else:
+            raise UnhandledMessageError(f"Unknown object type: {object_type}")
+        # Echo the correlation id so the device can match reply to request
+        if "id" in message:
+            response["id"] = message["id"]
+        return encode(response, format_of(frame))
+
+    def _handle_pin_message(self, message: dict[str, Any]) -> dict[str, Any]:
         """Handle a Pin message by dispatching to the appropriate pin."""
         for pin in self.pins:
-            if response := pin.handle_message(json_message):
-                self.from_device_socket.send_string(response)
-                return
-        raise UnhandledMessageError(f"Pin not found: {json_message.get('name')}")
+            if response := pin.handle_message(message):
+                return response
+        raise UnhandledMessageError(f"Pin not found: {message.get('name')}")
 
-    def _handle_uart_message(self, json_message: dict[str, Any]) -> None:
+    def _handle_uart_message(self, message: dict[str, Any]) -> dict[str, Any]:
         """Handle a Uart message by dispatching to the appropriate uart."""
         for uart in self.uarts:
-            if response := uart.handle_message(json_message):
-                self.from_device_socket.send_string(response)
-                return
-        raise UnhandledMessageError(f"Uart not found: {json_message.get('name')}")
+            if response := uart.handle_message(message):
+                return response
+        raise UnhandledMessageError(f"Uart not found: {message.get('name')}")
 
-    def _handle_i2c_message(self, json_message: dict[str, Any]) -> None:
+    def _handle_i2c_message(self, message: dict[str, Any]) -> dict[str, Any]:
         """Handle an I2C message by dispatching to the appropriate i2c."""
         for i2c in self.i2cs:
-            if response := i2c.handle_message(json_message):
-                self.from_device_socket.send_string(response)
-                return
-        raise UnhandledMessageError(f"I2C not found: {json_message.get('name')}")
+            if response := i2c.handle_message(message):
+                return response
+        raise UnhandledMessageError(f"I2C not found: {message.get('name')}")
+
+    def _handle_port_message(self, message: dict[str, Any]) -> dict[str, Any]:
+        """Handle a Port message by dispatching to the appropriate port."""
+        for port in self.ports:
+            if response := port.handle_message(message):
+                return response
+        raise UnhandledMessageError(f"Port not found: {message.get('name')}")
+
+    def _handle_clock_message(self, message: dict[str, Any]) -> dict[str, Any]:
+        """Handle a Clock message from a device running in simulated time."""
+        if response := self.clock.handle_message(message):
+            return response
+        raise UnhandledMessageError(f"Clock not found: {message.get('name')}")
 
     def start(self) -> None:
         """Start emulator and wait until ready."""
@@ -186,8 +265,9 @@ class DeviceEmulator:
                 raise RuntimeError("Emulator failed to start within timeout")
             time.sleep(0.01)
 
-        self.to_device_socket.connect(self.to_device_endpoint)
-        logger.debug("Connected to %s", self.to_device_endpoint)
+        if isinstance(self.to_device_socket, zmq.Socket):
+            self.to_device_socket.connect(self.to_device_endpoint)
+            logger.debug("Connected to %s", self.to_device_endpoint)
 
         time.sleep(0.05)
 
@@ -200,6 +280,8 @@ class DeviceEmulator:
 
         self.to_device_socket.close()
         self.context.term()
+        if self.shm_segment is not None:
+            self.shm_segment.close()
         logger.info("Emulator stopped")
 
     def uart_initialized(self, name: str) -> bool:
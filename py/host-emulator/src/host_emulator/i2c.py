@@ -2,8 +2,8 @@
 
 from __future__ import annotations
 
-import json
 import logging
+import struct
 import threading
 from typing import TYPE_CHECKING, Any
 
@@ -14,6 +14,11 @@ if TYPE_CHECKING:
 
 logger = logging.getLogger(__name__)
 
+# Header of each segment packed into a Transaction request's data: address,
+# write size, read size and flags. Matches kI2CSegmentHeaderSize in
+# src/libs/mcu/host/host_emulator_messages.hpp.
+_SEGMENT_HEADER = struct.Struct("<HHHB")
+
 
 class I2C:
     """Emulates an I2C controller/peripheral."""
@@ -25,7 +30,7 @@ class I2C:
         self.on_response: Callable[[dict[str, Any]], None] | None = None
         self.on_request: Callable[[dict[str, Any]], None] | None = None
 
-    def handle_request(self, message: dict[str, Any]) -> str:
+    def handle_request(self, message: dict[str, Any]) -> dict[str, Any]:
         response: dict[str, Any] = {
             "type": "Response",
             "object": "I2C",
@@ -58,31 +63,81 @@ class I2C:
 
         elif message["operation"] == "Receive":
             # Device is receiving data from I2C peripheral
-            size: int = message.get("size", 0)
-            if address in self.device_buffers:
-                bytes_to_send = min(size, len(self.device_buffers[address]))
-                data = list(self.device_buffers[address][:bytes_to_send])
-            else:
-                bytes_to_send = 0
-                data = []
-            response.update(
-                {
-                    "data": data,
-                    "bytes_transferred": bytes_to_send,
-                    "status": Status.Ok.name,
-                }
-            )
+            response.update(self._read(address, message.get("size", 0)))
+
+        elif message["operation"] == "Transfer":
+            # Write then read after a repeated start, in one transaction
+            written: list[int] = message.get("data", [])
+            if written:
+                self.device_buffers[address] = bytearray(written)
             logger.info(
-                "[I2C %s] Read %d bytes from address 0x%02X: %s",
+                "[I2C %s] Wrote %d bytes to address 0x%02X: %s",
                 self.name,
-                bytes_to_send,
+                len(written),
                 address,
-                bytes(data),
+                bytes(written),
             )
+            response.update(self._read(address, message.get("size", 0)))
+
+        elif message["operation"] == "Transaction":
+            response.update(self._transact(bytes(message.get("data", []))))
 
         if self.on_request:
             self.on_request(message)
-        return json.dumps(response)
+        return response
+
+    def _read(self, address: int, size: int) -> dict[str, Any]:
+        """Read up to size bytes from the device buffer at address."""
+        if address in self.device_buffers:
+            bytes_to_send = min(size, len(self.device_buffers[address]))
+            data = list(self.device_buffers[address][:bytes_to_send])
+        else:
+            bytes_to_send = 0
+            data = []
+        logger.info(
+            "[I2C %s] Read %d bytes from address 0x%02X: %s",
+            self.name,
+            bytes_to_send,
+            address,
+            bytes(data),
+        )
+        return {
+            "data": data,
+            "bytes_transferred": bytes_to_send,
+            "status": Status.Ok.name,
+        }
+
+    def _transact(self, packed: bytes) -> dict[str, Any]:
+        """Run the segments packed into a Transaction request in order.
+
+        Each read is padded with 0xFF, as an idle bus reads, so that every
+        segment's bytes land at a fixed offset in the response.
+        """
+        read_data = bytearray()
+        offset = 0
+        while offset < len(packed):
+            if offset + _SEGMENT_HEADER.size > len(packed):
+                return {"status": Status.InvalidArgument.name}
+            address, write_size, read_size, _flags = _SEGMENT_HEADER.unpack_from(
+                packed, offset
+            )
+            offset += _SEGMENT_HEADER.size
+            written = packed[offset : offset + write_size]
+            if len(written) != write_size:
+                return {"status": Status.InvalidArgument.name}
+            offset += write_size
+            if written:
+                self.device_buffers[address] = bytearray(written)
+            stored = self.device_buffers.get(address, bytearray())
+            read_data += stored[:read_size].ljust(read_size, b"\xff")
+        logger.info(
+            "[I2C %s] Ran transaction, read %d bytes", self.name, len(read_data)
+        )
+        return {
+            "data": list(read_data),
+            "bytes_transferred": len(read_data),
+            "status": Status.Ok.name,
+        }
 
     def handle_response(self, message: dict[str, Any]) -> None:
         logger.debug("[I2C %s] Received response: %s", self.name, message)
@@ -99,7 +154,7 @@ class I2C:
     ) -> None:
         self.on_response = on_response
 
-    def handle_message(self, message: dict[str, Any]) -> str | None:
+    def handle_message(self, message: dict[str, Any]) -> dict[str, Any] | None:
         if message["object"] != "I2C":
             return None
         if message["name"] != self.name:
@@ -133,7 +188,8 @@ class I2C:
         """Wait for a specific I2C operation to occur.
 
         Args:
-            operation: The operation to wait for ("Send" or "Receive")
+            operation: The operation to wait for ("Send", "Receive",
+                "Transfer" or "Transaction")
             address: Optional address to filter on (waits for any address if None)
             timeout: Maximum time to wait in seconds
 
@@ -161,7 +217,10 @@ class I2C:
     def wait_for_transactions(
         self, count: int, address: int | None = None, timeout: float = 2.0
     ) -> bool:
-        """Wait for a specific number of I2C transactions (send or receive).
+        """Wait for a specific number of I2C transactions.
+
+        Sends, receives, write-then-read transfers and batched transactions
+        each count as one.
 
         Args:
             count: Number of transactions to wait for
@@ -181,7 +240,10 @@ class I2C:
                 old_handler(message)
             operation = message.get("operation")
             addr_matches = address is None or message.get("address") == address
-            if operation in ("Send", "Receive") and addr_matches:
+            if (
+                operation in ("Send", "Receive", "Transfer", "Transaction")
+                and addr_matches
+            ):
                 transactions += 1
                 if transactions >= count:
                     event.set()
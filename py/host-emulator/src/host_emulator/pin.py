@@ -2,18 +2,18 @@
 
 from __future__ import annotations
 
-import json
 import logging
 import threading
 from enum import Enum
 from typing import TYPE_CHECKING, Any
 
+from .codec import WireFormat, decode, encode
 from .common import Status
 
 if TYPE_CHECKING:
     from collections.abc import Callable
 
-    import zmq
+    from .shm import DeviceSocket
 
 logger = logging.getLogger(__name__)
 
@@ -41,16 +41,18 @@ class Pin:
         name: str,
         pin_direction: PinDirection,
         initial_state: PinState,
-        to_device_socket: zmq.Socket[bytes],
+        to_device_socket: DeviceSocket,
+        wire_format: WireFormat = WireFormat.JSON,
     ) -> None:
         self.name = name
         self.pin_direction = pin_direction
         self.state = initial_state
         self.to_device_socket = to_device_socket
+        self.wire_format = wire_format
         self.on_response: Callable[[dict[str, Any]], None] | None = None
         self.on_request: Callable[[dict[str, Any]], None] | None = None
 
-    def handle_request(self, message: dict[str, Any]) -> str:
+    def handle_request(self, message: dict[str, Any]) -> dict[str, Any]:
         response: dict[str, Any] = {
             "type": "Response",
             "object": "Pin",
@@ -76,7 +78,7 @@ class Pin:
 
         if self.on_request:
             self.on_request(message)
-        return json.dumps(response)
+        return response
 
     def set_state(self, state: PinState) -> dict[str, Any]:
         self.state = state
@@ -88,10 +90,10 @@ class Pin:
             "state": self.state.name,
         }
         logger.debug("[Pin Set] Sending request: %s", request)
-        self.to_device_socket.send_string(json.dumps(request))
+        self.to_device_socket.send(encode(request, self.wire_format))
         reply = self.to_device_socket.recv()
         logger.debug("[Pin Set] Received response: %s", reply)
-        response: dict[str, Any] = json.loads(reply)
+        response = decode(reply)
         self.handle_response(response)
         return response
 
@@ -104,10 +106,10 @@ class Pin:
             "state": PinState.Hi_Z.name,
         }
         logger.debug("[Pin Get] Sending request: %s", request)
-        self.to_device_socket.send_string(json.dumps(request))
+        self.to_device_socket.send(encode(request, self.wire_format))
         reply = self.to_device_socket.recv()
         logger.debug("[Pin Get] Received response: %s", reply)
-        response: dict[str, Any] = json.loads(reply)
+        response = decode(reply)
         self.handle_response(response)
         return response
 
@@ -132,7 +134,7 @@ class Pin:
         )
         self.on_response = on_response
 
-    def handle_message(self, message: dict[str, Any]) -> str | None:
+    def handle_message(self, message: dict[str, Any]) -> dict[str, Any] | None:
         if message["object"] != "Pin":
             return None
         if message["name"] != self.name:
@@ -0,0 +1,75 @@
+"""GPIO port emulation for the host emulator."""
+
+from __future__ import annotations
+
+import logging
+from typing import TYPE_CHECKING, Any
+
+from .common import Status
+
+if TYPE_CHECKING:
+    from collections.abc import Callable
+
+logger = logging.getLogger(__name__)
+
+
+class Port:
+    """Emulates a GPIO port whose pins are read and written as one bitmask.
+
+    Bit n of ``levels`` is pin n. The device drives pins with a masked Set and
+    reads every pin with Get; tests drive the inputs with ``set_levels``.
+    """
+
+    def __init__(self, name: str, width: int = 32) -> None:
+        self.name = name
+        self.width_mask = (1 << width) - 1
+        self.levels = 0
+        self.on_request: Callable[[dict[str, Any]], None] | None = None
+
+    def handle_request(self, message: dict[str, Any]) -> dict[str, Any]:
+        response: dict[str, Any] = {
+            "type": "Response",
+            "object": "Port",
+            "name": self.name,
+            "value": self.levels,
+            "status": Status.InvalidOperation.name,
+        }
+        if message["operation"] == "Get":
+            response["status"] = Status.Ok.name
+        elif message["operation"] == "Set":
+            self.set_levels(message.get("mask", 0), message.get("value", 0))
+            response.update(
+                {
+                    "value": self.levels,
+                    "status": Status.Ok.name,
+                }
+            )
+        # default response status is InvalidOperation
+
+        if self.on_request:
+            self.on_request(message)
+        return response
+
+    def set_levels(self, mask: int, value: int) -> None:
+        """Drive the pins in mask to the matching bits of value."""
+        mask &= self.width_mask
+        self.levels = (self.levels & ~mask) | (value & mask)
+        logger.debug("[Port %s] Levels: 0x%08X", self.name, self.levels)
+
+    def pin(self, index: int) -> bool:
+        """Level of a single pin."""
+        return bool(self.levels >> index & 1)
+
+    def set_on_request(
+        self, on_request: Callable[[dict[str, Any]], None] | None
+    ) -> None:
+        self.on_request = on_request
+
+    def handle_message(self, message: dict[str, Any]) -> dict[str, Any] | None:
+        if message["object"] != "Port":
+            return None
+        if message["name"] != self.name:
+            return None
+        if message["type"] == "Request":
+            return self.handle_request(message)
+        return None
@@ -0,0 +1,317 @@
+"""Shared-memory transport for talking to the device without sockets.
+
+The emulator creates a POSIX shared-memory segment holding four
+single-producer single-consumer rings; the device opens it with
+``mcu::ShmTransport``. The layout matches
+``src/libs/mcu/host/shm_segment.hpp`` and ``src/libs/mcu/host/shm_ring.hpp``.
+
+Ring positions are plain 32-bit words updated with single aligned stores.
+Python has no release or acquire operations, so this side relies on the
+strong ordering of x86-64 to publish frame bytes before the position that
+covers them, and to read the position before the bytes it covers. Weaker
+architectures could see a position ahead of its data, so ShmSegment refuses
+to run on them.
+"""
+
+from __future__ import annotations
+
+import contextlib
+import ctypes
+import ctypes.util
+import platform
+import struct
+import time
+from multiprocessing import shared_memory
+from typing import Any, TypeAlias
+
+import zmq
+
+SHM_ENDPOINT_SCHEME = "shm://"
+
+MAGIC = 0x4D485345  # "ESHM"
+VERSION = 1
+DEFAULT_RING_CAPACITY = 64 * 1024
+SEGMENT_HEADER_SIZE = 64
+RING_HEADER_SIZE = 128
+MORE_FLAG = 0x80000000
+
+# Ring indices, named after who writes them
+DEVICE_REQUEST = 0
+EMULATOR_REPLY = 1
+EMULATOR_REQUEST = 2
+DEVICE_REPLY = 3
+_RING_COUNT = 4
+
+# Header word indices within a ring
+_HEAD = 0
+_CONSUMER_WAITING = 1
+_TAIL = 16
+_PRODUCER_WAITING = 17
+
+_LENGTH = struct.Struct("<I")
+
+# Upper bound on one sleep, matching the device side
+_MAX_SLEEP = 0.01
+
+# Where plain stores and loads keep their program order (see above)
+_SUPPORTED_MACHINES = ("x86_64", "AMD64")
+
+
+def is_shm_endpoint(endpoint: str) -> bool:
+    return endpoint.startswith(SHM_ENDPOINT_SCHEME)
+
+
+class _Futex:
+    """Shared (cross-process) futex wait and wake through libc's syscall()."""
+
+    _SYS_FUTEX = {"x86_64": 202}
+    _FUTEX_WAIT = 0
+    _FUTEX_WAKE = 1
+
+    class _Timespec(ctypes.Structure):
+        _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+    def __init__(self) -> None:
+        self._number = self._SYS_FUTEX.get(platform.machine())
+        self._syscall: Any = None
+        if self._number is not None and (libc := ctypes.util.find_library("c")):
+            self._syscall = ctypes.CDLL(libc, use_errno=True).syscall
+
+    def wait(self, address: int, seen: int, timeout: float) -> None:
+        if self._syscall is None:
+            time.sleep(min(timeout, 0.0001))
+            return
+        relative = self._Timespec(int(timeout), int((timeout % 1) * 1e9))
+        self._syscall(
+            ctypes.c_long(self._number),
+            ctypes.c_void_p(address),
+            ctypes.c_int(self._FUTEX_WAIT),
+            ctypes.c_uint32(seen),
+            ctypes.byref(relative),
+            None,
+            ctypes.c_int(0),
+        )
+
+    def wake(self, address: int) -> None:
+        if self._syscall is None:
+            return  # The device re-checks at least every _MAX_SLEEP
+        self._syscall(
+            ctypes.c_long(self._number),
+            ctypes.c_void_p(address),
+            ctypes.c_int(self._FUTEX_WAKE),
+            ctypes.c_int(2**31 - 1),
+            None,
+            None,
+            ctypes.c_int(0),
+        )
+
+
+_FUTEX = _Futex()
+
+
+class ShmRing:
+    """One direction of a shared-memory channel."""
+
+    def __init__(
+        self, buf: memoryview, offset: int, capacity: int, base_address: int
+    ) -> None:
+        self._words = buf[offset : offset + RING_HEADER_SIZE].cast("I")
+        data_offset = offset + RING_HEADER_SIZE
+        self._data = buf[data_offset : data_offset + capacity]
+        self._capacity = capacity
+        self._head_address = base_address + offset + _HEAD * 4
+        self._tail_address = base_address + offset + _TAIL * 4
+
+    def release(self) -> None:
+        self._words.release()
+        self._data.release()
+
+    def write(self, frame: bytes, more: bool = False, timeout: float = 1.0) -> None:
+        """Write one frame, waiting up to timeout seconds for room."""
+        record = _LENGTH.size + len(frame)
+        if len(frame) >= MORE_FLAG or record > self._capacity:
+            raise ValueError(f"Frame of {len(frame)} bytes does not fit the ring")
+        head = self._words[_HEAD]
+        deadline = time.monotonic() + timeout
+        while True:
+            tail = self._words[_TAIL]
+            if self._capacity - ((head - tail) & 0xFFFFFFFF) >= record:
+                break
+            if not self._wait_for_change(
+                _TAIL, tail, _PRODUCER_WAITING, self._tail_address, deadline
+            ):
+                raise TimeoutError("Timed out waiting for room in the ring")
+
+        length = len(frame) | (MORE_FLAG if more else 0)
+        self._copy_in(head, _LENGTH.pack(length))
+        self._copy_in(head + _LENGTH.size, frame)
+        self._words[_HEAD] = (head + record) & 0xFFFFFFFF
+        if self._words[_CONSUMER_WAITING]:
+            _FUTEX.wake(self._head_address)
+
+    def read(self, timeout: float | None = None) -> tuple[bytes, bool]:
+        """Read one frame and its more flag, waiting up to timeout seconds."""
+        tail = self._words[_TAIL]
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while self._words[_HEAD] == tail:
+            if not self._wait_for_change(
+                _HEAD, tail, _CONSUMER_WAITING, self._head_address, deadline
+            ):
+                raise TimeoutError("Timed out waiting for a frame")
+
+        (length,) = _LENGTH.unpack(self._copy_out(tail, _LENGTH.size))
+        size = length & ~MORE_FLAG
+        frame = self._copy_out(tail + _LENGTH.size, size)
+        self._words[_TAIL] = (tail + _LENGTH.size + size) & 0xFFFFFFFF
+        if self._words[_PRODUCER_WAITING]:
+            _FUTEX.wake(self._tail_address)
+        return frame, bool(length & MORE_FLAG)
+
+    def _wait_for_change(
+        self,
+        word: int,
+        seen: int,
+        waiting: int,
+        address: int,
+        deadline: float | None,
+    ) -> bool:
+        while True:
+            remaining = _MAX_SLEEP if deadline is None else deadline - time.monotonic()
+            if remaining <= 0:
+                return self._words[word] != seen
+            # Publish the flag before the final check so a wake is not missed
+            self._words[waiting] = 1
+            if self._words[word] == seen:
+                _FUTEX.wait(address, seen, min(remaining, _MAX_SLEEP))
+            self._words[waiting] = 0
+            if self._words[word] != seen:
+                return True
+
+    def _copy_in(self, position: int, data: bytes) -> None:
+        offset = position % self._capacity
+        first = min(len(data), self._capacity - offset)
+        self._data[offset : offset + first] = data[:first]
+        self._data[: len(data) - first] = data[first:]
+
+    def _copy_out(self, position: int, size: int) -> bytes:
+        offset = position % self._capacity
+        first = min(size, self._capacity - offset)
+        return bytes(self._data[offset : offset + first]) + bytes(
+            self._data[: size - first]
+        )
+
+
+class ShmChannel:
+    """Socket-like pairing of a ring to write and a ring to read.
+
+    Offers the subset of the zmq.Socket API the emulator uses, and raises
+    zmq.Again on receive timeouts like a socket with RCVTIMEO set, so it can
+    stand in for one.
+    """
+
+    def __init__(
+        self,
+        outgoing: ShmRing,
+        incoming: ShmRing,
+        recv_timeout: float | None = None,
+        send_timeout: float = 1.0,
+    ) -> None:
+        self._outgoing = outgoing
+        self._incoming = incoming
+        self._recv_timeout = recv_timeout
+        self._send_timeout = send_timeout
+
+    def send(self, data: bytes) -> None:
+        self.send_multipart([data])
+
+    def recv(self) -> bytes:
+        frame, _ = self._read()
+        return frame
+
+    def send_string(self, data: str) -> None:
+        self.send(data.encode())
+
+    def send_multipart(self, frames: list[bytes]) -> None:
+        for i, frame in enumerate(frames):
+            self._outgoing.write(frame, i + 1 < len(frames), self._send_timeout)
+
+    def recv_multipart(self) -> list[bytes]:
+        frame, more = self._read()
+        frames = [frame]
+        while more:
+            frame, more = self._incoming.read(self._send_timeout)
+            frames.append(frame)
+        return frames
+
+    def close(self) -> None:
+        """Nothing to release; the segment owns the rings."""
+
+    def _read(self) -> tuple[bytes, bool]:
+        try:
+            return self._incoming.read(self._recv_timeout)
+        except TimeoutError as error:
+            raise zmq.Again from error
+
+
+# Either kind of connection to the device
+DeviceSocket: TypeAlias = "zmq.Socket[bytes] | ShmChannel"
+
+
+class ShmSegment:
+    """Shared-memory segment created by the emulator for one device."""
+
+    def __init__(self, name: str, ring_capacity: int = DEFAULT_RING_CAPACITY) -> None:
+        if platform.machine() not in _SUPPORTED_MACHINES:
+            raise RuntimeError(
+                f"Shared-memory transport needs x86-64, not {platform.machine()}"
+            )
+        if ring_capacity <= 0 or ring_capacity & (ring_capacity - 1):
+            raise ValueError("Ring capacity must be a power of two")
+        name = name.removeprefix(SHM_ENDPOINT_SCHEME).lstrip("/")
+
+        # Replace a segment left behind by a run that did not clean up
+        with contextlib.suppress(FileNotFoundError):
+            shared_memory.SharedMemory(name).unlink()
+
+        ring_size = RING_HEADER_SIZE + ring_capacity
+        self._shm = shared_memory.SharedMemory(
+            name, create=True, size=SEGMENT_HEADER_SIZE + _RING_COUNT * ring_size
+        )
+        buf = self._shm.buf
+        # Only used for its address; dropped before the segment is closed
+        self._anchor: ctypes.Array[ctypes.c_char] | None = (
+            ctypes.c_char * len(buf)
+        ).from_buffer(buf)
+        base_address = ctypes.addressof(self._anchor)
+        self.rings = [
+            ShmRing(
+                buf, SEGMENT_HEADER_SIZE + i * ring_size, ring_capacity, base_address
+            )
+            for i in range(_RING_COUNT)
+        ]
+
+        header = buf[:SEGMENT_HEADER_SIZE].cast("I")
+        header[1] = VERSION
+        header[2] = ring_capacity
+        header[0] = MAGIC  # Last: the device waits for it
+        header.release()
+
+    def channel(
+        self,
+        outgoing: int,
+        incoming: int,
+        recv_timeout: float | None = None,
+        send_timeout: float = 1.0,
+    ) -> ShmChannel:
+        return ShmChannel(
+            self.rings[outgoing], self.rings[incoming], recv_timeout, send_timeout
+        )
+
+    def close(self) -> None:
+        """Unmap and unlink the segment."""
+        for ring in self.rings:
+            ring.release()
+        self._anchor = None
+        self._shm.close()
+        with contextlib.suppress(FileNotFoundError):
+            self._shm.unlink()
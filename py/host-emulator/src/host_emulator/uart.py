@@ -2,17 +2,17 @@
 
 from __future__ import annotations
 
-import json
 import logging
 import threading
 from typing import TYPE_CHECKING, Any
 
+from .codec import WireFormat, decode, encode
 from .common import Status
 
 if TYPE_CHECKING:
     from collections.abc import Callable
 
-    import zmq
+    from .shm import DeviceSocket
 
 logger = logging.getLogger(__name__)
 
@@ -20,14 +20,20 @@ logger = logging.getLogger(__name__)
 class Uart:
     """Emulates a UART peripheral."""
 
-    def __init__(self, name: str, to_device_socket: zmq.Socket[bytes]) -> None:
+    def __init__(
+        self,
+        name: str,
+        to_device_socket: DeviceSocket,
+        wire_format: WireFormat = WireFormat.JSON,
+    ) -> None:
         self.name = name
         self.to_device_socket = to_device_socket
+        self.wire_format = wire_format
         self.rx_buffer = bytearray()  # Data waiting to be read
         self.on_response: Callable[[dict[str, Any]], None] | None = None
         self.on_request: Callable[[dict[str, Any]], None] | None = None
 
-    def handle_request(self, message: dict[str, Any]) -> str:
+    def handle_request(self, message: dict[str, Any]) -> dict[str, Any]:
         response: dict[str, Any] = {
             "type": "Response",
             "object": "Uart",
@@ -72,7 +78,7 @@ class Uart:
 
         if self.on_request:
             self.on_request(message)
-        return json.dumps(response)
+        return response
 
     def send_data(self, data: bytes | list[int]) -> dict[str, Any]:
         """Send data to the device (emulator -> device)."""
@@ -87,11 +93,10 @@ class Uart:
             "timeout_ms": 0,
         }
         logger.debug("[UART %s] Sending data to device: %s", self.name, data)
-        self.to_device_socket.send_string(json.dumps(request))
+        self.to_device_socket.send(encode(request, self.wire_format))
         reply = self.to_device_socket.recv()
         logger.debug("[UART %s] Received response: %s", self.name, reply)
-        result: dict[str, Any] = json.loads(reply)
-        return result
+        return decode(reply)
 
     def handle_response(self, message: dict[str, Any]) -> None:
         logger.debug("[UART %s] Received response: %s", self.name, message)
@@ -108,7 +113,7 @@ class Uart:
     ) -> None:
         self.on_response = on_response
 
-    def handle_message(self, message: dict[str, Any]) -> str | None:
+    def handle_message(self, message: dict[str, Any]) -> dict[str, Any] | None:
         if message["object"] != "Uart":
             return None
         if message["name"] != self.name:
@@ -0,0 +1,51 @@
+"""Tests for the simulated clock."""
+
+from __future__ import annotations
+
+from host_emulator import Clock
+
+
+def _advance(advance_us: int, name: str = "Clock") -> dict[str, object]:
+    return {
+        "type": "Request",
+        "object": "Clock",
+        "name": name,
+        "operation": "Advance",
+        "advance_us": advance_us,
+    }
+
+
+def test_advance_moves_time() -> None:
+    clock = Clock()
+    response = clock.handle_message(_advance(200_000))
+    assert response is not None
+    assert response["status"] == "Ok"
+    assert clock.now_us == 200_000
+
+
+def test_callbacks_run_in_deadline_order_at_their_time() -> None:
+    clock = Clock()
+    fired: list[tuple[str, int]] = []
+    clock.call_at(300, lambda: fired.append(("late", clock.now_us)))
+    clock.call_at(100, lambda: fired.append(("early", clock.now_us)))
+    clock.call_at(5_000, lambda: fired.append(("later", clock.now_us)))
+
+    clock.handle_message(_advance(1_000))
+    assert fired == [("early", 100), ("late", 300)]
+    assert clock.now_us == 1_000
+
+    clock.call_later(10, lambda: fired.append(("next", clock.now_us)))
+    clock.handle_message(_advance(10_000))
+    assert fired[2:] == [("next", 1_010), ("later", 5_000)]
+
+
+def test_wait_until() -> None:
+    clock = Clock()
+    assert not clock.wait_until(1, timeout=0.01)
+    clock.advance(1)
+    assert clock.wait_until(1, timeout=0.01)
+
+
+def test_other_clocks_are_ignored() -> None:
+    clock = Clock("Clock")
+    assert clock.handle_message(_advance(1, name="Other")) is None
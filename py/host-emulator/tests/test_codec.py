@@ -0,0 +1,93 @@
+"""Tests for the emulator wire codecs."""
+
+from __future__ import annotations
+
+import pytest
+
+from host_emulator.codec import (
+    WireFormat,
+    decode,
+    encode,
+    format_of,
+    is_binary_frame,
+)
+
+MESSAGES = [
+    {
+        "type": "Request",
+        "object": "Pin",
+        "name": "LED 1",
+        "operation": "Set",
+        "state": "High",
+    },
+    {
+        "type": "Response",
+        "object": "Uart",
+        "name": "UART 1",
+        "data": list(range(256)),
+        "bytes_transferred": 256,
+        "status": "Ok",
+    },
+    {
+        "type": "Request",
+        "object": "I2C",
+        "name": "I2C 1",
+        "operation": "Receive",
+        "address": 0x50,
+        "data": [],
+        "size": 4,
+        "id": 7,
+    },
+    {
+        "type": "Request",
+        "object": "I2C",
+        "name": "I2C 1",
+        "operation": "Transfer",
+        "address": 0x50,
+        "data": [0x0F],
+        "size": 2,
+    },
+    {
+        "type": "Request",
+        "object": "Port",
+        "name": "Port A",
+        "operation": "Set",
+        "mask": 0x800000F0,
+        "value": 0xFFFFFF50,
+    },
+    {
+        "type": "Request",
+        "object": "Clock",
+        "name": "Clock",
+        "operation": "Advance",
+        "advance_us": 0xFFFFFFFF,
+    },
+]
+
+
+@pytest.mark.parametrize("wire_format", list(WireFormat))
+@pytest.mark.parametrize("message", MESSAGES)
+def test_round_trip(message: dict[str, object], wire_format: WireFormat) -> None:
+    frame = encode(message, wire_format)
+    assert format_of(frame) == wire_format
+    assert decode(frame) == message
+
+
+def test_binary_layout_matches_device() -> None:
+    frame = encode(MESSAGES[0], WireFormat.BINARY)
+    assert is_binary_frame(frame)
+    assert len(frame) == 32 + len("LED 1")
+    assert frame[1:6] == bytes([1, 1, 1, 0, 2])  # Request, Pin, Set, -, High
+    assert frame[32:] == b"LED 1"
+
+
+def test_binary_correlation_id() -> None:
+    frame = encode(MESSAGES[2], WireFormat.BINARY)
+    assert frame[28:32] == (7).to_bytes(4, "little")
+    assert "id" not in decode(encode(MESSAGES[0], WireFormat.BINARY))
+
+
+def test_truncated_binary_frame_is_rejected() -> None:
+    frame = encode(MESSAGES[1], WireFormat.BINARY)
+    with pytest.raises(ValueError):
+        decode(frame[:-1])
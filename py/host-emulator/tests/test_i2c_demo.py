@@ -21,27 +21,22 @@ def test_i2c_demo_starts(
 def test_i2c_demo_write_read_cycle(
     emulator: DeviceEmulator, i2c_demo: subprocess.Popen[bytes]
 ) -> None:
-    """Test that i2c_demo writes and reads from I2C device."""
+    """Test that i2c_demo writes and reads back in one I2C transfer."""
     _ = i2c_demo  # Ensure i2c_demo is running
     device_address = 0x50
     test_pattern = [0xDE, 0xAD, 0xBE, 0xEF]
-    write_count = 0
-    read_count = 0
+    transfer_count = 0
 
     def i2c_handler(message: dict[str, Any]) -> None:
-        nonlocal write_count, read_count
-        if message.get("operation") == "Send":
-            write_count += 1
+        nonlocal transfer_count
+        if message.get("operation") == "Transfer":
+            transfer_count += 1
             data = message.get("data", [])
             address = message.get("address", 0)
 
             assert address == device_address, f"Wrong address: 0x{address:02X}"
             assert data == test_pattern, f"Wrong data: {data}"
-
-        elif message.get("operation") == "Receive":
-            read_count += 1
-            address = message.get("address", 0)
-            assert address == device_address, f"Wrong address: 0x{address:02X}"
+            assert message.get("size") == len(test_pattern)
 
     emulator.i2c1().set_on_request(i2c_handler)
 
@@ -51,11 +46,7 @@ def test_i2c_demo_write_read_cycle(
         2, address=device_address, timeout=3.0
     ), "No I2C transactions occurred within timeout"
 
-    assert write_count > 0, "No I2C writes occurred"
-    assert read_count > 0, "No I2C reads occurred"
-    assert write_count == read_count, (
-        f"Write/read mismatch: {write_count} writes, {read_count} reads"
-    )
+    assert transfer_count > 0, "No I2C transfers occurred"
 
 
 def test_i2c_demo_toggles_leds(
@@ -87,7 +78,7 @@ def test_i2c_demo_data_mismatch(
     emulator.i2c1().write_to_device(device_address, wrong_pattern)
 
     assert emulator.i2c1().wait_for_operation(
-        "Receive", address=device_address, timeout=2.0
+        "Transfer", address=device_address, timeout=2.0
     ), "No I2C read occurred"
 
     assert emulator.user_led1().wait_for_state(PinState.Low, timeout=2.0), (
@@ -0,0 +1,40 @@
+"""Tests for the GPIO port emulation."""
+
+from __future__ import annotations
+
+from host_emulator import Port
+
+
+def _request(operation: str, mask: int = 0, value: int = 0) -> dict[str, object]:
+    return {
+        "type": "Request",
+        "object": "Port",
+        "name": "Port A",
+        "operation": operation,
+        "mask": mask,
+        "value": value,
+    }
+
+
+def test_set_only_touches_masked_pins() -> None:
+    port = Port("Port A")
+    port.set_levels(0xF000, 0xF000)
+    response = port.handle_message(_request("Set", mask=0x00FF, value=0xFFA5))
+    assert response is not None
+    assert response["status"] == "Ok"
+    assert response["value"] == 0xF0A5
+    assert port.pin(0)
+    assert not port.pin(1)
+
+
+def test_get_reports_every_pin() -> None:
+    port = Port("Port A", width=16)
+    port.set_levels(0xFFFFFFFF, 0x12345678)
+    response = port.handle_message(_request("Get"))
+    assert response is not None
+    assert response["value"] == 0x5678
+
+
+def test_other_ports_are_ignored() -> None:
+    port = Port("Port B")
+    assert port.handle_message(_request("Get")) is None
@@ -0,0 +1,84 @@
+"""Tests for the shared-memory transport."""
+
+from __future__ import annotations
+
+import os
+from threading import Thread
+from typing import TYPE_CHECKING
+
+import pytest
+import zmq
+
+from host_emulator.shm import (
+    DEVICE_REPLY,
+    DEVICE_REQUEST,
+    EMULATOR_REPLY,
+    EMULATOR_REQUEST,
+    MAGIC,
+    ShmSegment,
+)
+
+if TYPE_CHECKING:
+    from collections.abc import Generator
+
+
+@pytest.fixture
+def segment() -> Generator[ShmSegment, None, None]:
+    shm = ShmSegment(f"shm://test_shm_{os.getpid()}", ring_capacity=64)
+    yield shm
+    shm.close()
+
+
+def test_header_published(segment: ShmSegment) -> None:
+    # The device checks these before using the rings
+    header = segment._shm.buf[:12].cast("I")
+    assert list(header) == [MAGIC, 1, 64]
+    header.release()
+
+
+def test_frames_wrap_around_the_end(segment: ShmSegment) -> None:
+    ring = segment.rings[DEVICE_REQUEST]
+    for fill in range(10):
+        frame = bytes([fill]) * 25
+        ring.write(frame, more=fill == 1, timeout=0)
+        assert ring.read(timeout=0) == (frame, fill == 1)
+
+
+def test_full_and_empty_time_out(segment: ShmSegment) -> None:
+    ring = segment.rings[DEVICE_REQUEST]
+    with pytest.raises(TimeoutError):
+        ring.read(timeout=0.001)
+    ring.write(b"x" * 40, timeout=0)
+    with pytest.raises(TimeoutError):
+        ring.write(b"y" * 40, timeout=0.001)
+    with pytest.raises(ValueError, match="does not fit"):
+        ring.write(b"z" * 61)
+
+
+def test_channels_exchange_batches(segment: ShmSegment) -> None:
+    emulator = segment.channel(EMULATOR_REPLY, DEVICE_REQUEST, recv_timeout=1.0)
+    device = segment.channel(DEVICE_REQUEST, EMULATOR_REPLY, recv_timeout=1.0)
+
+    def serve() -> None:
+        frames = emulator.recv_multipart()
+        emulator.send_multipart([frame.upper() for frame in frames])
+
+    server = Thread(target=serve)
+    server.start()
+    device.send_multipart([b"one", b"two"])
+    assert device.recv_multipart() == [b"ONE", b"TWO"]
+    server.join()
+
+
+def test_receive_timeout_raises_again(segment: ShmSegment) -> None:
+    channel = segment.channel(EMULATOR_REQUEST, DEVICE_REPLY, recv_timeout=0.001)
+    with pytest.raises(zmq.Again):
+        channel.recv()
+
+
+def test_segment_refuses_weakly_ordered_machines(
+    monkeypatch: pytest.MonkeyPatch,
+) -> None:
+    monkeypatch.setattr("platform.machine", lambda: "aarch64")
+    with pytest.raises(RuntimeError, match="x86-64"):
+        ShmSegment(f"shm://test_shm_arm_{os.getpid()}")
@@ -1,17 +1,16 @@
 #include "blinky.hpp"
 
-#include <chrono>
 #include <expected>
 #include <functional>
 
 #include "apps/app.hpp"
 #include "libs/board/board.hpp"
 #include "libs/common/error.hpp"
-#include "libs/mcu/delay.hpp"
+#include "libs/common/scheduler.hpp"
 #include "libs/mcu/pin.hpp"
+#include "libs/mcu/timer.hpp"
 
 namespace app {
-using std::chrono::operator""ms;
 
 auto AppMain(board::Board& board) -> std::expected<void, common::Error> {
   Blinky blinky{board};
@@ -25,19 +24,27 @@ auto AppMain(board::Board& board) -> std::expected<void, common::Error> {
 }
 
 auto Blinky::Run() -> std::expected<void, common::Error> {
-  auto status{board_.UserLed1().SetHigh()};
-
-  while (true) {
-    status = status
-                 .and_then([this]() {
-                   mcu::Delay(200ms);
-                   return board_.UserLed1().Toggle();
-                 })
-                 .or_else([](auto error) -> std::expected<void, common::Error> {
-                   return std::unexpected(error);
-                 });
+  status_ = board_.UserLed1().SetHigh();
+  if (!status_) {
+    return status_;
+  }
+
+  status_ =
+      board_.Timer1().StartPeriodic(kBlinkPeriod, [this]() { Blink(); });
+  if (!status_) {
+    return status_;
+  }
+  board_.Events().Run();
+  return status_;
+}
+
+// Runs each period; a failed toggle stops the timer and the loop
+auto Blinky::Blink() -> void {
+  status_ = board_.UserLed1().Toggle();
+  if (!status_) {
+    board_.Timer1().Stop();
+    board_.Events().Stop();
   }
-  return {};
 }
 
 auto Blinky::Init() -> std::expected<void, common::Error> {
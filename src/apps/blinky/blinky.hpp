@@ -1,9 +1,25 @@
 #pragma once
 
+#include <chrono>
+#include <expected>
+
 #include "libs/board/board.hpp"
+#include "libs/common/error.hpp"
+#include "libs/mcu/delay.hpp"
+#include "libs/mcu/pin.hpp"
 
 namespace app {
 
+inline constexpr std::chrono::milliseconds kBlinkPeriod{200};
+
+// One blink step. Templated on the pin so that a board bound at compile
+// time gets the toggle inlined; the virtual OutputPin works as well.
+template <mcu::OutputPinLike Led>
+auto BlinkOnce(Led& led) -> std::expected<void, common::Error> {
+  mcu::Delay(kBlinkPeriod);
+  return led.Toggle();
+}
+
 class Blinky {
  public:
   explicit Blinky(board::Board& board) : board_(board) {}
@@ -11,7 +27,22 @@ class Blinky {
   auto Run() -> std::expected<void, common::Error>;
 
  private:
+  auto Blink() -> void;
+
   board::Board& board_;
+  std::expected<void, common::Error> status_{};
 };
 
+// Blinky against a board's static pins, e.g.
+// RunStaticBlinky<board::stm32f3_discovery::StaticBoard>()
+template <board::StaticBoardLike StaticBoard>
+auto RunStaticBlinky() -> std::expected<void, common::Error> {
+  typename StaticBoard::UserLed1 led{};
+  auto status{led.SetHigh()};
+  while (status) {
+    status = BlinkOnce(led);
+  }
+  return status;
+}
+
 }  // namespace app
@@ -9,9 +9,10 @@
 #include "apps/app.hpp"
 #include "libs/board/board.hpp"
 #include "libs/common/error.hpp"
-#include "libs/mcu/delay.hpp"
+#include "libs/common/scheduler.hpp"
 #include "libs/mcu/i2c.hpp"
 #include "libs/mcu/pin.hpp"
+#include "libs/mcu/timer.hpp"
 
 namespace app {
 using std::chrono::operator""ms;
@@ -32,6 +33,14 @@ auto I2CDemo::Init() -> std::expected<void, common::Error> {
 }
 
 auto I2CDemo::Run() -> std::expected<void, common::Error> {
+  board_.Events().Post([this]() { Step(); });
+  board_.Events().Run();
+  return {};
+}
+
+// One iteration: write the pattern, read it back, verify. Schedules the
+// next one rather than sleeping, so the event loop stays free in between.
+auto I2CDemo::Step() -> void {
   // I2C device address to test
   constexpr uint16_t kDeviceAddress{0x50};
 
@@ -42,52 +51,42 @@ auto I2CDemo::Run() -> std::expected<void, common::Error> {
   // Buffer for receiving data (caller-provided, no heap allocation)
   std::array<std::byte, 4> receive_buffer{};
 
-  // Main loop - write pattern, read it back, verify
-  while (true) {
-    // Write test pattern to I2C device
-    auto write_result{board_.I2C1().SendData(kDeviceAddress, test_pattern)};
-    if (!write_result) {
-      // Turn off LED1 on write error
-      std::ignore = board_.UserLed1().SetLow();
-      mcu::Delay(100ms);
-      continue;
-    }
-
-    // Small delay between write and read
-    mcu::Delay(50ms);
-
-    // Read data back from I2C device into our buffer
-    auto read_result{board_.I2C1().ReceiveData(kDeviceAddress, receive_buffer)};
-    if (!read_result) {
-      // Turn off LED1 on read error
-      std::ignore = board_.UserLed1().SetLow();
-      mcu::Delay(100ms);
-      continue;
-    }
-
-    // Verify received data matches test pattern
-    const size_t bytes_received{read_result.value()};
-    const bool data_matches{
-        bytes_received == test_pattern.size() &&
-        std::ranges::equal(std::span{receive_buffer.data(), bytes_received},
-                           test_pattern)};
-
-    // Toggle LED1 based on verification result
-    if (data_matches) {
-      std::ignore = board_.UserLed1().Toggle();
-    } else {
-      // Data mismatch - turn off LED1
-      std::ignore = board_.UserLed1().SetLow();
-    }
-
-    // Toggle LED2 to show we're alive
-    std::ignore = board_.UserLed2().Toggle();
-
-    // Delay before next iteration
-    mcu::Delay(200ms);
+  // Write test pattern and read it back in one repeated-start transfer
+  auto read_result{
+      board_.I2C1().WriteRead(kDeviceAddress, test_pattern, receive_buffer)};
+  if (!read_result) {
+    // Turn off LED1 on transfer error
+    std::ignore = board_.UserLed1().SetLow();
+    StepAfter(100ms);
+    return;
   }
 
-  return {};
+  // Verify received data matches test pattern
+  const size_t bytes_received{read_result.value()};
+  const bool data_matches{
+      bytes_received == test_pattern.size() &&
+      std::ranges::equal(std::span{receive_buffer.data(), bytes_received},
+                         test_pattern)};
+
+  // Toggle LED1 based on verification result
+  if (data_matches) {
+    std::ignore = board_.UserLed1().Toggle();
+  } else {
+    // Data mismatch - turn off LED1
+    std::ignore = board_.UserLed1().SetLow();
+  }
+
+  // Toggle LED2 to show we're alive
+  std::ignore = board_.UserLed2().Toggle();
+
+  // Delay before next iteration
+  StepAfter(200ms);
+}
+
+auto I2CDemo::StepAfter(std::chrono::milliseconds delay) -> void {
+  if (!board_.Timer1().StartOnce(delay, [this]() { Step(); })) {
+    board_.Events().Stop();
+  }
 }
 
 }  // namespace app
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+
 #include "libs/board/board.hpp"
 
 namespace app {
@@ -11,6 +13,11 @@ class I2CDemo {
   auto Run() -> std::expected<void, common::Error>;
 
  private:
+  auto Step() -> void;
+  // Runs the next Step() once delay has passed; stops the loop if the
+  // timer cannot
+  auto StepAfter(std::chrono::milliseconds delay) -> void;
+
   board::Board& board_;
 };
 
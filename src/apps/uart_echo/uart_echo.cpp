@@ -9,12 +9,17 @@
 #include "apps/app.hpp"
 #include "libs/board/board.hpp"
 #include "libs/common/error.hpp"
-#include "libs/mcu/delay.hpp"
+#include "libs/common/scheduler.hpp"
+#include "libs/mcu/timer.hpp"
 #include "libs/mcu/uart.hpp"
 
 namespace app {
+namespace {
 using std::chrono::operator""ms;
 
+constexpr auto kHeartbeatPeriod{200ms};
+}  // namespace
+
 auto AppMain(board::Board& board) -> std::expected<void, common::Error> {
   UartEcho uart_echo{board};
   if (!uart_echo.Init()) {
@@ -53,13 +58,19 @@ auto UartEcho::Run() -> std::expected<void, common::Error> {
     return std::unexpected(send_result.error());
   }
 
-  // Main loop - just blink LED2 slowly to show we're alive
-  // The actual echo happens via the RxHandler callback
-  while (true) {
-    mcu::Delay(200ms);
-    std::ignore = board_.UserLed2().Toggle();
+  // Blink LED2 slowly to show we're alive; the actual echo happens via the
+  // RxHandler callback, which the event loop runs between heartbeats
+  auto heartbeat_result{board_.Timer1().StartPeriodic(
+      kHeartbeatPeriod, [this]() { Heartbeat(); })};
+  if (!heartbeat_result) {
+    return std::unexpected(heartbeat_result.error());
   }
+  board_.Events().Run();
   return {};
 }
 
+auto UartEcho::Heartbeat() -> void {
+  std::ignore = board_.UserLed2().Toggle();
+}
+
 }  // namespace app
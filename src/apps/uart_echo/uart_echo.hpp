@@ -11,6 +11,8 @@ class UartEcho {
   auto Run() -> std::expected<void, common::Error>;
 
  private:
+  auto Heartbeat() -> void;
+
   board::Board& board_;
 };
 
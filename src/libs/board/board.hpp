@@ -4,8 +4,10 @@
 #include <expected>
 
 #include "libs/common/error.hpp"
+#include "libs/common/scheduler.hpp"
 #include "libs/mcu/i2c.hpp"
 #include "libs/mcu/pin.hpp"
+#include "libs/mcu/timer.hpp"
 #include "libs/mcu/uart.hpp"
 
 namespace board {
@@ -19,5 +21,18 @@ struct Board {
   [[nodiscard]] virtual auto UserButton1() -> mcu::InputPin& = 0;
   [[nodiscard]] virtual auto I2C1() -> mcu::I2CController& = 0;
   [[nodiscard]] virtual auto Uart1() -> mcu::Uart& = 0;
+  // For periodic work; its callbacks run alongside the peripherals'
+  [[nodiscard]] virtual auto Timer1() -> mcu::Timer& = 0;
+  // Peripheral callbacks run here; apps post their own work to it too and
+  // call Run() in place of a busy loop
+  [[nodiscard]] virtual auto Events() -> common::Scheduler& = 0;
 };
+
+// A board whose pins are types rather than objects behind Board's virtual
+// accessors. Apps templated on one compile every pin access down to the
+// register writes; see <board>/static_board.hpp.
+template <typename B>
+concept StaticBoardLike = mcu::OutputPinLike<typename B::UserLed1> &&
+                          mcu::OutputPinLike<typename B::UserLed2> &&
+                          mcu::InputPinLike<typename B::UserButton1>;
 }  // namespace board
@@ -1,47 +1,147 @@
 #include "host_board.hpp"
 
+#include <chrono>
 #include <expected>
+#include <memory>
+#include <thread>
 #include <utility>
 
 #include "libs/common/error.hpp"
+#include "libs/common/poller.hpp"
+#include "libs/mcu/gpio_port.hpp"
+#include "libs/mcu/host/host_delay.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/i2c.hpp"
 #include "libs/mcu/pin.hpp"
+#include "libs/mcu/timer.hpp"
 #include "libs/mcu/uart.hpp"
 
 namespace board {
-HostBoard::HostBoard(Endpoints endpoints) : endpoints_(std::move(endpoints)) {}
+namespace {
+
+// Replies to async requests are read on the application thread, so the
+// event loop reads them while it would otherwise sleep
+class TransportPoller final : public common::Poller {
+ public:
+  explicit TransportPoller(mcu::Transport& transport) : transport_(transport) {}
+
+  [[nodiscard]] auto Busy() const -> bool override {
+    return transport_.HasInFlight();
+  }
+
+  auto Poll(Clock::duration max_wait) -> void override {
+    if (!transport_.Poll(
+            std::chrono::ceil<std::chrono::milliseconds>(max_wait))) {
+      // Do not spin on a transport that keeps failing
+      std::this_thread::sleep_for(max_wait);
+    }
+  }
+
+ private:
+  mcu::Transport& transport_;
+};
+
+}  // namespace
+
+HostBoard::HostBoard(Endpoints endpoints, mcu::WireFormat wire_format,
+                     TimeMode time_mode)
+    : endpoints_(std::move(endpoints)),
+      wire_format_(wire_format),
+      time_mode_(time_mode) {}
+
+HostBoard::~HostBoard() {
+  if (clock_) {
+    mcu::SetDelayTimeSource(nullptr);
+  }
+  // The components are destroyed before the transport, which must not
+  // dispatch emulator requests to them meanwhile
+  if (transport_) {
+    transport_->StopServing();
+  }
+}
 
 auto HostBoard::Init() -> std::expected<void, common::Error> {
-  // Step 1: Create the dispatcher with an empty receiver map initially
-  // We'll build the actual receiver map after creating components
-  dispatcher_.emplace(receiver_map_);
+  // Step 1: Create the dispatcher with an empty route table initially
+  // We'll register the routes after creating components
+  dispatcher_.emplace(route_table_);
 
   // Step 2: Create the transport with the dispatcher using configured endpoints
-  auto transport_result{mcu::ZmqTransport::Create(
-      endpoints_.to_emulator, endpoints_.from_emulator, *dispatcher_)};
-  if (!transport_result) {
-    return std::unexpected(transport_result.error());
+  if (mcu::IsShmEndpoint(endpoints_.to_emulator)) {
+    auto transport_result{
+        mcu::ShmTransport::Create(endpoints_.to_emulator, *dispatcher_)};
+    if (!transport_result) {
+      return std::unexpected(transport_result.error());
+    }
+    transport_ = std::move(transport_result.value());
+  } else {
+    auto transport_result{mcu::ZmqTransport::Create(
+        endpoints_.to_emulator, endpoints_.from_emulator, *dispatcher_)};
+    if (!transport_result) {
+      return std::unexpected(transport_result.error());
+    }
+    transport_ = std::move(transport_result.value());
   }
-  zmq_transport_ = std::move(transport_result.value());
 
   // Step 3: Create all components with the transport
-  user_led_1_ = std::make_unique<mcu::HostPin>("LED 1", *zmq_transport_);
-  user_led_2_ = std::make_unique<mcu::HostPin>("LED 2", *zmq_transport_);
-  user_button_1_ = std::make_unique<mcu::HostPin>("Button 1", *zmq_transport_);
-  uart_1_ = std::make_unique<mcu::HostUart>("UART 1", *zmq_transport_);
-  i2c_1_ = std::make_unique<mcu::HostI2CController>("I2C 1", *zmq_transport_);
-
-  // Step 4: Now build the receiver map with all components
-  receiver_map_ = mcu::ReceiverMap{
-      {IsJson, std::ref(*user_led_1_)},    {IsJson, std::ref(*user_led_2_)},
-      {IsJson, std::ref(*user_button_1_)}, {IsJson, std::ref(*uart_1_)},
-      {IsJson, std::ref(*i2c_1_)},
-  };
-
-  // Step 5: Recreate the dispatcher with the actual receiver map
-  dispatcher_.emplace(receiver_map_);
-
-  // Step 6: Configure pins
+  user_led_1_ =
+      std::make_unique<mcu::HostPin>("LED 1", *transport_, wire_format_);
+  user_led_2_ =
+      std::make_unique<mcu::HostPin>("LED 2", *transport_, wire_format_);
+  user_button_1_ = std::make_unique<mcu::HostPin>("Button 1", *transport_,
+                                                  wire_format_);
+  uart_1_ =
+      std::make_unique<mcu::HostUart>("UART 1", *transport_, wire_format_);
+  i2c_1_ = std::make_unique<mcu::HostI2CController>("I2C 1", *transport_,
+                                                     wire_format_);
+  port_a_ =
+      std::make_unique<mcu::HostGpioPort>("Port A", *transport_, wire_format_);
+
+  // Step 4: Route each peripheral's messages straight to it
+  route_table_ = mcu::RouteTable{};
+  auto routed{
+      route_table_.Add(mcu::ObjectType::kPin, "LED 1", *user_led_1_)
+          .and_then([this]() {
+            return route_table_.Add(mcu::ObjectType::kPin, "LED 2",
+                                    *user_led_2_);
+          })
+          .and_then([this]() {
+            return route_table_.Add(mcu::ObjectType::kPin, "Button 1",
+                                    *user_button_1_);
+          })
+          .and_then([this]() {
+            return route_table_.Add(mcu::ObjectType::kUart, "UART 1",
+                                    *uart_1_);
+          })
+          .and_then([this]() {
+            return route_table_.Add(mcu::ObjectType::kI2C, "I2C 1", *i2c_1_);
+          })
+          .and_then([this]() {
+            return route_table_.Add(mcu::ObjectType::kPort, "Port A",
+                                    *port_a_);
+          })};
+  if (!routed) {
+    return std::unexpected(routed.error());
+  }
+
+  // Step 5: Recreate the dispatcher with the populated route table
+  dispatcher_.emplace(route_table_);
+
+  // Step 6: Run peripheral callbacks on the event loop rather than the
+  // transport's server thread, and have the loop read the replies to async
+  // requests. In simulated time the loop's timers and mcu::Delay() run on
+  // the simulation clock.
+  user_button_1_->SetEventLoop(event_loop_);
+  uart_1_->SetEventLoop(event_loop_);
+  transport_poller_ = std::make_unique<TransportPoller>(*transport_);
+  event_loop_.SetPoller(*transport_poller_);
+  if (time_mode_ == TimeMode::kSimulated) {
+    clock_ = std::make_unique<mcu::SimulationClock>("Clock", *transport_,
+                                                    wire_format_);
+    event_loop_.SetTimeSource(*clock_);
+    mcu::SetDelayTimeSource(clock_.get());
+  }
+
+  // Step 7: Configure pins
   return user_led_1_->Configure(mcu::PinDirection::kOutput)
       .and_then([this]() {
         return user_led_2_->Configure(mcu::PinDirection::kOutput);
@@ -55,4 +155,7 @@ auto HostBoard::UserLed2() -> mcu::OutputPin& { return *user_led_2_; }
 auto HostBoard::UserButton1() -> mcu::InputPin& { return *user_button_1_; }
 auto HostBoard::I2C1() -> mcu::I2CController& { return *i2c_1_; }
 auto HostBoard::Uart1() -> mcu::Uart& { return *uart_1_; }
+auto HostBoard::Timer1() -> mcu::Timer& { return timer_1_; }
+auto HostBoard::Events() -> common::EventLoop& { return event_loop_; }
+auto HostBoard::PortA() -> mcu::GpioPort& { return *port_a_; }
 }  // namespace board
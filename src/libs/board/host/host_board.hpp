@@ -8,30 +8,46 @@
 
 #include "libs/board/board.hpp"
 #include "libs/common/error.hpp"
+#include "libs/common/event_loop.hpp"
+#include "libs/common/poller.hpp"
 #include "libs/mcu/host/dispatcher.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/host/host_gpio_port.hpp"
 #include "libs/mcu/host/host_i2c.hpp"
 #include "libs/mcu/host/host_pin.hpp"
+#include "libs/mcu/host/host_timer.hpp"
 #include "libs/mcu/host/host_uart.hpp"
 #include "libs/mcu/host/receiver.hpp"
+#include "libs/mcu/host/shm_transport.hpp"
+#include "libs/mcu/host/simulation_clock.hpp"
+#include "libs/mcu/host/transport.hpp"
 #include "libs/mcu/host/zmq_transport.hpp"
 
 namespace board {
 
 class HostBoard : public Board {
  public:
-  // Endpoint configuration for ZMQ communication
+  // Endpoint configuration for ZMQ communication. A to_emulator endpoint of
+  // the form "shm://<name>" selects the shared-memory transport instead, in
+  // which case from_emulator is unused.
   struct Endpoints {
     std::string to_emulator{"ipc:///tmp/device_emulator.ipc"};
     std::string from_emulator{"ipc:///tmp/emulator_device.ipc"};
   };
 
+  // Real time sleeps through delays and timers. Simulated time skips
+  // straight past them, in step with the emulator (see SimulationClock).
+  enum class TimeMode { kReal, kSimulated };
+
   HostBoard() = default;
-  explicit HostBoard(Endpoints endpoints);
+  explicit HostBoard(Endpoints endpoints,
+                     mcu::WireFormat wire_format = mcu::WireFormat::kJson,
+                     TimeMode time_mode = TimeMode::kReal);
   HostBoard(const HostBoard&) = delete;
   HostBoard(HostBoard&&) = delete;
   auto operator=(const HostBoard&) -> HostBoard& = delete;
   auto operator=(HostBoard&&) -> HostBoard& = delete;
-  ~HostBoard() override = default;
+  ~HostBoard() override;
 
   auto Init() -> std::expected<void, common::Error> override;
   auto UserLed1() -> mcu::OutputPin& override;
@@ -39,14 +55,31 @@ class HostBoard : public Board {
   auto UserButton1() -> mcu::InputPin& override;
   auto I2C1() -> mcu::I2CController& override;
   auto Uart1() -> mcu::Uart& override;
+  auto Timer1() -> mcu::Timer& override;
+  // Host code gets the whole EventLoop, e.g. for PostAt() and RunReady()
+  auto Events() -> common::EventLoop& override;
+  // Whole-port access for bit-banged buses and LED matrices; host only
+  auto PortA() -> mcu::GpioPort&;
 
  private:
-  static constexpr auto IsJson(const std::string_view& message) -> bool {
-    return message.starts_with("{") && message.ends_with("}");
-  }
-
   // Endpoint configuration (declared first to be initialized first)
   Endpoints endpoints_{};
+  // Encoding used by all peripherals when talking to the emulator
+  mcu::WireFormat wire_format_{mcu::WireFormat::kJson};
+  TimeMode time_mode_{TimeMode::kReal};
+  // Outlives the peripherals that post to it
+  common::EventLoop event_loop_{};
+  // Needs nothing from Init(), so it is ready from construction
+  mcu::HostTimer timer_1_{event_loop_};
+
+  // Route table and dispatcher (built in Init() after components exist).
+  // Declared ahead of the components so that they outlive them: a
+  // component cancels its in-flight requests on the transport as it goes.
+  mcu::RouteTable route_table_{};
+  std::optional<mcu::Dispatcher> dispatcher_{};
+  std::unique_ptr<mcu::Transport> transport_{};
+  // Lets the event loop complete async requests (built in Init())
+  std::unique_ptr<common::Poller> transport_poller_{};
 
   // Store components (order matters for destruction)
   std::unique_ptr<mcu::HostPin> user_led_1_{};
@@ -54,10 +87,8 @@ class HostBoard : public Board {
   std::unique_ptr<mcu::HostPin> user_button_1_{};
   std::unique_ptr<mcu::HostUart> uart_1_{};
   std::unique_ptr<mcu::HostI2CController> i2c_1_{};
-
-  // Receiver map and dispatcher (built in Init() after components exist)
-  mcu::ReceiverMap receiver_map_{};
-  std::optional<mcu::Dispatcher> dispatcher_{};
-  std::unique_ptr<mcu::ZmqTransport> zmq_transport_{};
+  std::unique_ptr<mcu::HostGpioPort> port_a_{};
+  // Only in simulated time
+  std::unique_ptr<mcu::SimulationClock> clock_{};
 };
 }  // namespace board
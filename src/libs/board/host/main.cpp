@@ -1,11 +1,29 @@
+#include <cstdlib>
 #include <iostream>
+#include <string_view>
 
 #include "apps/app.hpp"
 #include "libs/board/host/host_board.hpp"
 
+namespace {
+
+// EMULATOR_TIME=simulated runs the application in simulated time, so a
+// simulation does not take as long as the behavior it simulates
+auto TimeModeFromEnvironment() -> board::HostBoard::TimeMode {
+  // NOLINTNEXTLINE(concurrency-mt-unsafe): read before any thread starts
+  const char* mode{std::getenv("EMULATOR_TIME")};
+  if (mode != nullptr && std::string_view{mode} == "simulated") {
+    return board::HostBoard::TimeMode::kSimulated;
+  }
+  return board::HostBoard::TimeMode::kReal;
+}
+
+}  // namespace
+
 auto main() -> int {
   try {
-    board::HostBoard board{};
+    board::HostBoard board{board::HostBoard::Endpoints{},
+                           mcu::WireFormat::kJson, TimeModeFromEnvironment()};
 
     if (!app::AppMain(board)) {
       std::cout << "app_main failed" << '\n';
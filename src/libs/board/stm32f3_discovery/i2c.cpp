@@ -0,0 +1,43 @@
+#include "i2c.hpp"
+
+namespace board::stm32f3_discovery {
+namespace {
+
+I2C_HandleTypeDef* attached_handle{nullptr};
+I2CController* attached_controller{nullptr};
+
+auto ControllerFor(const I2C_HandleTypeDef* handle) -> I2CController* {
+  return handle == attached_handle ? attached_controller : nullptr;
+}
+
+}  // namespace
+
+auto AttachI2C(I2C_HandleTypeDef* handle, I2CController* controller) -> void {
+  attached_handle = handle;
+  attached_controller = controller;
+}
+
+}  // namespace board::stm32f3_discovery
+
+// Overrides of the HAL's weak callbacks, called from the I2C and DMA ISRs
+
+extern "C" void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef* hi2c) {
+  using board::stm32f3_discovery::ControllerFor;
+  if (auto* controller{ControllerFor(hi2c)}) {
+    controller->OnTransmitComplete();
+  }
+}
+
+extern "C" void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef* hi2c) {
+  using board::stm32f3_discovery::ControllerFor;
+  if (auto* controller{ControllerFor(hi2c)}) {
+    controller->OnReceiveComplete();
+  }
+}
+
+extern "C" void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c) {
+  using board::stm32f3_discovery::ControllerFor;
+  if (auto* controller{ControllerFor(hi2c)}) {
+    controller->OnError();
+  }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+
+#include "libs/mcu/stm32/stm32_i2c.hpp"
+#include "stm32f3xx_hal.h"
+
+namespace board::stm32f3_discovery {
+
+// The HAL I2C master calls for one CubeMX-initialized handle
+struct I2CHal {
+  I2C_HandleTypeDef* handle;
+
+  auto Transmit(uint16_t address, uint8_t* data, uint16_t size,
+                uint32_t timeout_ms) -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Transmit(handle, address, data, size,
+                                          timeout_ms));
+  }
+  auto Receive(uint16_t address, uint8_t* data, uint16_t size,
+               uint32_t timeout_ms) -> mcu::Stm32HalStatus {
+    return Status(
+        HAL_I2C_Master_Receive(handle, address, data, size, timeout_ms));
+  }
+  auto TransmitIt(uint16_t address, uint8_t* data, uint16_t size)
+      -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Transmit_IT(handle, address, data, size));
+  }
+  auto ReceiveIt(uint16_t address, uint8_t* data, uint16_t size)
+      -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Receive_IT(handle, address, data, size));
+  }
+  auto TransmitDma(uint16_t address, uint8_t* data, uint16_t size)
+      -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Transmit_DMA(handle, address, data, size));
+  }
+  auto ReceiveDma(uint16_t address, uint8_t* data, uint16_t size)
+      -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Receive_DMA(handle, address, data, size));
+  }
+  auto MemRead(uint16_t address, uint16_t mem_address, uint16_t mem_size,
+               uint8_t* data, uint16_t size, uint32_t timeout_ms)
+      -> mcu::Stm32HalStatus {
+    const uint16_t mem_add_size{mem_size == 2 ? I2C_MEMADD_SIZE_16BIT
+                                              : I2C_MEMADD_SIZE_8BIT};
+    return Status(HAL_I2C_Mem_Read(handle, address, mem_address, mem_add_size,
+                                   data, size, timeout_ms));
+  }
+  auto SeqTransmitIt(uint16_t address, uint8_t* data, uint16_t size,
+                     mcu::Stm32I2CFrame frame) -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Seq_Transmit_IT(handle, address, data, size,
+                                                 Options(frame)));
+  }
+  auto SeqReceiveIt(uint16_t address, uint8_t* data, uint16_t size,
+                    mcu::Stm32I2CFrame frame) -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Seq_Receive_IT(handle, address, data, size,
+                                                Options(frame)));
+  }
+  auto SeqTransmitDma(uint16_t address, uint8_t* data, uint16_t size,
+                      mcu::Stm32I2CFrame frame) -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Seq_Transmit_DMA(handle, address, data, size,
+                                                  Options(frame)));
+  }
+  auto SeqReceiveDma(uint16_t address, uint8_t* data, uint16_t size,
+                     mcu::Stm32I2CFrame frame) -> mcu::Stm32HalStatus {
+    return Status(HAL_I2C_Master_Seq_Receive_DMA(handle, address, data, size,
+                                                 Options(frame)));
+  }
+
+ private:
+  static auto Status(HAL_StatusTypeDef status) -> mcu::Stm32HalStatus {
+    return static_cast<mcu::Stm32HalStatus>(status);
+  }
+
+  static auto Options(mcu::Stm32I2CFrame frame) -> uint32_t {
+    switch (frame) {
+      case mcu::Stm32I2CFrame::kFirst:
+        return I2C_FIRST_FRAME;
+      case mcu::Stm32I2CFrame::kNext:
+        return I2C_NEXT_FRAME;
+      case mcu::Stm32I2CFrame::kLast:
+        return I2C_LAST_FRAME;
+      case mcu::Stm32I2CFrame::kFirstAndLast:
+        break;
+    }
+    return I2C_FIRST_AND_LAST_FRAME;
+  }
+};
+
+using I2CController = mcu::Stm32I2CController<I2CHal>;
+
+// Routes the HAL's completion and error callbacks for handle to controller.
+// Both must outlive any transfer started afterwards.
+auto AttachI2C(I2C_HandleTypeDef* handle, I2CController* controller) -> void;
+
+}  // namespace board::stm32f3_discovery
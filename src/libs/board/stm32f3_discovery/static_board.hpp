@@ -0,0 +1,18 @@
+#pragma once
+
+#include "libs/board/board.hpp"
+#include "libs/mcu/stm32/stm32_gpio.hpp"
+#include "libs/mcu/stm32/stm32_static_pin.hpp"
+
+namespace board::stm32f3_discovery {
+
+// The STM32F3DISCOVERY's user pins, bound at compile time
+struct StaticBoard {
+  using UserLed1 = mcu::StaticPin<mcu::stm32f3::GpioE, 9>;     // LD3, red
+  using UserLed2 = mcu::StaticPin<mcu::stm32f3::GpioE, 8>;     // LD4, blue
+  using UserButton1 = mcu::StaticPin<mcu::stm32f3::GpioA, 0>;  // B1, user
+};
+
+static_assert(StaticBoardLike<StaticBoard>);
+
+}  // namespace board::stm32f3_discovery
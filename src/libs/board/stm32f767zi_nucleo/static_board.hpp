@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "libs/board/board.hpp"
+#include "libs/mcu/stm32/stm32_dcache.hpp"
+#include "libs/mcu/stm32/stm32_dma.hpp"
+#include "libs/mcu/stm32/stm32_gpio.hpp"
+#include "libs/mcu/stm32/stm32_static_pin.hpp"
+#include "libs/mcu/stm32/stm32_uart.hpp"
+
+extern "C" uint32_t HAL_GetTick(void);  // NOLINT(readability-identifier-naming)
+
+namespace board::stm32f767zi_nucleo {
+
+// The NUCLEO-F767ZI's user pins, bound at compile time
+struct StaticBoard {
+  using UserLed1 = mcu::StaticPin<mcu::stm32f7::GpioB, 0>;      // LD1, green
+  using UserLed2 = mcu::StaticPin<mcu::stm32f7::GpioB, 7>;      // LD2, blue
+  using UserLed3 = mcu::StaticPin<mcu::stm32f7::GpioB, 14>;     // LD3, red
+  using UserButton1 = mcu::StaticPin<mcu::stm32f7::GpioC, 13>;  // B1, user
+};
+
+static_assert(StaticBoardLike<StaticBoard>);
+
+// USART3, wired to the ST-LINK virtual COM port on PD8/PD9, with its
+// DMA1 channel 4 streams
+struct Uart1Hardware {
+  static constexpr uintptr_t kUsartAddress{0x4000'4800};
+  static constexpr uintptr_t kDmaAddress{0x4002'6000};
+  static constexpr uint32_t kRxStream{1};
+  static constexpr uint32_t kTxStream{3};
+  static constexpr uint32_t kDmaChannel{4};
+  // APB1: the 216 MHz system clock divided by 4
+  static constexpr uint32_t kClockHz{54'000'000};
+
+  static auto Usart() -> mcu::Stm32UsartRegisters& {
+    return *reinterpret_cast<mcu::Stm32UsartRegisters*>(  // NOLINT
+        kUsartAddress);
+  }
+  static auto Dma() -> mcu::Stm32DmaRegisters& {
+    return *reinterpret_cast<mcu::Stm32DmaRegisters*>(kDmaAddress);  // NOLINT
+  }
+  static auto Milliseconds() -> uint32_t { return HAL_GetTick(); }
+  // main.c turns the data cache on
+  static auto CleanDCache(const std::byte* data, size_t size) -> void {
+    mcu::dcache::Clean(data, size);
+  }
+  static auto InvalidateDCache(const std::byte* data, size_t size) -> void {
+    mcu::dcache::Invalidate(data, size);
+  }
+};
+
+using Uart1 = mcu::Stm32Uart<Uart1Hardware>;
+
+}  // namespace board::stm32f767zi_nucleo
@@ -0,0 +1,193 @@
+#include "async_logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+
+#include "libs/common/binary_log.hpp"
+#include "libs/common/logger.hpp"
+
+namespace common {
+namespace {
+
+std::atomic<uint64_t> next_serial{1};
+
+// The ring the calling thread last logged to, and whose logger it is
+struct RingCache {
+  uint64_t serial{0};
+  void* ring{nullptr};
+};
+thread_local RingCache ring_cache{};
+
+auto HeaderOf(std::span<const std::byte> record) -> binary_log::RecordHeader {
+  binary_log::RecordHeader header{};
+  std::memcpy(&header.size, record.data(), 2);
+  std::memcpy(&header.format, record.data() + 2, 2);
+  std::memcpy(&header.time_ns, record.data() + 8, 8);
+  return header;
+}
+
+}  // namespace
+
+auto TextLogSink::Write(std::span<const std::byte> record) -> void {
+  const auto decoded{binary_log::DecodeRecord(record)};
+  if (!decoded) {
+    return;
+  }
+  const auto format{binary_log::FormatText(decoded->header.format)};
+  const auto line{
+      binary_log::FormatLine(*decoded, format ? *format : "<unknown format>")};
+  std::fputs(line.c_str(), file_);
+  std::fputc('\n', file_);
+}
+
+auto TextLogSink::Flush() -> void { std::fflush(file_); }
+
+auto BinaryLogSink::Write(std::span<const std::byte> record) -> void {
+  const auto format{HeaderOf(record).format};
+  if (format >= defined_.size()) {
+    defined_.resize(format + 1U, false);
+  }
+  if (!defined_[format]) {
+    const auto text{binary_log::FormatText(format)};
+    std::array<std::byte, binary_log::kMaxRecordSize> definition;
+    const size_t size{binary_log::EncodeRecord(
+        definition, format, binary_log::kFormatDefinition, 0, 0,
+        std::string_view{text ? *text : ""})};
+    std::fwrite(definition.data(), 1, size, file_);
+    defined_[format] = true;
+  }
+  std::fwrite(record.data(), 1, record.size(), file_);
+}
+
+auto BinaryLogSink::Flush() -> void { std::fflush(file_); }
+
+AsyncLogger::AsyncLogger(LogSink& sink, Config config)
+    : sink_{sink},
+      config_{config},
+      serial_{next_serial.fetch_add(1, std::memory_order_relaxed)},
+      thread_{[this]() { SinkThread(); }} {}
+
+AsyncLogger::~AsyncLogger() {
+  {
+    const std::lock_guard lock{mutex_};
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+auto AsyncLogger::Debug(std::string_view msg) -> void {
+  Record(binary_log::PlainFormatId(), LogLevel::kDebug, msg);
+}
+
+auto AsyncLogger::Info(std::string_view msg) -> void {
+  Record(binary_log::PlainFormatId(), LogLevel::kInfo, msg);
+}
+
+auto AsyncLogger::Warning(std::string_view msg) -> void {
+  Record(binary_log::PlainFormatId(), LogLevel::kWarning, msg);
+}
+
+auto AsyncLogger::Error(std::string_view msg) -> void {
+  Record(binary_log::PlainFormatId(), LogLevel::kError, msg);
+}
+
+auto AsyncLogger::Flush() -> void {
+  std::unique_lock lock{mutex_};
+  const uint64_t ticket{++flush_requested_};
+  wake_.notify_one();
+  flushed_.wait(lock, [this, ticket]() { return flush_done_ >= ticket; });
+}
+
+auto AsyncLogger::ThreadRing() -> Ring& {
+  if (ring_cache.serial == serial_) {
+    return *static_cast<Ring*>(ring_cache.ring);
+  }
+  const std::lock_guard lock{rings_mutex_};
+  // A thread that logs to several loggers comes back to its ring here
+  const auto self{std::this_thread::get_id()};
+  auto found{std::ranges::find_if(
+      rings_, [self](const auto& ring) { return ring->owner == self; })};
+  if (found == rings_.end()) {
+    rings_.push_back(std::make_unique<Ring>(
+        config_.ring_bytes, static_cast<uint16_t>(rings_.size())));
+    found = std::prev(rings_.end());
+  }
+  ring_cache = RingCache{.serial = serial_, .ring = found->get()};
+  return **found;
+}
+
+auto AsyncLogger::SinkThread() -> void {
+  while (true) {
+    uint64_t ticket{0};
+    bool stopping{false};
+    {
+      std::unique_lock lock{mutex_};
+      wake_.wait_for(lock, config_.flush_interval, [this]() {
+        return stopping_ || flush_requested_ > flush_done_;
+      });
+      ticket = flush_requested_;
+      stopping = stopping_;
+    }
+
+    Drain();
+
+    {
+      const std::lock_guard lock{mutex_};
+      flush_done_ = ticket;
+    }
+    flushed_.notify_all();
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+auto AsyncLogger::Drain() -> void {
+  batch_.clear();
+  batch_offsets_.clear();
+  {
+    const std::lock_guard lock{rings_mutex_};
+    for (const auto& ring : rings_) {
+      // Records go in whole, so a size means the rest is there too
+      uint16_t size{0};
+      while (ring->bytes.Size() >= sizeof(size)) {
+        const size_t offset{batch_.size()};
+        batch_.resize(offset + sizeof(size));
+        ring->bytes.Pop(std::span{batch_.data() + offset, sizeof(size)});
+        std::memcpy(&size, batch_.data() + offset, sizeof(size));
+        batch_.resize(offset + size);
+        ring->bytes.Pop(std::span{batch_.data() + offset + sizeof(size),
+                                  size - sizeof(size)});
+        batch_offsets_.push_back(offset);
+      }
+    }
+  }
+  if (batch_offsets_.empty()) {
+    return;
+  }
+
+  // Each ring is in order already; this interleaves the threads
+  const auto record_at{[this](size_t offset) {
+    return std::span<const std::byte>{batch_}.subspan(offset);
+  }};
+  std::ranges::stable_sort(batch_offsets_, {}, [&](size_t offset) {
+    return HeaderOf(record_at(offset)).time_ns;
+  });
+  for (const size_t offset : batch_offsets_) {
+    const auto record{record_at(offset)};
+    sink_.Write(record.first(HeaderOf(record).size));
+  }
+  sink_.Flush();
+}
+
+}  // namespace common
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "libs/common/binary_log.hpp"
+#include "libs/common/logger.hpp"
+#include "libs/common/spsc_ring.hpp"
+
+namespace common {
+
+/// @brief Where an AsyncLogger's records end up, on its sink thread
+class LogSink {
+ public:
+  LogSink() = default;
+  LogSink(const LogSink&) = delete;
+  LogSink(LogSink&&) = delete;
+  auto operator=(const LogSink&) -> LogSink& = delete;
+  auto operator=(LogSink&&) -> LogSink& = delete;
+  virtual ~LogSink() = default;
+
+  /// @brief Take one record, as encoded by binary_log::EncodeRecord()
+  virtual auto Write(std::span<const std::byte> record) -> void = 0;
+
+  /// @brief Push out anything buffered; called after each batch
+  virtual auto Flush() -> void {}
+};
+
+/// @brief Formats records into lines of text, like ConsoleLogger
+class TextLogSink final : public LogSink {
+ public:
+  explicit TextLogSink(std::FILE* file) : file_{file} {}
+
+  auto Write(std::span<const std::byte> record) -> void override;
+  auto Flush() -> void override;
+
+ private:
+  std::FILE* file_;
+};
+
+/// @brief Writes records as they are, for the log_decoder tool to format
+/// Each format is defined in the file before its first use.
+class BinaryLogSink final : public LogSink {
+ public:
+  explicit BinaryLogSink(std::FILE* file) : file_{file} {}
+
+  auto Write(std::span<const std::byte> record) -> void override;
+  auto Flush() -> void override;
+
+ private:
+  std::FILE* file_;
+  // Format ids already defined in the file
+  std::vector<bool> defined_{};
+};
+
+/// @brief Logger that leaves the formatting and output to another thread
+///
+/// A log call copies the format's id and the raw arguments into a ring
+/// owned by the calling thread, with no lock, allocation or formatting,
+/// and returns. A sink thread empties the rings every flush interval,
+/// orders each batch by time and hands the records to the sink.
+///
+/// Each thread's ring is made on its first log call; that call allocates.
+/// When a ring is full the record is dropped and counted, rather than the
+/// caller waiting for the sink.
+class AsyncLogger final : public Logger {
+ public:
+  struct Config {
+    // Per logging thread
+    size_t ring_bytes{16 * 1024};
+    std::chrono::milliseconds flush_interval{10};
+  };
+
+  explicit AsyncLogger(LogSink& sink) : AsyncLogger{sink, Config{}} {}
+  AsyncLogger(LogSink& sink, Config config);
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger(AsyncLogger&&) = delete;
+  auto operator=(const AsyncLogger&) -> AsyncLogger& = delete;
+  auto operator=(AsyncLogger&&) -> AsyncLogger& = delete;
+  // Writes out everything logged before it
+  ~AsyncLogger() override;
+
+  // Messages that are already text go in as the one argument of "{}"
+  auto Debug(std::string_view msg) -> void override;
+  auto Info(std::string_view msg) -> void override;
+  auto Warning(std::string_view msg) -> void override;
+  auto Error(std::string_view msg) -> void override;
+
+  /// @brief Log Format with args, formatted later on the sink thread
+  /// Arguments are numbers, bools, enums and strings; strings are copied.
+  /// Below kMinLogLevel the call compiles to nothing.
+  template <LogLevel Level, binary_log::FormatString Format, typename... Args>
+  auto Log(const Args&... args) -> void {
+    if constexpr (Level >= kMinLogLevel && Level != LogLevel::kOff) {
+      Record(binary_log::kFormatId<Format>, Level, args...);
+    }
+  }
+
+  /// @brief Wait until everything logged before the call is in the sink
+  auto Flush() -> void;
+
+  /// @brief Records lost to full rings
+  [[nodiscard]] auto Dropped() const -> size_t {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Ring {
+    explicit Ring(size_t bytes, uint16_t index)
+        : bytes{bytes}, thread{index} {}
+
+    SpscRing<std::byte> bytes;
+    const uint16_t thread;
+    const std::thread::id owner{std::this_thread::get_id()};
+  };
+
+  // Not Write(), which would hide Logger::Write(level, msg)
+  template <typename... Args>
+  auto Record(uint16_t format, LogLevel level, const Args&... args) -> void {
+    if (!Enabled(level)) {
+      return;
+    }
+    Ring& ring{ThreadRing()};
+    std::array<std::byte, binary_log::kMaxRecordSize> record;
+    const size_t size{binary_log::EncodeRecord(
+        record, format, static_cast<uint8_t>(level), ring.thread,
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_)
+                .count()),
+        args...)};
+    // Only this thread pushes, so the space can only grow meanwhile, and
+    // the record goes in whole or not at all
+    if (ring.bytes.Capacity() - ring.bytes.Size() < size) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    ring.bytes.Push(std::span{record.data(), size});
+  }
+
+  // The calling thread's ring, made on first use
+  auto ThreadRing() -> Ring&;
+  auto SinkThread() -> void;
+  // Moves every complete record from the rings to the sink
+  auto Drain() -> void;
+
+  LogSink& sink_;
+  const Config config_;
+  const std::chrono::steady_clock::time_point start_{
+      std::chrono::steady_clock::now()};
+  // Tells the thread-local ring cache which logger it belongs to
+  const uint64_t serial_;
+
+  std::mutex rings_mutex_{};
+  std::vector<std::unique_ptr<Ring>> rings_{};
+
+  std::mutex mutex_{};
+  std::condition_variable wake_{};
+  std::condition_variable flushed_{};
+  uint64_t flush_requested_{0};
+  uint64_t flush_done_{0};
+  bool stopping_{false};
+
+  std::atomic<size_t> dropped_{0};
+  // Sink thread only: the batch being ordered, reused between batches
+  std::vector<std::byte> batch_{};
+  std::vector<size_t> batch_offsets_{};
+  std::thread thread_;
+};
+
+}  // namespace common
@@ -0,0 +1,206 @@
+#include "binary_log.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "libs/common/logger.hpp"
+
+namespace common::binary_log {
+namespace {
+
+struct Registry {
+  std::mutex mutex{};
+  std::vector<std::string_view> formats{};
+};
+
+// Function-local, so formats registered during static initialization find
+// it constructed whatever the order of translation units
+auto GetRegistry() -> Registry& {
+  static Registry registry{};
+  return registry;
+}
+
+auto LevelName(uint8_t level) -> std::string_view {
+  switch (static_cast<LogLevel>(level)) {
+    case LogLevel::kDebug:
+      return "[DEBUG]";
+    case LogLevel::kInfo:
+      return "[INFO] ";
+    case LogLevel::kWarning:
+      return "[WARN] ";
+    case LogLevel::kError:
+      return "[ERROR]";
+    case LogLevel::kOff:
+      break;
+  }
+  return "[?]    ";
+}
+
+// Formats one argument with the spec from its replacement field, e.g.
+// ":08x"; a spec that does not suit the argument falls back to "{}"
+auto FormatArg(std::string_view spec, const Arg& arg) -> std::string {
+  const std::string field{"{" + std::string{spec} + "}"};
+  return std::visit(
+      [&field](const auto& value) {
+        try {
+          return std::vformat(field, std::make_format_args(value));
+        } catch (const std::format_error&) {
+          return std::format("{}", value);
+        }
+      },
+      arg);
+}
+
+}  // namespace
+
+auto RegisterFormat(std::string_view format) -> uint16_t {
+  auto& registry{GetRegistry()};
+  const std::lock_guard lock{registry.mutex};
+  registry.formats.push_back(format);
+  return static_cast<uint16_t>(registry.formats.size() - 1);
+}
+
+auto FormatText(uint16_t id) -> std::optional<std::string> {
+  auto& registry{GetRegistry()};
+  const std::lock_guard lock{registry.mutex};
+  if (id >= registry.formats.size()) {
+    return std::nullopt;
+  }
+  return std::string{registry.formats[id]};
+}
+
+auto PlainFormatId() -> uint16_t { return kFormatId<"{}">; }
+
+auto DecodeRecord(std::span<const std::byte> data) -> std::optional<Record> {
+  if (data.size() < kHeaderSize) {
+    return std::nullopt;
+  }
+  Record record{};
+  auto& header{record.header};
+  std::memcpy(&header.size, data.data(), 2);
+  std::memcpy(&header.format, data.data() + 2, 2);
+  std::memcpy(&header.level, data.data() + 4, 1);
+  std::memcpy(&header.args, data.data() + 5, 1);
+  std::memcpy(&header.thread, data.data() + 6, 2);
+  std::memcpy(&header.time_ns, data.data() + 8, 8);
+  if (header.size < kHeaderSize || header.size > data.size()) {
+    return std::nullopt;
+  }
+
+  size_t offset{kHeaderSize};
+  const auto take{[&](void* out, size_t size) {
+    if (size > header.size - offset) {
+      return false;
+    }
+    std::memcpy(out, data.data() + offset, size);
+    offset += size;
+    return true;
+  }};
+  for (uint8_t i = 0; i < header.args; ++i) {
+    ArgType type{};
+    if (!take(&type, 1)) {
+      return std::nullopt;
+    }
+    bool ok{false};
+    switch (type) {
+      case ArgType::kBool: {
+        uint8_t value{0};
+        ok = take(&value, sizeof(value));
+        record.args.emplace_back(value != 0);
+        break;
+      }
+      case ArgType::kInt: {
+        int64_t value{0};
+        ok = take(&value, sizeof(value));
+        record.args.emplace_back(value);
+        break;
+      }
+      case ArgType::kUint: {
+        uint64_t value{0};
+        ok = take(&value, sizeof(value));
+        record.args.emplace_back(value);
+        break;
+      }
+      case ArgType::kDouble: {
+        double value{0};
+        ok = take(&value, sizeof(value));
+        record.args.emplace_back(value);
+        break;
+      }
+      case ArgType::kString: {
+        uint16_t size{0};
+        std::string value{};
+        if (take(&size, sizeof(size))) {
+          value.resize(size);
+          ok = take(value.data(), size);
+        }
+        record.args.emplace_back(std::move(value));
+        break;
+      }
+    }
+    if (!ok) {
+      return std::nullopt;
+    }
+  }
+  return record;
+}
+
+auto FormatMessage(std::string_view format, const std::vector<Arg>& args)
+    -> std::string {
+  std::string out{};
+  size_t next_arg{0};
+  size_t i{0};
+  while (i < format.size()) {
+    const char c{format[i]};
+    if ((c == '{' || c == '}') && i + 1 < format.size() &&
+        format[i + 1] == c) {
+      out += c;
+      i += 2;
+      continue;
+    }
+    const size_t close{c == '{' ? format.find('}', i) : std::string_view::npos};
+    if (close == std::string_view::npos) {
+      out += c;
+      ++i;
+      continue;
+    }
+    // {index:spec}, both parts optional
+    const auto field{format.substr(i + 1, close - i - 1)};
+    const auto colon{field.find(':')};
+    const auto index_text{field.substr(0, colon)};
+    const auto spec{colon == std::string_view::npos ? std::string_view{}
+                                                    : field.substr(colon)};
+    size_t index{next_arg++};
+    if (!index_text.empty()) {
+      std::from_chars(index_text.data(),
+                      index_text.data() + index_text.size(), index);
+    }
+    if (index < args.size()) {
+      out += FormatArg(spec, args[index]);
+    } else {
+      out += format.substr(i, close - i + 1);
+    }
+    i = close + 1;
+  }
+  return out;
+}
+
+auto FormatLine(const Record& record, std::string_view format) -> std::string {
+  const auto& header{record.header};
+  return std::format("[{:>6}.{:06}] {} t{} {}", header.time_ns / 1'000'000'000,
+                     (header.time_ns / 1'000) % 1'000'000,
+                     LevelName(header.level), header.thread,
+                     FormatMessage(format, record.args));
+}
+
+}  // namespace common::binary_log
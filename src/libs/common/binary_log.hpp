@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "libs/common/logger.hpp"
+
+namespace common::binary_log {
+
+// Log records as they sit in the rings and in binary log files: a header,
+// then each argument as a type tag and its raw bytes, in host byte order.
+// Nothing is formatted until the record is read back.
+//
+//   uint16 size     whole record, header included
+//   uint16 format   id from RegisterFormat()
+//   uint8  level    LogLevel, or kFormatDefinition
+//   uint8  args     argument count
+//   uint16 thread   logging thread, numbered by the logger
+//   uint64 time     nanoseconds since the logger started
+//
+// A binary log file also carries a kFormatDefinition record ahead of the
+// first use of each format id, whose one string argument is the format
+// string, so a file can be decoded on its own.
+
+inline constexpr size_t kHeaderSize{16};
+inline constexpr size_t kMaxRecordSize{256};
+inline constexpr size_t kMaxArgs{8};
+// Level of a record that defines a format id rather than logging anything
+inline constexpr uint8_t kFormatDefinition{0xFF};
+
+enum class ArgType : uint8_t { kBool, kInt, kUint, kDouble, kString };
+
+struct RecordHeader {
+  uint16_t size{0};
+  uint16_t format{0};
+  uint8_t level{0};
+  uint8_t args{0};
+  uint16_t thread{0};
+  uint64_t time_ns{0};
+};
+
+using Arg = std::variant<bool, int64_t, uint64_t, double, std::string>;
+
+struct Record {
+  RecordHeader header{};
+  std::vector<Arg> args{};
+};
+
+/// @brief A string literal usable as a template argument
+template <size_t N>
+struct FormatString {
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  consteval FormatString(const char (&text)[N]) {
+    std::copy_n(text, N, chars.begin());
+  }
+  [[nodiscard]] constexpr auto View() const -> std::string_view {
+    return {chars.data(), N - 1};
+  }
+
+  std::array<char, N> chars{};
+};
+
+/// @brief Add format to the process's table of formats
+/// Called during static initialization, once per distinct format.
+/// @return The format's id
+auto RegisterFormat(std::string_view format) -> uint16_t;
+
+/// @brief The format registered under id, if any
+auto FormatText(uint16_t id) -> std::optional<std::string>;
+
+/// @brief The id of Format, fixed before main() runs
+template <FormatString Format>
+inline const uint16_t kFormatId{RegisterFormat(Format.View())};
+
+/// @brief Id of "{}", used for messages that are already text
+auto PlainFormatId() -> uint16_t;
+
+namespace detail {
+
+// Appends to a record under construction; stops quietly when full
+class Writer {
+ public:
+  explicit Writer(std::span<std::byte> buffer) : buffer_{buffer} {}
+
+  auto Put(const void* data, size_t size) -> bool {
+    if (size > buffer_.size() - used_) {
+      return false;
+    }
+    std::memcpy(buffer_.data() + used_, data, size);
+    used_ += size;
+    return true;
+  }
+
+  template <typename T>
+  auto PutArg(ArgType type, T value) -> void {
+    if (used_ + 1 + sizeof(T) <= buffer_.size()) {
+      Put(&type, 1);
+      Put(&value, sizeof(T));
+      ++count_;
+    }
+  }
+
+  // Keeps as much of text as fits
+  auto PutString(std::string_view text) -> void {
+    if (used_ + 3 > buffer_.size()) {
+      return;
+    }
+    const auto size{static_cast<uint16_t>(
+        std::min(text.size(), buffer_.size() - used_ - 3))};
+    const ArgType type{ArgType::kString};
+    Put(&type, 1);
+    Put(&size, sizeof(size));
+    Put(text.data(), size);
+    ++count_;
+  }
+
+  [[nodiscard]] auto Used() const -> size_t { return used_; }
+  [[nodiscard]] auto Count() const -> uint8_t { return count_; }
+
+ private:
+  std::span<std::byte> buffer_;
+  size_t used_{kHeaderSize};
+  uint8_t count_{0};
+};
+
+template <typename T>
+auto Encode(Writer& writer, const T& value) -> void {
+  using Value = std::remove_cvref_t<T>;
+  if constexpr (std::same_as<Value, bool>) {
+    writer.PutArg(ArgType::kBool, static_cast<uint8_t>(value));
+  } else if constexpr (std::is_enum_v<Value>) {
+    Encode(writer, std::to_underlying(value));
+  } else if constexpr (std::signed_integral<Value>) {
+    writer.PutArg(ArgType::kInt, static_cast<int64_t>(value));
+  } else if constexpr (std::unsigned_integral<Value>) {
+    writer.PutArg(ArgType::kUint, static_cast<uint64_t>(value));
+  } else if constexpr (std::floating_point<Value>) {
+    writer.PutArg(ArgType::kDouble, static_cast<double>(value));
+  } else if constexpr (std::convertible_to<const Value&, std::string_view>) {
+    writer.PutString(std::string_view{value});
+  } else {
+    static_assert(sizeof(Value) == 0, "Type cannot be logged");
+  }
+}
+
+}  // namespace detail
+
+/// @brief Build a record in buffer
+/// Arguments past kMaxArgs, or that do not fit, are left off; the last
+/// string that fits only in part is cut short.
+/// @return Size of the record
+template <typename... Args>
+auto EncodeRecord(std::span<std::byte, kMaxRecordSize> buffer, uint16_t format,
+                  uint8_t level, uint16_t thread, uint64_t time_ns,
+                  const Args&... args) -> size_t {
+  static_assert(sizeof...(Args) <= kMaxArgs, "Too many log arguments");
+  detail::Writer writer{buffer};
+  (detail::Encode(writer, args), ...);
+  const RecordHeader header{.size = static_cast<uint16_t>(writer.Used()),
+                            .format = format,
+                            .level = level,
+                            .args = writer.Count(),
+                            .thread = thread,
+                            .time_ns = time_ns};
+  std::memcpy(buffer.data(), &header.size, 2);
+  std::memcpy(buffer.data() + 2, &header.format, 2);
+  std::memcpy(buffer.data() + 4, &header.level, 1);
+  std::memcpy(buffer.data() + 5, &header.args, 1);
+  std::memcpy(buffer.data() + 6, &header.thread, 2);
+  std::memcpy(buffer.data() + 8, &header.time_ns, 8);
+  return header.size;
+}
+
+/// @brief Read the record at the start of data, which must hold all of it
+/// @return The record, or nothing if it is malformed
+auto DecodeRecord(std::span<const std::byte> data) -> std::optional<Record>;
+
+/// @brief Substitute a record's arguments into format
+/// Replacement fields take std::format specs, and may name an argument
+/// by index. Fields with no argument left are kept as they are.
+auto FormatMessage(std::string_view format, const std::vector<Arg>& args)
+    -> std::string;
+
+/// @brief One line of log output, as ConsoleLogger would print it, with
+/// the record's time and thread in front
+auto FormatLine(const Record& record, std::string_view format) -> std::string;
+
+}  // namespace common::binary_log
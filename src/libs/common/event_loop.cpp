@@ -0,0 +1,161 @@
+#include "event_loop.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+namespace common {
+namespace {
+
+// Orders the timer heap so the earliest timer is at the front
+template <typename Timer>
+auto Later(const Timer& lhs, const Timer& rhs) -> bool {
+  if (lhs.due != rhs.due) {
+    return lhs.due > rhs.due;
+  }
+  return lhs.sequence > rhs.sequence;
+}
+
+}  // namespace
+
+auto EventLoop::Post(Task task) -> void {
+  {
+    const std::lock_guard lock{mutex_};
+    ready_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+auto EventLoop::PostAfter(Clock::duration delay, Task task) -> void {
+  PostAt(Now() + delay, std::move(task));
+}
+
+auto EventLoop::PostAt(Clock::time_point due, Task task) -> void {
+  {
+    const std::lock_guard lock{mutex_};
+    timers_.push_back(Timer{.due = due,
+                            .sequence = next_sequence_++,
+                            .task = std::move(task)});
+    std::ranges::push_heap(timers_, Later<Timer>);
+  }
+  // The new timer may be due before the one Run() is sleeping on
+  wake_.notify_one();
+}
+
+auto EventLoop::Run() -> void {
+  while (true) {
+    {
+      std::unique_lock lock{mutex_};
+      while (true) {
+        if (stopped_) {
+          stopped_ = false;
+          return;
+        }
+        ReleaseDueTimers(Now());
+        if (!ready_.empty()) {
+          break;
+        }
+        if (poller_ != nullptr && poller_->Busy()) {
+          // Unlocked, since completions may post here
+          const auto wait{PollWait()};
+          lock.unlock();
+          poller_->Poll(wait);
+          lock.lock();
+          if (!ready_.empty() || wait > Clock::duration::zero()) {
+            continue;
+          }
+        }
+        if (timers_.empty()) {
+          wake_.wait(lock);
+        } else if (time_source_ != nullptr) {
+          // Unlocked, since moving a simulated clock may hand events to
+          // other threads that post them here
+          const auto due{timers_.front().due};
+          lock.unlock();
+          time_source_->AdvanceTo(due);
+          lock.lock();
+        } else {
+          wake_.wait_until(lock, timers_.front().due);
+        }
+      }
+    }
+    RunBatch(true);
+  }
+}
+
+auto EventLoop::RunReady() -> size_t { return RunBatch(false); }
+
+auto EventLoop::Stop() -> void {
+  {
+    const std::lock_guard lock{mutex_};
+    stopped_ = true;
+  }
+  wake_.notify_one();
+}
+
+auto EventLoop::SetTimeSource(TimeSource& source) -> void {
+  const std::lock_guard lock{mutex_};
+  time_source_ = &source;
+}
+
+auto EventLoop::Now() const -> Clock::time_point {
+  return time_source_ != nullptr ? time_source_->Now() : Clock::now();
+}
+
+auto EventLoop::SetPoller(Poller& poller) -> void {
+  const std::lock_guard lock{mutex_};
+  poller_ = &poller;
+}
+
+auto EventLoop::PollWait() const -> Clock::duration {
+  if (timers_.empty()) {
+    return kPollSlice;
+  }
+  // Simulated time moves on to the timer rather than waiting for replies
+  if (time_source_ != nullptr) {
+    return Clock::duration::zero();
+  }
+  return std::clamp(timers_.front().due - Now(), Clock::duration::zero(),
+                    kPollSlice);
+}
+
+auto EventLoop::ReleaseDueTimers(Clock::time_point now) -> void {
+  while (!timers_.empty() && timers_.front().due <= now) {
+    std::ranges::pop_heap(timers_, Later<Timer>);
+    ready_.push_back(std::move(timers_.back().task));
+    timers_.pop_back();
+  }
+}
+
+// Tasks run without the lock held, so they may post more work; that work
+// runs in the next batch, after everything already queued.
+auto EventLoop::RunBatch(bool stoppable) -> size_t {
+  {
+    const std::lock_guard lock{mutex_};
+    ReleaseDueTimers(Now());
+    batch_.swap(ready_);
+  }
+
+  size_t ran{0};
+  while (!batch_.empty()) {
+    auto task{std::move(batch_.front())};
+    batch_.pop_front();
+    task();
+    ++ran;
+
+    if (stoppable && !batch_.empty()) {
+      const std::lock_guard lock{mutex_};
+      if (stopped_) {
+        // Leave the rest for the next Run(), ahead of anything posted since
+        ready_.insert(ready_.begin(), std::make_move_iterator(batch_.begin()),
+                      std::make_move_iterator(batch_.end()));
+        batch_.clear();
+      }
+    }
+  }
+  return ran;
+}
+
+}  // namespace common
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "libs/common/poller.hpp"
+#include "libs/common/scheduler.hpp"
+#include "libs/common/time_source.hpp"
+
+namespace common {
+
+/// @brief Single-threaded run-to-completion executor
+///
+/// Any thread may Post() work; it runs on the thread that calls Run() or
+/// RunReady(), one task at a time and in the order posted. A producer such
+/// as a transport's server thread hands an event over and carries on
+/// instead of running application code itself.
+class EventLoop : public Scheduler {
+ public:
+  EventLoop() = default;
+  EventLoop(const EventLoop&) = delete;
+  EventLoop(EventLoop&&) = delete;
+  auto operator=(const EventLoop&) -> EventLoop& = delete;
+  auto operator=(EventLoop&&) -> EventLoop& = delete;
+  ~EventLoop() override = default;
+
+  /// @brief Queue task to run as soon as the tasks ahead of it have
+  auto Post(Task task) -> void override;
+
+  /// @brief Queue task to run once delay has passed
+  /// Timers due at the same time run in the order they were posted.
+  auto PostAfter(Clock::duration delay, Task task) -> void override;
+
+  /// @brief Queue task to run once Now() reaches due
+  /// For work on a fixed grid, where a delay from a late start would drift.
+  auto PostAt(Clock::time_point due, Task task) -> void;
+
+  /// @brief Run tasks as they arrive until Stop() is called
+  /// Sleeps while there is nothing to do, or polls the poller while it is
+  /// busy. Polling waits in slices of kPollSlice at most, so work posted
+  /// from other threads meanwhile starts up to a slice late.
+  auto Run() -> void override;
+
+  /// @brief Run the tasks that are ready now without waiting for more
+  /// Tasks they post run on the next call. Stop() does not affect it.
+  /// @return Number of tasks run
+  auto RunReady() -> size_t;
+
+  /// @brief Make Run() return once the current task finishes
+  /// Safe to call from any thread, including from a task.
+  auto Stop() -> void override;
+
+  /// @brief Schedule timers against source instead of the steady clock
+  /// When only timers are left, Run() advances source to the next one
+  /// rather than sleeping. Set it before posting any timer.
+  auto SetTimeSource(TimeSource& source) -> void;
+
+  /// @brief The time timers are scheduled against
+  [[nodiscard]] auto Now() const -> Clock::time_point;
+
+  /// @brief Have Run() poll poller instead of sleeping while it is busy
+  /// In simulated time Run() only polls what has already arrived before
+  /// advancing to the next timer. Set it before calling Run().
+  auto SetPoller(Poller& poller) -> void;
+
+  static constexpr Clock::duration kPollSlice{std::chrono::milliseconds{1}};
+
+ private:
+  struct Timer {
+    Clock::time_point due{};
+    // Breaks ties between timers due at the same time
+    uint64_t sequence{0};
+    Task task{};
+  };
+
+  // Moves due timers to the ready queue; mutex_ must be held
+  auto ReleaseDueTimers(Clock::time_point now) -> void;
+  // How long Run() may poll before it has other work; mutex_ must be held
+  [[nodiscard]] auto PollWait() const -> Clock::duration;
+  // Runs the tasks taken from ready_ in one go; returns how many ran. When
+  // stoppable, a Stop() leaves the rest of the batch queued.
+  auto RunBatch(bool stoppable) -> size_t;
+
+  std::mutex mutex_{};
+  std::condition_variable wake_{};
+  std::deque<Task> ready_{};
+  // Min-heap on (due, sequence)
+  std::vector<Timer> timers_{};
+  uint64_t next_sequence_{0};
+  bool stopped_{false};
+  TimeSource* time_source_{nullptr};
+  Poller* poller_{nullptr};
+  // Tasks being run; only touched by the running thread, and swapped with
+  // ready_ so its storage is reused
+  std::deque<Task> batch_{};
+};
+
+}  // namespace common
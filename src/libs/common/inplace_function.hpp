@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace common {
+
+template <typename Signature, size_t Capacity>
+class InplaceFunction;
+
+/// @brief std::function-like callable wrapper that never allocates
+///
+/// The callable is stored inside the object, so a capture larger than
+/// Capacity bytes fails to compile instead of falling back to the heap.
+/// Such a callable does not convert at all, so overloads and concepts
+/// that test for convertibility see it as unsupported.
+/// That makes it safe to create, copy and destroy in interrupt handlers.
+/// Like std::function, the callable must be copyable; a move-only one
+/// does not convert either.
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+ public:
+  InplaceFunction() = default;
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  InplaceFunction(std::nullptr_t /*null*/) {}
+
+  template <typename F>
+    requires(!std::is_same_v<std::remove_cvref_t<F>, InplaceFunction> &&
+             std::is_invocable_r_v<R, std::remove_cvref_t<F>&, Args...> &&
+             sizeof(std::remove_cvref_t<F>) <= Capacity &&
+             alignof(std::remove_cvref_t<F>) <= alignof(std::max_align_t) &&
+             std::is_nothrow_move_constructible_v<std::remove_cvref_t<F>> &&
+             std::copy_constructible<std::remove_cvref_t<F>>)
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  InplaceFunction(F&& callable) {
+    using Callable = std::remove_cvref_t<F>;
+    ::new (static_cast<void*>(storage_.data()))
+        Callable(std::forward<F>(callable));
+    ops_ = &kOps<Callable>;
+  }
+
+  InplaceFunction(const InplaceFunction& other) : ops_{other.ops_} {
+    if (ops_ != nullptr) {
+      ops_->copy(storage_.data(), other.storage_.data());
+    }
+  }
+
+  InplaceFunction(InplaceFunction&& other) noexcept : ops_{other.ops_} {
+    if (ops_ != nullptr) {
+      ops_->move(storage_.data(), other.storage_.data());
+      other.Reset();
+    }
+  }
+
+  auto operator=(const InplaceFunction& other) -> InplaceFunction& {
+    if (this != &other) {
+      Reset();
+      if (other.ops_ != nullptr) {
+        other.ops_->copy(storage_.data(), other.storage_.data());
+        ops_ = other.ops_;
+      }
+    }
+    return *this;
+  }
+
+  auto operator=(InplaceFunction&& other) noexcept -> InplaceFunction& {
+    if (this != &other) {
+      Reset();
+      if (other.ops_ != nullptr) {
+        other.ops_->move(storage_.data(), other.storage_.data());
+        ops_ = other.ops_;
+        other.Reset();
+      }
+    }
+    return *this;
+  }
+
+  auto operator=(std::nullptr_t /*null*/) -> InplaceFunction& {
+    Reset();
+    return *this;
+  }
+
+  ~InplaceFunction() { Reset(); }
+
+  // Calling an empty InplaceFunction is undefined, unlike std::function,
+  // which would throw
+  auto operator()(Args... args) const -> R {
+    return ops_->invoke(storage_.data(), std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+ private:
+  // One table per stored callable type, shared by every instance
+  struct Ops {
+    R (*invoke)(void* storage, Args&&... args);
+    void (*copy)(void* destination, const void* source);
+    void (*move)(void* destination, void* source);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Callable>
+  static constexpr Ops kOps{
+      .invoke = [](void* storage, Args&&... args) -> R {
+        return std::invoke(*static_cast<Callable*>(storage),
+                           std::forward<Args>(args)...);
+      },
+      .copy =
+          [](void* destination, const void* source) {
+            ::new (destination)
+                Callable(*static_cast<const Callable*>(source));
+          },
+      .move =
+          [](void* destination, void* source) {
+            ::new (destination)
+                Callable(std::move(*static_cast<Callable*>(source)));
+          },
+      .destroy =
+          [](void* storage) {
+            std::destroy_at(static_cast<Callable*>(storage));
+          },
+  };
+
+  auto Reset() -> void {
+    if (ops_ != nullptr) {
+      ops_->destroy(storage_.data());
+      ops_ = nullptr;
+    }
+  }
+
+  // Mutable so that a const InplaceFunction can call a mutable lambda, as
+  // std::function allows
+  alignas(std::max_align_t) mutable std::array<std::byte, Capacity> storage_;
+  const Ops* ops_{nullptr};
+};
+
+}  // namespace common
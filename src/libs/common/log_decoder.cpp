@@ -0,0 +1,75 @@
+// Prints a binary log written by BinaryLogSink as text, one line per
+// record, the same as TextLogSink would have.
+//
+//   log_decoder device.blog
+//   log_decoder < device.blog
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <print>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "libs/common/binary_log.hpp"
+
+namespace {
+
+namespace binary_log = common::binary_log;
+
+auto Decode(std::istream& input) -> int {
+  const std::vector<char> bytes{std::istreambuf_iterator<char>{input},
+                                std::istreambuf_iterator<char>{}};
+  const auto data{std::as_bytes(std::span{bytes})};
+  std::unordered_map<uint16_t, std::string> formats{};
+
+  size_t offset{0};
+  while (offset < data.size()) {
+    const auto record{binary_log::DecodeRecord(data.subspan(offset))};
+    if (!record) {
+      std::println(stderr, "log_decoder: malformed record at byte {}", offset);
+      return 1;
+    }
+    offset += record->header.size;
+
+    if (record->header.level == binary_log::kFormatDefinition) {
+      if (!record->args.empty() &&
+          std::holds_alternative<std::string>(record->args[0])) {
+        formats[record->header.format] =
+            std::get<std::string>(record->args[0]);
+      }
+      continue;
+    }
+    const auto format{formats.find(record->header.format)};
+    std::println("{}", binary_log::FormatLine(
+                           *record, format != formats.end()
+                                        ? std::string_view{format->second}
+                                        : "<unknown format>"));
+  }
+  return 0;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  if (argc > 2 || (argc == 2 && std::strcmp(argv[1], "--help") == 0)) {
+    std::println(stderr, "usage: log_decoder [binary log file]");
+    return 2;
+  }
+  if (argc == 1) {
+    return Decode(std::cin);
+  }
+  std::ifstream file{argv[1], std::ios::binary};
+  if (!file) {
+    std::println(stderr, "log_decoder: cannot open {}", argv[1]);
+    return 1;
+  }
+  return Decode(file);
+}
@@ -5,18 +5,30 @@
 namespace common {
 
 auto ConsoleLogger::Debug(std::string_view msg) -> void {
+  if (!Enabled(LogLevel::kDebug)) {
+    return;
+  }
   std::println("[DEBUG] {}", msg);
 }
 
 auto ConsoleLogger::Info(std::string_view msg) -> void {
+  if (!Enabled(LogLevel::kInfo)) {
+    return;
+  }
   std::println("[INFO]  {}", msg);
 }
 
 auto ConsoleLogger::Warning(std::string_view msg) -> void {
+  if (!Enabled(LogLevel::kWarning)) {
+    return;
+  }
   std::println(stderr, "[WARN]  {}", msg);
 }
 
 auto ConsoleLogger::Error(std::string_view msg) -> void {
+  if (!Enabled(LogLevel::kError)) {
+    return;
+  }
   std::println(stderr, "[ERROR] {}", msg);
 }
 
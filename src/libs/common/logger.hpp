@@ -1,25 +1,102 @@
 #pragma once
 
+#include <atomic>
+#include <concepts>
 #include <string_view>
+#include <utility>
+
+// Lowest level whose log calls are compiled in, as a LogLevel value (0 for
+// kDebug). The build sets it to kWarning for target and host Release
+// builds.
+#ifndef COMMON_MIN_LOG_LEVEL
+#define COMMON_MIN_LOG_LEVEL 0
+#endif
+
+static_assert(COMMON_MIN_LOG_LEVEL >= 0 && COMMON_MIN_LOG_LEVEL <= 4,
+              "COMMON_MIN_LOG_LEVEL must be 0 (debug) to 4 (off)");
 
 namespace common {
 
-enum class LogLevel { kDebug, kInfo, kWarning, kError };
+enum class LogLevel { kDebug, kInfo, kWarning, kError, kOff };
+
+// Calls through Log() below this level compile to nothing: no virtual
+// call, and a message built by a callable is never built
+inline constexpr LogLevel kMinLogLevel{
+    static_cast<LogLevel>(COMMON_MIN_LOG_LEVEL)};
 
 // Abstract logging interface
 class Logger {
  public:
+  Logger() = default;
+  Logger(const Logger&) = delete;
+  Logger(Logger&&) = delete;
+  auto operator=(const Logger&) -> Logger& = delete;
+  auto operator=(Logger&&) -> Logger& = delete;
   virtual ~Logger() = default;
 
   virtual auto Debug(std::string_view msg) -> void = 0;
   virtual auto Info(std::string_view msg) -> void = 0;
   virtual auto Warning(std::string_view msg) -> void = 0;
   virtual auto Error(std::string_view msg) -> void = 0;
+
+  // Run-time threshold on top of kMinLogLevel; kOff silences the logger
+  auto SetLevel(LogLevel level) -> void {
+    level_.store(level, std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto Level() const -> LogLevel {
+    return level_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto Enabled(LogLevel level) const -> bool {
+    return level >= kMinLogLevel && level >= Level() &&
+           level != LogLevel::kOff;
+  }
+
+  // Passes msg to the method for level
+  auto Write(LogLevel level, std::string_view msg) -> void {
+    switch (level) {
+      case LogLevel::kDebug:
+        Debug(msg);
+        break;
+      case LogLevel::kInfo:
+        Info(msg);
+        break;
+      case LogLevel::kWarning:
+        Warning(msg);
+        break;
+      case LogLevel::kError:
+        Error(msg);
+        break;
+      case LogLevel::kOff:
+        break;
+    }
+  }
+
+ private:
+  std::atomic<LogLevel> level_{LogLevel::kDebug};
 };
 
-// Null logger - discards all messages (default for embedded)
+// Logs msg at Level unless Level is compiled out or below the logger's
+// level. msg may be a callable returning the text, so that a message that
+// has to be built is only built when it is logged.
+template <LogLevel Level, typename Message>
+auto Log(Logger& logger, Message&& msg) -> void {
+  if constexpr (Level >= kMinLogLevel && Level != LogLevel::kOff) {
+    if (logger.Enabled(Level)) {
+      if constexpr (std::invocable<Message>) {
+        logger.Write(Level, std::forward<Message>(msg)());
+      } else {
+        logger.Write(Level, std::forward<Message>(msg));
+      }
+    }
+  }
+}
+
+// Null logger - discards all messages (default for embedded). Its level is
+// kOff, so Log() does not even make the call.
 class NullLogger : public Logger {
  public:
+  NullLogger() { SetLevel(LogLevel::kOff); }
+
   auto Debug(std::string_view /* msg */) -> void override {}
   auto Info(std::string_view /* msg */) -> void override {}
   auto Warning(std::string_view /* msg */) -> void override {}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+
+namespace common {
+
+/// @brief Completions that only arrive while someone waits for them
+///
+/// A transport that reads replies on the application thread completes
+/// nothing unless that thread asks it to. An event loop with such a source
+/// calls Poll() rather than sleeping for as long as Busy() is true.
+class Poller {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  Poller() = default;
+  Poller(const Poller&) = delete;
+  Poller(Poller&&) = delete;
+  auto operator=(const Poller&) -> Poller& = delete;
+  auto operator=(Poller&&) -> Poller& = delete;
+  virtual ~Poller() = default;
+
+  /// @brief Whether there is anything to wait for
+  [[nodiscard]] virtual auto Busy() const -> bool = 0;
+
+  /// @brief Wait up to max_wait for completions and run those that arrive
+  /// May return early, and at once when max_wait is zero.
+  virtual auto Poll(Clock::duration max_wait) -> void = 0;
+};
+
+}  // namespace common
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+namespace common {
+
+/// @brief Where an application's work runs
+///
+/// What apps see of the board's event loop: they post work to it and hand
+/// it the thread in place of a busy loop. Hosted builds implement it with
+/// EventLoop (libs/common/event_loop.hpp); a bare-metal board implements it
+/// over its own interrupts and idle loop.
+class Scheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Task = std::function<void()>;
+
+  Scheduler() = default;
+  Scheduler(const Scheduler&) = delete;
+  Scheduler(Scheduler&&) = delete;
+  auto operator=(const Scheduler&) -> Scheduler& = delete;
+  auto operator=(Scheduler&&) -> Scheduler& = delete;
+  virtual ~Scheduler() = default;
+
+  /// @brief Queue task to run as soon as the tasks ahead of it have
+  virtual auto Post(Task task) -> void = 0;
+
+  /// @brief Queue task to run once delay has passed
+  virtual auto PostAfter(Clock::duration delay, Task task) -> void = 0;
+
+  /// @brief Run tasks as they arrive until Stop() is called
+  virtual auto Run() -> void = 0;
+
+  /// @brief Make Run() return once the current task finishes
+  /// Safe to call from a task and from interrupt or other threads.
+  virtual auto Stop() -> void = 0;
+};
+
+}  // namespace common
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace common {
+
+/// @brief Lock-free single-producer single-consumer ring buffer
+///
+/// One thread may Push() while another Pop()s, without locks. This is the
+/// buffer an interrupt-driven driver keeps between its ISR and the
+/// application. Size() and Capacity() may be called from either side.
+template <typename T>
+class SpscRing {
+ public:
+  explicit SpscRing(size_t capacity)
+      : capacity_{capacity}, storage_{std::make_unique<T[]>(capacity)} {}
+
+  /// @brief Copy as much of data as fits (producer side)
+  /// @return Number of elements stored; the rest did not fit
+  auto Push(std::span<const T> data) -> size_t {
+    // head_ is only written by the producer, so relaxed sees our own store
+    const size_t head{head_.load(std::memory_order_relaxed)};
+    const size_t tail{tail_.load(std::memory_order_acquire)};
+    const size_t count{std::min(data.size(), capacity_ - (head - tail))};
+    if (count == 0) {
+      return 0;
+    }
+    const size_t offset{head % capacity_};
+    const size_t first{std::min(count, capacity_ - offset)};
+    std::copy_n(data.begin(), first, storage_.get() + offset);
+    std::copy_n(data.begin() + first, count - first, storage_.get());
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  /// @brief Move up to out.size() elements into out (consumer side)
+  /// @return Number of elements copied
+  auto Pop(std::span<T> out) -> size_t {
+    // tail_ is only written by the consumer, so relaxed sees our own store
+    const size_t tail{tail_.load(std::memory_order_relaxed)};
+    const size_t head{head_.load(std::memory_order_acquire)};
+    const size_t count{std::min(out.size(), head - tail)};
+    if (count == 0) {
+      return 0;
+    }
+    const size_t offset{tail % capacity_};
+    const size_t first{std::min(count, capacity_ - offset)};
+    std::copy_n(storage_.get() + offset, first, out.begin());
+    std::copy_n(storage_.get(), count - first, out.begin() + first);
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  [[nodiscard]] auto Size() const -> size_t {
+    // Reading tail first guarantees head >= tail
+    const size_t tail{tail_.load(std::memory_order_acquire)};
+    return head_.load(std::memory_order_acquire) - tail;
+  }
+
+  [[nodiscard]] auto Capacity() const -> size_t { return capacity_; }
+
+ private:
+  // Keeps the producer's and consumer's counters on separate cache lines
+  static constexpr size_t kCacheLineSize{64};
+
+  // Elements pushed and popped since construction; both only ever grow
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  alignas(kCacheLineSize) const size_t capacity_;
+  std::unique_ptr<T[]> storage_;
+};
+
+}  // namespace common
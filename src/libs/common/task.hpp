@@ -0,0 +1,194 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace common {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+// Coroutine frame allocation. A coroutine whose parameters start with
+// (std::allocator_arg_t, std::pmr::memory_resource&) - after the object, for
+// a member function - gets its frame from that resource, e.g. a
+// monotonic_buffer_resource over a static buffer, so it never touches the
+// heap. Other coroutines use the global operator new.
+class FrameAllocation {
+ public:
+  static auto operator new(size_t size) -> void* {
+    return Allocate(size, nullptr);
+  }
+
+  template <typename... Args>
+  static auto operator new(size_t size, std::allocator_arg_t /*tag*/,
+                           std::pmr::memory_resource& resource,
+                           Args&... /*args*/) -> void* {
+    return Allocate(size, &resource);
+  }
+
+  template <typename Object, typename... Args>
+  static auto operator new(size_t size, Object& /*object*/,
+                           std::allocator_arg_t /*tag*/,
+                           std::pmr::memory_resource& resource,
+                           Args&... /*args*/) -> void* {
+    return Allocate(size, &resource);
+  }
+
+  // The coroutine always frees its frame with the sized delete below, which
+  // finds the resource in the frame's header
+  static auto operator delete(void* frame, size_t size) -> void {
+    auto* header{static_cast<std::byte*>(frame) - kHeaderSize};
+    auto* resource{*reinterpret_cast<std::pmr::memory_resource**>(header)};
+    if (resource == nullptr) {
+      ::operator delete(header);
+    } else {
+      resource->deallocate(header, size + kHeaderSize,
+                           alignof(std::max_align_t));
+    }
+  }
+
+ private:
+  // Records which resource to give the frame back to; padded so the frame
+  // keeps the alignment the compiler expects
+  static constexpr size_t kHeaderSize{alignof(std::max_align_t)};
+
+  static auto Allocate(size_t size, std::pmr::memory_resource* resource)
+      -> void* {
+    auto* header{static_cast<std::byte*>(
+        resource == nullptr
+            ? ::operator new(size + kHeaderSize)
+            : resource->allocate(size + kHeaderSize,
+                                 alignof(std::max_align_t)))};
+    *reinterpret_cast<std::pmr::memory_resource**>(header) = resource;
+    return header + kHeaderSize;
+  }
+};
+
+// Hands control back to whoever awaited the task, or to the caller of
+// Start() when nobody did
+struct FinalAwaiter {
+  [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+  template <typename Promise>
+  auto await_suspend(std::coroutine_handle<Promise> handle) noexcept
+      -> std::coroutine_handle<> {
+    if (auto continuation{handle.promise().continuation}) {
+      return continuation;
+    }
+    return std::noop_coroutine();
+  }
+  auto await_resume() const noexcept -> void {}
+};
+
+template <typename T>
+struct PromiseBase : FrameAllocation {
+  // Tasks are lazy: nothing runs until the task is awaited or started
+  auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+  auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+  // Built without exception handling in mind, as on target
+  auto unhandled_exception() noexcept -> void { std::terminate(); }
+
+  auto return_value(T value) -> void { result.emplace(std::move(value)); }
+
+  std::coroutine_handle<> continuation{};
+  std::optional<T> result{};
+};
+
+template <>
+struct PromiseBase<void> : FrameAllocation {
+  auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+  auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+  auto unhandled_exception() noexcept -> void { std::terminate(); }
+
+  auto return_void() -> void {}
+
+  std::coroutine_handle<> continuation{};
+};
+
+}  // namespace detail
+
+/// @brief Coroutine that produces a T, for writing multi-step async
+/// operations as straight-line code
+///
+/// A Task does nothing until it is co_awaited from another coroutine, which
+/// then resumes with its result, or until Start() runs it from plain code.
+/// It owns its frame, so it must outlive the coroutine's execution.
+template <typename T>
+class Task {
+ public:
+  struct promise_type : detail::PromiseBase<T> {
+    auto get_return_object() -> Task {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+  };
+
+  Task() = default;
+  Task(const Task&) = delete;
+  Task(Task&& other) noexcept
+      : handle_{std::exchange(other.handle_, nullptr)} {}
+  auto operator=(const Task&) -> Task& = delete;
+  auto operator=(Task&& other) noexcept -> Task& {
+    if (this != &other) {
+      Destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  ~Task() { Destroy(); }
+
+  /// @brief Run the task from non-coroutine code until it first suspends
+  auto Start() -> void { handle_.resume(); }
+
+  /// @brief Whether the task has run to completion
+  [[nodiscard]] auto Done() const -> bool { return handle_ && handle_.done(); }
+
+  /// @brief The value the task returned; only valid once Done()
+  [[nodiscard]] auto Result() -> T&
+    requires(!std::is_void_v<T>)
+  {
+    return *handle_.promise().result;
+  }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      [[nodiscard]] auto await_ready() const noexcept -> bool {
+        return handle.done();
+      }
+      auto await_suspend(std::coroutine_handle<> awaiting) noexcept
+          -> std::coroutine_handle<> {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      auto await_resume() -> T {
+        if constexpr (!std::is_void_v<T>) {
+          return std::move(*handle.promise().result);
+        }
+      }
+
+      std::coroutine_handle<promise_type> handle;
+    };
+    return Awaiter{handle_};
+  }
+
+ private:
+  explicit Task(std::coroutine_handle<promise_type> handle)
+      : handle_{handle} {}
+
+  auto Destroy() -> void {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  std::coroutine_handle<promise_type> handle_{};
+};
+
+}  // namespace common
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+
+namespace common {
+
+/// @brief Where time comes from, when it is not the wall clock
+///
+/// A simulation runs on a clock that only moves when told to. Waiting for a
+/// point in time then means moving the clock there, which takes no time at
+/// all, instead of sleeping until the steady clock reaches it.
+class TimeSource {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TimeSource() = default;
+  TimeSource(const TimeSource&) = delete;
+  TimeSource(TimeSource&&) = delete;
+  auto operator=(const TimeSource&) -> TimeSource& = delete;
+  auto operator=(TimeSource&&) -> TimeSource& = delete;
+  virtual ~TimeSource() = default;
+
+  [[nodiscard]] virtual auto Now() const -> Clock::time_point = 0;
+
+  /// @brief Move time forward to when
+  /// Returns at once, with Now() >= when, if when has already passed.
+  virtual auto AdvanceTo(Clock::time_point when) -> void = 0;
+};
+
+}  // namespace common
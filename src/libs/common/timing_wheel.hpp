@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/common/inplace_function.hpp"
+
+namespace common {
+
+/// @brief Names a timer in a TimingWheel, for Cancel()
+/// Stays safe to use after the timer fires: its slot's generation moves
+/// on, so a stale id matches nothing.
+struct TimerId {
+  uint32_t index{0};
+  uint32_t generation{0};
+
+  auto operator==(const TimerId&) const -> bool = default;
+};
+
+/// @brief Hierarchical timing wheel of up to Capacity one-shot timers
+///
+/// Time is a tick count moved on by Advance(). Timers due within 64 ticks
+/// sit in the slot for their tick; later ones sit in coarser levels of 64
+/// slots, 64 times wider each, and move down a level as their time comes
+/// closer. Start() and Cancel() are O(1), and so is a tick, apart from
+/// moving a coarse slot down once every 64 ticks of the level below.
+///
+/// Timers live in a fixed pool inside the wheel and their callbacks in
+/// InplaceFunctions, so nothing is allocated after construction. There is
+/// no locking: use a wheel from one context, e.g. a SysTick handler that
+/// calls Advance(), with thread code masking that interrupt around its
+/// Start() and Cancel() calls.
+template <size_t Capacity, size_t CallbackCapacity = 4 * sizeof(void*)>
+class TimingWheel {
+ public:
+  using Callback = InplaceFunction<void(), CallbackCapacity>;
+
+  static constexpr size_t kLevels{4};
+  static constexpr size_t kSlotBits{6};
+  static constexpr size_t kSlots{size_t{1} << kSlotBits};
+  // Ticks the levels cover. Longer timers wait in the top level and are
+  // placed again each time it turns.
+  static constexpr uint64_t kRange{uint64_t{1} << (kLevels * kSlotBits)};
+
+  static_assert(Capacity > 0 &&
+                    Capacity < std::numeric_limits<uint32_t>::max(),
+                "Capacity out of range");
+
+  TimingWheel() {
+    for (uint32_t i = 0; i < Capacity; ++i) {
+      nodes_[i].next = i + 1 < Capacity ? i + 1 : kNone;
+    }
+    for (auto& level : slots_) {
+      level.fill(kNone);
+    }
+  }
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel(TimingWheel&&) = delete;
+  auto operator=(const TimingWheel&) -> TimingWheel& = delete;
+  auto operator=(TimingWheel&&) -> TimingWheel& = delete;
+  ~TimingWheel() = default;
+
+  /// @brief Run callback once ticks more ticks have passed
+  /// Zero ticks counts as one: the callback runs on the next tick.
+  /// @return The timer's id, or kWouldBlock if every timer is in use
+  auto Start(uint64_t ticks, Callback callback)
+      -> std::expected<TimerId, Error> {
+    if (!callback) {
+      return std::unexpected(Error::kInvalidArgument);
+    }
+    if (free_ == kNone) {
+      return std::unexpected(Error::kWouldBlock);
+    }
+    const uint32_t index{free_};
+    auto& node{nodes_[index]};
+    free_ = node.next;
+    node.callback = std::move(callback);
+    node.expiry = now_ + std::max<uint64_t>(ticks, 1);
+    node.active = true;
+    Place(index);
+    ++size_;
+    return TimerId{.index = index, .generation = node.generation};
+  }
+
+  /// @brief Stop the timer before it fires
+  /// @return Whether it was still pending
+  auto Cancel(TimerId id) -> bool {
+    if (id.index >= Capacity) {
+      return false;
+    }
+    auto& node{nodes_[id.index]};
+    if (!node.active || node.generation != id.generation) {
+      return false;
+    }
+    Unlink(id.index);
+    Release(id.index);
+    return true;
+  }
+
+  /// @brief Move time on by ticks, running the timers that come due
+  /// Timers due on the same tick run in the order they were started.
+  /// Callbacks may start and cancel timers, but not call Advance().
+  /// @return Number of callbacks run
+  auto Advance(uint64_t ticks = 1) -> size_t {
+    size_t fired{0};
+    while (ticks > 0) {
+      if (size_ == 0) {
+        // Nothing to place or run, so the ticks can go in one step
+        now_ += ticks;
+        break;
+      }
+      --ticks;
+      ++now_;
+      Cascade();
+      fired += Fire();
+    }
+    return fired;
+  }
+
+  /// @brief Ticks passed since construction
+  [[nodiscard]] auto Now() const -> uint64_t { return now_; }
+
+  /// @brief Number of pending timers
+  [[nodiscard]] auto Size() const -> size_t { return size_; }
+
+ private:
+  static constexpr uint32_t kNone{std::numeric_limits<uint32_t>::max()};
+  static constexpr uint64_t kSlotMask{kSlots - 1};
+
+  struct Node {
+    Callback callback{};
+    // Tick the timer is due on
+    uint64_t expiry{0};
+    // Neighbors in the slot's list, or in the free list (next only)
+    uint32_t prev{kNone};
+    uint32_t next{kNone};
+    // Bumped each time the node is freed, retiring its old ids
+    uint32_t generation{1};
+    // The slot's list head the node is linked into
+    uint32_t* head{nullptr};
+    bool active{false};
+  };
+
+  // Links a node into the slot for its expiry, at the tail so that
+  // timers due on the same tick run in start order
+  auto Place(uint32_t index) -> void {
+    auto& node{nodes_[index]};
+    const uint64_t delta{std::min(node.expiry - now_, kRange - 1)};
+    const uint64_t expiry{now_ + delta};
+    size_t level{0};
+    while (level + 1 < kLevels &&
+           delta >= (uint64_t{1} << ((level + 1) * kSlotBits))) {
+      ++level;
+    }
+    auto& head{slots_[level][(expiry >> (level * kSlotBits)) & kSlotMask]};
+    node.head = &head;
+    node.next = kNone;
+    if (head == kNone) {
+      node.prev = index;
+      head = index;
+    } else {
+      // The head's prev points at the tail, so appending is O(1)
+      const uint32_t tail{nodes_[head].prev};
+      node.prev = tail;
+      nodes_[tail].next = index;
+      nodes_[head].prev = index;
+    }
+  }
+
+  auto Unlink(uint32_t index) -> void {
+    auto& node{nodes_[index]};
+    uint32_t& head{*node.head};
+    if (head == index) {
+      head = node.next;
+      if (head != kNone) {
+        nodes_[head].prev = node.prev;
+      }
+    } else {
+      nodes_[node.prev].next = node.next;
+      const uint32_t next{node.next != kNone ? node.next : head};
+      nodes_[next].prev = node.prev;
+    }
+    node.head = nullptr;
+  }
+
+  // Returns the node to the free list; its callback must be gone already
+  // or is dropped here
+  auto Release(uint32_t index) -> void {
+    auto& node{nodes_[index]};
+    node.callback = nullptr;
+    node.active = false;
+    ++node.generation;
+    node.next = free_;
+    free_ = index;
+    --size_;
+  }
+
+  // When a level turns over, the next level's current slot comes due
+  // within its range and moves down. Lower levels go first, as the Linux
+  // kernel's timer wheel does, so that nothing lands in a slot that was
+  // already moved this tick.
+  auto Cascade() -> void {
+    for (size_t level = 1; level < kLevels; ++level) {
+      if ((now_ & ((uint64_t{1} << (level * kSlotBits)) - 1)) != 0) {
+        return;
+      }
+      auto& head{slots_[level][(now_ >> (level * kSlotBits)) & kSlotMask]};
+      uint32_t index{std::exchange(head, kNone)};
+      while (index != kNone) {
+        const uint32_t next{nodes_[index].next};
+        Place(index);
+        index = next;
+      }
+    }
+  }
+
+  // Runs the timers in the current tick's slot
+  auto Fire() -> size_t {
+    auto& head{slots_[0][now_ & kSlotMask]};
+    size_t fired{0};
+    while (head != kNone) {
+      const uint32_t index{head};
+      Unlink(index);
+      // Freed before the call, so the callback can start a timer in its
+      // place
+      auto callback{std::move(nodes_[index].callback)};
+      Release(index);
+      callback();
+      ++fired;
+    }
+    return fired;
+  }
+
+  std::array<Node, Capacity> nodes_{};
+  std::array<std::array<uint32_t, kSlots>, kLevels> slots_{};
+  uint32_t free_{0};
+  size_t size_{0};
+  uint64_t now_{0};
+};
+
+}  // namespace common
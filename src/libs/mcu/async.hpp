@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/i2c.hpp"
+#include "libs/mcu/uart.hpp"
+
+// Awaitable forms of the callback-based UART and I2C operations, so a
+// driver that needs several transfers can be written as one coroutine
+// (see libs/common/task.hpp):
+//
+//   auto ReadTemperature(mcu::I2CController& i2c) -> common::Task<...> {
+//     std::array<std::byte, 2> raw{};
+//     auto read{co_await mcu::WriteReadAsync(i2c, kAddress, kTempReg, raw)};
+//     ...
+//   }
+//
+// The coroutine resumes wherever the driver completes the operation: in
+// Transport::Poll() on the host, in the interrupt handler on target.
+
+namespace mcu {
+
+/// @brief Suspends the awaiting coroutine until an operation's callback runs
+/// @tparam T Value the operation produces; void for writes
+/// @tparam Start Callable that starts the operation given its callback
+template <typename T, typename Start>
+class CompletionAwaiter {
+ public:
+  explicit CompletionAwaiter(Start start) : start_{std::move(start)} {}
+  CompletionAwaiter(const CompletionAwaiter&) = delete;
+  CompletionAwaiter(CompletionAwaiter&&) = delete;
+  auto operator=(const CompletionAwaiter&) -> CompletionAwaiter& = delete;
+  auto operator=(CompletionAwaiter&&) -> CompletionAwaiter& = delete;
+  ~CompletionAwaiter() = default;
+
+  [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+
+  // The callback may run before the start function returns, e.g. when the
+  // data is already buffered. Whichever of the two finishes second resumes
+  // the coroutine, so it is never resumed from inside await_suspend().
+  auto await_suspend(std::coroutine_handle<> awaiting) -> bool {
+    awaiting_ = awaiting;
+    // Captures only this, so the callback fits the drivers' inline
+    // callback storage
+    auto started{start_([this](std::expected<T, common::Error> result) {
+      result_ = std::move(result);
+      if (completed_.exchange(true, std::memory_order_acq_rel)) {
+        awaiting_.resume();
+      }
+    })};
+    if (!started) {
+      result_ = std::unexpected(started.error());
+      return false;
+    }
+    return !completed_.exchange(true, std::memory_order_acq_rel);
+  }
+
+  auto await_resume() -> std::expected<T, common::Error> {
+    return std::move(result_);
+  }
+
+ private:
+  Start start_;
+  std::coroutine_handle<> awaiting_{};
+  std::expected<T, common::Error> result_{
+      std::unexpected(common::Error::kUnknown)};
+  std::atomic<bool> completed_{false};
+};
+
+template <typename T, typename Start>
+auto MakeCompletionAwaiter(Start start) -> CompletionAwaiter<T, Start> {
+  return CompletionAwaiter<T, Start>{std::move(start)};
+}
+
+/// @brief co_await to send data with Uart::SendAsync()
+[[nodiscard]] inline auto WriteAsync(Uart& uart,
+                                     std::span<const std::byte> data) {
+  return MakeCompletionAwaiter<void>([&uart, data](auto callback) {
+    return uart.SendAsync(data, std::move(callback));
+  });
+}
+
+/// @brief co_await to receive data with Uart::ReceiveAsync()
+/// @return Number of bytes received, or error
+[[nodiscard]] inline auto ReadAsync(Uart& uart, std::span<std::byte> buffer) {
+  return MakeCompletionAwaiter<size_t>([&uart, buffer](auto callback) {
+    return uart.ReceiveAsync(buffer, std::move(callback));
+  });
+}
+
+/// @brief co_await to send data with I2CController::SendDataDma()
+[[nodiscard]] inline auto WriteAsync(I2CController& i2c, uint16_t address,
+                                     std::span<const std::byte> data) {
+  return MakeCompletionAwaiter<void>([&i2c, address, data](auto callback) {
+    return i2c.SendDataDma(address, data, std::move(callback));
+  });
+}
+
+/// @brief co_await to receive data with I2CController::ReceiveDataDma()
+/// @return Number of bytes received, or error
+[[nodiscard]] inline auto ReadAsync(I2CController& i2c, uint16_t address,
+                                    std::span<std::byte> buffer) {
+  return MakeCompletionAwaiter<size_t>([&i2c, address, buffer](auto callback) {
+    return i2c.ReceiveDataDma(address, buffer, std::move(callback));
+  });
+}
+
+/// @brief co_await a repeated-start register read with
+/// I2CController::WriteReadDma()
+/// @return Number of bytes received, or error
+[[nodiscard]] inline auto WriteReadAsync(I2CController& i2c, uint16_t address,
+                                         std::span<const std::byte> data,
+                                         std::span<std::byte> buffer) {
+  return MakeCompletionAwaiter<size_t>(
+      [&i2c, address, data, buffer](auto callback) {
+        return i2c.WriteReadDma(address, data, buffer, std::move(callback));
+      });
+}
+
+/// @brief co_await a batched transaction with I2CController::Transact()
+[[nodiscard]] inline auto TransactAsync(I2CController& i2c,
+                                        std::span<const I2CSegment> segments) {
+  return MakeCompletionAwaiter<void>([&i2c, segments](auto callback) {
+    return i2c.Transact(segments, std::move(callback));
+  });
+}
+
+}  // namespace mcu
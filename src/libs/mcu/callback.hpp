@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+
+#include "libs/common/error.hpp"
+#include "libs/common/inplace_function.hpp"
+
+namespace mcu {
+
+// Room for a driver callback's captures: `this` plus a few references or a
+// span. Callbacks run in interrupt context on target, so anything larger is
+// rejected at compile time rather than put on the heap.
+inline constexpr size_t kCallbackCapacity{4 * sizeof(void*)};
+
+// Completes an asynchronous transfer with its result
+template <typename T>
+using CompletionCallback =
+    common::InplaceFunction<void(std::expected<T, common::Error>),
+                            kCallbackCapacity>;
+
+// Runs on a pin's configured transition
+using InterruptHandler = common::InplaceFunction<void(), kCallbackCapacity>;
+
+// Runs when a timer expires
+using TimerCallback = common::InplaceFunction<void(), kCallbackCapacity>;
+
+// Receives data nobody asked for, e.g. bytes arriving on a UART
+using RxHandler =
+    common::InplaceFunction<void(const std::byte*, size_t), kCallbackCapacity>;
+
+}  // namespace mcu
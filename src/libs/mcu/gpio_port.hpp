@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+
+#include "libs/common/error.hpp"
+
+namespace mcu {
+
+/// @brief A GPIO port driven as a whole
+///
+/// Bit n of a mask or value is pin n of the port. Each call touches every
+/// selected pin at once, so multi-pin updates cost one call instead of one
+/// per pin and other pins never see a half-written port.
+class GpioPort {
+ public:
+  virtual ~GpioPort() = default;
+
+  /// @brief Drive the pins in mask to the matching bits of value
+  [[nodiscard]] virtual auto Write(uint32_t mask, uint32_t value)
+      -> std::expected<void, common::Error> = 0;
+
+  /// @brief Read the level of every pin of the port
+  [[nodiscard]] virtual auto Read()
+      -> std::expected<uint32_t, common::Error> = 0;
+
+  /// @brief Invert the pins in mask
+  [[nodiscard]] virtual auto Toggle(uint32_t mask)
+      -> std::expected<void, common::Error> = 0;
+};
+
+}  // namespace mcu
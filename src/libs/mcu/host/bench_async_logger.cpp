@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <span>
+#include <string>
+
+#include "libs/common/async_logger.hpp"
+#include "libs/common/logger.hpp"
+
+namespace common {
+namespace {
+
+// Takes records and does nothing, so only the logging side is measured
+class DiscardSink : public LogSink {
+ public:
+  auto Write(std::span<const std::byte> /*record*/) -> void override {}
+};
+
+constexpr AsyncLogger::Config kConfig{
+    .ring_bytes = 1024 * 1024, .flush_interval = std::chrono::milliseconds{1}};
+
+// What a transport's log call costs with the async logger behind it. At
+// kWarning, since Release builds compile debug and info out.
+auto BmAsyncLogText(benchmark::State& state) -> void {
+  DiscardSink sink{};
+  AsyncLogger logger{sink, kConfig};
+  for (auto _ : state) {
+    logger.Warning("ServerThread received a message");
+  }
+  state.counters["dropped"] = static_cast<double>(logger.Dropped());
+  state.SetItemsProcessed(state.iterations());
+}
+
+auto BmAsyncLogArgs(benchmark::State& state) -> void {
+  DiscardSink sink{};
+  AsyncLogger logger{sink, kConfig};
+  uint32_t id{0};
+  for (auto _ : state) {
+    logger.Log<LogLevel::kWarning, "reply {} for {} after {} us">(
+        id++, "UART 1", 12.5);
+  }
+  state.counters["dropped"] = static_cast<double>(logger.Dropped());
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The baseline: format on the logging thread and write the line out, as
+// ConsoleLogger does, here to /dev/null rather than a terminal
+auto BmFormatAndWrite(benchmark::State& state) -> void {
+  std::FILE* null{std::fopen("/dev/null", "w")};
+  uint32_t id{0};
+  for (auto _ : state) {
+    const auto line{std::format("[WARN]  reply {} for {} after {} us\n", id++,
+                                "UART 1", 12.5)};
+    std::fputs(line.c_str(), null);
+  }
+  std::fclose(null);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BmAsyncLogText);
+BENCHMARK(BmAsyncLogArgs);
+BENCHMARK(BmFormatAndWrite);
+
+}  // namespace
+}  // namespace common
@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "dispatcher.hpp"
+#include "emulator_message_codec.hpp"
+#include "host_emulator_messages.hpp"
+#include "libs/common/error.hpp"
+#include "receiver.hpp"
+
+namespace mcu {
+namespace {
+
+// Behaves like HostPin::Receive: decode fully, then reject on name mismatch
+class PinReceiver : public Receiver {
+ public:
+  explicit PinReceiver(std::string name) : name_{std::move(name)} {}
+
+  auto Receive(const std::string_view& message)
+      -> std::expected<std::string, common::Error> override {
+    auto request{DecodeMessage<PinEmulatorRequest>(message)};
+    if (!request || request->name != name_) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return {"Ok"};
+  }
+
+  [[nodiscard]] auto Name() const -> const std::string& { return name_; }
+
+ private:
+  std::string name_;
+};
+
+struct Board {
+  explicit Board(size_t peripheral_count) {
+    for (size_t i = 0; i < peripheral_count; ++i) {
+      auto& receiver{receivers.emplace_back("Pin " + std::to_string(i))};
+      receiver_map.emplace_back(IsEmulatorMessage, std::ref(receiver));
+      routes.Add(ObjectType::kPin, receiver.Name(), receiver).value();
+    }
+  }
+
+  // The last peripheral is the worst case for the predicate scan
+  [[nodiscard]] auto MessageForLast(WireFormat format) const -> std::string {
+    return EncodeMessage(PinEmulatorRequest{.name = receivers.back().Name(),
+                                            .operation = OperationType::kGet,
+                                            .state = PinState::kLow},
+                         format)
+        .value();
+  }
+
+  std::deque<PinReceiver> receivers;
+  ReceiverMap receiver_map;
+  RouteTable routes;
+};
+
+auto BmDispatchPredicateScan(benchmark::State& state) -> void {
+  const Board board{static_cast<size_t>(state.range(0))};
+  const Dispatcher dispatcher{board.receiver_map};
+  const auto message{
+      board.MessageForLast(static_cast<WireFormat>(state.range(1)))};
+  for (auto _ : state) {
+    auto reply{dispatcher.Dispatch(message)};
+    benchmark::DoNotOptimize(reply);
+  }
+}
+
+auto BmDispatchRouteTable(benchmark::State& state) -> void {
+  const Board board{static_cast<size_t>(state.range(0))};
+  const Dispatcher dispatcher{board.routes};
+  const auto message{
+      board.MessageForLast(static_cast<WireFormat>(state.range(1)))};
+  for (auto _ : state) {
+    auto reply{dispatcher.Dispatch(message)};
+    benchmark::DoNotOptimize(reply);
+  }
+}
+
+// Peripheral count x wire format
+auto DispatchArgs(benchmark::internal::Benchmark* bench) -> void {
+  for (const auto format : {WireFormat::kJson, WireFormat::kBinary}) {
+    for (const int64_t count : {1, 5, 16, 64}) {
+      bench->Args({count, static_cast<int64_t>(format)});
+    }
+  }
+  bench->ArgNames({"peripherals", "format"});
+}
+
+BENCHMARK(BmDispatchPredicateScan)->Apply(DispatchArgs);
+BENCHMARK(BmDispatchRouteTable)->Apply(DispatchArgs);
+
+}  // namespace
+}  // namespace mcu
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "libs/common/event_loop.hpp"
+
+namespace common {
+namespace {
+
+// Reports post-to-run latency percentiles alongside Google Benchmark's mean
+class LatencyRecorder {
+ public:
+  explicit LatencyRecorder(benchmark::State& state) : state_{state} {
+    samples_.reserve(static_cast<size_t>(state.max_iterations));
+  }
+  LatencyRecorder(const LatencyRecorder&) = delete;
+  LatencyRecorder(LatencyRecorder&&) = delete;
+  auto operator=(const LatencyRecorder&) -> LatencyRecorder& = delete;
+  auto operator=(LatencyRecorder&&) -> LatencyRecorder& = delete;
+  ~LatencyRecorder() {
+    if (samples_.empty()) {
+      return;
+    }
+    std::ranges::sort(samples_);
+    state_.counters["p50_us"] = Percentile(0.50);
+    state_.counters["p99_us"] = Percentile(0.99);
+    state_.counters["p999_us"] = Percentile(0.999);
+    state_.SetItemsProcessed(state_.iterations());
+  }
+
+  auto Add(std::chrono::steady_clock::duration sample) -> void {
+    samples_.push_back(sample);
+  }
+
+ private:
+  [[nodiscard]] auto Percentile(double fraction) const -> double {
+    const auto index{static_cast<size_t>(
+        fraction * static_cast<double>(samples_.size() - 1))};
+    return std::chrono::duration<double, std::micro>{samples_[index]}.count();
+  }
+
+  benchmark::State& state_;
+  std::vector<std::chrono::steady_clock::duration> samples_{};
+};
+
+// Cost of queueing and running a task on the loop's own thread
+auto BmPostAndRunReady(benchmark::State& state) -> void {
+  EventLoop loop{};
+  const auto batch{static_cast<size_t>(state.range(0))};
+  size_t ran{0};
+  for (auto _ : state) {
+    for (size_t i = 0; i < batch; ++i) {
+      loop.Post([&ran]() { ++ran; });
+    }
+    benchmark::DoNotOptimize(loop.RunReady());
+  }
+  benchmark::DoNotOptimize(ran);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+
+// What a transport thread handing an event to the application sees: the
+// time from Post() on one thread until the task starts on the loop's
+// thread, which may be asleep waiting for work
+auto BmCrossThreadPostLatency(benchmark::State& state) -> void {
+  EventLoop loop{};
+  std::thread runner{[&loop]() { loop.Run(); }};
+  std::atomic<std::chrono::steady_clock::time_point> started{};
+
+  {
+    LatencyRecorder latency{state};
+    for (auto _ : state) {
+      const auto posted{std::chrono::steady_clock::now()};
+      started.store({}, std::memory_order_relaxed);
+      loop.Post([&started]() {
+        started.store(std::chrono::steady_clock::now(),
+                      std::memory_order_release);
+      });
+      auto ran{started.load(std::memory_order_acquire)};
+      while (ran == std::chrono::steady_clock::time_point{}) {
+        ran = started.load(std::memory_order_acquire);
+      }
+      latency.Add(ran - posted);
+    }
+  }
+
+  loop.Stop();
+  runner.join();
+}
+
+BENCHMARK(BmPostAndRunReady)->RangeMultiplier(8)->Range(1, 512);
+// Tasks run on another thread, so CPU time would undercount
+BENCHMARK(BmCrossThreadPostLatency)->UseRealTime();
+
+}  // namespace
+}  // namespace common
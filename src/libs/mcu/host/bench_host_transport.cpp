@@ -0,0 +1,456 @@
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <zmq.hpp>
+
+#include "dispatcher.hpp"
+#include "emulator_message_codec.hpp"
+#include "host_emulator_messages.hpp"
+#include "libs/common/error.hpp"
+#include "receiver.hpp"
+#include "shm_segment.hpp"
+#include "shm_transport.hpp"
+#include "transport.hpp"
+#include "zmq_transport.hpp"
+
+namespace mcu {
+namespace {
+
+using std::chrono::milliseconds;
+
+constexpr milliseconds kServerPollInterval{50};
+
+// Unique per process so concurrent runs do not share endpoints
+auto UniqueName(std::string_view stem) -> std::string {
+  return std::string{stem} + "_" + std::to_string(getpid());
+}
+
+// Echoes every frame back, standing in for the Python emulator so the
+// numbers measure the transport rather than the interpreter
+class ZmqEchoServer {
+ public:
+  explicit ZmqEchoServer(std::string endpoint)
+      : endpoint_{std::move(endpoint)},
+        thread_{&ZmqEchoServer::Run, this} {}
+  ZmqEchoServer(const ZmqEchoServer&) = delete;
+  ZmqEchoServer(ZmqEchoServer&&) = delete;
+  auto operator=(const ZmqEchoServer&) -> ZmqEchoServer& = delete;
+  auto operator=(ZmqEchoServer&&) -> ZmqEchoServer& = delete;
+  ~ZmqEchoServer() {
+    running_ = false;
+    thread_.join();
+  }
+
+ private:
+  auto Run() -> void {
+    zmq::socket_t socket{context_, zmq::socket_type::pair};
+    socket.bind(endpoint_);
+    std::array<zmq::pollitem_t, 1> items{{{.socket = static_cast<void*>(socket),
+                                           .fd = 0,
+                                           .events = ZMQ_POLLIN,
+                                           .revents = 0}}};
+    while (running_) {
+      if (zmq::poll(items.data(), 1, kServerPollInterval) <= 0) {
+        continue;
+      }
+      zmq::message_t frame{};
+      while (socket.recv(frame, zmq::recv_flags::dontwait)) {
+        const auto flags{frame.more() ? zmq::send_flags::sndmore
+                                      : zmq::send_flags::none};
+        socket.send(frame, flags);
+      }
+    }
+  }
+
+  const std::string endpoint_;
+  zmq::context_t context_{1};
+  std::atomic<bool> running_{true};
+  std::thread thread_;
+};
+
+class ShmEchoServer {
+ public:
+  explicit ShmEchoServer(std::unique_ptr<ShmSegment> segment)
+      : segment_{std::move(segment)}, thread_{&ShmEchoServer::Run, this} {}
+  ShmEchoServer(const ShmEchoServer&) = delete;
+  ShmEchoServer(ShmEchoServer&&) = delete;
+  auto operator=(const ShmEchoServer&) -> ShmEchoServer& = delete;
+  auto operator=(ShmEchoServer&&) -> ShmEchoServer& = delete;
+  ~ShmEchoServer() {
+    running_ = false;
+    thread_.join();
+  }
+
+ private:
+  auto Run() -> void {
+    auto requests{segment_->Ring(ShmRingId::kDeviceRequest)};
+    auto replies{segment_->Ring(ShmRingId::kEmulatorReply)};
+    std::string frame{};
+    bool more{false};
+    while (running_) {
+      const auto deadline{std::chrono::steady_clock::now() +
+                          kServerPollInterval};
+      if (requests.Read(frame, more, deadline)) {
+        std::ignore = replies.Write(frame, more, deadline);
+      }
+    }
+  }
+
+  std::unique_ptr<ShmSegment> segment_;
+  std::atomic<bool> running_{true};
+  std::thread thread_;
+};
+
+// Reports round-trip latency percentiles alongside Google Benchmark's mean
+class LatencyRecorder {
+ public:
+  explicit LatencyRecorder(benchmark::State& state) : state_{state} {
+    samples_.reserve(static_cast<size_t>(state.max_iterations));
+  }
+  LatencyRecorder(const LatencyRecorder&) = delete;
+  LatencyRecorder(LatencyRecorder&&) = delete;
+  auto operator=(const LatencyRecorder&) -> LatencyRecorder& = delete;
+  auto operator=(LatencyRecorder&&) -> LatencyRecorder& = delete;
+  ~LatencyRecorder() {
+    if (samples_.empty()) {
+      return;
+    }
+    std::ranges::sort(samples_);
+    state_.counters["p50_us"] = Percentile(0.50);
+    state_.counters["p99_us"] = Percentile(0.99);
+    state_.counters["p999_us"] = Percentile(0.999);
+    state_.SetItemsProcessed(state_.iterations());
+  }
+
+  auto Add(std::chrono::steady_clock::duration sample) -> void {
+    samples_.push_back(sample);
+  }
+
+ private:
+  [[nodiscard]] auto Percentile(double fraction) const -> double {
+    const auto index{static_cast<size_t>(
+        fraction * static_cast<double>(samples_.size() - 1))};
+    return std::chrono::duration<double, std::micro>{samples_[index]}.count();
+  }
+
+  benchmark::State& state_;
+  std::vector<std::chrono::steady_clock::duration> samples_{};
+};
+
+auto RoundTrips(benchmark::State& state, Transport& transport) -> void {
+  const std::string request(static_cast<size_t>(state.range(0)), 'x');
+  LatencyRecorder latency{state};
+  for (auto _ : state) {
+    const auto start{std::chrono::steady_clock::now()};
+    auto sent{transport.Send(request)};
+    auto reply{transport.Receive()};
+    latency.Add(std::chrono::steady_clock::now() - start);
+    if (!sent || !reply) {
+      state.SkipWithError("round trip failed");
+      break;
+    }
+    benchmark::DoNotOptimize(reply);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+
+auto BmZmqRoundTrip(benchmark::State& state) -> void {
+  const auto to_emulator{"ipc:///tmp/" + UniqueName("bench_to_emulator")};
+  const auto from_emulator{"ipc:///tmp/" + UniqueName("bench_from_emulator")};
+  const ZmqEchoServer server{to_emulator};
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport{ZmqTransport::Create(to_emulator, from_emulator, dispatcher)};
+  if (!transport) {
+    state.SkipWithError("transport setup failed");
+    return;
+  }
+  RoundTrips(state, **transport);
+}
+
+auto BmShmRoundTrip(benchmark::State& state) -> void {
+  const auto name{UniqueName("bench_host_transport")};
+  auto segment{ShmSegment::Create(name, ShmSegment::kDefaultRingCapacity)};
+  if (!segment) {
+    state.SkipWithError("segment setup failed");
+    return;
+  }
+  const ShmEchoServer server{std::move(segment.value())};
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport{ShmTransport::Create(
+      std::string{kShmEndpointScheme} + name, dispatcher)};
+  if (!transport) {
+    state.SkipWithError("transport setup failed");
+    return;
+  }
+  RoundTrips(state, **transport);
+}
+
+// Round trips complete on another thread, so CPU time would undercount
+BENCHMARK(BmZmqRoundTrip)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096)
+    ->UseRealTime();
+BENCHMARK(BmShmRoundTrip)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096)
+    ->UseRealTime();
+
+// A burst of pin writes, as a bit-banged signal makes them: one round trip
+// per write, or the whole burst as one Enqueue()/Flush() batch
+auto PinBurst(benchmark::State& state, Transport& transport) -> void {
+  const auto burst{static_cast<size_t>(state.range(0))};
+  const bool batched{state.range(1) != 0};
+  std::vector<std::string> frames{};
+  for (size_t i = 0; i < burst; ++i) {
+    frames.push_back(
+        EncodeMessage(
+            PinEmulatorRequest{.name = "LED 1",
+                               .operation = OperationType::kSet,
+                               .state = i % 2 == 0 ? PinState::kHigh
+                                                   : PinState::kLow},
+            WireFormat::kBinary)
+            .value());
+  }
+  for (auto _ : state) {
+    bool ok{true};
+    if (batched) {
+      for (const auto& frame : frames) {
+        ok = ok && transport.Enqueue(frame).has_value();
+      }
+      auto replies{transport.Flush()};
+      ok = ok && replies && replies->size() == burst;
+      benchmark::DoNotOptimize(replies);
+    } else {
+      for (const auto& frame : frames) {
+        ok = ok && transport.Send(frame) && transport.Receive();
+      }
+    }
+    if (!ok) {
+      state.SkipWithError("burst failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+
+auto BmZmqPinBurst(benchmark::State& state) -> void {
+  const auto to_emulator{"ipc:///tmp/" + UniqueName("bench_to_emulator")};
+  const auto from_emulator{"ipc:///tmp/" + UniqueName("bench_from_emulator")};
+  const ZmqEchoServer server{to_emulator};
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport{ZmqTransport::Create(to_emulator, from_emulator, dispatcher)};
+  if (!transport) {
+    state.SkipWithError("transport setup failed");
+    return;
+  }
+  PinBurst(state, **transport);
+}
+
+auto BmShmPinBurst(benchmark::State& state) -> void {
+  const auto name{UniqueName("bench_host_transport")};
+  auto segment{ShmSegment::Create(name, ShmSegment::kDefaultRingCapacity)};
+  if (!segment) {
+    state.SkipWithError("segment setup failed");
+    return;
+  }
+  const ShmEchoServer server{std::move(segment.value())};
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport{ShmTransport::Create(
+      std::string{kShmEndpointScheme} + name, dispatcher)};
+  if (!transport) {
+    state.SkipWithError("transport setup failed");
+    return;
+  }
+  PinBurst(state, **transport);
+}
+
+// Burst length x batched
+BENCHMARK(BmZmqPinBurst)
+    ->ArgsProduct({{8, 64}, {0, 1}})
+    ->ArgNames({"burst", "batched"})
+    ->UseRealTime();
+BENCHMARK(BmShmPinBurst)
+    ->ArgsProduct({{8, 64}, {0, 1}})
+    ->ArgNames({"burst", "batched"})
+    ->UseRealTime();
+
+// A representative message of each type; the payload only applies to types
+// that carry data
+template <typename T>
+auto MakeMessage(size_t payload_size) -> T;
+
+template <>
+auto MakeMessage<PinEmulatorRequest>(size_t /*payload_size*/)
+    -> PinEmulatorRequest {
+  return {.name = "LED 1",
+          .operation = OperationType::kSet,
+          .state = PinState::kHigh,
+          .id = 1};
+}
+
+template <>
+auto MakeMessage<PinEmulatorResponse>(size_t /*payload_size*/)
+    -> PinEmulatorResponse {
+  return {.name = "LED 1",
+          .state = PinState::kHigh,
+          .status = common::Error::kOk,
+          .id = 1};
+}
+
+template <>
+auto MakeMessage<UartEmulatorRequest>(size_t payload_size)
+    -> UartEmulatorRequest {
+  return {.name = "UART 1",
+          .operation = OperationType::kSend,
+          .data = std::vector<std::byte>(payload_size, std::byte{0xA5}),
+          .id = 1};
+}
+
+template <>
+auto MakeMessage<UartEmulatorResponse>(size_t payload_size)
+    -> UartEmulatorResponse {
+  return {.name = "UART 1",
+          .data = std::vector<std::byte>(payload_size, std::byte{0xA5}),
+          .bytes_transferred = payload_size,
+          .status = common::Error::kOk,
+          .id = 1};
+}
+
+template <>
+auto MakeMessage<I2CEmulatorRequest>(size_t payload_size)
+    -> I2CEmulatorRequest {
+  return {.name = "I2C 1",
+          .operation = OperationType::kSend,
+          .address = 0x50,
+          .data = std::vector<std::byte>(payload_size, std::byte{0xA5}),
+          .id = 1};
+}
+
+template <>
+auto MakeMessage<I2CEmulatorResponse>(size_t payload_size)
+    -> I2CEmulatorResponse {
+  return {.name = "I2C 1",
+          .address = 0x50,
+          .data = std::vector<std::byte>(payload_size, std::byte{0xA5}),
+          .bytes_transferred = payload_size,
+          .status = common::Error::kOk,
+          .id = 1};
+}
+
+template <typename T>
+auto BmEncode(benchmark::State& state) -> void {
+  const auto message{MakeMessage<T>(static_cast<size_t>(state.range(0)))};
+  const auto format{static_cast<WireFormat>(state.range(1))};
+  for (auto _ : state) {
+    auto frame{EncodeMessage(message, format)};
+    benchmark::DoNotOptimize(frame);
+  }
+}
+
+template <typename T>
+auto BmDecode(benchmark::State& state) -> void {
+  const auto frame{
+      EncodeMessage(MakeMessage<T>(static_cast<size_t>(state.range(0))),
+                    static_cast<WireFormat>(state.range(1)))
+          .value()};
+  for (auto _ : state) {
+    auto message{DecodeMessage<T>(frame)};
+    benchmark::DoNotOptimize(message);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+}
+
+// Payload size x wire format
+auto CodecArgs(benchmark::internal::Benchmark* bench) -> void {
+  for (const auto format : {WireFormat::kJson, WireFormat::kBinary}) {
+    for (const int64_t size : {0, 16, 256, 4096}) {
+      bench->Args({size, static_cast<int64_t>(format)});
+    }
+  }
+  bench->ArgNames({"payload", "format"});
+}
+
+// Pin messages carry no payload
+auto PinCodecArgs(benchmark::internal::Benchmark* bench) -> void {
+  for (const auto format : {WireFormat::kJson, WireFormat::kBinary}) {
+    bench->Args({0, static_cast<int64_t>(format)});
+  }
+  bench->ArgNames({"payload", "format"});
+}
+
+BENCHMARK_TEMPLATE(BmEncode, PinEmulatorRequest)->Apply(PinCodecArgs);
+BENCHMARK_TEMPLATE(BmDecode, PinEmulatorRequest)->Apply(PinCodecArgs);
+BENCHMARK_TEMPLATE(BmEncode, PinEmulatorResponse)->Apply(PinCodecArgs);
+BENCHMARK_TEMPLATE(BmDecode, PinEmulatorResponse)->Apply(PinCodecArgs);
+BENCHMARK_TEMPLATE(BmEncode, UartEmulatorRequest)->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmDecode, UartEmulatorRequest)->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmEncode, UartEmulatorResponse)->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmDecode, UartEmulatorResponse)->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmEncode, I2CEmulatorRequest)->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmDecode, I2CEmulatorRequest)->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmEncode, I2CEmulatorResponse)->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmDecode, I2CEmulatorResponse)->Apply(CodecArgs);
+
+// Does what a peripheral does with an emulator request: decode it and
+// encode the response in the same format
+template <typename Request, typename Response>
+class PeripheralReceiver : public Receiver {
+ public:
+  auto Receive(const std::string_view& message)
+      -> std::expected<std::string, common::Error> override {
+    auto request{DecodeMessage<Request>(message)};
+    if (!request) {
+      return std::unexpected(request.error());
+    }
+    auto response{MakeMessage<Response>(request->data.size())};
+    response.id = request->id;
+    return EncodeMessage(response, FormatOf(message));
+  }
+};
+
+// Dispatch cost for one emulator request, including the receiver's work.
+// bench_dispatcher covers how routing scales with the peripheral count.
+template <typename Request, typename Response>
+auto BmDispatch(benchmark::State& state) -> void {
+  PeripheralReceiver<Request, Response> receiver{};
+  const auto request{MakeMessage<Request>(static_cast<size_t>(state.range(0)))};
+  RouteTable routes{};
+  routes.Add(request.object, request.name, receiver).value();
+  const Dispatcher dispatcher{routes};
+  const auto frame{
+      EncodeMessage(request, static_cast<WireFormat>(state.range(1)))
+          .value()};
+  for (auto _ : state) {
+    auto reply{dispatcher.Dispatch(frame)};
+    benchmark::DoNotOptimize(reply);
+  }
+}
+
+BENCHMARK_TEMPLATE(BmDispatch, UartEmulatorRequest, UartEmulatorResponse)
+    ->Apply(CodecArgs);
+BENCHMARK_TEMPLATE(BmDispatch, I2CEmulatorRequest, I2CEmulatorResponse)
+    ->Apply(CodecArgs);
+
+}  // namespace
+}  // namespace mcu
@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "emulator_message_binary_encoder.hpp"
+#include "emulator_message_json_encoder.hpp"
+#include "emulator_message_stream_decoder.hpp"
+#include "host_emulator_messages.hpp"
+
+namespace mcu {
+namespace {
+
+auto MakeUartResponse(size_t payload_size) -> UartEmulatorResponse {
+  return UartEmulatorResponse{
+      .name = "UART 1",
+      .data = std::vector<std::byte>(payload_size, std::byte{0xA5}),
+      .bytes_transferred = payload_size,
+      .status = common::Error::kOk};
+}
+
+// Baseline: nlohmann DOM parse followed by get<T>()
+auto BmDecodeJsonDom(benchmark::State& state) -> void {
+  const auto frame{
+      Encode(MakeUartResponse(static_cast<size_t>(state.range(0))))};
+  for (auto _ : state) {
+    auto response{Decode<UartEmulatorResponse>(frame)};
+    benchmark::DoNotOptimize(response);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+}
+
+auto BmDecodeJsonStreaming(benchmark::State& state) -> void {
+  const auto payload_size{static_cast<size_t>(state.range(0))};
+  const auto frame{Encode(MakeUartResponse(payload_size))};
+  std::vector<std::byte> payload(payload_size);
+  for (auto _ : state) {
+    MessageView view{.data = payload};
+    auto result{DecodeInto(frame, view)};
+    benchmark::DoNotOptimize(result);
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+}
+
+auto BmDecodeBinary(benchmark::State& state) -> void {
+  const auto frame{
+      EncodeBinary(MakeUartResponse(static_cast<size_t>(state.range(0))))
+          .value()};
+  for (auto _ : state) {
+    auto response{DecodeBinary<UartEmulatorResponse>(frame)};
+    benchmark::DoNotOptimize(response);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+}
+
+auto BmDecodeBinaryStreaming(benchmark::State& state) -> void {
+  const auto payload_size{static_cast<size_t>(state.range(0))};
+  const auto frame{EncodeBinary(MakeUartResponse(payload_size)).value()};
+  std::vector<std::byte> payload(payload_size);
+  for (auto _ : state) {
+    MessageView view{.data = payload};
+    auto result{DecodeInto(frame, view)};
+    benchmark::DoNotOptimize(result);
+    benchmark::DoNotOptimize(view);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+}
+
+BENCHMARK(BmDecodeJsonDom)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BmDecodeJsonStreaming)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BmDecodeBinary)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BmDecodeBinaryStreaming)->RangeMultiplier(4)->Range(16, 4096);
+
+}  // namespace
+}  // namespace mcu
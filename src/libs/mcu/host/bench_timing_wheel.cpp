@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "libs/common/timing_wheel.hpp"
+
+namespace common {
+namespace {
+
+constexpr size_t kCapacity{4096};
+
+// Timeouts as firmware uses them: mostly short retries and debounces,
+// some watchdog-length ones
+auto Delays(size_t count) -> std::vector<uint64_t> {
+  std::mt19937 random{7};
+  std::uniform_int_distribution<uint64_t> delay{1, 5000};
+  std::vector<uint64_t> delays(count);
+  for (auto& ticks : delays) {
+    ticks = delay(random) >> (random() % 8);
+    ticks = ticks == 0 ? 1 : ticks;
+  }
+  return delays;
+}
+
+// The usual alternative: a binary heap on expiry, holding std::functions
+// as the event loop does. Cancel cannot reach into the heap, so it takes
+// the timer off the set of live ones and the heap drops it when it
+// surfaces. The set only holds pending timers, so it stays as small as
+// the heap does however long the benchmark runs.
+class HeapTimers {
+ public:
+  auto Start(uint64_t ticks, std::function<void()> callback) -> uint64_t {
+    const uint64_t sequence{next_sequence_++};
+    live_.insert(sequence);
+    heap_.push(Entry{.expiry = now_ + ticks,
+                     .sequence = sequence,
+                     .callback = std::move(callback)});
+    return sequence;
+  }
+  auto Cancel(uint64_t sequence) -> void { live_.erase(sequence); }
+  auto Advance() -> size_t {
+    ++now_;
+    size_t fired{0};
+    while (!heap_.empty() && heap_.top().expiry <= now_) {
+      if (live_.erase(heap_.top().sequence) == 1) {
+        heap_.top().callback();
+        ++fired;
+      }
+      heap_.pop();
+    }
+    return fired;
+  }
+
+ private:
+  struct Entry {
+    uint64_t expiry{0};
+    uint64_t sequence{0};
+    std::function<void()> callback{};
+  };
+  struct Later {
+    auto operator()(const Entry& lhs, const Entry& rhs) const -> bool {
+      if (lhs.expiry != rhs.expiry) {
+        return lhs.expiry > rhs.expiry;
+      }
+      return lhs.sequence > rhs.sequence;
+    }
+  };
+
+  std::priority_queue<Entry, std::vector<Entry>, Later> heap_{};
+  // Sequence numbers of the timers neither fired nor cancelled
+  std::unordered_set<uint64_t> live_{};
+  uint64_t next_sequence_{0};
+  uint64_t now_{0};
+};
+
+// Steady state with range(0) timers pending: each iteration starts one,
+// cancels one (a retry that got its answer) and ticks once
+auto BmWheelChurn(benchmark::State& state) -> void {
+  TimingWheel<kCapacity> wheel{};
+  const auto pending{static_cast<size_t>(state.range(0))};
+  const auto delays{Delays(1 << 16)};
+  size_t fired{0};
+  std::vector<TimerId> ids{};
+  for (size_t i = 0; i < pending; ++i) {
+    ids.push_back(*wheel.Start(delays[i], [&fired]() { ++fired; }));
+  }
+  size_t next{0};
+  for (auto _ : state) {
+    const uint64_t ticks{delays[next++ % delays.size()]};
+    auto id{wheel.Start(ticks, [&fired]() { ++fired; })};
+    if (id) {
+      std::ignore = wheel.Cancel(ids[next % pending]);
+      ids[next % pending] = *id;
+    }
+    benchmark::DoNotOptimize(wheel.Advance());
+  }
+  benchmark::DoNotOptimize(fired);
+  state.SetItemsProcessed(state.iterations());
+}
+
+auto BmHeapChurn(benchmark::State& state) -> void {
+  HeapTimers heap{};
+  const auto pending{static_cast<size_t>(state.range(0))};
+  const auto delays{Delays(1 << 16)};
+  size_t fired{0};
+  std::vector<uint64_t> ids{};
+  for (size_t i = 0; i < pending; ++i) {
+    ids.push_back(heap.Start(delays[i], [&fired]() { ++fired; }));
+  }
+  size_t next{0};
+  for (auto _ : state) {
+    const uint64_t ticks{delays[next++ % delays.size()]};
+    heap.Cancel(ids[next % pending]);
+    ids[next % pending] = heap.Start(ticks, [&fired]() { ++fired; });
+    benchmark::DoNotOptimize(heap.Advance());
+  }
+  benchmark::DoNotOptimize(fired);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BmWheelChurn)->RangeMultiplier(8)->Range(8, 2048);
+BENCHMARK(BmHeapChurn)->RangeMultiplier(8)->Range(8, 2048);
+
+}  // namespace
+}  // namespace common
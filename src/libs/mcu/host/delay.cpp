@@ -1,10 +1,26 @@
 #include "libs/mcu/delay.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <thread>
 
+#include "libs/common/time_source.hpp"
+#include "libs/mcu/host/host_delay.hpp"
+
 namespace mcu {
+namespace {
+std::atomic<common::TimeSource*> delay_time_source{nullptr};
+}  // namespace
+
+auto SetDelayTimeSource(common::TimeSource* source) -> void {
+  delay_time_source.store(source, std::memory_order_release);
+}
+
 auto Delay(std::chrono::microseconds usecs) -> void {
+  if (auto* source{delay_time_source.load(std::memory_order_acquire)}) {
+    source->AdvanceTo(source->Now() + usecs);
+    return;
+  }
   std::this_thread::sleep_for(usecs);
 }
 }  // namespace mcu
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <expected>
 #include <functional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "libs/common/error.hpp"
+#include "libs/mcu/host/emulator_message_stream_decoder.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
 #include "receiver.hpp"
 
 namespace mcu {
@@ -15,9 +22,64 @@ using ReceiverMap =
     std::vector<std::pair<std::function<bool(const std::string_view& message)>,
                           std::reference_wrapper<Receiver>>>;
 
+// Maps (object, name) to the receiver that owns that peripheral
+class RouteTable {
+ public:
+  auto Add(ObjectType object, std::string_view name, Receiver& receiver)
+      -> std::expected<void, common::Error> {
+    const auto index{Index(object)};
+    if (index >= routes_.size()) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    // PeekHeader() cannot produce a longer name, so the route would never match
+    if (name.size() > kMaxMessageNameLength) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    routes_[index].insert_or_assign(std::string{name}, &receiver);
+    return {};
+  }
+
+  [[nodiscard]] auto Find(ObjectType object, std::string_view name) const
+      -> Receiver* {
+    const auto index{Index(object)};
+    if (index >= routes_.size()) {
+      return nullptr;
+    }
+    const auto& routes{routes_[index]};
+    const auto route{routes.find(name)};
+    return route != routes.end() ? route->second : nullptr;
+  }
+
+ private:
+  // Lets find() take a string_view without building a std::string
+  struct NameHash {
+    using is_transparent = void;
+    auto operator()(std::string_view name) const -> size_t {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+  using Routes =
+      std::unordered_map<std::string, Receiver*, NameHash, std::equal_to<>>;
+
+  static constexpr auto Index(ObjectType object) -> size_t {
+    return static_cast<size_t>(object);
+  }
+
+  // Indexed by ObjectType; slot 0 is unused since the enum starts at 1
+  std::array<Routes, static_cast<size_t>(ObjectType::kClock) + 1> routes_{};
+};
+
+// Routes messages to receivers.
+//
+// Messages with a route are delivered after peeking only their header, so
+// the cost does not grow with the number of peripherals. Anything without a
+// route falls back to asking each predicate in the ReceiverMap in turn.
 class Dispatcher {
  public:
-  explicit Dispatcher(const ReceiverMap& receivers) : receivers_{receivers} {}
+  explicit Dispatcher(const ReceiverMap& receivers) : receivers_{&receivers} {}
+  explicit Dispatcher(const RouteTable& routes) : routes_{&routes} {}
+  Dispatcher(const RouteTable& routes, const ReceiverMap& receivers)
+      : routes_{&routes}, receivers_{&receivers} {}
 
   ~Dispatcher() = default;
   Dispatcher(const Dispatcher&) = delete;
@@ -27,9 +89,34 @@ class Dispatcher {
 
   auto Dispatch(const std::string_view& message) const
       -> std::expected<std::string, common::Error> {
-    for (const auto& [predicate, receiver_ref] : receivers_) {
+    return DispatchWith(message, [&message](Receiver& receiver) {
+      return receiver.Receive(message);
+    });
+  }
+
+  // Like Dispatch(), but the reply is written into a buffer the caller
+  // reuses across messages, so dispatch itself does not allocate
+  auto DispatchInto(const std::string_view& message, std::string& reply) const
+      -> std::expected<void, common::Error> {
+    return DispatchWith(message, [&message, &reply](Receiver& receiver) {
+      reply.clear();
+      return receiver.ReceiveInto(message, reply);
+    });
+  }
+
+ private:
+  template <typename Deliver>
+  auto DispatchWith(const std::string_view& message, Deliver deliver) const
+      -> std::invoke_result_t<Deliver, Receiver&> {
+    if (auto* receiver{Route(message)}) {
+      return deliver(*receiver);
+    }
+    if (receivers_ == nullptr) {
+      return std::unexpected(common::Error::kUnhandled);
+    }
+    for (const auto& [predicate, receiver_ref] : *receivers_) {
       if (predicate(message)) {
-        auto reply = receiver_ref.get().Receive(message);
+        auto reply = deliver(receiver_ref.get());
         if (reply.has_value()) {
           return reply;
         }
@@ -38,8 +125,19 @@ class Dispatcher {
     return std::unexpected(common::Error::kUnhandled);
   }
 
- private:
-  const ReceiverMap& receivers_;
+  auto Route(const std::string_view& message) const -> Receiver* {
+    if (routes_ == nullptr) {
+      return nullptr;
+    }
+    MessageHeader header{};
+    if (!PeekHeader(message, header)) {
+      return nullptr;
+    }
+    return routes_->Find(header.object, header.name.View());
+  }
+
+  const RouteTable* routes_{nullptr};
+  const ReceiverMap* receivers_{nullptr};
 };
 
 }  // namespace mcu
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/pin.hpp"
+
+namespace mcu {
+
+// Compact binary wire format for emulator messages.
+//
+// A frame is a fixed little-endian header followed by the name and the raw
+// payload bytes. Fields a message type does not carry are encoded as 0.
+//
+//   offset  size  field
+//   0       1     magic (kBinaryFrameMagic)
+//   1       1     type
+//   2       1     object
+//   3       1     operation
+//   4       1     status
+//   5       1     state
+//   6       2     name size
+//   8       2     address
+//   10      2     reserved
+//   12      4     size (mask for ports)
+//   16      4     timeout_ms (value for ports, advance_us for the clock)
+//   20      4     bytes_transferred
+//   24      4     data size
+//   28      4     id
+//   32      n     name
+//   32 + n  m     data
+//
+// The magic byte can never start a JSON document, so both formats can share
+// a socket and be told apart by their first byte.
+inline constexpr uint8_t kBinaryFrameMagic{0xEB};
+inline constexpr size_t kBinaryFrameHeaderSize{32};
+// Largest name the 16-bit name size field can describe
+inline constexpr size_t kMaxBinaryNameSize{0xFFFF};
+
+inline auto IsBinaryFrame(std::string_view frame) -> bool {
+  return !frame.empty() &&
+         static_cast<uint8_t>(frame.front()) == kBinaryFrameMagic;
+}
+
+namespace detail {
+
+inline auto PutU16(char* out, uint16_t value) -> void {
+  out[0] = static_cast<char>(value & 0xFFU);
+  out[1] = static_cast<char>((value >> 8U) & 0xFFU);
+}
+
+inline auto PutU32(char* out, uint32_t value) -> void {
+  PutU16(out, static_cast<uint16_t>(value & 0xFFFFU));
+  PutU16(out + 2, static_cast<uint16_t>(value >> 16U));
+}
+
+inline auto GetU8(const char* in) -> uint8_t {
+  return static_cast<uint8_t>(*in);
+}
+
+inline auto GetU16(const char* in) -> uint16_t {
+  return static_cast<uint16_t>(GetU8(in) | (GetU8(in + 1) << 8U));
+}
+
+inline auto GetU32(const char* in) -> uint32_t {
+  return static_cast<uint32_t>(GetU16(in)) |
+         (static_cast<uint32_t>(GetU16(in + 2)) << 16U);
+}
+
+}  // namespace detail
+
+/// @brief Encode a message into a binary frame, reusing the storage of out
+/// @return kMessageTooLarge if the name or payload overflows its size field
+template <typename T>
+inline auto EncodeBinary(const T& obj, std::string& out)
+    -> std::expected<void, common::Error> {
+  size_t data_size{0};
+  if constexpr (requires { obj.data; }) {
+    data_size = obj.data.size();
+  }
+  if (obj.name.size() > kMaxBinaryNameSize ||
+      data_size > std::numeric_limits<uint32_t>::max()) {
+    return std::unexpected(common::Error::kMessageTooLarge);
+  }
+
+  std::array<char, kBinaryFrameHeaderSize> header{};
+  header[0] = static_cast<char>(kBinaryFrameMagic);
+  header[1] = static_cast<char>(obj.type);
+  header[2] = static_cast<char>(obj.object);
+  if constexpr (requires { obj.operation; }) {
+    header[3] = static_cast<char>(obj.operation);
+  }
+  if constexpr (requires { obj.status; }) {
+    header[4] = static_cast<char>(obj.status);
+  }
+  if constexpr (requires { obj.state; }) {
+    header[5] = static_cast<char>(obj.state);
+  }
+  detail::PutU16(&header[6], static_cast<uint16_t>(obj.name.size()));
+  if constexpr (requires { obj.address; }) {
+    detail::PutU16(&header[8], obj.address);
+  }
+  if constexpr (requires { obj.size; }) {
+    detail::PutU32(&header[12], static_cast<uint32_t>(obj.size));
+  }
+  if constexpr (requires { obj.timeout_ms; }) {
+    detail::PutU32(&header[16], obj.timeout_ms);
+  }
+  if constexpr (requires { obj.mask; }) {
+    detail::PutU32(&header[12], obj.mask);
+  }
+  if constexpr (requires { obj.value; }) {
+    detail::PutU32(&header[16], obj.value);
+  }
+  if constexpr (requires { obj.advance_us; }) {
+    detail::PutU32(&header[16], obj.advance_us);
+  }
+  if constexpr (requires { obj.bytes_transferred; }) {
+    detail::PutU32(&header[20], static_cast<uint32_t>(obj.bytes_transferred));
+  }
+  detail::PutU32(&header[24], static_cast<uint32_t>(data_size));
+  detail::PutU32(&header[28], obj.id);
+
+  out.clear();
+  out.reserve(kBinaryFrameHeaderSize + obj.name.size() + data_size);
+  out.append(header.data(), header.size());
+  out.append(obj.name);
+  if constexpr (requires { obj.data; }) {
+    out.append(reinterpret_cast<const char*>(obj.data.data()), data_size);
+  }
+  return {};
+}
+
+template <typename T>
+inline auto EncodeBinary(const T& obj)
+    -> std::expected<std::string, common::Error> {
+  std::string out{};
+  return EncodeBinary(obj, out).transform([&out]() { return std::move(out); });
+}
+
+template <typename T>
+inline auto DecodeBinary(std::string_view frame)
+    -> std::expected<T, common::Error> {
+  if (frame.size() < kBinaryFrameHeaderSize || !IsBinaryFrame(frame)) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  const char* header{frame.data()};
+  const size_t name_size{detail::GetU16(&header[6])};
+  const size_t data_size{detail::GetU32(&header[24])};
+  if (frame.size() != kBinaryFrameHeaderSize + name_size + data_size) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+
+  // Reject frames meant for a different message struct, mirroring the JSON
+  // decoder which fails when required fields are missing.
+  T obj{};
+  if (static_cast<MessageType>(detail::GetU8(&header[1])) != obj.type ||
+      static_cast<ObjectType>(detail::GetU8(&header[2])) != obj.object) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+
+  if constexpr (requires { obj.operation; }) {
+    obj.operation = static_cast<OperationType>(detail::GetU8(&header[3]));
+  }
+  if constexpr (requires { obj.status; }) {
+    obj.status = static_cast<common::Error>(detail::GetU8(&header[4]));
+  }
+  if constexpr (requires { obj.state; }) {
+    obj.state = static_cast<PinState>(detail::GetU8(&header[5]));
+  }
+  if constexpr (requires { obj.address; }) {
+    obj.address = detail::GetU16(&header[8]);
+  }
+  if constexpr (requires { obj.size; }) {
+    obj.size = detail::GetU32(&header[12]);
+  }
+  if constexpr (requires { obj.timeout_ms; }) {
+    obj.timeout_ms = detail::GetU32(&header[16]);
+  }
+  if constexpr (requires { obj.mask; }) {
+    obj.mask = detail::GetU32(&header[12]);
+  }
+  if constexpr (requires { obj.value; }) {
+    obj.value = detail::GetU32(&header[16]);
+  }
+  if constexpr (requires { obj.advance_us; }) {
+    obj.advance_us = detail::GetU32(&header[16]);
+  }
+  if constexpr (requires { obj.bytes_transferred; }) {
+    obj.bytes_transferred = detail::GetU32(&header[20]);
+  }
+  obj.id = detail::GetU32(&header[28]);
+
+  const auto body{frame.substr(kBinaryFrameHeaderSize)};
+  obj.name.assign(body.substr(0, name_size));
+  if constexpr (requires { obj.data; }) {
+    const auto payload{body.substr(name_size)};
+    const auto* first{reinterpret_cast<const std::byte*>(payload.data())};
+    obj.data.assign(first, first + payload.size());
+  } else if (data_size != 0) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  return obj;
+}
+
+}  // namespace mcu
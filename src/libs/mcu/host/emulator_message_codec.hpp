@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/emulator_message_binary_encoder.hpp"
+#include "libs/mcu/host/emulator_message_json_encoder.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+
+namespace mcu {
+
+template <typename T>
+inline auto EncodeMessage(const T& obj, WireFormat format)
+    -> std::expected<std::string, common::Error> {
+  if (format == WireFormat::kBinary) {
+    return EncodeBinary(obj);
+  }
+  return Encode(obj);
+}
+
+// Encodes into out. The binary format reuses out's storage and does not
+// allocate once it is large enough; JSON builds a document tree first and
+// allocates on every call.
+template <typename T>
+inline auto EncodeMessage(const T& obj, WireFormat format, std::string& out)
+    -> std::expected<void, common::Error> {
+  if (format == WireFormat::kBinary) {
+    return EncodeBinary(obj, out);
+  }
+  out = Encode(obj);
+  return {};
+}
+
+// Decoding detects the format from the frame itself, so a device configured
+// for one format still understands an emulator replying in the other.
+template <typename T>
+inline auto DecodeMessage(std::string_view frame)
+    -> std::expected<T, common::Error> {
+  if (IsBinaryFrame(frame)) {
+    return DecodeBinary<T>(frame);
+  }
+  return Decode<T>(frame);
+}
+
+// Replies to emulator-initiated requests use the format of the request
+inline auto FormatOf(std::string_view frame) -> WireFormat {
+  return IsBinaryFrame(frame) ? WireFormat::kBinary : WireFormat::kJson;
+}
+
+// Upper bound on the encoded size of a message whose name and payload have
+// the given sizes, in either wire format. JSON is the larger: it may escape
+// a name character as \u00XX and spends up to four characters per payload
+// byte.
+constexpr auto MaxFrameSize(size_t name_size, size_t payload_size) -> size_t {
+  constexpr size_t kFieldsSize{256};
+  return kFieldsSize + (6 * name_size) + (4 * payload_size);
+}
+
+// Dispatcher predicate accepting either wire format
+constexpr auto IsEmulatorMessage(const std::string_view& message) -> bool {
+  return (!message.empty() &&
+          static_cast<uint8_t>(message.front()) == kBinaryFrameMagic) ||
+         (message.starts_with("{") && message.ends_with("}"));
+}
+
+}  // namespace mcu
@@ -65,12 +65,17 @@ NLOHMANN_JSON_SERIALIZE_ENUM(OperationType,
                                  {OperationType::kGet, "Get"},
                                  {OperationType::kSend, "Send"},
                                  {OperationType::kReceive, "Receive"},
+                                 {OperationType::kTransfer, "Transfer"},
+                                 {OperationType::kTransaction, "Transaction"},
+                                 {OperationType::kAdvance, "Advance"},
                              })
 
 NLOHMANN_JSON_SERIALIZE_ENUM(ObjectType, {
                                              {ObjectType::kPin, "Pin"},
                                              {ObjectType::kUart, "Uart"},
                                              {ObjectType::kI2C, "I2C"},
+                                             {ObjectType::kPort, "Port"},
+                                             {ObjectType::kClock, "Clock"},
                                          })
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PinEmulatorRequest, type, object, name,
@@ -91,16 +96,37 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(I2CEmulatorRequest, type, object, name,
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(I2CEmulatorResponse, type, object, name,
                                    address, data, bytes_transferred, status)
 
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PortEmulatorRequest, type, object, name,
+                                   operation, mask, value)
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PortEmulatorResponse, type, object, name,
+                                   value, status)
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ClockEmulatorRequest, type, object, name,
+                                   operation, advance_us)
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ClockEmulatorResponse, type, object, name,
+                                   status)
+
+// The correlation id is optional on the wire: it is only written when set,
+// and a message without one decodes with id 0.
 template <typename T>
 inline auto Encode(const T& obj) -> std::string {
-  return nlohmann::json(obj).dump();
+  nlohmann::json json(obj);
+  if (obj.id != 0) {
+    json["id"] = obj.id;
+  }
+  return json.dump();
 };
 
 template <typename T>
 inline auto Decode(const std::string_view& str)
     -> std::expected<T, common::Error> {
   try {
-    return nlohmann::json::parse(str).template get<T>();
+    const auto json = nlohmann::json::parse(str);
+    auto obj{json.template get<T>()};
+    obj.id = json.value("id", uint32_t{0});
+    return obj;
   } catch (const nlohmann::json::exception&) {
     return std::unexpected(common::Error::kInvalidArgument);
   }
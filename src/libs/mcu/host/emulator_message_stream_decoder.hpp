@@ -0,0 +1,587 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/emulator_message_binary_encoder.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/pin.hpp"
+
+namespace mcu {
+
+inline constexpr size_t kMaxMessageNameLength{32};
+
+// Fixed-capacity storage for a peripheral name
+struct MessageName {
+  std::array<char, kMaxMessageNameLength> chars{};
+  size_t size{0};
+
+  [[nodiscard]] auto View() const -> std::string_view {
+    return {chars.data(), size};
+  }
+};
+
+// Decoded form of any of the *EmulatorRequest/Response structs.
+//
+// Unlike Decode<T>(), nothing is allocated: the name is copied into a fixed
+// buffer and payload bytes are written straight into the caller-provided
+// data span. Fields the message does not carry are left untouched.
+struct MessageView {
+  MessageType type{};
+  ObjectType object{};
+  MessageName name{};
+  OperationType operation{};
+  PinState state{};
+  common::Error status{};
+  uint16_t address{0};
+  size_t size{0};
+  uint32_t timeout_ms{0};
+  size_t bytes_transferred{0};
+  uint32_t mask{0};   // Pins a port request applies to
+  uint32_t value{0};  // Port levels
+  uint32_t advance_us{0};
+  std::span<std::byte> data{};  // Caller-provided payload storage
+  size_t data_size{0};          // Number of payload bytes written to data
+  uint32_t id{0};
+
+  [[nodiscard]] auto Payload() const -> std::span<std::byte> {
+    return data.first(data_size);
+  }
+};
+
+// Routing fields common to every emulator message
+struct MessageHeader {
+  MessageType type{};
+  ObjectType object{};
+  MessageName name{};
+  uint32_t id{0};  // 0 when the message carries no correlation id
+};
+
+namespace detail {
+
+inline constexpr std::array<std::pair<std::string_view, MessageType>, 2>
+    kMessageTypeNames{{
+        {"Request", MessageType::kRequest},
+        {"Response", MessageType::kResponse},
+    }};
+
+inline constexpr std::array<std::pair<std::string_view, ObjectType>, 5>
+    kObjectTypeNames{{
+        {"Pin", ObjectType::kPin},
+        {"Uart", ObjectType::kUart},
+        {"I2C", ObjectType::kI2C},
+        {"Port", ObjectType::kPort},
+        {"Clock", ObjectType::kClock},
+    }};
+
+inline constexpr std::array<std::pair<std::string_view, OperationType>, 7>
+    kOperationTypeNames{{
+        {"Set", OperationType::kSet},
+        {"Get", OperationType::kGet},
+        {"Send", OperationType::kSend},
+        {"Receive", OperationType::kReceive},
+        {"Transfer", OperationType::kTransfer},
+        {"Transaction", OperationType::kTransaction},
+        {"Advance", OperationType::kAdvance},
+    }};
+
+inline constexpr std::array<std::pair<std::string_view, PinState>, 3>
+    kPinStateNames{{
+        {"Low", PinState::kLow},
+        {"High", PinState::kHigh},
+        {"Hi_Z", PinState::kHighZ},
+    }};
+
+inline constexpr std::array<std::pair<std::string_view, common::Error>, 12>
+    kErrorNames{{
+        {"Ok", common::Error::kOk},
+        {"Unknown", common::Error::kUnknown},
+        {"InvalidArgument", common::Error::kInvalidArgument},
+        {"InvalidState", common::Error::kInvalidState},
+        {"InvalidOperation", common::Error::kInvalidOperation},
+        {"OperationFailed", common::Error::kOperationFailed},
+        {"Unhandled", common::Error::kUnhandled},
+        {"ConnectionRefused", common::Error::kConnectionRefused},
+        {"ConnectionClosed", common::Error::kConnectionClosed},
+        {"Timeout", common::Error::kTimeout},
+        {"WouldBlock", common::Error::kWouldBlock},
+        {"MessageTooLarge", common::Error::kMessageTooLarge},
+    }};
+
+template <typename E, size_t N>
+inline auto LookupName(
+    const std::array<std::pair<std::string_view, E>, N>& names,
+    std::string_view name) -> std::expected<E, common::Error> {
+  for (const auto& [candidate, value] : names) {
+    if (candidate == name) {
+      return value;
+    }
+  }
+  return std::unexpected(common::Error::kInvalidArgument);
+}
+
+// Minimal pull parser for the flat JSON objects produced by the encoders.
+// Strings are unescaped into caller storage; unknown values are skipped.
+class JsonCursor {
+ public:
+  explicit JsonCursor(std::string_view text) : text_{text} {}
+
+  auto SkipWhitespace() -> void {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+            text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  auto Peek() -> char {
+    SkipWhitespace();
+    return pos_ < text_.size() ? text_[pos_] : '\0';
+  }
+
+  auto Consume(char expected) -> bool {
+    if (Peek() != expected) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  [[nodiscard]] auto AtEnd() -> bool { return Peek() == '\0'; }
+
+  // Reads a string into out, returning the number of characters written
+  auto ReadString(std::span<char> out)
+      -> std::expected<size_t, common::Error> {
+    if (!Consume('"')) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    size_t written{0};
+    while (pos_ < text_.size()) {
+      char chr{text_[pos_++]};
+      if (chr == '"') {
+        return written;
+      }
+      if (chr == '\\') {
+        auto escaped{ReadEscape()};
+        if (!escaped) {
+          return std::unexpected(escaped.error());
+        }
+        chr = *escaped;
+      }
+      if (written == out.size()) {
+        return std::unexpected(common::Error::kMessageTooLarge);
+      }
+      out[written++] = chr;
+    }
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+
+  auto ReadUnsigned() -> std::expected<uint64_t, common::Error> {
+    SkipWhitespace();
+    const size_t start{pos_};
+    uint64_t value{0};
+    while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+      const auto digit{static_cast<uint64_t>(text_[pos_] - '0')};
+      if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+        return std::unexpected(common::Error::kInvalidArgument);
+      }
+      value = (value * 10) + digit;
+      ++pos_;
+    }
+    if (pos_ == start) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return value;
+  }
+
+  // Reads an array of byte values into out, returning the count written
+  auto ReadByteArray(std::span<std::byte> out)
+      -> std::expected<size_t, common::Error> {
+    if (!Consume('[')) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    size_t written{0};
+    if (Consume(']')) {
+      return written;
+    }
+    do {
+      auto value{ReadUnsigned()};
+      if (!value || *value > 0xFF) {
+        return std::unexpected(common::Error::kInvalidArgument);
+      }
+      if (written == out.size()) {
+        return std::unexpected(common::Error::kMessageTooLarge);
+      }
+      out[written++] = static_cast<std::byte>(*value);
+    } while (Consume(','));
+    if (!Consume(']')) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return written;
+  }
+
+  // Skips any JSON value without interpreting it
+  auto SkipValue() -> std::expected<void, common::Error> {
+    const char first{Peek()};
+    if (first == '"') {
+      ++pos_;
+      return SkipStringBody();
+    }
+    if (first == '{' || first == '[') {
+      return SkipContainer();
+    }
+    // Number, true, false or null
+    const size_t start{pos_};
+    while (pos_ < text_.size() && text_[pos_] != ',' && text_[pos_] != '}' &&
+           text_[pos_] != ']') {
+      ++pos_;
+    }
+    if (pos_ == start) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return {};
+  }
+
+ private:
+  auto ReadEscape() -> std::expected<char, common::Error> {
+    if (pos_ >= text_.size()) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    switch (text_[pos_++]) {
+      case '"':
+        return '"';
+      case '\\':
+        return '\\';
+      case '/':
+        return '/';
+      case 'b':
+        return '\b';
+      case 'f':
+        return '\f';
+      case 'n':
+        return '\n';
+      case 'r':
+        return '\r';
+      case 't':
+        return '\t';
+      case 'u': {
+        // Only code points in the ASCII range are produced by the encoders
+        if (pos_ + 4 > text_.size()) {
+          return std::unexpected(common::Error::kInvalidArgument);
+        }
+        uint32_t code{0};
+        for (size_t i = 0; i < 4; ++i) {
+          const char hex{text_[pos_++]};
+          code <<= 4U;
+          if (hex >= '0' && hex <= '9') {
+            code |= static_cast<uint32_t>(hex - '0');
+          } else if (hex >= 'a' && hex <= 'f') {
+            code |= static_cast<uint32_t>(hex - 'a' + 10);
+          } else if (hex >= 'A' && hex <= 'F') {
+            code |= static_cast<uint32_t>(hex - 'A' + 10);
+          } else {
+            return std::unexpected(common::Error::kInvalidArgument);
+          }
+        }
+        if (code > 0x7F) {
+          return std::unexpected(common::Error::kInvalidArgument);
+        }
+        return static_cast<char>(code);
+      }
+      default:
+        return std::unexpected(common::Error::kInvalidArgument);
+    }
+  }
+
+  auto SkipStringBody() -> std::expected<void, common::Error> {
+    while (pos_ < text_.size()) {
+      const char chr{text_[pos_++]};
+      if (chr == '\\') {
+        ++pos_;
+      } else if (chr == '"') {
+        return {};
+      }
+    }
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+
+  auto SkipContainer() -> std::expected<void, common::Error> {
+    size_t depth{0};
+    SkipWhitespace();
+    while (pos_ < text_.size()) {
+      const char chr{text_[pos_++]};
+      if (chr == '"') {
+        if (auto result{SkipStringBody()}; !result) {
+          return result;
+        }
+      } else if (chr == '{' || chr == '[') {
+        ++depth;
+      } else if (chr == '}' || chr == ']') {
+        if (--depth == 0) {
+          return {};
+        }
+      }
+    }
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+
+  std::string_view text_;
+  size_t pos_{0};
+};
+
+template <typename E, size_t N>
+inline auto ReadEnum(JsonCursor& cursor,
+                     const std::array<std::pair<std::string_view, E>, N>& names)
+    -> std::expected<E, common::Error> {
+  std::array<char, 32> buffer{};
+  auto length{cursor.ReadString(buffer)};
+  if (!length) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  return LookupName(names, std::string_view{buffer.data(), *length});
+}
+
+// Stores a successfully read field into target. Numbers that do not fit the
+// target are rejected, as the DOM decoder does, rather than truncated.
+template <typename T, typename R>
+inline auto StoreField(const std::expected<R, common::Error>& result,
+                       T& target) -> std::expected<void, common::Error> {
+  if (!result) {
+    return std::unexpected(result.error());
+  }
+  if constexpr (std::is_integral_v<T>) {
+    if (!std::in_range<T>(*result)) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+  }
+  target = static_cast<T>(*result);
+  return {};
+}
+
+// Walks the members of a flat JSON object, calling visit(key) with the cursor
+// positioned at each value. visit consumes the value and returns false to
+// stop before the end of the object.
+template <typename Visitor>
+inline auto ReadJsonObject(JsonCursor& cursor, Visitor&& visit)
+    -> std::expected<void, common::Error> {
+  if (!cursor.Consume('{')) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  if (cursor.Consume('}')) {
+    return {};
+  }
+  do {
+    std::array<char, 32> key_buffer{};
+    auto key_length{cursor.ReadString(key_buffer)};
+    if (!key_length || !cursor.Consume(':')) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    auto more{visit(std::string_view{key_buffer.data(), *key_length})};
+    if (!more) {
+      return std::unexpected(more.error());
+    }
+    if (!*more) {
+      return {};
+    }
+  } while (cursor.Consume(','));
+
+  if (!cursor.Consume('}')) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  return {};
+}
+
+inline auto DecodeJsonInto(std::string_view text, MessageView& view)
+    -> std::expected<void, common::Error> {
+  JsonCursor cursor{text};
+  bool has_type{false};
+  bool has_object{false};
+  bool has_name{false};
+  auto visit = [&](std::string_view key) -> std::expected<bool, common::Error> {
+    std::expected<void, common::Error> field{};
+    if (key == "type") {
+      field = StoreField(ReadEnum(cursor, kMessageTypeNames), view.type);
+      has_type = true;
+    } else if (key == "object") {
+      field = StoreField(ReadEnum(cursor, kObjectTypeNames), view.object);
+      has_object = true;
+    } else if (key == "name") {
+      field = StoreField(cursor.ReadString(view.name.chars), view.name.size);
+      has_name = true;
+    } else if (key == "operation") {
+      field = StoreField(ReadEnum(cursor, kOperationTypeNames), view.operation);
+    } else if (key == "state") {
+      field = StoreField(ReadEnum(cursor, kPinStateNames), view.state);
+    } else if (key == "status") {
+      field = StoreField(ReadEnum(cursor, kErrorNames), view.status);
+    } else if (key == "address") {
+      field = StoreField(cursor.ReadUnsigned(), view.address);
+    } else if (key == "size") {
+      field = StoreField(cursor.ReadUnsigned(), view.size);
+    } else if (key == "timeout_ms") {
+      field = StoreField(cursor.ReadUnsigned(), view.timeout_ms);
+    } else if (key == "bytes_transferred") {
+      field = StoreField(cursor.ReadUnsigned(), view.bytes_transferred);
+    } else if (key == "mask") {
+      field = StoreField(cursor.ReadUnsigned(), view.mask);
+    } else if (key == "value") {
+      field = StoreField(cursor.ReadUnsigned(), view.value);
+    } else if (key == "advance_us") {
+      field = StoreField(cursor.ReadUnsigned(), view.advance_us);
+    } else if (key == "data") {
+      field = StoreField(cursor.ReadByteArray(view.data), view.data_size);
+    } else if (key == "id") {
+      field = StoreField(cursor.ReadUnsigned(), view.id);
+    } else {
+      field = cursor.SkipValue();
+    }
+    if (!field) {
+      return std::unexpected(field.error());
+    }
+    return true;
+  };
+
+  if (auto result{ReadJsonObject(cursor, visit)}; !result) {
+    return result;
+  }
+  if (!cursor.AtEnd() || !has_type || !has_object || !has_name) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  return {};
+}
+
+inline auto DecodeBinaryInto(std::string_view frame, MessageView& view)
+    -> std::expected<void, common::Error> {
+  if (frame.size() < kBinaryFrameHeaderSize) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  const char* header{frame.data()};
+  const size_t name_size{GetU16(&header[6])};
+  const size_t data_size{GetU32(&header[24])};
+  if (frame.size() != kBinaryFrameHeaderSize + name_size + data_size) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  if (name_size > view.name.chars.size() || data_size > view.data.size()) {
+    return std::unexpected(common::Error::kMessageTooLarge);
+  }
+
+  view.type = static_cast<MessageType>(GetU8(&header[1]));
+  view.object = static_cast<ObjectType>(GetU8(&header[2]));
+  view.operation = static_cast<OperationType>(GetU8(&header[3]));
+  view.status = static_cast<common::Error>(GetU8(&header[4]));
+  view.state = static_cast<PinState>(GetU8(&header[5]));
+  view.address = GetU16(&header[8]);
+  // Ports and the clock reuse the size and timeout_ms slots, as
+  // EncodeBinary() does
+  if (view.object == ObjectType::kPort) {
+    view.mask = GetU32(&header[12]);
+    view.value = GetU32(&header[16]);
+  } else if (view.object == ObjectType::kClock) {
+    view.advance_us = GetU32(&header[16]);
+  } else {
+    view.size = GetU32(&header[12]);
+    view.timeout_ms = GetU32(&header[16]);
+  }
+  view.bytes_transferred = GetU32(&header[20]);
+  view.id = GetU32(&header[28]);
+
+  const char* body{header + kBinaryFrameHeaderSize};
+  std::copy_n(body, name_size, view.name.chars.begin());
+  view.name.size = name_size;
+  std::copy_n(reinterpret_cast<const std::byte*>(body + name_size), data_size,
+              view.data.begin());
+  view.data_size = data_size;
+  return {};
+}
+
+inline auto PeekJsonHeader(std::string_view text, MessageHeader& header)
+    -> std::expected<void, common::Error> {
+  JsonCursor cursor{text};
+  bool has_type{false};
+  bool has_object{false};
+  bool has_name{false};
+  bool has_id{false};
+  auto visit = [&](std::string_view key) -> std::expected<bool, common::Error> {
+    std::expected<void, common::Error> field{};
+    if (key == "type") {
+      field = StoreField(ReadEnum(cursor, kMessageTypeNames), header.type);
+      has_type = true;
+    } else if (key == "object") {
+      field = StoreField(ReadEnum(cursor, kObjectTypeNames), header.object);
+      has_object = true;
+    } else if (key == "name") {
+      field =
+          StoreField(cursor.ReadString(header.name.chars), header.name.size);
+      has_name = true;
+    } else if (key == "id") {
+      field = StoreField(cursor.ReadUnsigned(), header.id);
+      has_id = true;
+    } else {
+      field = cursor.SkipValue();
+    }
+    if (!field) {
+      return std::unexpected(field.error());
+    }
+    // The rest of the frame is validated by whichever receiver decodes it
+    return !(has_type && has_object && has_name && has_id);
+  };
+
+  if (auto result{ReadJsonObject(cursor, visit)}; !result) {
+    return result;
+  }
+  if (!has_type || !has_object || !has_name) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  return {};
+}
+
+}  // namespace detail
+
+/// @brief Read only the type, object, name and id of a frame
+/// Used to route a message before any receiver fully decodes it.
+inline auto PeekHeader(std::string_view frame, MessageHeader& header)
+    -> std::expected<void, common::Error> {
+  if (!IsBinaryFrame(frame)) {
+    return detail::PeekJsonHeader(frame, header);
+  }
+  if (frame.size() < kBinaryFrameHeaderSize) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  const size_t name_size{detail::GetU16(&frame[6])};
+  if (name_size > header.name.chars.size() ||
+      frame.size() < kBinaryFrameHeaderSize + name_size) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  header.type = static_cast<MessageType>(detail::GetU8(&frame[1]));
+  header.object = static_cast<ObjectType>(detail::GetU8(&frame[2]));
+  header.id = detail::GetU32(&frame[28]);
+  std::copy_n(&frame[kBinaryFrameHeaderSize], name_size,
+              header.name.chars.begin());
+  header.name.size = name_size;
+  return {};
+}
+
+/// @brief Decode a JSON or binary frame without allocating
+/// @param frame Encoded message
+/// @param view Destination; view.data must point at the payload storage
+/// @return kMessageTooLarge if the name or payload does not fit, or
+///         kInvalidArgument if the frame is malformed
+inline auto DecodeInto(std::string_view frame, MessageView& view)
+    -> std::expected<void, common::Error> {
+  view.data_size = 0;
+  if (IsBinaryFrame(frame)) {
+    return detail::DecodeBinaryInto(frame, view);
+  }
+  return detail::DecodeJsonInto(frame, view);
+}
+
+}  // namespace mcu
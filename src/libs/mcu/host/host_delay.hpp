@@ -0,0 +1,11 @@
+#pragma once
+
+#include "libs/common/time_source.hpp"
+
+namespace mcu {
+
+// Makes Delay() advance source instead of sleeping, e.g. to a
+// SimulationClock. nullptr restores sleeping. Applies to every thread.
+auto SetDelayTimeSource(common::TimeSource* source) -> void;
+
+}  // namespace mcu
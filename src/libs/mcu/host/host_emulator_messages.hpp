@@ -13,15 +13,29 @@
 namespace mcu {
 
 enum class MessageType { kRequest = 1, kResponse };
-enum class OperationType { kSet = 1, kGet, kSend, kReceive };
-enum class ObjectType { kPin = 1, kUart, kI2C };
+enum class OperationType {
+  kSet = 1,
+  kGet,
+  kSend,
+  kReceive,
+  kTransfer,
+  kTransaction,
+  kAdvance
+};
+enum class ObjectType { kPin = 1, kUart, kI2C, kPort, kClock };
+
+// Wire format used to encode messages exchanged with the emulator
+enum class WireFormat : uint8_t { kJson = 1, kBinary };
 
+// Every message carries an `id` that pairs a response with its request;
+// 0 marks an untracked message.
 struct PinEmulatorRequest {
   MessageType type{MessageType::kRequest};
   ObjectType object{ObjectType::kPin};
   std::string name;
   OperationType operation;
   PinState state;
+  uint32_t id{0};
   auto operator<=>(const PinEmulatorRequest&) const = default;
 };
 
@@ -31,6 +45,7 @@ struct PinEmulatorResponse {
   std::string name;
   PinState state;
   common::Error status;
+  uint32_t id{0};
   auto operator<=>(const PinEmulatorResponse&) const = default;
 };
 
@@ -42,6 +57,7 @@ struct UartEmulatorRequest {
   std::vector<std::byte> data;  // For Send operation
   size_t size{0};               // For Receive operation (buffer size)
   uint32_t timeout_ms{0};       // For Receive operation
+  uint32_t id{0};
   auto operator<=>(const UartEmulatorRequest&) const = default;
 };
 
@@ -52,17 +68,33 @@ struct UartEmulatorResponse {
   std::vector<std::byte> data;  // Received data
   size_t bytes_transferred{0};
   common::Error status;
+  uint32_t id{0};
   auto operator<=>(const UartEmulatorResponse&) const = default;
 };
 
+// A Transaction request packs its segments into data, one after another,
+// each as a little-endian header followed by the segment's write bytes:
+//
+//   offset  size  field
+//   0       2     address
+//   2       2     write size
+//   4       2     read size
+//   6       1     flags (bit 0: stop after the segment)
+//
+// size is the total read size. The response's data holds every segment's
+// read bytes back to back.
+inline constexpr size_t kI2CSegmentHeaderSize{7};
+inline constexpr uint8_t kI2CSegmentStop{0x01};
+
 struct I2CEmulatorRequest {
   MessageType type{MessageType::kRequest};
   ObjectType object{ObjectType::kI2C};
   std::string name;
   OperationType operation;
   uint16_t address{0};
-  std::vector<std::byte> data;  // For Send operation
-  size_t size{0};               // For Receive operation (buffer size)
+  std::vector<std::byte> data;  // For Send, Transfer and Transaction
+  size_t size{0};               // Bytes to read; unused by Send
+  uint32_t id{0};
   auto operator<=>(const I2CEmulatorRequest&) const = default;
 };
 
@@ -74,7 +106,53 @@ struct I2CEmulatorResponse {
   std::vector<std::byte> data;  // Received data
   size_t bytes_transferred{0};
   common::Error status;
+  uint32_t id{0};
   auto operator<=>(const I2CEmulatorResponse&) const = default;
 };
 
+// Bits of mask select the pins a request touches; pins outside it keep
+// their level. Set writes value to the selected pins, Get reads them all.
+struct PortEmulatorRequest {
+  MessageType type{MessageType::kRequest};
+  ObjectType object{ObjectType::kPort};
+  std::string name;
+  OperationType operation;
+  uint32_t mask{0};
+  uint32_t value{0};
+  uint32_t id{0};
+  auto operator<=>(const PortEmulatorRequest&) const = default;
+};
+
+struct PortEmulatorResponse {
+  MessageType type{MessageType::kResponse};
+  ObjectType object{ObjectType::kPort};
+  std::string name;
+  uint32_t value{0};  // Level of every pin after the request
+  common::Error status;
+  uint32_t id{0};
+  auto operator<=>(const PortEmulatorResponse&) const = default;
+};
+
+// Sent by a device running in simulated time each time its clock moves
+// forward. The emulator replies once it has caught up, so anything it
+// scheduled for that stretch of time has reached the device by then.
+struct ClockEmulatorRequest {
+  MessageType type{MessageType::kRequest};
+  ObjectType object{ObjectType::kClock};
+  std::string name;
+  OperationType operation{OperationType::kAdvance};
+  uint32_t advance_us{0};  // How far the clock moved since the last request
+  uint32_t id{0};
+  auto operator<=>(const ClockEmulatorRequest&) const = default;
+};
+
+struct ClockEmulatorResponse {
+  MessageType type{MessageType::kResponse};
+  ObjectType object{ObjectType::kClock};
+  std::string name;
+  common::Error status;
+  uint32_t id{0};
+  auto operator<=>(const ClockEmulatorResponse&) const = default;
+};
+
 }  // namespace mcu
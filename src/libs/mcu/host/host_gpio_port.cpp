@@ -0,0 +1,80 @@
+#include "host_gpio_port.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+
+namespace mcu {
+
+auto HostGpioPort::Write(uint32_t mask, uint32_t value)
+    -> std::expected<void, common::Error> {
+  return Transact(OperationType::kSet, mask, value)
+      .transform([](uint32_t /*levels*/) {});
+}
+
+auto HostGpioPort::Read() -> std::expected<uint32_t, common::Error> {
+  return Transact(OperationType::kGet, 0, 0);
+}
+
+auto HostGpioPort::Toggle(uint32_t mask)
+    -> std::expected<void, common::Error> {
+  // Only ask the emulator when no reply has told us the levels
+  if (!latch_valid_) {
+    auto levels{Read()};
+    if (!levels) {
+      return std::unexpected(levels.error());
+    }
+  }
+  return Write(mask, ~output_latch_);
+}
+
+auto HostGpioPort::Transact(OperationType operation, uint32_t mask,
+                            uint32_t value)
+    -> std::expected<uint32_t, common::Error> {
+  const PortEmulatorRequest req = {
+      .name = name_,
+      .operation = operation,
+      .mask = mask,
+      .value = value,
+  };
+
+  return EncodeMessage(req, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this]() {
+        return reply_buffer_.Receive(transport_, MaxFrameSize(name_.size(), 0));
+      })
+      .and_then([](std::string_view rx_bytes) {
+        return DecodeMessage<PortEmulatorResponse>(rx_bytes);
+      })
+      .and_then([this](const PortEmulatorResponse& resp)
+                    -> std::expected<uint32_t, common::Error> {
+        if (resp.status != common::Error::kOk) {
+          return std::unexpected(resp.status);
+        }
+        output_latch_ = resp.value;
+        latch_valid_ = true;
+        return resp.value;
+      })
+      .or_else([this](common::Error error)
+                   -> std::expected<uint32_t, common::Error> {
+        // The emulator may or may not have applied a write
+        latch_valid_ = false;
+        return std::unexpected(error);
+      });
+}
+
+// The emulator never drives a port; its inputs are read on demand
+auto HostGpioPort::Receive(const std::string_view& message)
+    -> std::expected<std::string, common::Error> {
+  static_cast<void>(message);
+  return std::unexpected(common::Error::kUnhandled);
+}
+
+}  // namespace mcu
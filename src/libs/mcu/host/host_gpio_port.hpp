@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <string>
+
+#include "libs/mcu/gpio_port.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/host/receiver.hpp"
+#include "libs/mcu/host/transport.hpp"
+
+namespace mcu {
+
+// Every call is a single request to the emulator, however many pins it
+// touches.
+class HostGpioPort final : public GpioPort, public Receiver {
+ public:
+  explicit HostGpioPort(std::string name, Transport& transport,
+                        WireFormat format = WireFormat::kJson)
+      : name_{std::move(name)}, transport_{transport}, format_{format} {}
+  HostGpioPort(const HostGpioPort&) = delete;
+  HostGpioPort(HostGpioPort&&) = delete;
+  auto operator=(const HostGpioPort&) -> HostGpioPort& = delete;
+  auto operator=(HostGpioPort&&) -> HostGpioPort& = delete;
+  ~HostGpioPort() override = default;
+
+  auto Write(uint32_t mask, uint32_t value)
+      -> std::expected<void, common::Error> override;
+  auto Read() -> std::expected<uint32_t, common::Error> override;
+  auto Toggle(uint32_t mask) -> std::expected<void, common::Error> override;
+
+  auto Receive(const std::string_view& message)
+      -> std::expected<std::string, common::Error> override;
+
+ private:
+  auto Transact(OperationType operation, uint32_t mask, uint32_t value)
+      -> std::expected<uint32_t, common::Error>;
+
+  const std::string name_;
+  Transport& transport_;
+  const WireFormat format_;
+  // Reused for the replies to blocking requests
+  ReplyBuffer reply_buffer_{};
+  // Levels of every pin as of the last reply, which carries them all. While
+  // valid, Toggle() works from it so that it needs no read first.
+  uint32_t output_latch_{0};
+  bool latch_valid_{false};
+};
+
+}  // namespace mcu
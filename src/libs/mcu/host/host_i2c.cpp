@@ -5,117 +5,356 @@
 #include <cstdint>
 #include <expected>
 #include <span>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "libs/common/error.hpp"
-#include "libs/mcu/host/emulator_message_json_encoder.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/emulator_message_stream_decoder.hpp"
 #include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/i2c.hpp"
 
 namespace mcu {
+namespace {
 
-auto HostI2CController::SendData(uint16_t address,
-                                 std::span<const std::byte> data)
+auto ParseSendResponse(std::string_view reply)
     -> std::expected<void, common::Error> {
-  const I2CEmulatorRequest request{
-      .type = MessageType::kRequest,
-      .object = ObjectType::kI2C,
-      .name = name_,
-      .operation = OperationType::kSend,
-      .address = address,
-      .data = std::vector<std::byte>(data.begin(), data.end()),
-      .size = 0,
-  };
-
-  auto send_result = transport_.Send(Encode(request));
-  if (!send_result) {
-    return std::unexpected(send_result.error());
-  }
-
-  auto receive_result = transport_.Receive();
-  if (!receive_result) {
-    return std::unexpected(receive_result.error());
-  }
-
-  auto response = Decode<I2CEmulatorResponse>(receive_result.value());
+  auto response = DecodeMessage<I2CEmulatorResponse>(reply);
   if (!response) {
     return std::unexpected(response.error());
   }
   if (response->status != common::Error::kOk) {
     return std::unexpected(response->status);
   }
-
   return {};
 }
 
-auto HostI2CController::ReceiveData(uint16_t address,
-                                    std::span<std::byte> buffer)
+// Decodes the payload straight into the caller-provided buffer
+auto ParseReceiveResponse(std::string_view reply, std::span<std::byte> buffer)
     -> std::expected<size_t, common::Error> {
-  const I2CEmulatorRequest request{
-      .type = MessageType::kRequest,
-      .object = ObjectType::kI2C,
-      .name = name_,
-      .operation = OperationType::kReceive,
-      .address = address,
-      .data = {},
-      .size = buffer.size(),
-  };
+  MessageView response{.data = buffer};
+  auto decoded = DecodeInto(reply, response);
+  if (!decoded) {
+    return std::unexpected(decoded.error());
+  }
+  if (response.type != MessageType::kResponse ||
+      response.object != ObjectType::kI2C) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  if (response.status != common::Error::kOk) {
+    return std::unexpected(response.status);
+  }
+  return response.data_size;
+}
 
-  auto send_result = transport_.Send(Encode(request));
-  if (!send_result) {
-    return std::unexpected(send_result.error());
+// Segment sizes travel in 16 bits
+constexpr size_t kMaxSegmentSize{0xFFFF};
+
+// Packs the segments into a Transaction request's data, as described next
+// to I2CEmulatorRequest
+auto EncodeSegments(std::span<const I2CSegment> segments)
+    -> std::expected<std::vector<std::byte>, common::Error> {
+  size_t encoded_size{0};
+  for (const auto& segment : segments) {
+    if (segment.write.size() > kMaxSegmentSize ||
+        segment.read.size() > kMaxSegmentSize) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    encoded_size += kI2CSegmentHeaderSize + segment.write.size();
   }
 
-  auto receive_result = transport_.Receive();
-  if (!receive_result) {
-    return std::unexpected(receive_result.error());
+  std::vector<std::byte> encoded{};
+  encoded.reserve(encoded_size);
+  auto put_u16 = [&encoded](size_t value) {
+    encoded.push_back(static_cast<std::byte>(value & 0xFFU));
+    encoded.push_back(static_cast<std::byte>((value >> 8U) & 0xFFU));
+  };
+  for (const auto& segment : segments) {
+    put_u16(segment.address);
+    put_u16(segment.write.size());
+    put_u16(segment.read.size());
+    encoded.push_back(
+        static_cast<std::byte>(segment.stop ? kI2CSegmentStop : 0U));
+    encoded.insert(encoded.end(), segment.write.begin(), segment.write.end());
   }
+  return encoded;
+}
 
-  auto response = Decode<I2CEmulatorResponse>(receive_result.value());
+// Scatters the reply's read bytes back into each segment's read buffer
+auto ParseTransactionResponse(std::string_view reply,
+                              std::span<const I2CSegment> segments)
+    -> std::expected<void, common::Error> {
+  auto response = DecodeMessage<I2CEmulatorResponse>(reply);
   if (!response) {
     return std::unexpected(response.error());
   }
   if (response->status != common::Error::kOk) {
     return std::unexpected(response->status);
   }
+  size_t read_size{0};
+  for (const auto& segment : segments) {
+    read_size += segment.read.size();
+  }
+  if (response->data.size() != read_size) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  auto next{response->data.cbegin()};
+  for (const auto& segment : segments) {
+    std::copy_n(next, segment.read.size(), segment.read.begin());
+    next += static_cast<std::ptrdiff_t>(segment.read.size());
+  }
+  return {};
+}
+
+}  // namespace
+
+auto HostI2CController::SendData(uint16_t address,
+                                 std::span<const std::byte> data)
+    -> std::expected<void, common::Error> {
+  const auto request{MakeSendRequest(address, data, 0)};
+  return EncodeMessage(request, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this]() {
+        return reply_buffer_.Receive(transport_, MaxFrameSize(name_.size(), 0));
+      })
+      .and_then([](std::string_view response_str) {
+        return ParseSendResponse(response_str);
+      });
+}
 
-  // Copy received data into caller-provided buffer
-  const size_t bytes_to_copy{std::min(response->data.size(), buffer.size())};
-  std::copy_n(response->data.begin(), bytes_to_copy, buffer.begin());
+auto HostI2CController::ReceiveData(uint16_t address,
+                                    std::span<std::byte> buffer)
+    -> std::expected<size_t, common::Error> {
+  const auto request{MakeReceiveRequest(address, buffer.size(), 0)};
+  return EncodeMessage(request, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this, buffer]() {
+        return reply_buffer_.Receive(
+            transport_, MaxFrameSize(name_.size(), buffer.size()));
+      })
+      .and_then([buffer](std::string_view response_str) {
+        return ParseReceiveResponse(response_str, buffer);
+      });
+}
 
-  return bytes_to_copy;
+// Both phases travel in one request, so a register read costs a single
+// round trip and no other transfer can slip in between them.
+auto HostI2CController::WriteRead(uint16_t address,
+                                  std::span<const std::byte> data,
+                                  std::span<std::byte> buffer)
+    -> std::expected<size_t, common::Error> {
+  const auto request{MakeTransferRequest(address, data, buffer.size(), 0)};
+  return EncodeMessage(request, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this, buffer]() {
+        return reply_buffer_.Receive(
+            transport_, MaxFrameSize(name_.size(), buffer.size()));
+      })
+      .and_then([buffer](std::string_view response_str) {
+        return ParseReceiveResponse(response_str, buffer);
+      });
 }
 
-auto HostI2CController::SendDataInterrupt(
-    uint16_t address, std::span<const std::byte> data,
-    std::function<void(std::expected<void, common::Error>)> callback)
+auto HostI2CController::SendDataInterrupt(uint16_t address,
+                                          std::span<const std::byte> data,
+                                          CompletionCallback<void> callback)
     -> std::expected<void, common::Error> {
-  callback(SendData(address, data));
-  return {};
+  return SendDataAsync(address, data, std::move(callback));
 }
 
 auto HostI2CController::ReceiveDataInterrupt(
     uint16_t address, std::span<std::byte> buffer,
-    std::function<void(std::expected<size_t, common::Error>)> callback)
+    CompletionCallback<size_t> callback)
     -> std::expected<void, common::Error> {
-  callback(ReceiveData(address, buffer));
-  return {};
+  return ReceiveDataAsync(address, buffer, std::move(callback));
 }
 
-auto HostI2CController::SendDataDma(
-    uint16_t address, std::span<const std::byte> data,
-    std::function<void(std::expected<void, common::Error>)> callback)
+auto HostI2CController::WriteReadInterrupt(uint16_t address,
+                                           std::span<const std::byte> data,
+                                           std::span<std::byte> buffer,
+                                           CompletionCallback<size_t> callback)
     -> std::expected<void, common::Error> {
-  callback(SendData(address, data));
-  return {};
+  return WriteReadAsync(address, data, buffer, std::move(callback));
 }
 
-auto HostI2CController::ReceiveDataDma(
-    uint16_t address, std::span<std::byte> buffer,
-    std::function<void(std::expected<size_t, common::Error>)> callback)
+auto HostI2CController::SendDataDma(uint16_t address,
+                                    std::span<const std::byte> data,
+                                    CompletionCallback<void> callback)
     -> std::expected<void, common::Error> {
-  callback(ReceiveData(address, buffer));
-  return {};
+  return SendDataAsync(address, data, std::move(callback));
+}
+
+auto HostI2CController::ReceiveDataDma(uint16_t address,
+                                       std::span<std::byte> buffer,
+                                       CompletionCallback<size_t> callback)
+    -> std::expected<void, common::Error> {
+  return ReceiveDataAsync(address, buffer, std::move(callback));
+}
+
+auto HostI2CController::WriteReadDma(uint16_t address,
+                                     std::span<const std::byte> data,
+                                     std::span<std::byte> buffer,
+                                     CompletionCallback<size_t> callback)
+    -> std::expected<void, common::Error> {
+  return WriteReadAsync(address, data, buffer, std::move(callback));
+}
+
+// The whole transaction is one request and one reply, however many
+// segments it has.
+auto HostI2CController::Transact(std::span<const I2CSegment> segments,
+                                 CompletionCallback<void> callback)
+    -> std::expected<void, common::Error> {
+  if (segments.empty()) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  auto encoded_segments{EncodeSegments(segments)};
+  if (!encoded_segments) {
+    return std::unexpected(encoded_segments.error());
+  }
+  size_t read_size{0};
+  for (const auto& segment : segments) {
+    read_size += segment.read.size();
+  }
+
+  const auto id{transport_.NextId()};
+  const I2CEmulatorRequest request{
+      .type = MessageType::kRequest,
+      .object = ObjectType::kI2C,
+      .name = name_,
+      .operation = OperationType::kTransaction,
+      // Each segment carries its own; the header names the first device
+      .address = segments.front().address,
+      .data = std::move(*encoded_segments),
+      .size = read_size,
+      .id = id,
+  };
+  auto frame{EncodeMessage(request, format_)};
+  if (!frame) {
+    return std::unexpected(frame.error());
+  }
+  return transport_.SendAsync(
+      *frame, id,
+      [segments, callback = std::move(callback)](
+          std::expected<std::string_view, common::Error> reply) {
+        callback(reply.and_then([segments](std::string_view response) {
+          return ParseTransactionResponse(response, segments);
+        }));
+      });
+}
+
+auto HostI2CController::MakeSendRequest(uint16_t address,
+                                        std::span<const std::byte> data,
+                                        uint32_t id) const
+    -> I2CEmulatorRequest {
+  return I2CEmulatorRequest{
+      .type = MessageType::kRequest,
+      .object = ObjectType::kI2C,
+      .name = name_,
+      .operation = OperationType::kSend,
+      .address = address,
+      .data = std::vector<std::byte>(data.begin(), data.end()),
+      .size = 0,
+      .id = id,
+  };
+}
+
+auto HostI2CController::MakeReceiveRequest(uint16_t address, size_t size,
+                                           uint32_t id) const
+    -> I2CEmulatorRequest {
+  return I2CEmulatorRequest{
+      .type = MessageType::kRequest,
+      .object = ObjectType::kI2C,
+      .name = name_,
+      .operation = OperationType::kReceive,
+      .address = address,
+      .data = {},
+      .size = size,
+      .id = id,
+  };
+}
+
+auto HostI2CController::MakeTransferRequest(uint16_t address,
+                                            std::span<const std::byte> data,
+                                            size_t size, uint32_t id) const
+    -> I2CEmulatorRequest {
+  return I2CEmulatorRequest{
+      .type = MessageType::kRequest,
+      .object = ObjectType::kI2C,
+      .name = name_,
+      .operation = OperationType::kTransfer,
+      .address = address,
+      .data = std::vector<std::byte>(data.begin(), data.end()),
+      .size = size,
+      .id = id,
+  };
+}
+
+// Several transfers may be outstanding at once. Each completion is matched
+// to its request by correlation id, so callbacks may run in any order.
+auto HostI2CController::SendDataAsync(uint16_t address,
+                                      std::span<const std::byte> data,
+                                      CompletionCallback<void> callback)
+    -> std::expected<void, common::Error> {
+  const auto id{transport_.NextId()};
+  auto frame{EncodeMessage(MakeSendRequest(address, data, id), format_)};
+  if (!frame) {
+    return std::unexpected(frame.error());
+  }
+  return transport_.SendAsync(
+      *frame, id,
+      [callback = std::move(callback)](
+          std::expected<std::string_view, common::Error> reply) {
+        callback(reply.and_then(ParseSendResponse));
+      });
+}
+
+auto HostI2CController::ReceiveDataAsync(uint16_t address,
+                                         std::span<std::byte> buffer,
+                                         CompletionCallback<size_t> callback)
+    -> std::expected<void, common::Error> {
+  const auto id{transport_.NextId()};
+  auto frame{
+      EncodeMessage(MakeReceiveRequest(address, buffer.size(), id), format_)};
+  if (!frame) {
+    return std::unexpected(frame.error());
+  }
+  return transport_.SendAsync(
+      *frame, id,
+      [buffer, callback = std::move(callback)](
+          std::expected<std::string_view, common::Error> reply) {
+        callback(reply.and_then([buffer](std::string_view response) {
+          return ParseReceiveResponse(response, buffer);
+        }));
+      });
+}
+
+auto HostI2CController::WriteReadAsync(uint16_t address,
+                                       std::span<const std::byte> data,
+                                       std::span<std::byte> buffer,
+                                       CompletionCallback<size_t> callback)
+    -> std::expected<void, common::Error> {
+  const auto id{transport_.NextId()};
+  auto frame{EncodeMessage(
+      MakeTransferRequest(address, data, buffer.size(), id), format_)};
+  if (!frame) {
+    return std::unexpected(frame.error());
+  }
+  return transport_.SendAsync(
+      *frame, id,
+      [buffer, callback = std::move(callback)](
+          std::expected<std::string_view, common::Error> reply) {
+        callback(reply.and_then([buffer](std::string_view response) {
+          return ParseReceiveResponse(response, buffer);
+        }));
+      });
 }
 
 auto HostI2CController::Receive(const std::string_view& message)
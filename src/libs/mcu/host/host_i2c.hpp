@@ -1,20 +1,24 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <span>
 #include <string>
 
+#include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/host/receiver.hpp"
 #include "libs/mcu/host/transport.hpp"
+#include "libs/mcu/callback.hpp"
 #include "libs/mcu/i2c.hpp"
 
 namespace mcu {
 
 class HostI2CController final : public I2CController, public Receiver {
  public:
-  explicit HostI2CController(std::string name, Transport& transport)
-      : name_{std::move(name)}, transport_{transport} {}
+  explicit HostI2CController(std::string name, Transport& transport,
+                             WireFormat format = WireFormat::kJson)
+      : name_{std::move(name)}, transport_{transport}, format_{format} {}
   HostI2CController(const HostI2CController&) = delete;
   HostI2CController(HostI2CController&&) = delete;
   auto operator=(const HostI2CController&) -> HostI2CController& = delete;
@@ -27,27 +31,62 @@ class HostI2CController final : public I2CController, public Receiver {
   auto ReceiveData(uint16_t address, std::span<std::byte> buffer)
       -> std::expected<size_t, common::Error> override;
 
-  auto SendDataInterrupt(
-      uint16_t address, std::span<const std::byte> data,
-      std::function<void(std::expected<void, common::Error>)> callback)
+  auto WriteRead(uint16_t address, std::span<const std::byte> data,
+                 std::span<std::byte> buffer)
+      -> std::expected<size_t, common::Error> override;
+
+  auto SendDataInterrupt(uint16_t address, std::span<const std::byte> data,
+                         CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override;
+  auto ReceiveDataInterrupt(uint16_t address, std::span<std::byte> buffer,
+                            CompletionCallback<size_t> callback)
       -> std::expected<void, common::Error> override;
-  auto ReceiveDataInterrupt(
-      uint16_t address, std::span<std::byte> buffer,
-      std::function<void(std::expected<size_t, common::Error>)> callback)
+  auto WriteReadInterrupt(uint16_t address, std::span<const std::byte> data,
+                          std::span<std::byte> buffer,
+                          CompletionCallback<size_t> callback)
       -> std::expected<void, common::Error> override;
 
   auto SendDataDma(uint16_t address, std::span<const std::byte> data,
-                   std::function<void(std::expected<void, common::Error>)>
-                       callback) -> std::expected<void, common::Error> override;
-  auto ReceiveDataDma(
-      uint16_t address, std::span<std::byte> buffer,
-      std::function<void(std::expected<size_t, common::Error>)> callback)
+                   CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override;
+  auto ReceiveDataDma(uint16_t address, std::span<std::byte> buffer,
+                      CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override;
+  auto WriteReadDma(uint16_t address, std::span<const std::byte> data,
+                    std::span<std::byte> buffer,
+                    CompletionCallback<size_t> callback)
       -> std::expected<void, common::Error> override;
+
+  auto Transact(std::span<const I2CSegment> segments,
+                CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override;
+
   auto Receive(const std::string_view& message)
       -> std::expected<std::string, common::Error> override;
 
  private:
+  auto MakeSendRequest(uint16_t address, std::span<const std::byte> data,
+                       uint32_t id) const -> I2CEmulatorRequest;
+  auto MakeReceiveRequest(uint16_t address, size_t size, uint32_t id) const
+      -> I2CEmulatorRequest;
+  auto MakeTransferRequest(uint16_t address, std::span<const std::byte> data,
+                           size_t size, uint32_t id) const
+      -> I2CEmulatorRequest;
+  auto SendDataAsync(uint16_t address, std::span<const std::byte> data,
+                     CompletionCallback<void> callback)
+      -> std::expected<void, common::Error>;
+  auto ReceiveDataAsync(uint16_t address, std::span<std::byte> buffer,
+                        CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error>;
+  auto WriteReadAsync(uint16_t address, std::span<const std::byte> data,
+                      std::span<std::byte> buffer,
+                      CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error>;
+
   const std::string name_;
   Transport& transport_;
+  const WireFormat format_;
+  // Reused for the replies to blocking requests
+  ReplyBuffer reply_buffer_{};
 };
 }  // namespace mcu
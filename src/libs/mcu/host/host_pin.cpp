@@ -1,18 +1,33 @@
 #include "host_pin.hpp"
 
+#include <atomic>
+#include <cstdint>
 #include <expected>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "libs/common/error.hpp"
-#include "libs/mcu/host/emulator_message_json_encoder.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
 #include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/pin.hpp"
 
 namespace mcu {
-using json = nlohmann::json;
+
+// The reply handlers of posted writes refer to this object
+HostPin::~HostPin() {
+  for (const auto id : posted_) {
+    transport_.Cancel(id);
+  }
+}
 
 auto HostPin::Configure(PinDirection direction)
     -> std::expected<void, common::Error> {
+  if (direction != direction_) {
+    state_cached_ = false;
+  }
   direction_ = direction;
   return {};
 }
@@ -33,21 +48,27 @@ auto HostPin::Toggle() -> std::expected<void, common::Error> {
   if (direction_ == PinDirection::kInput) {
     return std::unexpected(common::Error::kInvalidOperation);
   }
-  auto current_state{GetState()};
-  if (!current_state) {
-    return std::unexpected(current_state.error());
+  // Only ask the emulator when the cache cannot say what to toggle from
+  if (!IsCached()) {
+    auto current_state{GetState()};
+    if (!current_state) {
+      return std::unexpected(current_state.error());
+    }
   }
-  if (current_state.value() == PinState::kHigh) {
+  if (state_ == PinState::kHigh) {
     return SendState(PinState::kLow);
   }
   return SendState(PinState::kHigh);
 }
 
 auto HostPin::Get() -> std::expected<PinState, common::Error> {
+  if (IsCached() && direction_ == PinDirection::kOutput) {
+    return state_;
+  }
   return GetState();
 }
 
-auto HostPin::SetInterruptHandler(std::function<void()> handler,
+auto HostPin::SetInterruptHandler(InterruptHandler handler,
                                   PinTransition transition)
     -> std::expected<void, common::Error> {
   handler_ = handler;
@@ -55,26 +76,106 @@ auto HostPin::SetInterruptHandler(std::function<void()> handler,
   return {};
 }
 
+auto HostPin::SetPostedWrites(
+    std::function<void(common::Error)> error_handler) -> void {
+  posted_error_handler_ = std::move(error_handler);
+}
+
 auto HostPin::SendState(PinState state) -> std::expected<void, common::Error> {
+  // Coalesce writes of the level the pin already has
+  if (IsCached() && state == state_) {
+    return {};
+  }
+  if (posted_error_handler_) {
+    return PostState(state);
+  }
+
+  const auto invalidations{invalidations_.load(std::memory_order_acquire)};
   const PinEmulatorRequest req = {
       .name = name_,
       .operation = OperationType::kSet,
       .state = state,
   };
 
-  return transport_.Send(Encode(req))
-      .and_then([this]() { return transport_.Receive(); })
-      .and_then([](const std::string& rx_bytes) {
-        return Decode<PinEmulatorResponse>(rx_bytes);
+  return EncodeMessage(req, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this]() {
+        return reply_buffer_.Receive(transport_, MaxFrameSize(name_.size(), 0));
+      })
+      .and_then([](std::string_view rx_bytes) {
+        return DecodeMessage<PinEmulatorResponse>(rx_bytes);
       })
-      .and_then([this, state](const PinEmulatorResponse& resp)
+      .and_then([this, state, invalidations](const PinEmulatorResponse& resp)
                     -> std::expected<void, common::Error> {
         if (resp.status != common::Error::kOk) {
           return std::unexpected(resp.status);
         }
-        state_ = state;
+        Cache(state, invalidations);
         return {};
+      })
+      .or_else([this](common::Error error)
+                   -> std::expected<void, common::Error> {
+        // The emulator may or may not have applied the write
+        state_cached_ = false;
+        return std::unexpected(error);
+      });
+}
+
+auto HostPin::PostState(PinState state) -> std::expected<void, common::Error> {
+  const auto invalidations{invalidations_.load(std::memory_order_acquire)};
+  const auto id{transport_.NextId()};
+  const PinEmulatorRequest req = {
+      .name = name_,
+      .operation = OperationType::kSet,
+      .state = state,
+      .id = id,
+  };
+
+  auto frame{EncodeMessage(req, format_)};
+  if (!frame) {
+    return std::unexpected(frame.error());
+  }
+  // Completed by the transport whenever it next reads from the emulator
+  auto result = transport_.SendAsync(
+      *frame, id,
+      [this, id](std::expected<std::string_view, common::Error> reply) {
+        std::erase(posted_, id);
+        auto status = reply.and_then(DecodeMessage<PinEmulatorResponse>)
+                          .and_then([](const PinEmulatorResponse& resp)
+                                        -> std::expected<void, common::Error> {
+                            if (resp.status != common::Error::kOk) {
+                              return std::unexpected(resp.status);
+                            }
+                            return {};
+                          });
+        if (!status) {
+          state_cached_ = false;
+          if (posted_error_handler_) {
+            posted_error_handler_(status.error());
+          }
+        }
       });
+  if (!result) {
+    state_cached_ = false;
+    return result;
+  }
+  posted_.push_back(id);
+  // Write-through: assume the write lands until a reply says otherwise
+  Cache(state, invalidations);
+  return {};
+}
+
+auto HostPin::IsCached() const -> bool {
+  return state_cached_ && cached_invalidations_ ==
+                              invalidations_.load(std::memory_order_acquire);
+}
+
+auto HostPin::Cache(PinState state, uint32_t invalidations) -> void {
+  state_ = state;
+  state_cached_ = true;
+  cached_invalidations_ = invalidations;
 }
 
 auto HostPin::CheckAndInvokeHandler(PinState prev_state,
@@ -86,30 +187,49 @@ auto HostPin::CheckAndInvokeHandler(PinState prev_state,
         ((transition_ == PinTransition::kFalling &&
           cur_state == PinState::kLow)) ||
         (transition_ == PinTransition::kBoth)) {
-      handler_();
+      if (event_loop_ != nullptr) {
+        event_loop_->Post([this]() {
+          if (handler_) {
+            handler_();
+          }
+        });
+      } else {
+        handler_();
+      }
     }
   }
 }
 
 auto HostPin::GetState() -> std::expected<PinState, common::Error> {
+  const auto invalidations{invalidations_.load(std::memory_order_acquire)};
   const PinEmulatorRequest req = {
       .name = name_,
       .operation = OperationType::kGet,
       .state = PinState::kHighZ,
   };
 
-  return transport_.Send(Encode(req))
-      .and_then([this]() { return transport_.Receive(); })
-      .and_then([this](const std::string& rx_bytes)
+  return EncodeMessage(req, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this]() {
+        return reply_buffer_.Receive(transport_, MaxFrameSize(name_.size(), 0));
+      })
+      .and_then([this, invalidations](std::string_view rx_bytes)
                     -> std::expected<PinState, common::Error> {
-        auto resp = Decode<PinEmulatorResponse>(rx_bytes);
+        auto resp = DecodeMessage<PinEmulatorResponse>(rx_bytes);
         if (!resp) {
           return std::unexpected(resp.error());
         }
         // If the MCU is polling the input, then it should NOT be configured
         // for interrupts. Therefore, we should not invoke the handler.
         // const PinState prev_state{state_};
-        state_ = resp->state;
+        if (direction_ == PinDirection::kOutput) {
+          Cache(resp->state, invalidations);
+        } else {
+          state_ = resp->state;
+          state_cached_ = false;
+        }
         // CheckAndInvokeHandler(prev_state, resp.state);
         return resp->state;
       });
@@ -119,7 +239,17 @@ auto HostPin::GetState() -> std::expected<PinState, common::Error> {
 // requests. HostPin will only send responses.
 auto HostPin::Receive(const std::string_view& message)
     -> std::expected<std::string, common::Error> {
-  auto req = Decode<PinEmulatorRequest>(message);
+  std::string reply{};
+  auto result{ReceiveInto(message, reply)};
+  if (!result) {
+    return std::unexpected(result.error());
+  }
+  return reply;
+}
+
+auto HostPin::ReceiveInto(const std::string_view& message, std::string& reply)
+    -> std::expected<void, common::Error> {
+  auto req = DecodeMessage<PinEmulatorRequest>(message);
   if (!req) {
     return std::unexpected(common::Error::kInvalidArgument);
   }
@@ -135,17 +265,20 @@ auto HostPin::Receive(const std::string_view& message)
       .name = name_,
       .state = state_,
       .status = common::Error::kInvalidOperation,
+      .id = req->id,
   };
   if (req->operation == OperationType::kGet) {
     resp.status = common::Error::kOk;
-    return Encode(resp);
+    return EncodeMessage(resp, FormatOf(message), reply);
   }
   // Set from the external world is only allowed if the pin is an input
   // with respect to the MCU
   if (req->operation == OperationType::kSet) {
     if (direction_ == PinDirection::kOutput) {
+      // The emulator's idea of this pin may differ from ours; re-read it
+      invalidations_.fetch_add(1, std::memory_order_release);
       resp.status = common::Error::kInvalidOperation;
-      return Encode(resp);
+      return EncodeMessage(resp, FormatOf(message), reply);
     }
     // The external entity pushed a pin update to the MCU.
     // Therefore check for interrupt.
@@ -154,7 +287,7 @@ auto HostPin::Receive(const std::string_view& message)
     CheckAndInvokeHandler(prev_state, req->state);
     resp.state = state_;
     resp.status = common::Error::kOk;
-    return Encode(resp);
+    return EncodeMessage(resp, FormatOf(message), reply);
   }
   return std::unexpected(common::Error::kInvalidOperation);
 }
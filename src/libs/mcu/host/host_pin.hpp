@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
+#include "libs/common/event_loop.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/host/receiver.hpp"
 #include "libs/mcu/host/transport.hpp"
 #include "libs/mcu/pin.hpp"
@@ -11,9 +16,10 @@ namespace mcu {
 
 class HostPin final : public BidirectionalPin, public Receiver {
  public:
-  explicit HostPin(std::string name, Transport& transport)
-      : name_{std::move(name)}, transport_{transport} {}
-  ~HostPin() override = default;
+  explicit HostPin(std::string name, Transport& transport,
+                   WireFormat format = WireFormat::kJson)
+      : name_{std::move(name)}, transport_{transport}, format_{format} {}
+  ~HostPin() override;
   HostPin(const HostPin&) = delete;
   HostPin(HostPin&&) = delete;
   auto operator=(const HostPin&) -> HostPin& = delete;
@@ -26,23 +32,55 @@ class HostPin final : public BidirectionalPin, public Receiver {
   auto Toggle() -> std::expected<void, common::Error> override;
   auto Get() -> std::expected<PinState, common::Error> override;
 
-  auto SetInterruptHandler(std::function<void()> handler,
-                           PinTransition transition)
+  auto SetInterruptHandler(InterruptHandler handler, PinTransition transition)
       -> std::expected<void, common::Error> override;
   auto Receive(const std::string_view& message)
       -> std::expected<std::string, common::Error> override;
+  auto ReceiveInto(const std::string_view& message, std::string& reply)
+      -> std::expected<void, common::Error> override;
+
+  // Posted writes: SetHigh(), SetLow() and Toggle() return as soon as the
+  // request is sent instead of waiting for the emulator's reply. A write
+  // the emulator rejects is reported to error_handler once the reply is
+  // read, during a later blocking operation or Transport::Poll(). An empty
+  // handler restores blocking writes.
+  auto SetPostedWrites(std::function<void(common::Error)> error_handler)
+      -> void;
+
+  // Runs the interrupt handler on loop instead of the transport's server
+  // thread, which then never waits on application code
+  auto SetEventLoop(common::EventLoop& loop) -> void { event_loop_ = &loop; }
 
  private:
   auto SendState(PinState state) -> std::expected<void, common::Error>;
+  auto PostState(PinState state) -> std::expected<void, common::Error>;
   auto GetState() -> std::expected<PinState, common::Error>;
   auto CheckAndInvokeHandler(PinState prev_state, PinState cur_state) -> void;
+  auto IsCached() const -> bool;
+  auto Cache(PinState state, uint32_t invalidations) -> void;
 
   const std::string name_;
   Transport& transport_;
+  const WireFormat format_;
+  // Reused for the replies to blocking requests
+  ReplyBuffer reply_buffer_{};
   PinDirection direction_{PinDirection::kOutput};
-  PinState state_{PinState::kHighZ};
+  // Also read by ReceiveInto() on the transport's server thread
+  std::atomic<PinState> state_{PinState::kHighZ};
+  // Write-through cache: while valid, state_ is the level the emulator has
+  // for this output pin, so writes of that level and reads can be skipped.
+  // ReceiveInto() invalidates it from the server thread by bumping
+  // invalidations_; a level is only cached under the count read before its
+  // request was sent, so an invalidation racing the request is not lost.
+  bool state_cached_{false};
+  uint32_t cached_invalidations_{0};
+  std::atomic<uint32_t> invalidations_{0};
+  std::function<void(common::Error)> posted_error_handler_{};
+  // Ids of the posted writes awaiting their reply
+  std::vector<uint32_t> posted_{};
   PinTransition transition_{PinTransition::kBoth};
-  std::function<void()> handler_{};
+  InterruptHandler handler_{};
+  common::EventLoop* event_loop_{nullptr};
 };
 
 }  // namespace mcu
@@ -0,0 +1,80 @@
+#include "host_timer.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
+
+namespace mcu {
+
+auto HostTimer::StartOnce(std::chrono::microseconds delay,
+                          TimerCallback callback)
+    -> std::expected<void, common::Error> {
+  if (delay.count() < 0) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  return Start(delay, std::chrono::microseconds{0}, std::move(callback));
+}
+
+auto HostTimer::StartPeriodic(std::chrono::microseconds period,
+                              TimerCallback callback)
+    -> std::expected<void, common::Error> {
+  if (period.count() <= 0) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  return Start(period, period, std::move(callback));
+}
+
+auto HostTimer::Stop() -> void {
+  ++generation_;
+  running_ = false;
+}
+
+auto HostTimer::Start(std::chrono::microseconds delay,
+                      std::chrono::microseconds period, TimerCallback callback)
+    -> std::expected<void, common::Error> {
+  if (!callback) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  Stop();
+  callback_ = std::move(callback);
+  period_ = period;
+  running_ = true;
+  Schedule(event_loop_.Now() + delay);
+  return {};
+}
+
+auto HostTimer::Schedule(Clock::time_point due) -> void {
+  event_loop_.PostAt(due, [this, alive = std::weak_ptr{alive_},
+                            generation = generation_, due]() {
+    if (!alive.expired()) {
+      Expire(generation, due);
+    }
+  });
+}
+
+auto HostTimer::Expire(uint64_t generation, Clock::time_point due) -> void {
+  if (generation != generation_) {
+    return;
+  }
+  if (period_.count() > 0) {
+    // From the deadline rather than from now, so a late run does not
+    // push back the ones after it
+    Schedule(due + period_);
+  } else {
+    running_ = false;
+  }
+  // The callback may restart the timer, replacing itself, so it runs from
+  // a local and goes back only if it did not
+  auto callback{std::move(callback_)};
+  callback();
+  if (generation == generation_ && running_) {
+    callback_ = std::move(callback);
+  }
+}
+
+}  // namespace mcu
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <memory>
+
+#include "libs/common/error.hpp"
+#include "libs/common/event_loop.hpp"
+#include "libs/mcu/callback.hpp"
+#include "libs/mcu/timer.hpp"
+
+namespace mcu {
+
+// Timer on the board's event loop.
+//
+// Every HostTimer shares the loop's one thread and its timer queue, so any
+// number of them cost a queue entry each rather than a thread each, and
+// the loop sleeps until the earliest is due. In simulated time the loop
+// skips straight to it. Callbacks run on the loop like any other task.
+//
+// The loop's deadline heap is the final design here, not a stand-in for
+// common::TimingWheel. The wheel counts ticks that something has to
+// deliver. On the target, SysTick delivers them for free, but a host loop
+// would have to wake every tick, or work out from a heap when the next
+// one matters. A host runs a handful of timers, and the heap already
+// sleeps until exactly the next deadline, in real or simulated time, at
+// O(log n) per timer.
+//
+// Start and stop the timer from the loop's thread, or before Run().
+class HostTimer final : public Timer {
+ public:
+  explicit HostTimer(common::EventLoop& event_loop)
+      : event_loop_{event_loop} {}
+  HostTimer(const HostTimer&) = delete;
+  HostTimer(HostTimer&&) = delete;
+  auto operator=(const HostTimer&) -> HostTimer& = delete;
+  auto operator=(HostTimer&&) -> HostTimer& = delete;
+  ~HostTimer() override = default;
+
+  auto StartOnce(std::chrono::microseconds delay, TimerCallback callback)
+      -> std::expected<void, common::Error> override;
+  auto StartPeriodic(std::chrono::microseconds period, TimerCallback callback)
+      -> std::expected<void, common::Error> override;
+  auto Stop() -> void override;
+  [[nodiscard]] auto IsRunning() const -> bool override { return running_; }
+
+ private:
+  using Clock = common::EventLoop::Clock;
+
+  auto Start(std::chrono::microseconds delay, std::chrono::microseconds period,
+             TimerCallback callback) -> std::expected<void, common::Error>;
+  auto Schedule(Clock::time_point due) -> void;
+  auto Expire(uint64_t generation, Clock::time_point due) -> void;
+
+  common::EventLoop& event_loop_;
+  TimerCallback callback_{};
+  // Zero for a one-shot timer
+  std::chrono::microseconds period_{0};
+  // Bumped by every Start() and Stop(). The loop cannot take back a posted
+  // expiry, so one from an earlier generation is ignored instead.
+  uint64_t generation_{0};
+  bool running_{false};
+  // Posted expiries hold it weakly and find it gone once the timer is
+  // destroyed, which is how they outlive it safely
+  std::shared_ptr<const bool> alive_{std::make_shared<const bool>(true)};
+};
+
+}  // namespace mcu
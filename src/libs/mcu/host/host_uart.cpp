@@ -1,20 +1,62 @@
 #include "libs/mcu/host/host_uart.hpp"
 
-#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
-#include <functional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "libs/common/error.hpp"
-#include "libs/mcu/host/emulator_message_json_encoder.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/emulator_message_stream_decoder.hpp"
 #include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/uart.hpp"
 
 namespace mcu {
+namespace {
+
+auto ParseSendResponse(std::string_view reply)
+    -> std::expected<void, common::Error> {
+  auto response = DecodeMessage<UartEmulatorResponse>(reply);
+  if (!response) {
+    return std::unexpected(response.error());
+  }
+  if (response->status != common::Error::kOk) {
+    return std::unexpected(response->status);
+  }
+  return {};
+}
+
+// Decodes the payload straight into the caller's buffer
+auto ParseReceiveResponse(std::string_view reply, std::span<std::byte> buffer)
+    -> std::expected<size_t, common::Error> {
+  MessageView response{.data = buffer};
+  auto decoded{DecodeInto(reply, response)};
+  if (!decoded) {
+    return std::unexpected(decoded.error());
+  }
+  if (response.type != MessageType::kResponse ||
+      response.object != ObjectType::kUart) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  if (response.status != common::Error::kOk) {
+    return std::unexpected(response.status);
+  }
+  return response.data_size;
+}
+
+}  // namespace
+
+// The reply handlers of async operations refer to this object
+HostUart::~HostUart() {
+  for (const auto id : in_flight_) {
+    transport_.Cancel(id);
+  }
+}
 
 auto HostUart::Init(const UartConfig& config)
     -> std::expected<void, common::Error> {
@@ -33,10 +75,6 @@ auto HostUart::Send(std::span<const std::byte> data)
     return std::unexpected(common::Error::kInvalidState);
   }
 
-  if (busy_) {
-    return std::unexpected(common::Error::kInvalidOperation);
-  }
-
   const UartEmulatorRequest request{
       .type = MessageType::kRequest,
       .object = ObjectType::kUart,
@@ -45,20 +83,18 @@ auto HostUart::Send(std::span<const std::byte> data)
       .data = std::vector<std::byte>(data.begin(), data.end()),
       .size = 0,
       .timeout_ms = 0,
+      .id = 0,
   };
 
-  return transport_.Send(Encode(request))
-      .and_then([this]() { return transport_.Receive(); })
-      .and_then([](const std::string& response_str)
-                    -> std::expected<void, common::Error> {
-        auto response = Decode<UartEmulatorResponse>(response_str);
-        if (!response) {
-          return std::unexpected(response.error());
-        }
-        if (response->status != common::Error::kOk) {
-          return std::unexpected(response->status);
-        }
-        return {};
+  return EncodeMessage(request, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this]() {
+        return reply_buffer_.Receive(transport_, MaxFrameSize(name_.size(), 0));
+      })
+      .and_then([](std::string_view response_str) {
+        return ParseSendResponse(response_str);
       });
 }
 
@@ -68,8 +104,10 @@ auto HostUart::Receive(std::span<std::byte> buffer, uint32_t timeout_ms)
     return std::unexpected(common::Error::kInvalidState);
   }
 
-  if (busy_) {
-    return std::unexpected(common::Error::kInvalidOperation);
+  // Data the emulator already pushed is served without a round trip, the
+  // way a driver reads the ring its RX interrupt fills
+  if (rx_buffer_.Size() > 0) {
+    return rx_buffer_.Pop(buffer);
   }
 
   const UartEmulatorRequest request{
@@ -80,42 +118,30 @@ auto HostUart::Receive(std::span<std::byte> buffer, uint32_t timeout_ms)
       .data = {},
       .size = buffer.size(),
       .timeout_ms = timeout_ms,
+      .id = 0,
   };
 
-  return transport_.Send(Encode(request))
-      .and_then([this]() { return transport_.Receive(); })
-      .and_then([](const std::string& response_str) {
-        return Decode<UartEmulatorResponse>(response_str);
+  return EncodeMessage(request, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
       })
-      .and_then([buffer](const UartEmulatorResponse& response)
-                    -> std::expected<size_t, common::Error> {
-        if (response.status != common::Error::kOk) {
-          return std::unexpected(response.status);
-        }
-
-        // Copy received data to buffer
-        const size_t bytes_to_copy{
-            std::min(buffer.size(), response.data.size())};
-        std::copy_n(response.data.begin(), bytes_to_copy, buffer.begin());
-
-        return bytes_to_copy;
+      .and_then([this, buffer]() {
+        return reply_buffer_.Receive(
+            transport_, MaxFrameSize(name_.size(), buffer.size()));
+      })
+      .and_then([buffer](std::string_view response_str) {
+        return ParseReceiveResponse(response_str, buffer);
       });
 }
 
 auto HostUart::SendAsync(std::span<const std::byte> data,
-                         std::function<void(std::expected<void, common::Error>)>
-                             callback) -> std::expected<void, common::Error> {
+                         CompletionCallback<void> callback)
+    -> std::expected<void, common::Error> {
   if (!initialized_) {
     return std::unexpected(common::Error::kInvalidState);
   }
 
-  if (busy_) {
-    return std::unexpected(common::Error::kInvalidOperation);
-  }
-
-  busy_ = true;
-  send_callback_ = std::move(callback);
-
+  const auto id{transport_.NextId()};
   const UartEmulatorRequest request{
       .type = MessageType::kRequest,
       .object = ObjectType::kUart,
@@ -124,35 +150,40 @@ auto HostUart::SendAsync(std::span<const std::byte> data,
       .data = std::vector<std::byte>(data.begin(), data.end()),
       .size = 0,
       .timeout_ms = 0,
+      .id = id,
   };
 
-  auto result = transport_.Send(Encode(request));
-  if (!result) {
-    busy_ = false;
-    send_callback_ = {};
-    return std::unexpected(result.error());
+  auto frame{EncodeMessage(request, format_)};
+  if (!frame) {
+    return std::unexpected(frame.error());
   }
-
-  // Response will come asynchronously via Receive() method
-  return {};
+  // Completed by the transport when the reply with this id arrives
+  auto result = transport_.SendAsync(
+      *frame, id,
+      [this, id, callback = std::move(callback)](
+          std::expected<std::string_view, common::Error> reply) {
+        std::erase(in_flight_, id);
+        callback(reply.and_then(ParseSendResponse));
+      });
+  if (result) {
+    in_flight_.push_back(id);
+  }
+  return result;
 }
 
-auto HostUart::ReceiveAsync(
-    std::span<std::byte> buffer,
-    std::function<void(std::expected<size_t, common::Error>)> callback)
+auto HostUart::ReceiveAsync(std::span<std::byte> buffer,
+                            CompletionCallback<size_t> callback)
     -> std::expected<void, common::Error> {
   if (!initialized_) {
     return std::unexpected(common::Error::kInvalidState);
   }
 
-  if (busy_) {
-    return std::unexpected(common::Error::kInvalidOperation);
+  if (rx_buffer_.Size() > 0) {
+    callback(rx_buffer_.Pop(buffer));
+    return {};
   }
 
-  busy_ = true;
-  receive_callback_ = std::move(callback);
-  receive_buffer_.resize(buffer.size());
-
+  const auto id{transport_.NextId()};
   const UartEmulatorRequest request{
       .type = MessageType::kRequest,
       .object = ObjectType::kUart,
@@ -161,28 +192,32 @@ auto HostUart::ReceiveAsync(
       .data = {},
       .size = buffer.size(),
       .timeout_ms = 0,
+      .id = id,
   };
 
-  auto result = transport_.Send(Encode(request));
-  if (!result) {
-    busy_ = false;
-    receive_callback_ = {};
-    receive_buffer_.clear();
-    return std::unexpected(result.error());
+  auto frame{EncodeMessage(request, format_)};
+  if (!frame) {
+    return std::unexpected(frame.error());
   }
-
-  // Response will come asynchronously via Receive() method
-  // The buffer span will be filled when response arrives
-  return {};
+  // As with DMA, buffer must stay valid until the callback runs
+  auto result = transport_.SendAsync(
+      *frame, id,
+      [this, id, buffer, callback = std::move(callback)](
+          std::expected<std::string_view, common::Error> reply) {
+        std::erase(in_flight_, id);
+        callback(reply.and_then([buffer](std::string_view response) {
+          return ParseReceiveResponse(response, buffer);
+        }));
+      });
+  if (result) {
+    in_flight_.push_back(id);
+  }
+  return result;
 }
 
-auto HostUart::IsBusy() const -> bool { return busy_; }
+auto HostUart::IsBusy() const -> bool { return !in_flight_.empty(); }
 
-auto HostUart::Available() const -> size_t {
-  // For host implementation, we don't maintain a receive buffer
-  // Always return 0 (data is retrieved on-demand from emulator)
-  return 0;
-}
+auto HostUart::Available() const -> size_t { return rx_buffer_.Size(); }
 
 auto HostUart::Flush() -> std::expected<void, common::Error> {
   if (!initialized_) {
@@ -194,8 +229,8 @@ auto HostUart::Flush() -> std::expected<void, common::Error> {
   return {};
 }
 
-auto HostUart::SetRxHandler(std::function<void(const std::byte*, size_t)>
-                                handler) -> std::expected<void, common::Error> {
+auto HostUart::SetRxHandler(RxHandler handler)
+    -> std::expected<void, common::Error> {
   if (!initialized_) {
     return std::unexpected(common::Error::kInvalidState);
   }
@@ -204,96 +239,86 @@ auto HostUart::SetRxHandler(std::function<void(const std::byte*, size_t)>
   return {};
 }
 
-auto HostUart::Receive(const std::string_view& message)
-    -> std::expected<std::string, common::Error> {
-  // First, try to decode as a request (unsolicited data)
-  auto request_result = Decode<UartEmulatorRequest>(message);
-
-  // Handle unsolicited incoming data from emulator (Request type)
-  if (request_result && request_result->type == MessageType::kRequest) {
-    const auto& request = *request_result;
-
-    // Verify this message is for us
-    if (request.name != name_) {
-      return std::unexpected(common::Error::kInvalidArgument);
-    }
-
-    // Only handle "Receive" operation (emulator pushing data to device)
-    if (request.operation != OperationType::kReceive) {
-      return std::unexpected(common::Error::kInvalidOperation);
+// Earlier posts may have emptied the buffer already, in which case there is
+// nothing left to do
+auto HostUart::DeliverBuffered() -> void {
+  std::array<std::byte, 64> chunk{};
+  for (auto size{rx_buffer_.Pop(chunk)}; size > 0;
+       size = rx_buffer_.Pop(chunk)) {
+    if (rx_handler_) {
+      rx_handler_(chunk.data(), size);
     }
+  }
+}
 
-    // Invoke RxHandler if registered
-    if (rx_handler_ && !request.data.empty()) {
-      rx_handler_(request.data.data(), request.data.size());
-    }
+auto HostUart::Receive(const std::string_view& message)
+    -> std::expected<std::string, common::Error> {
+  std::string reply{};
+  auto result{ReceiveInto(message, reply)};
+  if (!result) {
+    return std::unexpected(result.error());
+  }
+  return reply;
+}
 
-    // Send acknowledgment response
-    const UartEmulatorResponse ack_response{
-        .type = MessageType::kResponse,
-        .object = ObjectType::kUart,
-        .name = name_,
-        .data = {},
-        .bytes_transferred = request.data.size(),
-        .status = common::Error::kOk,
-    };
-
-    return Encode(ack_response);
+auto HostUart::ReceiveInto(const std::string_view& message, std::string& reply)
+    -> std::expected<void, common::Error> {
+  // Neither format spends less than one character per payload byte
+  if (push_payload_.size() < message.size()) {
+    push_payload_.resize(message.size());
   }
+  MessageView request{.data = push_payload_};
+  auto decoded{DecodeInto(message, request)};
 
-  // Handle async operation responses
-  auto response_result = Decode<UartEmulatorResponse>(message);
-  if (!response_result) {
+  // Replies to our own requests are completed by the transport, so only
+  // unsolicited data from the emulator (Request type) is for us
+  if (!decoded || request.type != MessageType::kRequest ||
+      request.object != ObjectType::kUart) {
     return std::unexpected(common::Error::kInvalidArgument);
   }
-  const auto& response = *response_result;
 
   // Verify this message is for us
-  if (response.name != name_) {
+  if (request.name.View() != name_) {
     return std::unexpected(common::Error::kInvalidArgument);
   }
 
-  if (!busy_) {
-    return std::unexpected(common::Error::kInvalidState);
+  // Only handle "Receive" operation (emulator pushing data to device)
+  if (request.operation != OperationType::kReceive) {
+    return std::unexpected(common::Error::kInvalidOperation);
   }
 
-  // Handle async send response
-  if (send_callback_) {
-    auto callback = std::move(send_callback_);
-    send_callback_ = {};
-    busy_ = false;
-
-    if (response.status != common::Error::kOk) {
-      callback(std::unexpected(response.status));
-    } else {
-      callback({});
+  // Hand the data to the RxHandler if registered, otherwise buffer it
+  // for Receive(). With an event loop the handler runs there, after the
+  // data has been buffered.
+  const auto data{request.Payload()};
+  size_t accepted{data.size()};
+  if (rx_handler_ && event_loop_ != nullptr) {
+    accepted = rx_buffer_.Push(data);
+    overruns_.fetch_add(data.size() - accepted, std::memory_order_relaxed);
+    if (accepted > 0) {
+      event_loop_->Post([this]() { DeliverBuffered(); });
     }
-    return std::string{};  // Message consumed
-  }
-
-  // Handle async receive response
-  if (receive_callback_) {
-    auto callback = std::move(receive_callback_);
-    receive_callback_ = {};
-    busy_ = false;
-
-    if (response.status != common::Error::kOk) {
-      receive_buffer_.clear();
-      callback(std::unexpected(response.status));
-    } else {
-      // Copy received data to buffer (stored for the callback)
-      const size_t bytes_received{response.bytes_transferred};
-      receive_buffer_.resize(bytes_received);
-      std::copy_n(response.data.begin(), bytes_received,
-                  receive_buffer_.begin());
-      callback(bytes_received);
+  } else if (rx_handler_) {
+    if (!data.empty()) {
+      rx_handler_(data.data(), data.size());
     }
-    return std::string{};  // Message consumed
+  } else {
+    accepted = rx_buffer_.Push(data);
+    overruns_.fetch_add(data.size() - accepted, std::memory_order_relaxed);
   }
 
-  // No callback registered - unexpected state
-  busy_ = false;
-  return std::unexpected(common::Error::kInvalidState);
+  // Send acknowledgment response
+  const UartEmulatorResponse ack_response{
+      .type = MessageType::kResponse,
+      .object = ObjectType::kUart,
+      .name = name_,
+      .data = {},
+      .bytes_transferred = accepted,
+      .status = common::Error::kOk,
+      .id = request.id,
+  };
+
+  return EncodeMessage(ack_response, FormatOf(message), reply);
 }
 
 }  // namespace mcu
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <string>
 #include <vector>
 
+#include "libs/common/event_loop.hpp"
+#include "libs/common/spsc_ring.hpp"
+#include "libs/mcu/callback.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/host/receiver.hpp"
 #include "libs/mcu/host/transport.hpp"
 #include "libs/mcu/uart.hpp"
@@ -13,9 +18,16 @@ namespace mcu {
 
 class HostUart final : public Uart, public Receiver {
  public:
-  explicit HostUart(std::string name, Transport& transport)
-      : name_{std::move(name)}, transport_{transport} {}
-  ~HostUart() override = default;
+  static constexpr size_t kDefaultRxBufferSize{256};
+
+  explicit HostUart(std::string name, Transport& transport,
+                    WireFormat format = WireFormat::kJson,
+                    size_t rx_buffer_size = kDefaultRxBufferSize)
+      : name_{std::move(name)},
+        transport_{transport},
+        format_{format},
+        rx_buffer_{rx_buffer_size} {}
+  ~HostUart() override;
   HostUart(const HostUart&) = delete;
   HostUart(HostUart&&) = delete;
   auto operator=(const HostUart&) -> HostUart& = delete;
@@ -32,41 +44,63 @@ class HostUart final : public Uart, public Receiver {
       -> std::expected<size_t, common::Error> override;
 
   auto SendAsync(std::span<const std::byte> data,
-                 std::function<void(std::expected<void, common::Error>)>
-                     callback) -> std::expected<void, common::Error> override;
+                 CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override;
 
-  auto ReceiveAsync(
-      std::span<std::byte> buffer,
-      std::function<void(std::expected<size_t, common::Error>)> callback)
+  auto ReceiveAsync(std::span<std::byte> buffer,
+                    CompletionCallback<size_t> callback)
       -> std::expected<void, common::Error> override;
 
   auto IsBusy() const -> bool override;
   auto Available() const -> size_t override;
   auto Flush() -> std::expected<void, common::Error> override;
 
-  auto SetRxHandler(std::function<void(const std::byte*, size_t)> handler)
+  auto SetRxHandler(RxHandler handler)
       -> std::expected<void, common::Error> override;
 
   // Receiver interface for handling async responses from emulator
   auto Receive(const std::string_view& message)
       -> std::expected<std::string, common::Error> override;
+  auto ReceiveInto(const std::string_view& message, std::string& reply)
+      -> std::expected<void, common::Error> override;
+
+  // Bytes pushed by the emulator and dropped because the receive buffer was
+  // full
+  auto Overruns() const -> size_t {
+    return overruns_.load(std::memory_order_relaxed);
+  }
+
+  // Runs the RxHandler on loop instead of the transport's server thread.
+  // Incoming data then goes through the receive buffer, so a handler that
+  // falls behind drops bytes (see Overruns()) rather than stalling the
+  // emulator.
+  auto SetEventLoop(common::EventLoop& loop) -> void { event_loop_ = &loop; }
 
  private:
+  // Hands everything in rx_buffer_ to the RxHandler; runs on the event loop
+  auto DeliverBuffered() -> void;
+
   const std::string name_;
   Transport& transport_;
+  const WireFormat format_;
+  // Reused for the replies to blocking requests
+  ReplyBuffer reply_buffer_{};
   UartConfig config_{};
   bool initialized_{false};
-  bool busy_{false};
-
-  // Async callback storage
-  std::function<void(std::expected<void, common::Error>)> send_callback_{};
-  std::function<void(std::expected<size_t, common::Error>)> receive_callback_{};
+  // Ids of the async operations awaiting their reply; several may overlap
+  std::vector<uint32_t> in_flight_{};
 
   // Receive handler for unsolicited incoming data
-  std::function<void(const std::byte*, size_t)> rx_handler_{};
-
-  // Receive buffer for async operations
-  std::vector<std::byte> receive_buffer_{};
+  RxHandler rx_handler_{};
+  // Unsolicited data when no handler is set, or when one is set along with
+  // an event loop, filled on the transport's server thread and drained on
+  // the application thread
+  common::SpscRing<std::byte> rx_buffer_;
+  std::atomic<size_t> overruns_{0};
+  // Pushed payloads are decoded into this on the server thread. It grows to
+  // the largest frame seen and is then reused.
+  std::vector<std::byte> push_payload_{};
+  common::EventLoop* event_loop_{nullptr};
 };
 
 }  // namespace mcu
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/emulator_message_stream_decoder.hpp"
+#include "transport.hpp"
+
+namespace mcu {
+
+// Correlation-id bookkeeping shared by the transports. Not thread-safe: like
+// the request socket or ring it serves, it belongs to the application thread.
+class InFlightRequests {
+ public:
+  auto NextId() -> uint32_t {
+    // 0 marks untracked messages, so skip it on wrap-around
+    if (++next_id_ == 0) {
+      ++next_id_;
+    }
+    return next_id_;
+  }
+
+  // Whether id may be used for a new request
+  auto CanAdd(uint32_t id) const -> bool {
+    return id != 0 && !handlers_.contains(id) && !cancelled_.contains(id);
+  }
+
+  auto Add(uint32_t id, ResponseHandler handler)
+      -> std::expected<void, common::Error> {
+    if (!CanAdd(id)) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    handlers_.emplace(id, std::move(handler));
+    return {};
+  }
+
+  // Runs and retires the handler waiting for frame, if there is one
+  auto Complete(std::string_view frame) -> bool {
+    if (handlers_.empty() && cancelled_.empty()) {
+      return false;
+    }
+    MessageHeader header{};
+    if (!PeekHeader(frame, header) || header.id == 0) {
+      return false;
+    }
+    if (cancelled_.erase(header.id) != 0) {
+      return true;  // Late reply to a cancelled request; drop it
+    }
+    auto node{handlers_.extract(header.id)};
+    if (node.empty()) {
+      return false;
+    }
+    if (node.mapped()) {
+      node.mapped()(frame);
+    }
+    return true;
+  }
+
+  // Drops the handler for id. Its id is remembered so that a late reply is
+  // still recognised and discarded rather than taken for the reply to a
+  // later blocking request, but it no longer counts as in flight: the
+  // emulator may never answer it.
+  auto Cancel(uint32_t id) -> void {
+    if (handlers_.erase(id) != 0) {
+      cancelled_.insert(id);
+    }
+  }
+
+  // Whether any request is still waiting for its handler to run
+  auto Empty() const -> bool { return handlers_.empty(); }
+
+ private:
+  std::unordered_map<uint32_t, ResponseHandler> handlers_{};
+  std::unordered_set<uint32_t> cancelled_{};
+  uint32_t next_id_{0};
+};
+
+}  // namespace mcu
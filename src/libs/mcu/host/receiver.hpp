@@ -2,6 +2,7 @@
 
 #include <expected>
 #include <string>
+#include <string_view>
 
 #include "libs/common/error.hpp"
 
@@ -11,6 +12,19 @@ class Receiver {
  public:
   virtual auto Receive(const std::string_view& message)
       -> std::expected<std::string, common::Error> = 0;
+
+  // Writes the reply into a buffer owned by the caller, letting a transport
+  // reuse one allocation for every message. Receivers on a hot path
+  // override this; the default goes through Receive().
+  virtual auto ReceiveInto(const std::string_view& message, std::string& reply)
+      -> std::expected<void, common::Error> {
+    auto result{Receive(message)};
+    if (!result) {
+      return std::unexpected(result.error());
+    }
+    reply.assign(*result);
+    return {};
+  }
 };
 
 }  // namespace mcu
@@ -0,0 +1,216 @@
+#include "shm_ring.hpp"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "libs/common/error.hpp"
+
+namespace mcu {
+namespace {
+
+using Atomic = std::atomic<uint32_t>;
+
+// Polls before sleeping; a reply from a busy peer usually lands within this.
+// Spinning only delays the peer when both share a single CPU.
+auto SpinCount() -> int {
+  static const int count{std::thread::hardware_concurrency() > 1 ? 2000 : 0};
+  return count;
+}
+
+// Upper bound on one futex sleep, so a peer that cannot issue futex wakes
+// still gets noticed
+constexpr std::chrono::milliseconds kMaxSleep{10};
+
+auto CpuRelax() -> void {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// The segment is shared between processes, so the non-private futex
+// operations are required
+auto FutexWait(Atomic* word, uint32_t seen, std::chrono::nanoseconds timeout)
+    -> void {
+  const auto seconds{std::chrono::duration_cast<std::chrono::seconds>(timeout)};
+  const timespec relative{.tv_sec = seconds.count(),
+                          .tv_nsec = (timeout - seconds).count()};
+  syscall(SYS_futex, word, FUTEX_WAIT, seen, &relative, nullptr, 0);
+}
+
+auto FutexWake(Atomic* word) -> void {
+  syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// Waits until word no longer holds seen. Returns false if deadline passes
+// first.
+auto WaitForChange(Atomic* word, uint32_t seen, Atomic* waiting,
+                   std::chrono::steady_clock::time_point deadline) -> bool {
+  for (int i = 0; i < SpinCount(); ++i) {
+    if (word->load(std::memory_order_acquire) != seen) {
+      return true;
+    }
+    CpuRelax();
+  }
+  while (true) {
+    const auto now{std::chrono::steady_clock::now()};
+    if (now >= deadline) {
+      return word->load(std::memory_order_acquire) != seen;
+    }
+    // Publishing the flag before the final check pairs with the peer
+    // updating word before checking the flag, so a wake cannot be missed
+    waiting->store(1, std::memory_order_seq_cst);
+    if (word->load(std::memory_order_seq_cst) == seen) {
+      FutexWait(word, seen,
+                std::min<std::chrono::nanoseconds>(deadline - now, kMaxSleep));
+    }
+    waiting->store(0, std::memory_order_relaxed);
+    if (word->load(std::memory_order_acquire) != seen) {
+      return true;
+    }
+  }
+}
+
+auto EncodeLength(uint32_t length) -> std::array<char, sizeof(uint32_t)> {
+  return {static_cast<char>(length & 0xFFU),
+          static_cast<char>((length >> 8U) & 0xFFU),
+          static_cast<char>((length >> 16U) & 0xFFU),
+          static_cast<char>((length >> 24U) & 0xFFU)};
+}
+
+auto DecodeLength(const std::array<unsigned char, sizeof(uint32_t)>& bytes)
+    -> uint32_t {
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8U) |
+         (static_cast<uint32_t>(bytes[2]) << 16U) |
+         (static_cast<uint32_t>(bytes[3]) << 24U);
+}
+
+}  // namespace
+
+auto ShmRing::Write(std::string_view frame, bool more,
+                    std::chrono::steady_clock::time_point deadline)
+    -> std::expected<void, common::Error> {
+  const size_t record{sizeof(uint32_t) + frame.size()};
+  if (frame.size() >= kMoreFlag || record > capacity_) {
+    return std::unexpected(common::Error::kMessageTooLarge);
+  }
+
+  // Only this side writes head, so a relaxed load sees our own last store
+  const uint32_t head{head_->load(std::memory_order_relaxed)};
+  while (true) {
+    const uint32_t tail{tail_->load(std::memory_order_acquire)};
+    if (capacity_ - (head - tail) >= record) {
+      break;
+    }
+    if (!WaitForChange(tail_, tail, producer_waiting_, deadline)) {
+      return std::unexpected(common::Error::kTimeout);
+    }
+  }
+
+  const auto length{EncodeLength(static_cast<uint32_t>(frame.size()) |
+                                 (more ? kMoreFlag : 0U))};
+  CopyIn(head, length.data(), length.size());
+  CopyIn(head + sizeof(uint32_t), frame.data(), frame.size());
+  head_->store(head + static_cast<uint32_t>(record),
+               std::memory_order_seq_cst);
+  if (consumer_waiting_->load(std::memory_order_seq_cst) != 0) {
+    FutexWake(head_);
+  }
+  return {};
+}
+
+auto ShmRing::Read(std::string& out, bool& more,
+                   std::chrono::steady_clock::time_point deadline)
+    -> std::expected<void, common::Error> {
+  auto size{NextFrame(more, deadline)};
+  if (!size) {
+    return std::unexpected(size.error());
+  }
+  out.resize(*size);
+  PopFrame(out.data(), *size);
+  return {};
+}
+
+auto ShmRing::Read(std::span<char> out, bool& more,
+                   std::chrono::steady_clock::time_point deadline)
+    -> std::expected<size_t, common::Error> {
+  auto size{NextFrame(more, deadline)};
+  if (!size) {
+    return std::unexpected(size.error());
+  }
+  if (*size > out.size()) {
+    return std::unexpected(common::Error::kMessageTooLarge);
+  }
+  PopFrame(out.data(), *size);
+  return *size;
+}
+
+auto ShmRing::NextFrame(bool& more,
+                        std::chrono::steady_clock::time_point deadline)
+    -> std::expected<uint32_t, common::Error> {
+  // Only this side writes tail, so a relaxed load sees our own last store
+  const uint32_t tail{tail_->load(std::memory_order_relaxed)};
+  while (head_->load(std::memory_order_acquire) == tail) {
+    if (!WaitForChange(head_, tail, consumer_waiting_, deadline)) {
+      return std::unexpected(common::Error::kTimeout);
+    }
+  }
+
+  std::array<unsigned char, sizeof(uint32_t)> length_bytes{};
+  CopyOut(tail, length_bytes.data(), length_bytes.size());
+  const uint32_t length{DecodeLength(length_bytes)};
+  const uint32_t size{length & ~kMoreFlag};
+  if (sizeof(uint32_t) + size > capacity_) {
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+  more = (length & kMoreFlag) != 0;
+  return size;
+}
+
+auto ShmRing::PopFrame(char* dst, uint32_t size) -> void {
+  const uint32_t tail{tail_->load(std::memory_order_relaxed)};
+  CopyOut(tail + sizeof(uint32_t), dst, size);
+  tail_->store(tail + static_cast<uint32_t>(sizeof(uint32_t)) + size,
+               std::memory_order_seq_cst);
+  if (producer_waiting_->load(std::memory_order_seq_cst) != 0) {
+    FutexWake(tail_);
+  }
+}
+
+auto ShmRing::CopyIn(uint32_t position, const void* src, size_t size)
+    -> void {
+  const size_t offset{position & (capacity_ - 1)};
+  const size_t first{std::min(size, capacity_ - offset)};
+  const auto* bytes{static_cast<const std::byte*>(src)};
+  std::memcpy(data_ + offset, bytes, first);
+  std::memcpy(data_, bytes + first, size - first);
+}
+
+auto ShmRing::CopyOut(uint32_t position, void* dst, size_t size) const
+    -> void {
+  const size_t offset{position & (capacity_ - 1)};
+  const size_t first{std::min(size, capacity_ - offset)};
+  auto* bytes{static_cast<std::byte*>(dst)};
+  std::memcpy(bytes, data_ + offset, first);
+  std::memcpy(bytes + first, data_, size - first);
+}
+
+}  // namespace mcu
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "libs/common/error.hpp"
+
+namespace mcu {
+
+// Single-producer single-consumer frame ring living in shared memory.
+//
+// The ring is a header followed by capacity bytes of data. head and tail
+// count bytes written and read since creation and wrap at 2^32, which is why
+// capacity must be a power of two. Each frame is a little-endian u32 length
+// word followed by the frame bytes; bit 31 of the length word marks a frame
+// with more frames of the same batch following it.
+//
+//   offset  size  field
+//   0       4     head              written by the producer
+//   4       4     consumer_waiting  set while the consumer sleeps on head
+//   64      4     tail              written by the consumer
+//   68      4     producer_waiting  set while the producer sleeps on tail
+//   128     n     data
+//
+// Both sides spin briefly before sleeping on a futex, and only call into the
+// kernel to wake the other side when its waiting flag is set, so a busy pair
+// exchanges frames without any syscalls. The layout is shared with the
+// Python emulator (host_emulator/shm.py) and must be kept in sync.
+class ShmRing {
+ public:
+  static constexpr size_t kHeaderSize{128};
+  static constexpr uint32_t kMoreFlag{0x80000000U};
+
+  static constexpr auto SizeFor(uint32_t capacity) -> size_t {
+    return kHeaderSize + capacity;
+  }
+
+  // base must point at SizeFor(capacity) bytes of zeroed or live ring memory
+  ShmRing(std::byte* base, uint32_t capacity)
+      : head_{Word(base, kHeadOffset)},
+        consumer_waiting_{Word(base, kConsumerWaitingOffset)},
+        tail_{Word(base, kTailOffset)},
+        producer_waiting_{Word(base, kProducerWaitingOffset)},
+        data_{base + kHeaderSize},
+        capacity_{capacity} {}
+
+  // Producer side. Waits until deadline for room; frames that can never
+  // fit fail with kMessageTooLarge.
+  auto Write(std::string_view frame, bool more,
+             std::chrono::steady_clock::time_point deadline)
+      -> std::expected<void, common::Error>;
+
+  // Consumer side. Waits until deadline for a frame and replaces the
+  // contents of out with it.
+  auto Read(std::string& out, bool& more,
+            std::chrono::steady_clock::time_point deadline)
+      -> std::expected<void, common::Error>;
+  // As above, but copies the frame into out and returns its size. A frame
+  // larger than out fails with kMessageTooLarge and stays in the ring, to
+  // be read into a bigger buffer.
+  auto Read(std::span<char> out, bool& more,
+            std::chrono::steady_clock::time_point deadline)
+      -> std::expected<size_t, common::Error>;
+
+  auto Empty() const -> bool {
+    return head_->load(std::memory_order_acquire) ==
+           tail_->load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr size_t kHeadOffset{0};
+  static constexpr size_t kConsumerWaitingOffset{4};
+  static constexpr size_t kTailOffset{64};
+  static constexpr size_t kProducerWaitingOffset{68};
+
+  using Atomic = std::atomic<uint32_t>;
+  static_assert(sizeof(Atomic) == sizeof(uint32_t) &&
+                Atomic::is_always_lock_free);
+
+  static auto Word(std::byte* base, size_t offset) -> Atomic* {
+    return reinterpret_cast<Atomic*>(base + offset);  // NOLINT
+  }
+
+  // Waits for the next frame and returns its size without consuming it
+  auto NextFrame(bool& more, std::chrono::steady_clock::time_point deadline)
+      -> std::expected<uint32_t, common::Error>;
+  // Consumes the frame NextFrame() found, copying it to dst
+  auto PopFrame(char* dst, uint32_t size) -> void;
+  auto CopyIn(uint32_t position, const void* src, size_t size) -> void;
+  auto CopyOut(uint32_t position, void* dst, size_t size) const -> void;
+
+  Atomic* head_;
+  Atomic* consumer_waiting_;
+  Atomic* tail_;
+  Atomic* producer_waiting_;
+  std::byte* data_;
+  uint32_t capacity_;
+};
+
+}  // namespace mcu
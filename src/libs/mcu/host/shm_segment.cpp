@@ -0,0 +1,162 @@
+#include "shm_segment.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "shm_ring.hpp"
+
+namespace mcu {
+namespace {
+
+constexpr size_t kMagicOffset{0};
+constexpr size_t kVersionOffset{4};
+constexpr size_t kCapacityOffset{8};
+constexpr std::chrono::milliseconds kOpenRetryDelay{10};
+
+auto HeaderWord(std::byte* base, size_t offset) -> std::atomic<uint32_t>* {
+  return reinterpret_cast<std::atomic<uint32_t>*>(base + offset);  // NOLINT
+}
+
+// shm_open() names are a single path component with a leading slash
+auto SegmentPath(const std::string& name) -> std::string {
+  return name.starts_with('/') ? name : "/" + name;
+}
+
+// Maps the segment if its creator has finished initialising it. Fails with
+// kWouldBlock when it is not ready yet and the caller should retry.
+auto TryMap(const std::string& path)
+    -> std::expected<std::pair<std::byte*, size_t>, common::Error> {
+  const int fd{shm_open(path.c_str(), O_RDWR, 0)};
+  if (fd < 0) {
+    return std::unexpected(errno == ENOENT ? common::Error::kWouldBlock
+                                           : common::Error::kOperationFailed);
+  }
+  struct stat info{};
+  if (fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < ShmSegment::kHeaderSize) {
+    close(fd);
+    return std::unexpected(common::Error::kWouldBlock);
+  }
+  const auto size{static_cast<size_t>(info.st_size)};
+  void* base{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+  close(fd);
+  if (base == MAP_FAILED) {
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+  auto* bytes{static_cast<std::byte*>(base)};
+  if (HeaderWord(bytes, kMagicOffset)->load(std::memory_order_acquire) !=
+      ShmSegment::kMagic) {
+    munmap(base, size);
+    return std::unexpected(common::Error::kWouldBlock);
+  }
+  return std::pair{bytes, size};
+}
+
+}  // namespace
+
+auto ShmSegment::Create(const std::string& name, uint32_t ring_capacity)
+    -> std::expected<std::unique_ptr<ShmSegment>, common::Error> {
+  // Positions wrap at 2^32, so the capacity must divide it evenly
+  if (ring_capacity < sizeof(uint32_t) ||
+      (ring_capacity & (ring_capacity - 1)) != 0) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+
+  const auto path{SegmentPath(name)};
+  shm_unlink(path.c_str());  // Left behind by a run that did not clean up
+  const int fd{shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)};
+  if (fd < 0) {
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+
+  // ftruncate() zero-fills, which leaves every ring empty
+  const size_t size{SizeFor(ring_capacity)};
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    shm_unlink(path.c_str());
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+  void* base{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(path.c_str());
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+
+  auto* bytes{static_cast<std::byte*>(base)};
+  HeaderWord(bytes, kVersionOffset)->store(kVersion, std::memory_order_relaxed);
+  HeaderWord(bytes, kCapacityOffset)
+      ->store(ring_capacity, std::memory_order_relaxed);
+  HeaderWord(bytes, kMagicOffset)->store(kMagic, std::memory_order_release);
+
+  return std::unique_ptr<ShmSegment>{
+      new ShmSegment{path, bytes, size, ring_capacity, true}};
+}
+
+auto ShmSegment::Open(const std::string& name,
+                      std::chrono::milliseconds timeout)
+    -> std::expected<std::unique_ptr<ShmSegment>, common::Error> {
+  const auto path{SegmentPath(name)};
+  const auto deadline{std::chrono::steady_clock::now() + timeout};
+  auto mapped{TryMap(path)};
+  while (!mapped && mapped.error() == common::Error::kWouldBlock) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return std::unexpected(common::Error::kTimeout);
+    }
+    std::this_thread::sleep_for(kOpenRetryDelay);
+    mapped = TryMap(path);
+  }
+  if (!mapped) {
+    return std::unexpected(mapped.error());
+  }
+
+  auto [bytes, size] = *mapped;
+  const uint32_t version{
+      HeaderWord(bytes, kVersionOffset)->load(std::memory_order_relaxed)};
+  const uint32_t ring_capacity{
+      HeaderWord(bytes, kCapacityOffset)->load(std::memory_order_relaxed)};
+  if (version != kVersion || size < SizeFor(ring_capacity)) {
+    munmap(bytes, size);
+    return std::unexpected(common::Error::kInvalidState);
+  }
+  return std::unique_ptr<ShmSegment>{
+      new ShmSegment{path, bytes, size, ring_capacity, false}};
+}
+
+ShmSegment::ShmSegment(std::string name, std::byte* base, size_t size,
+                       uint32_t ring_capacity, bool owner)
+    : name_{std::move(name)},
+      base_{base},
+      size_{size},
+      ring_capacity_{ring_capacity},
+      owner_{owner} {}
+
+ShmSegment::~ShmSegment() {
+  munmap(base_, size_);
+  if (owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+auto ShmSegment::Ring(ShmRingId id) -> ShmRing {
+  const auto index{static_cast<size_t>(id)};
+  const size_t offset{kHeaderSize +
+                      (index * ShmRing::SizeFor(ring_capacity_))};
+  return ShmRing{base_ + offset, ring_capacity_};
+}
+
+}  // namespace mcu
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+
+#include "libs/common/error.hpp"
+#include "shm_ring.hpp"
+
+namespace mcu {
+
+// The four rings of a segment, named after who writes them
+enum class ShmRingId : uint8_t {
+  kDeviceRequest,    // Device -> emulator requests
+  kEmulatorReply,    // Replies to kDeviceRequest
+  kEmulatorRequest,  // Emulator -> device requests
+  kDeviceReply,      // Replies to kEmulatorRequest
+};
+
+// POSIX shared-memory segment holding the rings of a ShmTransport.
+//
+//   offset              size  field
+//   0                   4     magic (kMagic), written last by the creator
+//   4                   4     version (kVersion)
+//   8                   4     ring capacity
+//   64 + i * ring size  ...   ring i, laid out as described in ShmRing
+//
+// The emulator normally creates the segment and the device opens it, the
+// same way the emulator binds and the device connects with ZeroMQ.
+class ShmSegment {
+ public:
+  static constexpr uint32_t kMagic{0x4D485345};  // "ESHM"
+  static constexpr uint32_t kVersion{1};
+  static constexpr uint32_t kDefaultRingCapacity{64 * 1024};
+  static constexpr size_t kHeaderSize{64};
+  static constexpr size_t kRingCount{4};
+
+  static constexpr auto SizeFor(uint32_t ring_capacity) -> size_t {
+    return kHeaderSize + (kRingCount * ShmRing::SizeFor(ring_capacity));
+  }
+
+  // Creates a fresh segment, replacing a stale one left behind under the
+  // same name. The segment is unlinked when the creator destroys it.
+  static auto Create(const std::string& name,
+                     uint32_t ring_capacity = kDefaultRingCapacity)
+      -> std::expected<std::unique_ptr<ShmSegment>, common::Error>;
+  // Opens a segment made by Create(), waiting up to timeout for it to exist
+  static auto Open(const std::string& name, std::chrono::milliseconds timeout)
+      -> std::expected<std::unique_ptr<ShmSegment>, common::Error>;
+
+  ShmSegment() = delete;
+  ShmSegment(const ShmSegment&) = delete;
+  ShmSegment(ShmSegment&&) = delete;
+  auto operator=(const ShmSegment&) -> ShmSegment& = delete;
+  auto operator=(ShmSegment&&) -> ShmSegment& = delete;
+  ~ShmSegment();
+
+  auto Ring(ShmRingId id) -> ShmRing;
+  auto RingCapacity() const -> uint32_t { return ring_capacity_; }
+
+ private:
+  ShmSegment(std::string name, std::byte* base, size_t size,
+             uint32_t ring_capacity, bool owner);
+
+  std::string name_;
+  std::byte* base_;
+  size_t size_;
+  uint32_t ring_capacity_;
+  bool owner_;
+};
+
+}  // namespace mcu
@@ -0,0 +1,264 @@
+#include "shm_transport.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dispatcher.hpp"
+#include "libs/common/error.hpp"
+#include "shm_segment.hpp"
+
+namespace mcu {
+namespace {
+
+auto Deadline(std::chrono::milliseconds timeout)
+    -> std::chrono::steady_clock::time_point {
+  return std::chrono::steady_clock::now() + timeout;
+}
+
+}  // namespace
+
+auto ShmTransport::Create(std::string_view endpoint, Dispatcher& dispatcher,
+                          const TransportConfig& config)
+    -> std::expected<std::unique_ptr<ShmTransport>, common::Error> {
+  config.logger.Info("Creating ShmTransport");
+
+  if (IsShmEndpoint(endpoint)) {
+    endpoint.remove_prefix(kShmEndpointScheme.size());
+  }
+  auto segment{ShmSegment::Open(std::string{endpoint}, config.connect_timeout)};
+  if (!segment) {
+    config.logger.Error("Shared memory segment not available");
+    return std::unexpected(segment.error());
+  }
+
+  try {
+    auto transport{std::make_unique<ShmTransport>(std::move(segment.value()),
+                                                  dispatcher, config)};
+    config.logger.Info("ShmTransport created successfully");
+    return transport;
+  } catch (...) {
+    config.logger.Error("Unknown error during creation");
+    return std::unexpected(common::Error::kUnknown);
+  }
+}
+
+ShmTransport::ShmTransport(std::unique_ptr<ShmSegment> segment,
+                           Dispatcher& dispatcher,
+                           const TransportConfig& config)
+    : config_{config},
+      segment_{std::move(segment)},
+      requests_{segment_->Ring(ShmRingId::kDeviceRequest)},
+      replies_{segment_->Ring(ShmRingId::kEmulatorReply)},
+      emulator_requests_{segment_->Ring(ShmRingId::kEmulatorRequest)},
+      emulator_replies_{segment_->Ring(ShmRingId::kDeviceReply)},
+      dispatcher_{dispatcher} {
+  LogDebug("Initializing ShmTransport");
+  server_thread_ = std::thread{&ShmTransport::ServerThread, this};
+}
+
+ShmTransport::~ShmTransport() {
+  LogDebug("Shutting down ShmTransport");
+  StopServing();
+  LogDebug("ShmTransport shutdown complete");
+}
+
+auto ShmTransport::StopServing() -> void {
+  // The server thread wakes at least every poll_timeout to check running_
+  running_ = false;
+  if (server_thread_.joinable()) {
+    server_thread_.join();
+  }
+}
+
+auto ShmTransport::Send(std::string_view data)
+    -> std::expected<void, common::Error> {
+  auto sent{requests_.Write(data, false, Deadline(config_.send_timeout))};
+  if (!sent) {
+    LogError("Send failed");
+  }
+  return sent;
+}
+
+auto ShmTransport::Receive() -> std::expected<std::string, common::Error> {
+  const auto deadline{Deadline(config_.recv_timeout)};
+  std::string frame{};
+  bool more{false};
+  while (true) {
+    auto read{replies_.Read(frame, more, deadline)};
+    if (!read) {
+      LogDebug("Receive failed or timed out");
+      return std::unexpected(read.error());
+    }
+    // Replies to in-flight requests may arrive ahead of the one we want
+    if (!in_flight_.Complete(frame)) {
+      return frame;
+    }
+  }
+}
+
+auto ShmTransport::Receive(std::span<char> buffer)
+    -> std::expected<size_t, common::Error> {
+  const auto deadline{Deadline(config_.recv_timeout)};
+  bool more{false};
+  while (true) {
+    auto size{replies_.Read(buffer, more, deadline)};
+    if (!size && size.error() == common::Error::kMessageTooLarge) {
+      // Too big for the caller, but it may answer an in-flight request
+      std::string frame{};
+      auto read{replies_.Read(frame, more, deadline)};
+      if (read && in_flight_.Complete(frame)) {
+        continue;
+      }
+      LogError("Receive buffer too small for reply");
+      return std::unexpected(read ? size.error() : read.error());
+    }
+    if (!size) {
+      LogDebug("Receive failed or timed out");
+      return std::unexpected(size.error());
+    }
+    // Replies to in-flight requests may arrive ahead of the one we want
+    if (!in_flight_.Complete(std::string_view{buffer.data(), *size})) {
+      return size;
+    }
+  }
+}
+
+auto ShmTransport::Enqueue(std::string_view data)
+    -> std::expected<void, common::Error> {
+  batch_.emplace_back(data);
+  return {};
+}
+
+auto ShmTransport::Flush()
+    -> std::expected<std::vector<std::string>, common::Error> {
+  if (batch_.empty()) {
+    return {};
+  }
+
+  // The batch is consumed whether or not the exchange succeeds
+  const auto batch{std::exchange(batch_, {})};
+  const auto send_deadline{Deadline(config_.send_timeout)};
+  for (size_t i = 0; i < batch.size(); ++i) {
+    auto sent{requests_.Write(batch[i], i + 1 < batch.size(), send_deadline)};
+    if (!sent) {
+      LogError("Flush send failed");
+      // As with ZeroMQ, an empty final frame tells the emulator to drop the
+      // frames already written instead of waiting for the rest
+      if (i > 0 &&
+          !requests_.Write({}, false, Deadline(config_.send_timeout))) {
+        LogError("Flush could not terminate the abandoned batch");
+      }
+      return std::unexpected(sent.error());
+    }
+  }
+
+  const auto deadline{Deadline(config_.recv_timeout)};
+  std::vector<std::string> replies{};
+  replies.reserve(batch.size());
+  std::string frame{};
+  bool more{true};
+  while (more) {
+    auto read{replies_.Read(frame, more, deadline)};
+    if (!read) {
+      LogError("Flush receive failed");
+      return std::unexpected(read.error());
+    }
+    if (replies.empty() && !more && in_flight_.Complete(frame)) {
+      more = true;  // Not part of the batch; keep waiting for it
+      continue;
+    }
+    replies.push_back(std::move(frame));
+  }
+
+  if (replies.size() != batch.size()) {
+    LogError("Flush reply count does not match request count");
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+  return replies;
+}
+
+auto ShmTransport::NextId() -> uint32_t { return in_flight_.NextId(); }
+
+auto ShmTransport::Cancel(uint32_t id) -> void { in_flight_.Cancel(id); }
+
+auto ShmTransport::HasInFlight() const -> bool { return !in_flight_.Empty(); }
+
+auto ShmTransport::SendAsync(std::string_view data, uint32_t id,
+                             ResponseHandler handler)
+    -> std::expected<void, common::Error> {
+  if (!in_flight_.CanAdd(id)) {
+    LogWarning("SendAsync failed: invalid correlation id");
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  auto sent{Send(data)};
+  if (!sent) {
+    return sent;
+  }
+  return in_flight_.Add(id, std::move(handler));
+}
+
+auto ShmTransport::Poll(std::chrono::milliseconds timeout)
+    -> std::expected<size_t, common::Error> {
+  const auto deadline{Deadline(timeout)};
+  size_t completed{0};
+  std::string frame{};
+  bool more{false};
+  while (!in_flight_.Empty()) {
+    auto read{replies_.Read(frame, more, deadline)};
+    if (!read) {
+      if (read.error() == common::Error::kTimeout) {
+        break;
+      }
+      LogError("Poll receive failed");
+      return std::unexpected(read.error());
+    }
+    if (in_flight_.Complete(frame)) {
+      ++completed;
+    } else {
+      LogWarning("Poll discarded a reply with no request in flight");
+    }
+  }
+  return completed;
+}
+
+auto ShmTransport::ServerThread() -> void {
+  LogDebug("ServerThread starting");
+  // Reused for every message so dispatch does not allocate per message
+  std::string request{};
+  std::string reply{};
+  bool more{false};
+  while (running_) {
+    auto read{emulator_requests_.Read(request, more,
+                                      Deadline(config_.poll_timeout))};
+    if (!read) {
+      if (read.error() != common::Error::kTimeout) {
+        LogError("ServerThread receive failed");
+      }
+      continue;  // Timeout - normal, check running flag
+    }
+
+    auto handled{dispatcher_.DispatchInto(request, reply)};
+    if (!handled) {
+      LogWarning("Unhandled message in dispatcher");
+    }
+    const std::string_view reply_frame{handled ? std::string_view{reply}
+                                               : std::string_view{"Unhandled"}};
+    // Mirror the request's batch framing so each frame gets one reply
+    if (!emulator_replies_.Write(reply_frame, more,
+                                 Deadline(config_.send_timeout))) {
+      LogError("ServerThread failed to send reply");
+    }
+  }
+  LogDebug("ServerThread exiting");
+}
+
+}  // namespace mcu
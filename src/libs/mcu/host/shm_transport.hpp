@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "dispatcher.hpp"
+#include "in_flight_requests.hpp"
+#include "libs/common/error.hpp"
+#include "shm_ring.hpp"
+#include "shm_segment.hpp"
+#include "transport.hpp"
+#include "transport_config.hpp"
+
+namespace mcu {
+
+// Endpoints of the form "shm://<name>" select ShmTransport
+inline constexpr std::string_view kShmEndpointScheme{"shm://"};
+
+inline auto IsShmEndpoint(std::string_view endpoint) -> bool {
+  return endpoint.starts_with(kShmEndpointScheme);
+}
+
+// Transport over a shared-memory segment created by the emulator. Requests
+// and replies travel through lock-free rings instead of sockets, so a
+// message costs two copies and, while both sides are busy, no syscalls.
+// Requests from the emulator are dispatched on a server thread, as with
+// ZmqTransport.
+class ShmTransport : public Transport {
+ public:
+  ShmTransport() = delete;
+  ShmTransport(const ShmTransport&) = delete;
+  ShmTransport(ShmTransport&&) = delete;
+  auto operator=(const ShmTransport&) -> ShmTransport& = delete;
+  auto operator=(ShmTransport&&) -> ShmTransport& = delete;
+  ~ShmTransport() override;
+
+  auto Send(std::string_view data)
+      -> std::expected<void, common::Error> override;
+  auto Receive() -> std::expected<std::string, common::Error> override;
+  auto Receive(std::span<char> buffer)
+      -> std::expected<size_t, common::Error> override;
+  // The batch is written as one run of frames chained with the ring's more
+  // flag; the emulator answers with one reply frame per request frame.
+  auto Enqueue(std::string_view data)
+      -> std::expected<void, common::Error> override;
+  auto Flush()
+      -> std::expected<std::vector<std::string>, common::Error> override;
+  auto NextId() -> uint32_t override;
+  auto SendAsync(std::string_view data, uint32_t id, ResponseHandler handler)
+      -> std::expected<void, common::Error> override;
+  auto Poll(std::chrono::milliseconds timeout)
+      -> std::expected<size_t, common::Error> override;
+  auto Cancel(uint32_t id) -> void override;
+  [[nodiscard]] auto HasInFlight() const -> bool override;
+  auto StopServing() -> void override;
+
+  // Factory method - waits up to config.connect_timeout for the emulator to
+  // create the segment. endpoint may be a bare name or "shm://<name>".
+  static auto Create(std::string_view endpoint, Dispatcher& dispatcher,
+                     const TransportConfig& config = {})
+      -> std::expected<std::unique_ptr<ShmTransport>, common::Error>;
+
+  // Constructor - prefer using Create() factory method
+  ShmTransport(std::unique_ptr<ShmSegment> segment, Dispatcher& dispatcher,
+               const TransportConfig& config = {});
+
+ private:
+  auto ServerThread() -> void;
+
+  auto LogDebug(std::string_view msg) const -> void {
+    common::Log<common::LogLevel::kDebug>(config_.logger, msg);
+  }
+  auto LogWarning(std::string_view msg) const -> void {
+    common::Log<common::LogLevel::kWarning>(config_.logger, msg);
+  }
+  auto LogError(std::string_view msg) const -> void {
+    common::Log<common::LogLevel::kError>(config_.logger, msg);
+  }
+
+  TransportConfig config_;
+  std::unique_ptr<ShmSegment> segment_;
+
+  // Used only from the application thread
+  ShmRing requests_;
+  ShmRing replies_;
+  std::vector<std::string> batch_{};
+  InFlightRequests in_flight_{};
+
+  // Used only from the server thread
+  ShmRing emulator_requests_;
+  ShmRing emulator_replies_;
+
+  std::atomic<bool> running_{true};
+  Dispatcher& dispatcher_;
+  std::thread server_thread_;
+};
+
+}  // namespace mcu
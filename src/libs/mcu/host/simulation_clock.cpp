@@ -0,0 +1,78 @@
+#include "simulation_clock.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <string_view>
+#include <tuple>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+
+namespace mcu {
+
+auto SimulationClock::Now() const -> Clock::time_point {
+  return Clock::time_point{Elapsed()};
+}
+
+auto SimulationClock::AdvanceTo(Clock::time_point when) -> void {
+  // Rounded up, so the clock never stops just short of when
+  const auto duration{
+      std::chrono::ceil<std::chrono::microseconds>(when - Now())};
+  if (duration.count() > 0) {
+    // A waiting event loop has nobody to hand the error to; the clock has
+    // moved regardless
+    std::ignore = Advance(duration);
+  }
+}
+
+auto SimulationClock::Advance(std::chrono::microseconds duration)
+    -> std::expected<void, common::Error> {
+  if (duration.count() < 0) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  std::expected<void, common::Error> result{};
+  // The message carries 32 bits of microseconds, a little over an hour, so
+  // longer waits are reported in steps
+  auto remaining{duration.count()};
+  while (remaining > 0) {
+    const auto step{static_cast<uint32_t>(std::min<int64_t>(
+        remaining, std::numeric_limits<uint32_t>::max()))};
+    elapsed_us_.fetch_add(step, std::memory_order_acq_rel);
+    remaining -= step;
+    if (result) {
+      result = Report(step);
+    }
+  }
+  return result;
+}
+
+auto SimulationClock::Report(uint32_t advance_us)
+    -> std::expected<void, common::Error> {
+  const ClockEmulatorRequest req{
+      .name = name_,
+      .advance_us = advance_us,
+  };
+  return EncodeMessage(req, format_)
+      .and_then([this](const std::string& frame) {
+        return transport_.Send(frame);
+      })
+      .and_then([this]() {
+        return reply_buffer_.Receive(transport_, MaxFrameSize(name_.size(), 0));
+      })
+      .and_then([](std::string_view rx_bytes) {
+        return DecodeMessage<ClockEmulatorResponse>(rx_bytes);
+      })
+      .and_then([](const ClockEmulatorResponse& resp)
+                    -> std::expected<void, common::Error> {
+        if (resp.status != common::Error::kOk) {
+          return std::unexpected(resp.status);
+        }
+        return {};
+      });
+}
+
+}  // namespace mcu
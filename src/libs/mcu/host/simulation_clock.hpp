@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/common/time_source.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/host/transport.hpp"
+
+namespace mcu {
+
+// Simulated time shared with the emulator.
+//
+// The clock starts at zero and only moves when the device waits: a Delay(),
+// or an event loop with nothing to do but wait for its next timer. Each
+// move is reported to the emulator, which replies once it has played out
+// that stretch of its own schedule, so a device simulates hours of
+// behavior as fast as the two sides can exchange messages.
+class SimulationClock final : public common::TimeSource {
+ public:
+  explicit SimulationClock(std::string name, Transport& transport,
+                           WireFormat format = WireFormat::kJson)
+      : name_{std::move(name)}, transport_{transport}, format_{format} {}
+  SimulationClock(const SimulationClock&) = delete;
+  SimulationClock(SimulationClock&&) = delete;
+  auto operator=(const SimulationClock&) -> SimulationClock& = delete;
+  auto operator=(SimulationClock&&) -> SimulationClock& = delete;
+  ~SimulationClock() override = default;
+
+  [[nodiscard]] auto Now() const -> Clock::time_point override;
+  auto AdvanceTo(Clock::time_point when) -> void override;
+
+  // Moves the clock forward by duration and waits for the emulator to
+  // catch up. The device's time moves on even if the emulator cannot be
+  // told, so a lost emulator does not stall the device.
+  auto Advance(std::chrono::microseconds duration)
+      -> std::expected<void, common::Error>;
+
+  // Time simulated since the clock was created
+  [[nodiscard]] auto Elapsed() const -> std::chrono::microseconds {
+    return std::chrono::microseconds{
+        elapsed_us_.load(std::memory_order_acquire)};
+  }
+
+ private:
+  auto Report(uint32_t advance_us) -> std::expected<void, common::Error>;
+
+  const std::string name_;
+  Transport& transport_;
+  const WireFormat format_;
+  // Reused for the emulator's replies
+  ReplyBuffer reply_buffer_{};
+  // Read from any thread that schedules against the clock
+  std::atomic<int64_t> elapsed_us_{0};
+};
+
+}  // namespace mcu
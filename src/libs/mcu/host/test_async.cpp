@@ -0,0 +1,311 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/common/task.hpp"
+#include "libs/mcu/async.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
+#include "libs/mcu/i2c.hpp"
+#include "libs/mcu/uart.hpp"
+
+namespace mcu {
+namespace {
+
+// Completes receives when the test says so, or at once if data is waiting
+class FakeUart : public Uart {
+ public:
+  auto Init(const UartConfig& /*config*/)
+      -> std::expected<void, common::Error> override {
+    return {};
+  }
+  auto Send(std::span<const std::byte> /*data*/)
+      -> std::expected<void, common::Error> override {
+    return {};
+  }
+  auto Receive(std::span<std::byte> /*buffer*/, uint32_t /*timeout_ms*/)
+      -> std::expected<size_t, common::Error> override {
+    return 0;
+  }
+  auto SendAsync(std::span<const std::byte> data,
+                 CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    sent += data.size();
+    callback({});
+    return {};
+  }
+  auto ReceiveAsync(std::span<std::byte> buffer,
+                    CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    if (start_error) {
+      return std::unexpected(*start_error);
+    }
+    if (buffered != std::byte{0}) {
+      buffer[0] = std::exchange(buffered, std::byte{0});
+      callback(1U);
+      return {};
+    }
+    rx_buffer = buffer;
+    rx_callback = std::move(callback);
+    return {};
+  }
+  auto IsBusy() const -> bool override { return false; }
+  auto Available() const -> size_t override { return 0; }
+  auto Flush() -> std::expected<void, common::Error> override { return {}; }
+  auto SetRxHandler(RxHandler /*handler*/)
+      -> std::expected<void, common::Error> override {
+    return {};
+  }
+
+  // Delivers one byte to the pending ReceiveAsync()
+  auto Deliver(std::byte value) -> void {
+    rx_buffer[0] = value;
+    std::exchange(rx_callback, {})(1U);
+  }
+
+  std::optional<common::Error> start_error{};
+  std::byte buffered{0};
+  size_t sent{0};
+  std::span<std::byte> rx_buffer{};
+  CompletionCallback<size_t> rx_callback{};
+};
+
+// A device with 8-bit registers whose value is the register address plus
+// one. Transfers complete when the test calls Complete().
+class FakeI2C : public I2CController {
+ public:
+  auto SendData(uint16_t /*address*/, std::span<const std::byte> /*data*/)
+      -> std::expected<void, common::Error> override {
+    return {};
+  }
+  auto ReceiveData(uint16_t /*address*/, std::span<std::byte> /*buffer*/)
+      -> std::expected<size_t, common::Error> override {
+    return 0;
+  }
+  auto WriteRead(uint16_t /*address*/, std::span<const std::byte> /*data*/,
+                 std::span<std::byte> /*buffer*/)
+      -> std::expected<size_t, common::Error> override {
+    return 0;
+  }
+  auto SendDataInterrupt(uint16_t address, std::span<const std::byte> data,
+                         CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    return SendDataDma(address, data, std::move(callback));
+  }
+  auto ReceiveDataInterrupt(uint16_t address, std::span<std::byte> buffer,
+                            CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    return ReceiveDataDma(address, buffer, std::move(callback));
+  }
+  auto WriteReadInterrupt(uint16_t address, std::span<const std::byte> data,
+                          std::span<std::byte> buffer,
+                          CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    return WriteReadDma(address, data, buffer, std::move(callback));
+  }
+  auto SendDataDma(uint16_t /*address*/, std::span<const std::byte> /*data*/,
+                   CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    done_callback_ = std::move(callback);
+    return {};
+  }
+  auto ReceiveDataDma(uint16_t /*address*/, std::span<std::byte> buffer,
+                      CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    read_ = buffer;
+    size_callback_ = std::move(callback);
+    return {};
+  }
+  auto WriteReadDma(uint16_t /*address*/, std::span<const std::byte> data,
+                    std::span<std::byte> buffer,
+                    CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    write_ = data;
+    read_ = buffer;
+    size_callback_ = std::move(callback);
+    return {};
+  }
+  auto Transact(std::span<const I2CSegment> segments,
+                CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    if (segments.empty()) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    segments_ = segments;
+    done_callback_ = std::move(callback);
+    return {};
+  }
+
+  // Completes the outstanding transfer; false when there is none. Kept
+  // apart from the callbacks so that completing does not allocate.
+  auto Complete() -> bool {
+    if (size_callback_) {
+      ReadRegister(write_, read_);
+      std::exchange(size_callback_, {})(read_.size());
+      return true;
+    }
+    if (done_callback_) {
+      for (const auto& segment : std::exchange(segments_, {})) {
+        ReadRegister(segment.write, segment.read);
+      }
+      std::exchange(done_callback_, {})({});
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  static auto ReadRegister(std::span<const std::byte> reg,
+                           std::span<std::byte> value) -> void {
+    if (!reg.empty() && !value.empty()) {
+      value[0] = static_cast<std::byte>(static_cast<uint8_t>(reg[0]) + 1);
+    }
+  }
+
+  std::span<const std::byte> write_{};
+  std::span<std::byte> read_{};
+  std::span<const I2CSegment> segments_{};
+  CompletionCallback<size_t> size_callback_{};
+  CompletionCallback<void> done_callback_{};
+};
+
+auto ReadByte(Uart& uart)
+    -> common::Task<std::expected<std::byte, common::Error>> {
+  std::array<std::byte, 1> buffer{};
+  auto received{co_await ReadAsync(uart, buffer)};
+  if (!received) {
+    co_return std::unexpected(received.error());
+  }
+  co_return buffer[0];
+}
+
+TEST(AsyncTest, TaskResumesWhenTheReceiveCompletes) {
+  FakeUart uart{};
+  auto task{ReadByte(uart)};
+  EXPECT_FALSE(task.Done());
+
+  task.Start();
+  EXPECT_FALSE(task.Done());
+  uart.Deliver(std::byte{0x42});
+  ASSERT_TRUE(task.Done());
+  EXPECT_EQ(task.Result(), std::byte{0x42});
+}
+
+TEST(AsyncTest, CompletionInsideTheStartCallDoesNotSuspend) {
+  FakeUart uart{};
+  uart.buffered = std::byte{0x17};
+  auto task{ReadByte(uart)};
+  task.Start();
+  ASSERT_TRUE(task.Done());
+  EXPECT_EQ(task.Result(), std::byte{0x17});
+}
+
+TEST(AsyncTest, FailureToStartIsTheResult) {
+  FakeUart uart{};
+  uart.start_error = common::Error::kInvalidState;
+  auto task{ReadByte(uart)};
+  task.Start();
+  ASSERT_TRUE(task.Done());
+  EXPECT_EQ(task.Result(), std::unexpected(common::Error::kInvalidState));
+}
+
+// Prompt, then echo one byte: two operations written as one function
+auto Echo(Uart& uart) -> common::Task<std::expected<void, common::Error>> {
+  const std::array<std::byte, 2> prompt{std::byte{'>'}, std::byte{' '}};
+  auto sent{co_await WriteAsync(uart, prompt)};
+  if (!sent) {
+    co_return sent;
+  }
+  auto byte{co_await ReadByte(uart)};
+  if (!byte) {
+    co_return std::unexpected(byte.error());
+  }
+  co_return co_await WriteAsync(uart, std::span{&*byte, 1});
+}
+
+TEST(AsyncTest, TasksAwaitOtherTasks) {
+  FakeUart uart{};
+  auto task{Echo(uart)};
+  task.Start();
+  EXPECT_EQ(uart.sent, 2U);
+  EXPECT_FALSE(task.Done());
+
+  uart.Deliver(std::byte{'x'});
+  ASSERT_TRUE(task.Done());
+  EXPECT_TRUE(task.Result());
+  EXPECT_EQ(uart.sent, 3U);
+}
+
+constexpr uint16_t kAddress{0x48};
+
+// Reads two registers, one after the other; the frame comes from resource
+auto ReadPair(std::allocator_arg_t /*tag*/,
+              std::pmr::memory_resource& /*resource*/, I2CController& i2c)
+    -> common::Task<std::expected<uint16_t, common::Error>> {
+  std::array<std::byte, 1> high{};
+  std::array<std::byte, 1> low{};
+  const std::array<std::byte, 1> high_register{std::byte{0x10}};
+  const std::array<std::byte, 1> low_register{std::byte{0x20}};
+  auto read{co_await WriteReadAsync(i2c, kAddress, high_register, high)};
+  if (!read) {
+    co_return std::unexpected(read.error());
+  }
+  read = co_await WriteReadAsync(i2c, kAddress, low_register, low);
+  if (!read) {
+    co_return std::unexpected(read.error());
+  }
+  co_return static_cast<uint16_t>((static_cast<uint16_t>(high[0]) << 8U) |
+                                  static_cast<uint16_t>(low[0]));
+}
+
+TEST(AsyncTest, MultiStepReadWithoutHeapAllocation) {
+  FakeI2C i2c{};
+  alignas(std::max_align_t) std::array<std::byte, 1024> frames{};
+  std::pmr::monotonic_buffer_resource resource{
+      frames.data(), frames.size(), std::pmr::null_memory_resource()};
+
+  const auto allocations{test::AllocationCount()};
+  auto task{ReadPair(std::allocator_arg, resource, i2c)};
+  task.Start();
+  EXPECT_TRUE(i2c.Complete());
+  EXPECT_FALSE(task.Done());
+  EXPECT_TRUE(i2c.Complete());
+  ASSERT_TRUE(task.Done());
+  EXPECT_EQ(test::AllocationCount(), allocations);
+  EXPECT_EQ(task.Result(), uint16_t{0x1121});
+}
+
+auto RunTransaction(I2CController& i2c, std::span<const I2CSegment> segments)
+    -> common::Task<std::expected<void, common::Error>> {
+  co_return co_await TransactAsync(i2c, segments);
+}
+
+TEST(AsyncTest, TransactionIsAwaitable) {
+  FakeI2C i2c{};
+  const std::array<std::byte, 1> reg{std::byte{0x05}};
+  std::array<std::byte, 1> value{};
+  const std::array<I2CSegment, 1> segments{
+      {{.address = kAddress, .write = reg, .read = value}}};
+  auto task{RunTransaction(i2c, segments)};
+  task.Start();
+  EXPECT_TRUE(i2c.Complete());
+  ASSERT_TRUE(task.Done());
+  EXPECT_TRUE(task.Result());
+  EXPECT_EQ(value[0], std::byte{0x06});
+
+  auto empty{RunTransaction(i2c, {})};
+  empty.Start();
+  ASSERT_TRUE(empty.Done());
+  EXPECT_EQ(empty.Result(), std::unexpected(common::Error::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace mcu
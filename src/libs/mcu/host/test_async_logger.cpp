@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libs/common/async_logger.hpp"
+#include "libs/common/binary_log.hpp"
+#include "libs/common/logger.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
+
+namespace common {
+namespace {
+using std::chrono::operator""s;
+
+enum class Color : uint8_t { kRed = 3 };
+
+TEST(BinaryLogTest, RecordsRoundTrip) {
+  std::array<std::byte, binary_log::kMaxRecordSize> buffer{};
+  const std::string name{"UART 1"};
+  const size_t size{binary_log::EncodeRecord(
+      buffer, 7, static_cast<uint8_t>(LogLevel::kWarning), 2, 1234, -5, 42U,
+      true, 0.5, name, Color::kRed)};
+
+  const auto record{binary_log::DecodeRecord(std::span{buffer}.first(size))};
+  ASSERT_TRUE(record);
+  EXPECT_EQ(record->header.size, size);
+  EXPECT_EQ(record->header.format, 7U);
+  EXPECT_EQ(record->header.thread, 2U);
+  EXPECT_EQ(record->header.time_ns, 1234U);
+  ASSERT_EQ(record->args.size(), 6U);
+  EXPECT_EQ(record->args[0], binary_log::Arg{int64_t{-5}});
+  EXPECT_EQ(record->args[1], binary_log::Arg{uint64_t{42}});
+  EXPECT_EQ(record->args[2], binary_log::Arg{true});
+  EXPECT_EQ(record->args[3], binary_log::Arg{0.5});
+  EXPECT_EQ(record->args[4], binary_log::Arg{name});
+  EXPECT_EQ(record->args[5], binary_log::Arg{uint64_t{3}});
+
+  EXPECT_FALSE(binary_log::DecodeRecord(std::span{buffer}.first(size - 1)));
+}
+
+TEST(BinaryLogTest, LongStringsAreCutToFit) {
+  std::array<std::byte, binary_log::kMaxRecordSize> buffer{};
+  const std::string text(1000, 'x');
+  const size_t size{
+      binary_log::EncodeRecord(buffer, 0, 0, 0, 0, text, int64_t{1})};
+  EXPECT_EQ(size, binary_log::kMaxRecordSize);
+  const auto record{binary_log::DecodeRecord(buffer)};
+  ASSERT_TRUE(record);
+  ASSERT_EQ(record->args.size(), 1U);
+  EXPECT_EQ(std::get<std::string>(record->args[0]).size(),
+            binary_log::kMaxRecordSize - binary_log::kHeaderSize - 3);
+}
+
+TEST(BinaryLogTest, FormatsLikeStdFormat) {
+  const std::vector<binary_log::Arg> args{uint64_t{255}, std::string{"I2C"},
+                                          1.25};
+  EXPECT_EQ(binary_log::FormatMessage("{:#04x} on {} took {:.1f} ms", args),
+            "0xff on I2C took 1.2 ms");
+  EXPECT_EQ(binary_log::FormatMessage("{1} {0} {{}}", args), "I2C 255 {}");
+  // Missing arguments and specs that do not suit the type
+  EXPECT_EQ(binary_log::FormatMessage("{} {:d} {} {}", args),
+            "255 I2C 1.25 {}");
+}
+
+TEST(BinaryLogTest, FormatIdsAreStable) {
+  const auto id{binary_log::kFormatId<"ready after {} ms">};
+  EXPECT_EQ(binary_log::kFormatId<"ready after {} ms">, id);
+  EXPECT_NE(binary_log::kFormatId<"{} bytes">, id);
+  EXPECT_EQ(binary_log::FormatText(id), "ready after {} ms");
+}
+
+// Keeps what the logger hands over, as text
+class RecordingSink : public LogSink {
+ public:
+  auto Write(std::span<const std::byte> record) -> void override {
+    const auto decoded{binary_log::DecodeRecord(record)};
+    ASSERT_TRUE(decoded);
+    const std::lock_guard lock{mutex};
+    messages.push_back(binary_log::FormatMessage(
+        *binary_log::FormatText(decoded->header.format), decoded->args));
+  }
+
+  std::mutex mutex{};
+  std::vector<std::string> messages{};
+};
+
+// The tests log at kWarning and up, which every build compiles in
+
+TEST(AsyncLoggerTest, FlushDeliversEverythingLoggedBefore) {
+  RecordingSink sink{};
+  AsyncLogger logger{sink, {.flush_interval = std::chrono::seconds{10}}};
+  logger.Write(LogLevel::kWarning, "transport up");
+  logger.Log<LogLevel::kError, "sent {} bytes to {}">(12U, "LED 1");
+  logger.Flush();
+  EXPECT_EQ(sink.messages,
+            (std::vector<std::string>{"transport up", "sent 12 bytes to LED 1"}));
+}
+
+TEST(AsyncLoggerTest, ThreadsKeepTheirOwnOrder) {
+  RecordingSink sink{};
+  constexpr int kThreads{4};
+  constexpr int kRecords{500};
+  {
+    // Room for every record, so none depend on the sink keeping up
+    AsyncLogger logger{sink, {.ring_bytes = 64 * 1024}};
+    std::vector<std::thread> threads{};
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&logger, t]() {
+        for (int i = 0; i < kRecords; ++i) {
+          logger.Log<LogLevel::kWarning, "{} {}">(t, i);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(logger.Dropped(), 0U);
+  }
+
+  ASSERT_EQ(sink.messages.size(), static_cast<size_t>(kThreads * kRecords));
+  std::array<int, kThreads> next{};
+  for (const auto& message : sink.messages) {
+    const auto space{message.find(' ')};
+    const int thread{std::stoi(message.substr(0, space))};
+    EXPECT_EQ(std::stoi(message.substr(space + 1)), next[thread]++);
+  }
+}
+
+TEST(AsyncLoggerTest, FullRingsDropAndCount) {
+  RecordingSink sink{};
+  AsyncLogger logger{sink, {.ring_bytes = 64, .flush_interval = 10s}};
+  for (int i = 0; i < 10; ++i) {
+    logger.Log<LogLevel::kWarning, "{}">(i);
+  }
+  logger.Flush();
+  EXPECT_GT(logger.Dropped(), 0U);
+  EXPECT_EQ(sink.messages.size() + logger.Dropped(), 10U);
+}
+
+TEST(AsyncLoggerTest, LoggingDoesNotAllocate) {
+  RecordingSink sink{};
+  AsyncLogger logger{sink, {.flush_interval = 10s}};
+  // Makes this thread's ring
+  logger.Warning("first");
+  const auto allocations{mcu::test::AllocationCount()};
+  for (int i = 0; i < 100; ++i) {
+    logger.Log<LogLevel::kWarning, "step {} of {}: {}">(i, 100, "ok");
+  }
+  EXPECT_EQ(mcu::test::AllocationCount(), allocations);
+  logger.Flush();
+  EXPECT_EQ(sink.messages.size(), 101U);
+}
+
+TEST(AsyncLoggerTest, BinaryLogDecodesToTheTextLog) {
+  std::FILE* binary{std::tmpfile()};
+  std::FILE* text{std::tmpfile()};
+  ASSERT_NE(binary, nullptr);
+  ASSERT_NE(text, nullptr);
+  {
+    BinaryLogSink binary_sink{binary};
+    TextLogSink text_sink{text};
+    AsyncLogger binary_logger{binary_sink};
+    AsyncLogger text_logger{text_sink};
+    for (auto* logger : {&binary_logger, &text_logger}) {
+      logger->Warning("retrying");
+      logger->Log<LogLevel::kError, "{} of {} retries left">(0, 3);
+    }
+  }
+
+  // Replays the binary file the way log_decoder does
+  std::rewind(binary);
+  std::vector<std::byte> bytes(4096);
+  bytes.resize(std::fread(bytes.data(), 1, bytes.size(), binary));
+  std::vector<std::string> decoded{};
+  std::vector<std::string> formats(256);
+  for (size_t offset = 0; offset < bytes.size();) {
+    const auto record{
+        binary_log::DecodeRecord(std::span{bytes}.subspan(offset))};
+    ASSERT_TRUE(record);
+    offset += record->header.size;
+    if (record->header.level == binary_log::kFormatDefinition) {
+      formats.at(record->header.format) =
+          std::get<std::string>(record->args[0]);
+      continue;
+    }
+    auto line{binary_log::FormatLine(*record, formats[record->header.format])};
+    // Past the timestamp, which differs between the two loggers
+    decoded.push_back(line.substr(line.find(']') + 2));
+  }
+
+  std::rewind(text);
+  std::vector<std::string> printed{};
+  std::array<char, 256> line{};
+  while (std::fgets(line.data(), line.size(), text) != nullptr) {
+    std::string entry{line.data()};
+    entry.pop_back();
+    printed.push_back(entry.substr(entry.find(']') + 2));
+  }
+  std::fclose(binary);
+  std::fclose(text);
+
+  EXPECT_EQ(decoded, (std::vector<std::string>{
+                         "[WARN]  t0 retrying",
+                         "[ERROR] t0 0 of 3 retries left"}));
+  EXPECT_EQ(printed, decoded);
+}
+
+}  // namespace
+}  // namespace common
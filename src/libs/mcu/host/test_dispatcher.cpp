@@ -1,10 +1,14 @@
 #include <gtest/gtest.h>
 
+#include <cstddef>
 #include <expected>
 #include <string>
 
 #include "dispatcher.hpp"
+#include "emulator_message_binary_encoder.hpp"
+#include "host_emulator_messages.hpp"
 #include "libs/common/error.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
 #include "receiver.hpp"
 
 namespace mcu {
@@ -43,6 +47,22 @@ class DispatcherTest : public ::testing::Test {
     }
     std::string_view received_message;
   };
+
+  // Writes its reply straight into the dispatcher's buffer
+  class BufferedReceiver : public Receiver {
+   public:
+    auto Receive(const std::string_view& /*message*/)
+        -> std::expected<std::string, common::Error> override {
+      return std::unexpected(common::Error::kInvalidOperation);
+    }
+    auto ReceiveInto(const std::string_view& message, std::string& reply)
+        -> std::expected<void, common::Error> override {
+      // Long enough to defeat the small string optimisation
+      reply.append("Reply to a message of a typical length: ");
+      reply.append(message);
+      return {};
+    }
+  };
 };
 
 TEST_F(DispatcherTest, DispatchMessage) {
@@ -104,5 +124,136 @@ TEST_F(DispatcherTest, DispatchMessageUnhandled) {
   EXPECT_EQ(receiver.received_message, "");
 }
 
+TEST_F(DispatcherTest, RouteJsonMessageByName) {
+  const std::string sent_message{
+      R"({"name":"LED 2","object":"Pin","operation":"Get","type":"Request"})"};
+  SimpleReceiver receiver1;
+  SimpleReceiver receiver2;
+  RouteTable routes;
+  ASSERT_TRUE(routes.Add(ObjectType::kPin, "LED 1", receiver1));
+  ASSERT_TRUE(routes.Add(ObjectType::kPin, "LED 2", receiver2));
+  const Dispatcher dispatcher{routes};
+  auto reply = dispatcher.Dispatch(sent_message);
+  EXPECT_TRUE(reply.has_value());
+  EXPECT_EQ(receiver1.received_message, "");
+  EXPECT_EQ(receiver2.received_message, sent_message);
+}
+
+TEST_F(DispatcherTest, RouteBinaryMessageByName) {
+  const auto sent_message{
+      EncodeBinary(UartEmulatorRequest{.name = "UART 1",
+                                       .operation = OperationType::kReceive,
+                                       .data = {},
+                                       .size = 4,
+                                       .timeout_ms = 0})
+          .value()};
+  SimpleReceiver pin_receiver;
+  SimpleReceiver uart_receiver;
+  RouteTable routes;
+  ASSERT_TRUE(routes.Add(ObjectType::kPin, "UART 1", pin_receiver));
+  ASSERT_TRUE(routes.Add(ObjectType::kUart, "UART 1", uart_receiver));
+  const Dispatcher dispatcher{routes};
+  auto reply = dispatcher.Dispatch(sent_message);
+  EXPECT_TRUE(reply.has_value());
+  EXPECT_EQ(pin_receiver.received_message, "");
+  EXPECT_EQ(uart_receiver.received_message, sent_message);
+}
+
+TEST_F(DispatcherTest, RouteUnknownNameFallsBackToReceiverMap) {
+  const std::string sent_message{
+      R"({"type":"Request","object":"Pin","name":"LED 3"})"};
+  SimpleReceiver routed;
+  SimpleReceiver fallback;
+  RouteTable routes;
+  ASSERT_TRUE(routes.Add(ObjectType::kPin, "LED 1", routed));
+  const ReceiverMap receiver_map{{AcceptAll, std::ref(fallback)}};
+  const Dispatcher dispatcher{routes, receiver_map};
+  auto reply = dispatcher.Dispatch(sent_message);
+  EXPECT_TRUE(reply.has_value());
+  EXPECT_EQ(routed.received_message, "");
+  EXPECT_EQ(fallback.received_message, sent_message);
+}
+
+TEST_F(DispatcherTest, RouteUnhandled) {
+  SimpleReceiver receiver;
+  RouteTable routes;
+  ASSERT_TRUE(routes.Add(ObjectType::kPin, "LED 1", receiver));
+  const Dispatcher dispatcher{routes};
+  auto reply = dispatcher.Dispatch("Hello");
+  ASSERT_FALSE(reply.has_value());
+  EXPECT_EQ(reply.error(), common::Error::kUnhandled);
+  reply = dispatcher.Dispatch(
+      R"({"type":"Request","object":"I2C","name":"LED 1"})");
+  EXPECT_FALSE(reply.has_value());
+  EXPECT_EQ(receiver.received_message, "");
+}
+
+TEST_F(DispatcherTest, RouteRejectsUnknownObjectType) {
+  SimpleReceiver receiver;
+  RouteTable routes;
+  const auto unknown{static_cast<ObjectType>(99)};
+  EXPECT_EQ(routes.Add(unknown, "LED 1", receiver),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(routes.Find(unknown, "LED 1"), nullptr);
+}
+
+TEST_F(DispatcherTest, RouteRejectsOverlongName) {
+  SimpleReceiver receiver;
+  RouteTable routes;
+  const std::string longest(kMaxMessageNameLength, 'x');
+  const std::string overlong(kMaxMessageNameLength + 1, 'x');
+  EXPECT_TRUE(routes.Add(ObjectType::kPin, longest, receiver));
+  EXPECT_EQ(routes.Add(ObjectType::kPin, overlong, receiver),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(routes.Find(ObjectType::kPin, longest), &receiver);
+  EXPECT_EQ(routes.Find(ObjectType::kPin, overlong), nullptr);
+}
+
+TEST_F(DispatcherTest, DispatchIntoFallsBackToReceive) {
+  SimpleReceiver receiver;
+  const ReceiverMap receiver_map{{AcceptAll, std::ref(receiver)}};
+  const Dispatcher dispatcher{receiver_map};
+  std::string reply{"stale"};
+  ASSERT_TRUE(dispatcher.DispatchInto("Hello", reply));
+  EXPECT_EQ(reply, "Received message");
+  EXPECT_EQ(receiver.received_message, "Hello");
+}
+
+TEST_F(DispatcherTest, DispatchIntoUnhandled) {
+  SimpleReceiver receiver;
+  const ReceiverMap receiver_map{{RejectAll, std::ref(receiver)}};
+  const Dispatcher dispatcher{receiver_map};
+  std::string reply{};
+  EXPECT_EQ(dispatcher.DispatchInto("Hello", reply),
+            std::unexpected(common::Error::kUnhandled));
+}
+
+TEST_F(DispatcherTest, DispatchIntoReusesReplyBuffer) {
+  const auto sent_message{
+      EncodeBinary(PinEmulatorRequest{.name = "LED 1",
+                                      .operation = OperationType::kGet,
+                                      .state = PinState::kLow})
+          .value()};
+  BufferedReceiver receiver;
+  RouteTable routes;
+  ASSERT_TRUE(routes.Add(ObjectType::kPin, "LED 1", receiver));
+  const Dispatcher dispatcher{routes};
+  std::string reply{};
+  ASSERT_TRUE(dispatcher.DispatchInto(sent_message, reply));
+  const std::string first_reply{reply};
+
+  // After the first message the buffer is big enough for the rest
+  constexpr size_t kMessages{100};
+  const size_t before{test::AllocationCount()};
+  size_t handled{0};
+  for (size_t i = 0; i < kMessages; ++i) {
+    handled += dispatcher.DispatchInto(sent_message, reply) ? 1 : 0;
+  }
+  const size_t allocations{test::AllocationCount() - before};
+  EXPECT_EQ(handled, kMessages);
+  EXPECT_EQ(allocations, 0U);
+  EXPECT_EQ(reply, first_reply);
+}
+
 }  // namespace
 }  // namespace mcu
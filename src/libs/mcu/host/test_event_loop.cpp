@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "libs/common/event_loop.hpp"
+#include "libs/common/poller.hpp"
+#include "libs/common/time_source.hpp"
+
+namespace common {
+namespace {
+using std::chrono::operator""ms;
+using std::chrono::operator""s;
+
+TEST(EventLoopTest, RunsTasksInPostOrder) {
+  EventLoop loop{};
+  std::vector<int> order{};
+  for (int i = 0; i < 4; ++i) {
+    loop.Post([&order, i]() { order.push_back(i); });
+  }
+  EXPECT_EQ(loop.RunReady(), 4U);
+  EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(loop.RunReady(), 0U);
+}
+
+TEST(EventLoopTest, TasksPostedByATaskRunNextTime) {
+  EventLoop loop{};
+  std::vector<int> order{};
+  loop.Post([&]() {
+    order.push_back(1);
+    loop.Post([&order]() { order.push_back(3); });
+  });
+  loop.Post([&order]() { order.push_back(2); });
+
+  EXPECT_EQ(loop.RunReady(), 2U);
+  EXPECT_EQ(order, (std::vector<int>{1, 2}));
+  EXPECT_EQ(loop.RunReady(), 1U);
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(EventLoopTest, TimersRunWhenDueInDeadlineOrder) {
+  EventLoop loop{};
+  std::vector<int> order{};
+  loop.PostAfter(20ms, [&order]() { order.push_back(2); });
+  loop.PostAfter(10ms, [&order]() { order.push_back(1); });
+  loop.PostAfter(20ms, [&order]() { order.push_back(3); });
+  EXPECT_EQ(loop.RunReady(), 0U);
+
+  std::this_thread::sleep_for(30ms);
+  EXPECT_EQ(loop.RunReady(), 3U);
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(EventLoopTest, RunReturnsAfterStopFromATask) {
+  EventLoop loop{};
+  bool after_stop{false};
+  loop.PostAfter(5ms, [&loop]() { loop.Stop(); });
+  loop.PostAfter(5ms, [&after_stop]() { after_stop = true; });
+  loop.Run();
+
+  // The second timer was due in the same batch and stays queued
+  EXPECT_FALSE(after_stop);
+  EXPECT_EQ(loop.RunReady(), 1U);
+  EXPECT_TRUE(after_stop);
+}
+
+TEST(EventLoopTest, PostFromAnotherThreadWakesRun) {
+  EventLoop loop{};
+  size_t ran{0};
+  std::thread producer{[&]() {
+    std::this_thread::sleep_for(10ms);
+    for (int i = 0; i < 100; ++i) {
+      loop.Post([&ran]() { ++ran; });
+    }
+    loop.Post([&loop]() { loop.Stop(); });
+  }};
+  loop.Run();
+  producer.join();
+  EXPECT_EQ(ran, 100U);
+}
+
+// Moves only when the loop asks it to
+class ManualTime : public TimeSource {
+ public:
+  [[nodiscard]] auto Now() const -> Clock::time_point override { return now; }
+  auto AdvanceTo(Clock::time_point when) -> void override {
+    now = std::max(now, when);
+    ++advances;
+  }
+
+  Clock::time_point now{};
+  size_t advances{0};
+};
+
+TEST(EventLoopTest, IdleLoopAdvancesTheTimeSource) {
+  ManualTime time{};
+  EventLoop loop{};
+  loop.SetTimeSource(time);
+  std::vector<int> order{};
+  loop.PostAfter(60s, [&]() {
+    order.push_back(2);
+    loop.Stop();
+  });
+  loop.PostAfter(30s, [&order]() { order.push_back(1); });
+
+  const auto start{std::chrono::steady_clock::now()};
+  loop.Run();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 30s);
+  EXPECT_EQ(order, (std::vector<int>{1, 2}));
+  EXPECT_EQ(time.now, ManualTime::Clock::time_point{60s});
+  EXPECT_EQ(time.advances, 2U);
+}
+
+// Completes one of its pending operations per Poll() by posting
+// on_completed to the loop
+class FakePoller : public Poller {
+ public:
+  explicit FakePoller(EventLoop& loop) : loop_(loop) {}
+
+  [[nodiscard]] auto Busy() const -> bool override { return pending > 0; }
+  auto Poll(Clock::duration max_wait) -> void override {
+    waits.push_back(max_wait);
+    if (complete && pending > 0) {
+      --pending;
+      loop_.Post(on_completed);
+    }
+  }
+
+  size_t pending{0};
+  bool complete{true};
+  EventLoop::Task on_completed{};
+  std::vector<Clock::duration> waits{};
+
+ private:
+  EventLoop& loop_;
+};
+
+TEST(EventLoopTest, BusyPollerIsPolledInsteadOfSleeping) {
+  EventLoop loop{};
+  FakePoller poller{loop};
+  loop.SetPoller(poller);
+  poller.pending = 3;
+  size_t completed{0};
+  poller.on_completed = [&]() {
+    if (++completed == 3) {
+      loop.Stop();
+    }
+  };
+  // Would end the test if the loop slept instead
+  loop.PostAfter(10s, [&loop]() { loop.Stop(); });
+
+  const auto start{std::chrono::steady_clock::now()};
+  loop.Run();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+  EXPECT_EQ(completed, 3U);
+  EXPECT_TRUE(std::ranges::all_of(poller.waits, [](auto wait) {
+    return wait > Poller::Clock::duration::zero() &&
+           wait <= EventLoop::kPollSlice;
+  }));
+}
+
+TEST(EventLoopTest, SimulatedTimeDoesNotWaitForThePoller) {
+  ManualTime time{};
+  EventLoop loop{};
+  loop.SetTimeSource(time);
+  FakePoller poller{loop};
+  loop.SetPoller(poller);
+  // Never completes, like a request the emulator has not answered yet
+  poller.pending = 1;
+  poller.complete = false;
+  loop.PostAfter(60s, [&loop]() { loop.Stop(); });
+
+  loop.Run();
+  EXPECT_EQ(time.now, ManualTime::Clock::time_point{60s});
+  ASSERT_FALSE(poller.waits.empty());
+  EXPECT_TRUE(std::ranges::all_of(poller.waits, [](auto wait) {
+    return wait == Poller::Clock::duration::zero();
+  }));
+}
+
+}  // namespace
+}  // namespace common
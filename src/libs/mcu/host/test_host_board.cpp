@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "libs/board/host/host_board.hpp"
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/host/shm_segment.hpp"
+#include "libs/mcu/uart.hpp"
+
+namespace board {
+namespace {
+
+using std::chrono::milliseconds;
+
+auto Deadline(milliseconds timeout) -> std::chrono::steady_clock::time_point {
+  return std::chrono::steady_clock::now() + timeout;
+}
+
+// A whole board over the shared-memory transport, with an emulator that
+// answers UART reads a little late, as a device on the line would
+class HostBoardTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto segment{mcu::ShmSegment::Create(name_, kRingCapacity)};
+    ASSERT_TRUE(segment);
+    segment_ = std::move(segment.value());
+    emulator_thread_ = std::thread{&HostBoardTest::EmulatorLoop, this};
+
+    board_ = std::make_unique<HostBoard>(
+        HostBoard::Endpoints{.to_emulator = "shm://" + name_});
+    ASSERT_TRUE(board_->Init());
+    ASSERT_TRUE(board_->Uart1().Init(mcu::UartConfig{}));
+  }
+
+  void TearDown() override {
+    board_.reset();
+    emulator_running_ = false;
+    emulator_thread_.join();
+  }
+
+  static constexpr uint32_t kRingCapacity{4096};
+  static constexpr milliseconds kReplyDelay{20};
+  const std::string name_{"host_board_test_" + std::to_string(getpid())};
+  std::unique_ptr<mcu::ShmSegment> segment_{};
+  std::unique_ptr<HostBoard> board_{};
+
+ private:
+  void EmulatorLoop() {
+    auto requests{segment_->Ring(mcu::ShmRingId::kDeviceRequest)};
+    auto replies{segment_->Ring(mcu::ShmRingId::kEmulatorReply)};
+    std::string frame{};
+    bool more{false};
+    while (emulator_running_) {
+      if (!requests.Read(frame, more, Deadline(milliseconds{50}))) {
+        continue;
+      }
+      auto request{mcu::DecodeMessage<mcu::UartEmulatorRequest>(frame)};
+      ASSERT_TRUE(request);
+      ASSERT_EQ(request->operation, mcu::OperationType::kReceive);
+      std::this_thread::sleep_for(kReplyDelay);
+      const mcu::UartEmulatorResponse response{
+          .name = request->name,
+          .data = {std::byte{'h'}, std::byte{'i'}},
+          .bytes_transferred = 2,
+          .status = common::Error::kOk,
+          .id = request->id};
+      const auto reply{mcu::EncodeMessage(response, mcu::FormatOf(frame))};
+      ASSERT_TRUE(reply);
+      ASSERT_TRUE(replies.Write(*reply, more, Deadline(milliseconds{1000})));
+    }
+  }
+
+  std::thread emulator_thread_;
+  std::atomic<bool> emulator_running_{true};
+};
+
+TEST_F(HostBoardTest, EventLoopCompletesAsyncUartReads) {
+  auto& events{board_->Events()};
+  std::array<std::byte, 8> buffer{};
+  std::optional<std::expected<size_t, common::Error>> result{};
+  ASSERT_TRUE(board_->Uart1().ReceiveAsync(
+      buffer, [&](std::expected<size_t, common::Error> received) {
+        result = received;
+        events.Stop();
+      }));
+  EXPECT_TRUE(board_->Uart1().IsBusy());
+  // Ends the test should the reply never be read
+  events.PostAfter(std::chrono::seconds{5}, [&events]() { events.Stop(); });
+
+  events.Run();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), 2U);
+  EXPECT_EQ(buffer[0], std::byte{'h'});
+  EXPECT_EQ(buffer[1], std::byte{'i'});
+  EXPECT_FALSE(board_->Uart1().IsBusy());
+}
+
+TEST_F(HostBoardTest, DestroyedWithAsyncReadInFlight) {
+  std::array<std::byte, 8> buffer{};
+  bool called{false};
+  ASSERT_TRUE(board_->Uart1().ReceiveAsync(
+      buffer, [&called](std::expected<size_t, common::Error> /*received*/) {
+        called = true;
+      }));
+  ASSERT_TRUE(board_->Uart1().IsBusy());
+
+  // The reply is still on its way: the UART cancels the read on the live
+  // transport, which no longer dispatches to it
+  board_.reset();
+  EXPECT_FALSE(called);
+}
+
+}  // namespace
+}  // namespace board
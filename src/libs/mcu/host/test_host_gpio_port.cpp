@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/dispatcher.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/host/host_gpio_port.hpp"
+#include "libs/mcu/host/shm_segment.hpp"
+#include "libs/mcu/host/shm_transport.hpp"
+#include "libs/mcu/host/testing/forwarding_receiver.hpp"
+
+namespace mcu {
+namespace {
+
+using std::chrono::milliseconds;
+
+auto Deadline(milliseconds timeout) -> std::chrono::steady_clock::time_point {
+  return std::chrono::steady_clock::now() + timeout;
+}
+
+// Runs over the shared-memory transport with an emulator that keeps the
+// port's levels and counts the requests the port makes
+class HostGpioPortTest : public ::testing::TestWithParam<WireFormat> {
+ protected:
+  void SetUp() override {
+    auto segment{ShmSegment::Create(name_, kRingCapacity)};
+    ASSERT_TRUE(segment);
+    segment_ = std::move(segment.value());
+    emulator_thread_ = std::thread{&HostGpioPortTest::EmulatorLoop, this};
+
+    // The routes are complete before the transport starts dispatching
+    ASSERT_TRUE(routes_.Add(ObjectType::kPort, "Port A", port_route_));
+    dispatcher_ = std::make_unique<Dispatcher>(routes_);
+    auto transport{ShmTransport::Create(name_, *dispatcher_)};
+    ASSERT_TRUE(transport);
+    transport_ = std::move(transport.value());
+    port_ = std::make_unique<HostGpioPort>("Port A", *transport_, GetParam());
+    port_route_.Attach(*port_);
+  }
+
+  void TearDown() override {
+    transport_.reset();
+    emulator_running_ = false;
+    emulator_thread_.join();
+  }
+
+  static constexpr uint32_t kRingCapacity{4096};
+  const std::string name_{"host_gpio_port_test_" + std::to_string(getpid())};
+  std::unique_ptr<ShmSegment> segment_{};
+  test::ForwardingReceiver port_route_{};
+  RouteTable routes_{};
+  std::unique_ptr<Dispatcher> dispatcher_{};
+  std::unique_ptr<Transport> transport_{};
+  std::unique_ptr<HostGpioPort> port_{};
+
+  // Emulator side
+  std::atomic<size_t> requests_{0};
+  std::atomic<uint32_t> emulator_levels_{0};
+  std::atomic<bool> reject_writes_{false};
+
+ private:
+  void EmulatorLoop() {
+    auto requests{segment_->Ring(ShmRingId::kDeviceRequest)};
+    auto replies{segment_->Ring(ShmRingId::kEmulatorReply)};
+    std::string frame{};
+    bool more{false};
+    while (emulator_running_) {
+      if (!requests.Read(frame, more, Deadline(milliseconds{50}))) {
+        continue;
+      }
+      ++requests_;
+      auto request{DecodeMessage<PortEmulatorRequest>(frame)};
+      ASSERT_TRUE(request);
+      PortEmulatorResponse response{.name = request->name,
+                                    .status = common::Error::kOk,
+                                    .id = request->id};
+      if (request->operation == OperationType::kSet) {
+        if (reject_writes_) {
+          response.status = common::Error::kInvalidOperation;
+        } else {
+          emulator_levels_ = (emulator_levels_ & ~request->mask) |
+                             (request->value & request->mask);
+        }
+      }
+      response.value = emulator_levels_;
+      const auto reply{EncodeMessage(response, FormatOf(frame))};
+      ASSERT_TRUE(reply);
+      ASSERT_TRUE(replies.Write(*reply, more, Deadline(milliseconds{1000})));
+    }
+  }
+
+  std::thread emulator_thread_;
+  std::atomic<bool> emulator_running_{true};
+};
+
+TEST_P(HostGpioPortTest, WriteIsOneRequestForAllPins) {
+  emulator_levels_ = 0xF000;
+  ASSERT_TRUE(port_->Write(0x00FF, 0x00A5));
+  EXPECT_EQ(requests_, 1U);
+  EXPECT_EQ(emulator_levels_, 0xF0A5U);
+}
+
+TEST_P(HostGpioPortTest, ReadReturnsEveryPin) {
+  emulator_levels_ = 0x8001;
+  EXPECT_EQ(port_->Read(), 0x8001U);
+  EXPECT_EQ(requests_, 1U);
+}
+
+TEST_P(HostGpioPortTest, ToggleIsOneRequestWithoutARead) {
+  ASSERT_TRUE(port_->Write(0x000F, 0x0005));
+  ASSERT_TRUE(port_->Toggle(0x0003));
+  EXPECT_EQ(emulator_levels_, 0x0006U);
+  ASSERT_TRUE(port_->Toggle(0x0003));
+  EXPECT_EQ(emulator_levels_, 0x0005U);
+  EXPECT_EQ(requests_, 3U);
+}
+
+TEST_P(HostGpioPortTest, ToggleFirstReadsTheLevels) {
+  emulator_levels_ = 0x0003;
+  ASSERT_TRUE(port_->Toggle(0x0001));
+  EXPECT_EQ(emulator_levels_, 0x0002U);
+  EXPECT_EQ(requests_, 2U);
+  ASSERT_TRUE(port_->Toggle(0x0001));
+  EXPECT_EQ(emulator_levels_, 0x0003U);
+  EXPECT_EQ(requests_, 3U);
+}
+
+TEST_P(HostGpioPortTest, ToggleFollowsLevelsChangedByTheEmulator) {
+  ASSERT_TRUE(port_->Write(0x000F, 0x0000));
+  // The emulator drives a pin between requests; the next reply carries it
+  emulator_levels_ = 0x0004;
+  EXPECT_EQ(port_->Read(), 0x0004U);
+  ASSERT_TRUE(port_->Toggle(0x0006));
+  EXPECT_EQ(emulator_levels_, 0x0002U);
+}
+
+TEST_P(HostGpioPortTest, RejectedWriteRereadsBeforeToggling) {
+  ASSERT_TRUE(port_->Write(0x0001, 0x0000));
+  reject_writes_ = true;
+  EXPECT_EQ(port_->Write(0x0001, 0x0001),
+            std::unexpected(common::Error::kInvalidOperation));
+  reject_writes_ = false;
+  emulator_levels_ = 0x0001;
+  ASSERT_TRUE(port_->Toggle(0x0001));
+  EXPECT_EQ(emulator_levels_, 0x0000U);
+  EXPECT_EQ(requests_, 4U);
+}
+
+INSTANTIATE_TEST_SUITE_P(WireFormats, HostGpioPortTest,
+                         ::testing::Values(WireFormat::kJson,
+                                           WireFormat::kBinary));
+
+}  // namespace
+}  // namespace mcu
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
@@ -113,13 +114,20 @@ class HostI2CTest : public ::testing::Test {
             .data = {},
             .bytes_transferred = 0,
             .status = common::Error::kOk,
+            .id = request.id,
         };
 
         if (request.operation == mcu::OperationType::kSend) {
           // Device sent data to I2C peripheral - store in device buffer
           i2c_device_buffers[request.address] = request.data;
           response.bytes_transferred = request.data.size();
-        } else if (request.operation == mcu::OperationType::kReceive) {
+        } else if (request.operation == mcu::OperationType::kReceive ||
+                   request.operation == mcu::OperationType::kTransfer) {
+          // A transfer writes first, then reads after the repeated start
+          if (request.operation == mcu::OperationType::kTransfer &&
+              !request.data.empty()) {
+            i2c_device_buffers[request.address] = request.data;
+          }
           // Device wants to receive data from I2C peripheral
           if (i2c_device_buffers.contains(request.address)) {
             const auto& buffer = i2c_device_buffers[request.address];
@@ -129,6 +137,32 @@ class HostI2CTest : public ::testing::Test {
                 buffer.begin() + static_cast<std::ptrdiff_t>(bytes_to_send));
             response.bytes_transferred = bytes_to_send;
           }
+        } else if (request.operation == mcu::OperationType::kTransaction) {
+          transaction_address_ = request.address;
+          // Run each packed segment; reads are padded to their full size
+          auto next{request.data.cbegin()};
+          auto get_u16 = [&next]() {
+            const auto low{std::to_integer<uint16_t>(*next++)};
+            return static_cast<uint16_t>(
+                low | (std::to_integer<uint16_t>(*next++) << 8U));
+          };
+          while (next != request.data.cend()) {
+            const uint16_t address{get_u16()};
+            const size_t write_size{get_u16()};
+            const size_t read_size{get_u16()};
+            ++next;  // Flags
+            if (write_size != 0) {
+              i2c_device_buffers[address].assign(
+                  next, next + static_cast<std::ptrdiff_t>(write_size));
+              next += static_cast<std::ptrdiff_t>(write_size);
+            }
+            const auto& buffer = i2c_device_buffers[address];
+            for (size_t i = 0; i < read_size; ++i) {
+              response.data.push_back(i < buffer.size() ? buffer[i]
+                                                        : std::byte{0xFF});
+            }
+          }
+          response.bytes_transferred = response.data.size();
         }
 
         const auto response_str = mcu::Encode(response);
@@ -149,6 +183,7 @@ class HostI2CTest : public ::testing::Test {
   zmq::context_t emulator_context_{1};
   std::thread emulator_thread_;
   std::atomic<bool> emulator_running_{false};
+  std::atomic<uint16_t> transaction_address_{0};
 };
 
 TEST_F(HostI2CTest, SendData) {
@@ -253,6 +288,101 @@ TEST_F(HostI2CTest, ReceivePartialData) {
                          send_data.begin(), send_data.begin() + 5));
 }
 
+TEST_F(HostI2CTest, WriteRead) {
+  const uint16_t device_address{0x52};
+  const std::array<std::byte, 3> write_data{std::byte{0x0A}, std::byte{0x0B},
+                                            std::byte{0x0C}};
+
+  // The emulated device answers the read with the bytes just written
+  std::array<std::byte, 3> recv_buffer{};
+  auto result = i2c_->WriteRead(device_address, write_data, recv_buffer);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), write_data.size());
+  EXPECT_TRUE(std::equal(recv_buffer.begin(), recv_buffer.end(),
+                         write_data.begin(), write_data.end()));
+}
+
+TEST_F(HostI2CTest, WriteReadWithoutWriteData) {
+  const uint16_t device_address{0x53};
+  const std::array<std::byte, 2> send_data{std::byte{0x12}, std::byte{0x34}};
+  ASSERT_TRUE(i2c_->SendData(device_address, send_data));
+
+  std::array<std::byte, 2> recv_buffer{};
+  auto result = i2c_->WriteRead(device_address, {}, recv_buffer);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), send_data.size());
+  EXPECT_EQ(recv_buffer, send_data);
+}
+
+TEST_F(HostI2CTest, WriteReadInterrupt) {
+  const uint16_t device_address{0x54};
+  const std::array<std::byte, 2> write_data{std::byte{0x5A}, std::byte{0xA5}};
+
+  bool callback_called{false};
+  std::expected<size_t, common::Error> callback_result{
+      std::unexpected(common::Error::kUnknown)};
+  std::array<std::byte, 2> recv_buffer{};
+
+  auto result = i2c_->WriteReadInterrupt(
+      device_address, write_data, recv_buffer,
+      [&callback_called,
+       &callback_result](std::expected<size_t, common::Error> result) {
+        callback_called = true;
+        callback_result = result;
+      });
+
+  EXPECT_TRUE(result);
+  EXPECT_FALSE(callback_called);  // Completes when the reply is read
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 1);
+  EXPECT_TRUE(callback_called);
+  ASSERT_TRUE(callback_result);
+  EXPECT_EQ(callback_result.value(), write_data.size());
+  EXPECT_EQ(recv_buffer, write_data);
+}
+
+TEST_F(HostI2CTest, TransactIsOneRoundTrip) {
+  const std::array<std::byte, 2> first_data{std::byte{0x01}, std::byte{0x02}};
+  const std::array<std::byte, 1> second_data{std::byte{0x03}};
+  std::array<std::byte, 2> first_read{};
+  std::array<std::byte, 1> second_read{};
+  std::array<std::byte, 2> third_read{};
+  const std::array<mcu::I2CSegment, 3> segments{{
+      {.address = 0x40, .write = first_data, .read = first_read, .stop = false},
+      {.address = 0x41, .write = second_data, .read = second_read},
+      {.address = 0x40, .write = {}, .read = third_read},
+  }};
+
+  bool callback_called{false};
+  std::expected<void, common::Error> callback_result{
+      std::unexpected(common::Error::kUnknown)};
+  auto result = i2c_->Transact(
+      segments, [&callback_called, &callback_result](
+                    std::expected<void, common::Error> result) {
+        callback_called = true;
+        callback_result = result;
+      });
+  EXPECT_TRUE(result);
+  EXPECT_FALSE(callback_called);  // Completes when the reply is read
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 1);
+  EXPECT_TRUE(callback_called);
+  EXPECT_TRUE(callback_result);
+  EXPECT_EQ(first_read, first_data);
+  EXPECT_EQ(second_read, second_data);
+  EXPECT_EQ(third_read, first_data);
+  EXPECT_EQ(transaction_address_, 0x40U);
+}
+
+TEST_F(HostI2CTest, TransactRejectsAnEmptyList) {
+  EXPECT_EQ(i2c_->Transact({}, nullptr),
+            std::unexpected(common::Error::kInvalidArgument));
+}
+
 TEST_F(HostI2CTest, SendDataInterrupt) {
   const uint16_t device_address{0x42};
   const std::array<std::byte, 3> send_data{std::byte{0xAA}, std::byte{0xBB},
@@ -270,6 +400,11 @@ TEST_F(HostI2CTest, SendDataInterrupt) {
                               });
 
   EXPECT_TRUE(result);
+  EXPECT_FALSE(callback_called);  // Completes when the reply is read
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 1);
   EXPECT_TRUE(callback_called);
   EXPECT_TRUE(callback_result);
 }
@@ -297,6 +432,11 @@ TEST_F(HostI2CTest, ReceiveDataInterrupt) {
       });
 
   EXPECT_TRUE(result);
+  EXPECT_FALSE(callback_called);  // Completes when the reply is read
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 1);
   EXPECT_TRUE(callback_called);
   ASSERT_TRUE(callback_result);
 
@@ -323,6 +463,11 @@ TEST_F(HostI2CTest, SendDataDma) {
                         });
 
   EXPECT_TRUE(result);
+  EXPECT_FALSE(callback_called);  // Completes when the reply is read
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 1);
   EXPECT_TRUE(callback_called);
   EXPECT_TRUE(callback_result);
 }
@@ -351,6 +496,11 @@ TEST_F(HostI2CTest, ReceiveDataDma) {
                            });
 
   EXPECT_TRUE(result);
+  EXPECT_FALSE(callback_called);  // Completes when the reply is read
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 1);
   EXPECT_TRUE(callback_called);
   ASSERT_TRUE(callback_result);
 
@@ -359,3 +509,55 @@ TEST_F(HostI2CTest, ReceiveDataDma) {
   EXPECT_TRUE(std::equal(recv_buffer.begin(), recv_buffer.end(),
                          send_data.begin(), send_data.end()));
 }
+
+TEST_F(HostI2CTest, QueuedTransfersCompleteInOrder) {
+  const uint16_t device_address{0x60};
+  const std::array<std::byte, 2> first{std::byte{0x01}, std::byte{0x02}};
+  const std::array<std::byte, 2> second{std::byte{0x03}, std::byte{0x04}};
+  std::array<std::byte, 2> recv_buffer{};
+  std::vector<int> completions{};
+
+  auto on_sent = [&completions](int index) {
+    return [&completions, index](std::expected<void, common::Error> result) {
+      EXPECT_TRUE(result);
+      completions.push_back(index);
+    };
+  };
+  ASSERT_TRUE(i2c_->SendDataInterrupt(device_address, first, on_sent(1)));
+  ASSERT_TRUE(i2c_->SendDataDma(device_address, second, on_sent(2)));
+  ASSERT_TRUE(i2c_->ReceiveDataDma(
+      device_address, recv_buffer,
+      [&completions](std::expected<size_t, common::Error> result) {
+        ASSERT_TRUE(result);
+        EXPECT_EQ(result.value(), 2);
+        completions.push_back(3);
+      }));
+  EXPECT_TRUE(completions.empty());
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 3);
+  EXPECT_EQ(completions, (std::vector<int>{1, 2, 3}));
+  EXPECT_TRUE(std::equal(recv_buffer.begin(), recv_buffer.end(),
+                         second.begin(), second.end()));
+}
+
+TEST_F(HostI2CTest, BlockingTransferCompletesQueuedTransfers) {
+  const uint16_t device_address{0x61};
+  const std::array<std::byte, 1> data{std::byte{0x7F}};
+  bool callback_called{false};
+
+  ASSERT_TRUE(i2c_->SendDataInterrupt(
+      device_address, data,
+      [&callback_called](std::expected<void, common::Error> result) {
+        EXPECT_TRUE(result);
+        callback_called = true;
+      }));
+
+  // The blocking call reads past the queued reply, completing it on the way
+  std::array<std::byte, 1> recv_buffer{};
+  auto received = i2c_->ReceiveData(device_address, recv_buffer);
+  ASSERT_TRUE(received);
+  EXPECT_TRUE(callback_called);
+  EXPECT_EQ(recv_buffer[0], data[0]);
+}
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/dispatcher.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/host/host_pin.hpp"
+#include "libs/mcu/host/shm_segment.hpp"
+#include "libs/mcu/host/shm_transport.hpp"
+#include "libs/mcu/host/testing/forwarding_receiver.hpp"
+#include "libs/mcu/pin.hpp"
+
+namespace mcu {
+namespace {
+
+using std::chrono::milliseconds;
+
+auto Deadline(milliseconds timeout) -> std::chrono::steady_clock::time_point {
+  return std::chrono::steady_clock::now() + timeout;
+}
+
+// Runs over the shared-memory transport with an emulator that keeps the
+// pin's level and counts the requests the pin makes
+class HostPinTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto segment{ShmSegment::Create(name_, kRingCapacity)};
+    ASSERT_TRUE(segment);
+    segment_ = std::move(segment.value());
+    emulator_thread_ = std::thread{&HostPinTest::EmulatorLoop, this};
+
+    // The routes are complete before the transport starts dispatching
+    ASSERT_TRUE(routes_.Add(ObjectType::kPin, "LED 1", pin_route_));
+    dispatcher_ = std::make_unique<Dispatcher>(routes_);
+    auto transport{ShmTransport::Create(name_, *dispatcher_)};
+    ASSERT_TRUE(transport);
+    transport_ = std::move(transport.value());
+    pin_ = std::make_unique<HostPin>("LED 1", *transport_);
+    pin_route_.Attach(*pin_);
+    ASSERT_TRUE(pin_->Configure(PinDirection::kOutput));
+  }
+
+  void TearDown() override {
+    transport_.reset();
+    emulator_running_ = false;
+    emulator_thread_.join();
+  }
+
+  // Sends a request the way the Python emulator does when a user drives
+  // the pin, and returns the pin's reply
+  auto PushState(PinState state) -> std::optional<PinEmulatorResponse> {
+    auto requests{segment_->Ring(ShmRingId::kEmulatorRequest)};
+    auto replies{segment_->Ring(ShmRingId::kDeviceReply)};
+    const PinEmulatorRequest request{.name = "LED 1",
+                                     .operation = OperationType::kSet,
+                                     .state = state};
+    std::string reply{};
+    bool more{false};
+    if (!requests.Write(Encode(request), false, Deadline(milliseconds{1000})) ||
+        !replies.Read(reply, more, Deadline(milliseconds{1000}))) {
+      return std::nullopt;
+    }
+    auto response{DecodeMessage<PinEmulatorResponse>(reply)};
+    return response ? std::optional{*response} : std::nullopt;
+  }
+
+  static constexpr uint32_t kRingCapacity{4096};
+  const std::string name_{"host_pin_test_" + std::to_string(getpid())};
+  std::unique_ptr<ShmSegment> segment_{};
+  test::ForwardingReceiver pin_route_{};
+  RouteTable routes_{};
+  std::unique_ptr<Dispatcher> dispatcher_{};
+  std::unique_ptr<Transport> transport_{};
+  std::unique_ptr<HostPin> pin_{};
+
+  // Emulator side
+  std::atomic<size_t> requests_{0};
+  std::atomic<PinState> emulator_state_{PinState::kLow};
+  std::atomic<bool> reject_writes_{false};
+
+ private:
+  void EmulatorLoop() {
+    auto requests{segment_->Ring(ShmRingId::kDeviceRequest)};
+    auto replies{segment_->Ring(ShmRingId::kEmulatorReply)};
+    std::string frame{};
+    bool more{false};
+    while (emulator_running_) {
+      if (!requests.Read(frame, more, Deadline(milliseconds{50}))) {
+        continue;
+      }
+      ++requests_;
+      auto request{DecodeMessage<PinEmulatorRequest>(frame)};
+      ASSERT_TRUE(request);
+      PinEmulatorResponse response{.name = request->name,
+                                   .state = emulator_state_,
+                                   .status = common::Error::kOk,
+                                   .id = request->id};
+      if (request->operation == OperationType::kSet) {
+        if (reject_writes_) {
+          response.status = common::Error::kInvalidOperation;
+        } else {
+          emulator_state_ = request->state;
+          response.state = request->state;
+        }
+      }
+      ASSERT_TRUE(
+          replies.Write(Encode(response), more, Deadline(milliseconds{1000})));
+    }
+  }
+
+  std::thread emulator_thread_;
+  std::atomic<bool> emulator_running_{true};
+};
+
+TEST_F(HostPinTest, ToggleReadsStateWhenNotCached) {
+  emulator_state_ = PinState::kHigh;
+  ASSERT_TRUE(pin_->Toggle());
+  EXPECT_EQ(requests_, 2U);  // Get, then Set
+  EXPECT_EQ(emulator_state_, PinState::kLow);
+}
+
+TEST_F(HostPinTest, ToggleIsOneRoundTripOnceCached) {
+  ASSERT_TRUE(pin_->SetHigh());
+  ASSERT_TRUE(pin_->Toggle());
+  ASSERT_TRUE(pin_->Toggle());
+  EXPECT_EQ(requests_, 3U);
+  EXPECT_EQ(emulator_state_, PinState::kHigh);
+}
+
+TEST_F(HostPinTest, RepeatedWritesAndReadsAreServedFromTheCache) {
+  ASSERT_TRUE(pin_->SetHigh());
+  ASSERT_TRUE(pin_->SetHigh());
+  auto state{pin_->Get()};
+  ASSERT_TRUE(state);
+  EXPECT_EQ(state.value(), PinState::kHigh);
+  EXPECT_EQ(requests_, 1U);
+}
+
+TEST_F(HostPinTest, RejectedWriteInvalidatesTheCache) {
+  ASSERT_TRUE(pin_->SetHigh());
+  reject_writes_ = true;
+  EXPECT_EQ(pin_->SetLow(), std::unexpected(common::Error::kInvalidOperation));
+  reject_writes_ = false;
+  ASSERT_TRUE(pin_->Toggle());
+  EXPECT_EQ(requests_, 4U);  // Set, rejected Set, Get, Set
+  EXPECT_EQ(emulator_state_, PinState::kLow);
+}
+
+TEST_F(HostPinTest, EmulatorPushInvalidatesTheCache) {
+  ASSERT_TRUE(pin_->SetHigh());
+  // Output pins refuse to be driven from outside...
+  auto response{PushState(PinState::kLow)};
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response->status, common::Error::kInvalidOperation);
+  // ...but the next toggle re-reads the emulator's level
+  emulator_state_ = PinState::kLow;
+  ASSERT_TRUE(pin_->Toggle());
+  EXPECT_EQ(requests_, 3U);
+  EXPECT_EQ(emulator_state_, PinState::kHigh);
+}
+
+TEST_F(HostPinTest, EmulatorPushRacingWritesIsNotLost) {
+  constexpr size_t kRounds{200};
+  std::thread emulator_side{[this] {
+    for (size_t i = 0; i < kRounds; ++i) {
+      EXPECT_TRUE(PushState(PinState::kLow));
+    }
+  }};
+  for (size_t i = 0; i < kRounds; ++i) {
+    EXPECT_TRUE(i % 2 == 0 ? pin_->SetHigh() : pin_->SetLow());
+  }
+  emulator_side.join();
+
+  // However the two interleaved, a push after a write forces the next
+  // write of the same level back onto the wire
+  ASSERT_TRUE(pin_->SetHigh());
+  const size_t before{requests_};
+  ASSERT_TRUE(PushState(PinState::kLow));
+  emulator_state_ = PinState::kLow;
+  ASSERT_TRUE(pin_->SetHigh());
+  EXPECT_EQ(requests_, before + 1);
+  EXPECT_EQ(emulator_state_, PinState::kHigh);
+}
+
+TEST_F(HostPinTest, PostedWritesReportErrorsLater) {
+  std::optional<common::Error> posted_error{};
+  pin_->SetPostedWrites(
+      [&posted_error](common::Error error) { posted_error = error; });
+  reject_writes_ = true;
+  ASSERT_TRUE(pin_->SetHigh());
+  EXPECT_FALSE(posted_error);
+
+  auto completed{transport_->Poll(milliseconds{1000})};
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 1U);
+  EXPECT_EQ(posted_error, common::Error::kInvalidOperation);
+
+  // The failed write left the cache invalid, so this one is not coalesced
+  reject_writes_ = false;
+  ASSERT_TRUE(pin_->SetHigh());
+  ASSERT_TRUE(transport_->Poll(milliseconds{1000}));
+  EXPECT_EQ(requests_, 2U);
+  EXPECT_EQ(emulator_state_, PinState::kHigh);
+}
+
+TEST_F(HostPinTest, BlockingReadCompletesPostedWrites) {
+  pin_->SetPostedWrites([](common::Error /*error*/) { FAIL(); });
+  ASSERT_TRUE(pin_->SetHigh());
+  ASSERT_TRUE(pin_->Configure(PinDirection::kInput));
+  auto state{pin_->Get()};
+  ASSERT_TRUE(state);
+  EXPECT_EQ(state.value(), PinState::kHigh);
+  EXPECT_EQ(requests_, 2U);
+}
+
+}  // namespace
+}  // namespace mcu
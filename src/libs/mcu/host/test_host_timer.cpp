@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <expected>
+#include <vector>
+
+#include "libs/common/error.hpp"
+#include "libs/common/event_loop.hpp"
+#include "libs/common/time_source.hpp"
+#include "libs/mcu/host/host_timer.hpp"
+
+namespace mcu {
+namespace {
+using std::chrono::operator""ms;
+using std::chrono::operator""s;
+using std::chrono::operator""us;
+
+// Moves only when the loop asks it to, or the test does
+class ManualTime : public common::TimeSource {
+ public:
+  [[nodiscard]] auto Now() const -> Clock::time_point override { return now; }
+  auto AdvanceTo(Clock::time_point when) -> void override {
+    now = std::max(now, when);
+  }
+
+  Clock::time_point now{};
+};
+
+class HostTimerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { loop_.SetTimeSource(time_); }
+
+  // Elapsed time at each call, in milliseconds
+  auto Record() -> void {
+    fired_.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(
+                         time_.now.time_since_epoch())
+                         .count());
+  }
+
+  ManualTime time_{};
+  common::EventLoop loop_{};
+  HostTimer timer_{loop_};
+  std::vector<long> fired_{};
+};
+
+TEST_F(HostTimerTest, OneShotFiresOnce) {
+  ASSERT_TRUE(timer_.StartOnce(50ms, [this]() {
+    Record();
+    loop_.PostAfter(1s, [this]() { loop_.Stop(); });
+  }));
+  EXPECT_TRUE(timer_.IsRunning());
+  loop_.Run();
+
+  EXPECT_EQ(fired_, (std::vector<long>{50}));
+  EXPECT_FALSE(timer_.IsRunning());
+}
+
+TEST_F(HostTimerTest, PeriodicKeepsToTheGrid) {
+  ASSERT_TRUE(timer_.StartPeriodic(100ms, [this]() {
+    Record();
+    // Running late must not push back the next deadline
+    time_.now += 30ms;
+    if (fired_.size() == 3) {
+      timer_.Stop();
+      loop_.Stop();
+    }
+  }));
+  loop_.Run();
+
+  EXPECT_EQ(fired_, (std::vector<long>{100, 200, 300}));
+  EXPECT_FALSE(timer_.IsRunning());
+}
+
+TEST_F(HostTimerTest, RestartCancelsThePendingExpiry) {
+  ASSERT_TRUE(timer_.StartOnce(10ms, [this]() { Record(); }));
+  ASSERT_TRUE(timer_.StartOnce(40ms, [this]() {
+    Record();
+    loop_.Stop();
+  }));
+  loop_.Run();
+  EXPECT_EQ(fired_, (std::vector<long>{40}));
+}
+
+TEST_F(HostTimerTest, CallbackMayRestartItsTimer) {
+  ASSERT_TRUE(timer_.StartPeriodic(10ms, [this]() {
+    Record();
+    ASSERT_TRUE(timer_.StartOnce(25ms, [this]() {
+      Record();
+      loop_.Stop();
+    }));
+  }));
+  loop_.Run();
+  EXPECT_EQ(fired_, (std::vector<long>{10, 35}));
+}
+
+TEST_F(HostTimerTest, ManyTimersShareTheLoop) {
+  // A deque, since timers cannot move
+  std::deque<HostTimer> timers{};
+  std::vector<int> counts(8, 0);
+  for (size_t i = 0; i < counts.size(); ++i) {
+    timers.emplace_back(loop_);
+  }
+  for (size_t i = 0; i < timers.size(); ++i) {
+    ASSERT_TRUE(timers[i].StartPeriodic(
+        std::chrono::milliseconds{10 * (i + 1)}, [&counts, i]() {
+          ++counts[i];
+        }));
+  }
+  loop_.PostAfter(800ms + 1us, [this]() { loop_.Stop(); });
+  loop_.Run();
+
+  for (size_t i = 0; i < counts.size(); ++i) {
+    EXPECT_EQ(counts[i], static_cast<int>(80 / (i + 1))) << i;
+  }
+}
+
+TEST_F(HostTimerTest, DestroyedWithAnExpiryPending) {
+  bool called{false};
+  {
+    HostTimer timer{loop_};
+    ASSERT_TRUE(timer.StartPeriodic(10ms, [&called]() { called = true; }));
+  }
+  loop_.PostAfter(50ms, [this]() { loop_.Stop(); });
+  loop_.Run();
+
+  EXPECT_FALSE(called);
+}
+
+TEST_F(HostTimerTest, RejectsBadArguments) {
+  EXPECT_EQ(timer_.StartOnce(-1us, []() {}),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(timer_.StartPeriodic(0us, []() {}),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(timer_.StartOnce(1ms, nullptr),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_FALSE(timer_.IsRunning());
+}
+
+}  // namespace
+}  // namespace mcu
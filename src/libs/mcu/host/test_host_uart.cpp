@@ -1,17 +1,28 @@
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "libs/common/error.hpp"
+#include "libs/common/event_loop.hpp"
 #include "libs/mcu/host/dispatcher.hpp"
+#include "libs/mcu/host/emulator_message_binary_encoder.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
 #include "libs/mcu/host/emulator_message_json_encoder.hpp"
 #include "libs/mcu/host/host_emulator_messages.hpp"
 #include "libs/mcu/host/host_uart.hpp"
+#include "libs/mcu/host/shm_segment.hpp"
+#include "libs/mcu/host/shm_transport.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
+#include "libs/mcu/host/testing/forwarding_receiver.hpp"
 #include "libs/mcu/host/zmq_transport.hpp"
 #include "libs/mcu/uart.hpp"
 
@@ -40,8 +51,9 @@ class HostUartTest : public ::testing::Test {
                                   *dispatcher_)
             .value_or(nullptr);
 
-    // Now create UART with transport
-    uart_ = std::make_unique<mcu::HostUart>("UART 1", *device_transport_);
+    // Now create UART with transport and a small receive buffer
+    uart_ = std::make_unique<mcu::HostUart>(
+        "UART 1", *device_transport_, mcu::WireFormat::kJson, kRxBufferSize);
 
     // Add UART to receiver map (dispatcher holds reference, so this updates it)
     receiver_map_storage_.emplace_back(IsJson, std::ref(*uart_));
@@ -65,6 +77,31 @@ class HostUartTest : public ::testing::Test {
     }
   }
 
+  static constexpr size_t kRxBufferSize{8};
+
+  // Pushes data to the device the way the emulator does for external input,
+  // and returns the acknowledgement
+  auto SendUnsolicited(const std::vector<std::byte>& data)
+      -> mcu::UartEmulatorResponse {
+    const mcu::UartEmulatorRequest request{
+        .type = mcu::MessageType::kRequest,
+        .object = mcu::ObjectType::kUart,
+        .name = "UART 1",
+        .operation = mcu::OperationType::kReceive,
+        .data = data,
+        .size = data.size(),
+        .timeout_ms = 0,
+        .id = 0,
+    };
+    zmq::socket_t socket{unsolicited_context_, zmq::socket_type::pair};
+    socket.connect("ipc:///tmp/test_uart_emulator_device.ipc");
+    socket.send(zmq::buffer(mcu::Encode(request)), zmq::send_flags::none);
+    zmq::message_t reply{};
+    std::ignore = socket.recv(reply, zmq::recv_flags::none);
+    return mcu::Decode<mcu::UartEmulatorResponse>(reply.to_string())
+        .value_or(mcu::UartEmulatorResponse{});
+  }
+
   void EmulatorLoop() {
     std::vector<std::byte> uart_rx_buffer;
 
@@ -110,6 +147,7 @@ class HostUartTest : public ::testing::Test {
             .data = {},
             .bytes_transferred = 0,
             .status = common::Error::kOk,
+            .id = request.id,
         };
 
         if (request.operation == mcu::OperationType::kSend) {
@@ -222,11 +260,55 @@ TEST_F(HostUartTest, Available) {
   auto init_result = uart_->Init(config);
   ASSERT_TRUE(init_result);
 
-  // For host implementation, Available() always returns 0
-  // (data is retrieved on-demand from emulator)
+  // Nothing has been pushed by the emulator yet
   EXPECT_EQ(uart_->Available(), 0);
 }
 
+TEST_F(HostUartTest, UnsolicitedDataIsBufferedWithoutHandler) {
+  const mcu::UartConfig config{};
+  ASSERT_TRUE(uart_->Init(config));
+
+  const std::vector<std::byte> pushed{std::byte{0x01}, std::byte{0x02},
+                                      std::byte{0x03}};
+  const auto ack{SendUnsolicited(pushed)};
+  EXPECT_EQ(ack.bytes_transferred, pushed.size());
+  EXPECT_EQ(uart_->Available(), pushed.size());
+
+  // Served from the buffer: the test emulator's own buffer is empty, so a
+  // round trip would return nothing
+  std::array<std::byte, 2> first{};
+  auto result = uart_->Receive(first, 1000);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), 2U);
+  EXPECT_EQ(first,
+            (std::array<std::byte, 2>{std::byte{0x01}, std::byte{0x02}}));
+  EXPECT_EQ(uart_->Available(), 1U);
+
+  std::array<std::byte, 4> rest{};
+  std::expected<size_t, common::Error> async_result{
+      std::unexpected(common::Error::kUnknown)};
+  ASSERT_TRUE(uart_->ReceiveAsync(
+      rest, [&async_result](std::expected<size_t, common::Error> received) {
+        async_result = received;
+      }));
+  ASSERT_TRUE(async_result);
+  EXPECT_EQ(async_result.value(), 1U);
+  EXPECT_EQ(rest[0], std::byte{0x03});
+  EXPECT_EQ(uart_->Available(), 0U);
+  EXPECT_EQ(uart_->Overruns(), 0U);
+}
+
+TEST_F(HostUartTest, UnsolicitedDataOverrunIsCounted) {
+  const mcu::UartConfig config{};
+  ASSERT_TRUE(uart_->Init(config));
+
+  const std::vector<std::byte> pushed(kRxBufferSize + 4, std::byte{0xAA});
+  const auto ack{SendUnsolicited(pushed)};
+  EXPECT_EQ(ack.bytes_transferred, kRxBufferSize);
+  EXPECT_EQ(uart_->Available(), kRxBufferSize);
+  EXPECT_EQ(uart_->Overruns(), 4U);
+}
+
 TEST_F(HostUartTest, Flush) {
   const mcu::UartConfig config{};
   auto init_result = uart_->Init(config);
@@ -291,9 +373,184 @@ TEST_F(HostUartTest, RxHandlerUnsolicitedData) {
   EXPECT_EQ(received_data, test_data);
 }
 
+TEST_F(HostUartTest, RxHandlerRunsOnTheEventLoop) {
+  const mcu::UartConfig config{};
+  ASSERT_TRUE(uart_->Init(config));
+
+  common::EventLoop loop{};
+  uart_->SetEventLoop(loop);
+  std::vector<std::byte> received_data{};
+  ASSERT_TRUE(uart_->SetRxHandler(
+      [&received_data](const std::byte* data, size_t size) {
+        received_data.insert(received_data.end(), data, data + size);
+      }));
+
+  const std::vector<std::byte> pushed{std::byte{0xDE}, std::byte{0xAD}};
+  const auto ack{SendUnsolicited(pushed)};
+  EXPECT_EQ(ack.bytes_transferred, pushed.size());
+
+  // Acknowledged without the handler having run
+  EXPECT_TRUE(received_data.empty());
+  EXPECT_EQ(loop.RunReady(), 1U);
+  EXPECT_EQ(received_data, pushed);
+  EXPECT_EQ(uart_->Available(), 0U);
+}
+
 TEST_F(HostUartTest, RxHandlerWithoutInit) {
   // Try to set handler before initialization
   auto result = uart_->SetRxHandler([](const std::byte*, size_t) {});
   EXPECT_FALSE(result);
   EXPECT_EQ(result.error(), common::Error::kInvalidState);
 }
+
+TEST_F(HostUartTest, OverlappingAsyncOperations) {
+  const mcu::UartConfig config{};
+  ASSERT_TRUE(uart_->Init(config));
+
+  const std::array<std::byte, 3> send_data{std::byte{0x11}, std::byte{0x22},
+                                           std::byte{0x33}};
+  std::array<std::byte, 3> recv_buffer{};
+  bool send_done{false};
+  std::expected<size_t, common::Error> receive_result{
+      std::unexpected(common::Error::kUnknown)};
+
+  // Start a receive while the send is still in flight
+  ASSERT_TRUE(uart_->SendAsync(
+      send_data, [&send_done](std::expected<void, common::Error> result) {
+        EXPECT_TRUE(result);
+        send_done = true;
+      }));
+  ASSERT_TRUE(uart_->ReceiveAsync(
+      recv_buffer,
+      [&receive_result](std::expected<size_t, common::Error> result) {
+        receive_result = result;
+      }));
+  EXPECT_TRUE(uart_->IsBusy());
+
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 2);
+  EXPECT_FALSE(uart_->IsBusy());
+  EXPECT_TRUE(send_done);
+  ASSERT_TRUE(receive_result);
+  EXPECT_EQ(receive_result.value(), send_data.size());
+  EXPECT_EQ(recv_buffer, send_data);
+}
+
+TEST_F(HostUartTest, DestroyedWithAsyncOperationInFlight) {
+  const mcu::UartConfig config{};
+  ASSERT_TRUE(uart_->Init(config));
+
+  const std::array<std::byte, 1> send_data{std::byte{0x11}};
+  bool called{false};
+  ASSERT_TRUE(uart_->SendAsync(
+      send_data, [&called](std::expected<void, common::Error> /*result*/) {
+        called = true;
+      }));
+  receiver_map_storage_.clear();
+  uart_.reset();
+
+  // Nothing is left to hand the reply to, so an event loop need not wait
+  // for it; if it arrives it is dropped
+  EXPECT_FALSE(device_transport_->HasInFlight());
+  auto completed = device_transport_->Poll(std::chrono::milliseconds{100});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 0);
+  EXPECT_FALSE(called);
+}
+
+// Runs over the shared-memory transport, which moves frames without
+// allocating, so an allocation count covers the UART's own dispatch path
+class HostUartPushTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kMessages{100};
+
+  // Attaches a UART speaking format and a request for it in that format
+  void Start(mcu::WireFormat format) {
+    auto segment{mcu::ShmSegment::Create(segment_name_, 4096)};
+    ASSERT_TRUE(segment);
+    segment_ = std::move(segment.value());
+    ASSERT_TRUE(routes_.Add(mcu::ObjectType::kUart, "UART 1", uart_route_));
+    auto transport{mcu::ShmTransport::Create(segment_name_, dispatcher_)};
+    ASSERT_TRUE(transport);
+    transport_ = std::move(transport.value());
+    uart_ = std::make_unique<mcu::HostUart>("UART 1", *transport_, format);
+    uart_route_.Attach(*uart_);
+    ASSERT_TRUE(uart_->Init(mcu::UartConfig{}));
+    ASSERT_TRUE(uart_->SetRxHandler(
+        [this](const std::byte* /*data*/, size_t size) { received_ += size; }));
+    auto frame{mcu::EncodeMessage(request_, format)};
+    ASSERT_TRUE(frame);
+    frame_ = std::move(frame.value());
+  }
+
+  // Pushes the request to the UART and waits for its acknowledgement
+  auto Push() -> bool {
+    auto requests{segment_->Ring(mcu::ShmRingId::kEmulatorRequest)};
+    auto replies{segment_->Ring(mcu::ShmRingId::kDeviceReply)};
+    bool more{false};
+    const auto deadline{std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds{1000}};
+    return requests.Write(frame_, false, deadline) &&
+           replies.Read(reply_, more, deadline);
+  }
+
+  // Heap allocations made while pushing kMessages requests. The first push
+  // sizes the transport's buffers, the UART's and ours, so it is not
+  // counted.
+  auto CountPushAllocations() -> size_t {
+    EXPECT_TRUE(Push());
+    const size_t before{mcu::test::AllocationCount()};
+    size_t acknowledged{0};
+    for (size_t i = 0; i < kMessages; ++i) {
+      acknowledged += Push() ? 1 : 0;
+    }
+    const size_t allocations{mcu::test::AllocationCount() - before};
+    EXPECT_EQ(acknowledged, kMessages);
+    EXPECT_EQ(received_, (kMessages + 1) * request_.data.size());
+    return allocations;
+  }
+
+  const mcu::UartEmulatorRequest request_{
+      .type = mcu::MessageType::kRequest,
+      .object = mcu::ObjectType::kUart,
+      .name = "UART 1",
+      .operation = mcu::OperationType::kReceive,
+      .data = std::vector<std::byte>(64, std::byte{0x5A}),
+      .size = 64,
+      .timeout_ms = 0,
+  };
+  const std::string segment_name_{"host_uart_test_" +
+                                  std::to_string(getpid())};
+  std::unique_ptr<mcu::ShmSegment> segment_{};
+  mcu::test::ForwardingReceiver uart_route_{};
+  mcu::RouteTable routes_{};
+  mcu::Dispatcher dispatcher_{routes_};
+  std::unique_ptr<mcu::ShmTransport> transport_{};
+  std::unique_ptr<mcu::HostUart> uart_{};
+  std::string frame_{};
+  std::string reply_{};
+  size_t received_{0};
+};
+
+TEST_F(HostUartPushTest, PushedDataIsHandledWithoutAllocating) {
+  Start(mcu::WireFormat::kBinary);
+  EXPECT_EQ(CountPushAllocations(), 0U);
+
+  auto ack{mcu::DecodeBinary<mcu::UartEmulatorResponse>(reply_)};
+  ASSERT_TRUE(ack);
+  EXPECT_EQ(ack->status, common::Error::kOk);
+  EXPECT_EQ(ack->bytes_transferred, request_.data.size());
+}
+
+// JSON goes through a document tree, so only the binary format is free of
+// allocations. Acknowledgements still come back in the request's format.
+TEST_F(HostUartPushTest, PushedJsonDataAllocates) {
+  Start(mcu::WireFormat::kJson);
+  EXPECT_GT(CountPushAllocations(), 0U);
+
+  auto ack{mcu::Decode<mcu::UartEmulatorResponse>(reply_)};
+  ASSERT_TRUE(ack);
+  EXPECT_EQ(ack->status, common::Error::kOk);
+  EXPECT_EQ(ack->bytes_transferred, request_.data.size());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "libs/common/inplace_function.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
+
+namespace common {
+namespace {
+
+using Function = InplaceFunction<int(int), 4 * sizeof(void*)>;
+
+// Callables that do not fit are not convertible, rather than an error
+// inside the constructor
+template <size_t Words, size_t Alignment = alignof(void*)>
+struct alignas(Alignment) Capture {
+  std::array<void*, Words> words{};
+  auto operator()(int x) const -> int { return x; }
+};
+static_assert(std::is_constructible_v<Function, Capture<4>>);
+static_assert(!std::is_constructible_v<Function, Capture<5>>);
+static_assert(!std::is_constructible_v<
+              Function, Capture<1, 2 * alignof(std::max_align_t)>>);
+
+// Nor are move-only ones, which copying the function could not copy
+struct MoveOnlyCapture {
+  std::unique_ptr<int> value{};
+  auto operator()(int x) const -> int { return x; }
+};
+static_assert(!std::is_constructible_v<Function, MoveOnlyCapture>);
+
+TEST(InplaceFunctionTest, EmptyByDefault) {
+  const Function empty{};
+  EXPECT_FALSE(empty);
+  const Function null{nullptr};
+  EXPECT_FALSE(null);
+}
+
+TEST(InplaceFunctionTest, CallsTheStoredCallable) {
+  int offset{10};
+  const Function add{[&offset](int value) { return value + offset; }};
+  ASSERT_TRUE(add);
+  EXPECT_EQ(add(1), 11);
+  offset = 20;
+  EXPECT_EQ(add(1), 21);
+}
+
+TEST(InplaceFunctionTest, CopiesAreIndependent) {
+  Function counter{[count = 0](int step) mutable { return count += step; }};
+  EXPECT_EQ(counter(1), 1);
+
+  Function copy{counter};
+  EXPECT_EQ(copy(1), 2);
+  EXPECT_EQ(counter(1), 2);
+
+  copy = counter;
+  EXPECT_EQ(copy(5), 7);
+}
+
+TEST(InplaceFunctionTest, MoveLeavesTheSourceEmpty) {
+  Function source{[](int value) { return value * 2; }};
+  Function moved{std::move(source)};
+  EXPECT_FALSE(source);  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(moved(4), 8);
+
+  Function assigned{};
+  assigned = std::move(moved);
+  EXPECT_FALSE(moved);  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(assigned(5), 10);
+
+  assigned = nullptr;
+  EXPECT_FALSE(assigned);
+}
+
+TEST(InplaceFunctionTest, DestroysTheCapture) {
+  auto shared{std::make_shared<int>(3)};
+  {
+    const Function holder{[shared](int value) { return value + *shared; }};
+    EXPECT_EQ(shared.use_count(), 2);
+    EXPECT_EQ(holder(1), 4);
+  }
+  EXPECT_EQ(shared.use_count(), 1);
+
+  Function replaced{[shared](int value) { return value; }};
+  replaced = [](int value) { return -value; };
+  EXPECT_EQ(shared.use_count(), 1);
+  EXPECT_EQ(replaced(1), -1);
+}
+
+TEST(InplaceFunctionTest, NeverAllocates) {
+  std::array<int, 3> values{1, 2, 3};
+  const auto allocations{mcu::test::AllocationCount()};
+
+  Function sum{[&values, scale = 2](int extra) {
+    return (values[0] + values[1] + values[2]) * scale + extra;
+  }};
+  Function copy{sum};
+  Function moved{std::move(copy)};
+  sum = moved;
+
+  EXPECT_EQ(mcu::test::AllocationCount(), allocations);
+  EXPECT_EQ(sum(1), 13);
+}
+
+}  // namespace
+}  // namespace common
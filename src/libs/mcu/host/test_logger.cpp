@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libs/common/logger.hpp"
+
+namespace common {
+namespace {
+
+class RecordingLogger : public Logger {
+ public:
+  auto Debug(std::string_view msg) -> void override {
+    lines.push_back("D " + std::string{msg});
+  }
+  auto Info(std::string_view msg) -> void override {
+    lines.push_back("I " + std::string{msg});
+  }
+  auto Warning(std::string_view msg) -> void override {
+    lines.push_back("W " + std::string{msg});
+  }
+  auto Error(std::string_view msg) -> void override {
+    lines.push_back("E " + std::string{msg});
+  }
+
+  std::vector<std::string> lines{};
+};
+
+class CountingNullLogger : public NullLogger {
+ public:
+  auto Debug(std::string_view /* msg */) -> void override { ++calls; }
+  auto Error(std::string_view /* msg */) -> void override { ++calls; }
+
+  int calls{0};
+};
+
+TEST(LoggerTest, WriteGoesToTheLevelsMethod) {
+  RecordingLogger logger{};
+  logger.Write(LogLevel::kDebug, "a");
+  logger.Write(LogLevel::kInfo, "b");
+  logger.Write(LogLevel::kWarning, "c");
+  logger.Write(LogLevel::kError, "d");
+  logger.Write(LogLevel::kOff, "e");
+  EXPECT_EQ(logger.lines,
+            (std::vector<std::string>{"D a", "I b", "W c", "E d"}));
+}
+
+TEST(LoggerTest, LogSkipsLevelsBelowTheLoggersLevel) {
+  RecordingLogger logger{};
+  logger.SetLevel(LogLevel::kWarning);
+  Log<LogLevel::kDebug>(logger, "debug");
+  Log<LogLevel::kInfo>(logger, "info");
+  Log<LogLevel::kWarning>(logger, "warning");
+  Log<LogLevel::kError>(logger, "error");
+  EXPECT_EQ(logger.lines,
+            (std::vector<std::string>{"W warning", "E error"}));
+
+  logger.SetLevel(LogLevel::kOff);
+  Log<LogLevel::kError>(logger, "error");
+  EXPECT_EQ(logger.lines.size(), 2U);
+}
+
+TEST(LoggerTest, LogBuildsACallableMessageOnlyWhenLogged) {
+  RecordingLogger logger{};
+  logger.SetLevel(LogLevel::kError);
+  int built{0};
+  const auto message{[&built] {
+    ++built;
+    return std::string{"built"};
+  }};
+  Log<LogLevel::kWarning>(logger, message);
+  EXPECT_EQ(built, 0);
+  Log<LogLevel::kError>(logger, message);
+  EXPECT_EQ(built, 1);
+  EXPECT_EQ(logger.lines, (std::vector<std::string>{"E built"}));
+}
+
+TEST(LoggerTest, NullLoggerIsNotCalled) {
+  CountingNullLogger logger{};
+  EXPECT_EQ(logger.Level(), LogLevel::kOff);
+  Log<LogLevel::kDebug>(logger, "debug");
+  Log<LogLevel::kError>(logger, "error");
+  EXPECT_EQ(logger.calls, 0);
+}
+
+TEST(LoggerTest, EnabledHonorsTheCompiledInMinimum) {
+  RecordingLogger logger{};
+  EXPECT_EQ(logger.Enabled(LogLevel::kDebug),
+            kMinLogLevel == LogLevel::kDebug);
+  EXPECT_TRUE(logger.Enabled(LogLevel::kError));
+  EXPECT_FALSE(logger.Enabled(LogLevel::kOff));
+}
+
+}  // namespace
+}  // namespace common
@@ -1,11 +1,23 @@
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <vector>
+
+#include "emulator_message_binary_encoder.hpp"
+#include "emulator_message_codec.hpp"
 #include "emulator_message_json_encoder.hpp"
 #include "host_emulator_messages.hpp"
 
 namespace mcu {
 namespace {
 
+template <typename T>
+auto RoundTrip(const T& message) -> std::expected<T, common::Error> {
+  return EncodeBinary(message).and_then(DecodeBinary<T>);
+}
+
 TEST(EmulatorMessageJsonEncoderTest, EncodePinEmulatorRequest) {
   const PinEmulatorRequest request{.type = MessageType::kRequest,
                                    .object = ObjectType::kPin,
@@ -49,5 +61,184 @@ TEST(EmulatorMessageJsonEncoderTest, DecodeInvalidJson) {
   EXPECT_EQ(result.error(), common::Error::kInvalidArgument);
 }
 
+TEST(EmulatorMessageJsonEncoderTest, CorrelationIdIsOptional) {
+  PinEmulatorResponse response{.name = "PA0",
+                               .state = PinState::kLow,
+                               .status = common::Error::kOk,
+                               .id = 42};
+  const auto json{Encode(response)};
+  EXPECT_NE(json.find(R"("id":42)"), std::string::npos);
+  auto decoded{Decode<PinEmulatorResponse>(json)};
+  ASSERT_TRUE(decoded);
+  EXPECT_EQ(*decoded, response);
+
+  response.id = 0;
+  EXPECT_EQ(Encode(response).find("id"), std::string::npos);
+}
+
+TEST(EmulatorMessageBinaryEncoderTest, EncodeUartEmulatorRequestLayout) {
+  const UartEmulatorRequest request{.type = MessageType::kRequest,
+                                    .object = ObjectType::kUart,
+                                    .name = "U1",
+                                    .operation = OperationType::kSend,
+                                    .data = {std::byte{0xAA}, std::byte{0x55}},
+                                    .size = 0,
+                                    .timeout_ms = 0};
+  const auto frame{EncodeBinary(request).value()};
+  ASSERT_EQ(frame.size(), kBinaryFrameHeaderSize + 2 + 2);
+  EXPECT_TRUE(IsBinaryFrame(frame));
+  EXPECT_EQ(static_cast<uint8_t>(frame[1]), 1);   // Request
+  EXPECT_EQ(static_cast<uint8_t>(frame[2]), 2);   // Uart
+  EXPECT_EQ(static_cast<uint8_t>(frame[3]), 3);   // Send
+  EXPECT_EQ(static_cast<uint8_t>(frame[6]), 2);   // Name size
+  EXPECT_EQ(static_cast<uint8_t>(frame[24]), 2);  // Data size
+  EXPECT_EQ(frame.substr(kBinaryFrameHeaderSize, 2), "U1");
+  EXPECT_EQ(static_cast<uint8_t>(frame[kBinaryFrameHeaderSize + 2]), 0xAA);
+  EXPECT_EQ(static_cast<uint8_t>(frame[kBinaryFrameHeaderSize + 3]), 0x55);
+}
+
+TEST(EmulatorMessageBinaryEncoderTest, EncodeDecodeAllMessageTypes) {
+  const PinEmulatorRequest pin_request{.name = "LED 1",
+                                       .operation = OperationType::kSet,
+                                       .state = PinState::kHigh};
+  EXPECT_EQ(RoundTrip(pin_request), pin_request);
+
+  const PinEmulatorResponse pin_response{.name = "LED 1",
+                                         .state = PinState::kLow,
+                                         .status = common::Error::kOk};
+  EXPECT_EQ(RoundTrip(pin_response), pin_response);
+
+  const UartEmulatorRequest uart_request{.name = "UART 1",
+                                         .operation = OperationType::kReceive,
+                                         .data = {},
+                                         .size = 4096,
+                                         .timeout_ms = 100};
+  EXPECT_EQ(RoundTrip(uart_request), uart_request);
+
+  const UartEmulatorResponse uart_response{
+      .name = "UART 1",
+      .data = std::vector<std::byte>(4096, std::byte{0x5A}),
+      .bytes_transferred = 4096,
+      .status = common::Error::kOk};
+  EXPECT_EQ(RoundTrip(uart_response), uart_response);
+
+  const I2CEmulatorRequest i2c_request{.name = "I2C 1",
+                                       .operation = OperationType::kSend,
+                                       .address = 0x50,
+                                       .data = {std::byte{0xDE}},
+                                       .size = 0};
+  EXPECT_EQ(RoundTrip(i2c_request), i2c_request);
+
+  const I2CEmulatorResponse i2c_response{.name = "I2C 1",
+                                         .address = 0x50,
+                                         .data = {std::byte{0xAD}},
+                                         .bytes_transferred = 1,
+                                         .status = common::Error::kTimeout};
+  EXPECT_EQ(RoundTrip(i2c_response), i2c_response);
+
+  const PortEmulatorRequest port_request{.name = "Port A",
+                                         .operation = OperationType::kSet,
+                                         .mask = 0x8000'00F0,
+                                         .value = 0xFFFF'FF50};
+  EXPECT_EQ(RoundTrip(port_request), port_request);
+
+  const PortEmulatorResponse port_response{.name = "Port A",
+                                           .value = 0x8000'0050,
+                                           .status = common::Error::kOk};
+  EXPECT_EQ(RoundTrip(port_response), port_response);
+
+  const ClockEmulatorRequest clock_request{.name = "Clock",
+                                           .advance_us = 0xFFFF'FFFF};
+  EXPECT_EQ(RoundTrip(clock_request), clock_request);
+
+  const ClockEmulatorResponse clock_response{.name = "Clock",
+                                             .status = common::Error::kOk};
+  EXPECT_EQ(RoundTrip(clock_response), clock_response);
+}
+
+TEST(EmulatorMessageJsonEncoderTest, EncodeDecodePortEmulatorRequest) {
+  const PortEmulatorRequest request{.name = "Port A",
+                                    .operation = OperationType::kSet,
+                                    .mask = 0x0F,
+                                    .value = 0x05};
+  const std::string expected_json{
+      R"({"mask":15,"name":"Port A","object":"Port","operation":"Set",)"
+      R"("type":"Request","value":5})"};
+  EXPECT_EQ(Encode(request), expected_json);
+  EXPECT_EQ(Decode<PortEmulatorRequest>(expected_json), request);
+}
+
+TEST(EmulatorMessageJsonEncoderTest, EncodeDecodeClockEmulatorRequest) {
+  const ClockEmulatorRequest request{.name = "Clock", .advance_us = 200'000};
+  const std::string expected_json{
+      R"({"advance_us":200000,"name":"Clock","object":"Clock",)"
+      R"("operation":"Advance","type":"Request"})"};
+  EXPECT_EQ(Encode(request), expected_json);
+  EXPECT_EQ(Decode<ClockEmulatorRequest>(expected_json), request);
+}
+
+TEST(EmulatorMessageBinaryEncoderTest, EncodeDecodeCorrelationId) {
+  const I2CEmulatorRequest request{.name = "I2C 1",
+                                   .operation = OperationType::kReceive,
+                                   .address = 0x50,
+                                   .data = {},
+                                   .size = 4,
+                                   .id = 0x01020304};
+  const auto frame{EncodeBinary(request).value()};
+  EXPECT_EQ(static_cast<uint8_t>(frame[28]), 0x04);
+  EXPECT_EQ(static_cast<uint8_t>(frame[31]), 0x01);
+  auto decoded{DecodeBinary<I2CEmulatorRequest>(frame)};
+  ASSERT_TRUE(decoded);
+  EXPECT_EQ(*decoded, request);
+}
+
+TEST(EmulatorMessageBinaryEncoderTest, DecodeRejectsMismatchedMessage) {
+  const UartEmulatorResponse response{.name = "UART 1",
+                                      .data = {},
+                                      .bytes_transferred = 0,
+                                      .status = common::Error::kOk};
+  auto result =
+      EncodeBinary(response).and_then(DecodeBinary<UartEmulatorRequest>);
+  EXPECT_FALSE(result);
+  EXPECT_EQ(result.error(), common::Error::kInvalidArgument);
+}
+
+TEST(EmulatorMessageBinaryEncoderTest, DecodeTruncatedFrame) {
+  const PinEmulatorRequest request{.name = "PA0",
+                                   .operation = OperationType::kGet,
+                                   .state = PinState::kHighZ};
+  auto frame{EncodeBinary(request).value()};
+  frame.pop_back();
+  auto result = DecodeBinary<PinEmulatorRequest>(frame);
+  EXPECT_FALSE(result);
+  EXPECT_EQ(result.error(), common::Error::kInvalidArgument);
+}
+
+TEST(EmulatorMessageBinaryEncoderTest, EncodeRejectsOversizedName) {
+  const PinEmulatorRequest request{
+      .name = std::string(kMaxBinaryNameSize + 1, 'P'),
+      .operation = OperationType::kGet,
+      .state = PinState::kLow};
+  EXPECT_EQ(EncodeBinary(request),
+            std::unexpected(common::Error::kMessageTooLarge));
+  EXPECT_EQ(EncodeMessage(request, WireFormat::kBinary),
+            std::unexpected(common::Error::kMessageTooLarge));
+  EXPECT_TRUE(EncodeMessage(request, WireFormat::kJson));
+}
+
+TEST(EmulatorMessageCodecTest, DecodeMessageDetectsFormat) {
+  const PinEmulatorRequest request{.name = "PA0",
+                                   .operation = OperationType::kSet,
+                                   .state = PinState::kLow};
+  const auto json{EncodeMessage(request, WireFormat::kJson).value()};
+  const auto binary{EncodeMessage(request, WireFormat::kBinary).value()};
+  EXPECT_EQ(FormatOf(json), WireFormat::kJson);
+  EXPECT_EQ(FormatOf(binary), WireFormat::kBinary);
+  EXPECT_TRUE(IsEmulatorMessage(json));
+  EXPECT_TRUE(IsEmulatorMessage(binary));
+  EXPECT_EQ(DecodeMessage<PinEmulatorRequest>(json), request);
+  EXPECT_EQ(DecodeMessage<PinEmulatorRequest>(binary), request);
+}
+
 }  // namespace
 }  // namespace mcu
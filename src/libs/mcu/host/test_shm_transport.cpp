@@ -0,0 +1,387 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "dispatcher.hpp"
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
+#include "receiver.hpp"
+#include "shm_ring.hpp"
+#include "shm_segment.hpp"
+#include "shm_transport.hpp"
+
+namespace mcu {
+namespace {
+
+using std::chrono::milliseconds;
+
+auto Deadline(milliseconds timeout) -> std::chrono::steady_clock::time_point {
+  return std::chrono::steady_clock::now() + timeout;
+}
+
+// Plays the emulator: creates the segment and answers device requests the
+// same way the ZmqTransport test server does
+class ShmTransportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto segment{ShmSegment::Create(name_, kRingCapacity)};
+    ASSERT_TRUE(segment);
+    segment_ = std::move(segment.value());
+    server_thread_ = std::thread{&ShmTransportTest::ServerThread, this};
+  }
+
+  void TearDown() override {
+    running_ = false;
+    server_thread_.join();
+  }
+
+  static constexpr uint32_t kRingCapacity{4096};
+  // Unique per process so parallel test runs do not share a segment
+  const std::string name_{"shm_transport_test_" + std::to_string(getpid())};
+  std::unique_ptr<ShmSegment> segment_{};
+
+ private:
+  void ServerThread() {
+    auto requests{segment_->Ring(ShmRingId::kDeviceRequest)};
+    auto replies{segment_->Ring(ShmRingId::kEmulatorReply)};
+    std::string request{};
+    std::vector<std::string> batch{};
+    bool more{false};
+    while (running_) {
+      if (!requests.Read(request, more, Deadline(milliseconds{50}))) {
+        continue;
+      }
+      batch.push_back(request);
+      if (more) {
+        continue;
+      }
+      // A batch ending in an empty frame was abandoned by the device
+      if (batch.back().empty()) {
+        batch.clear();
+        continue;
+      }
+      // "Hello" gets "World", anything else is echoed back
+      for (size_t i = 0; i < batch.size(); ++i) {
+        const std::string reply{batch[i] == "Hello" ? "World" : batch[i]};
+        ASSERT_TRUE(replies.Write(reply, i + 1 < batch.size(),
+                                  Deadline(milliseconds{1000})));
+      }
+      batch.clear();
+    }
+  }
+
+  std::thread server_thread_;
+  std::atomic<bool> running_{true};
+};
+
+class EchoReceiver : public Receiver {
+ public:
+  auto Receive(const std::string_view& message)
+      -> std::expected<std::string, common::Error> override {
+    return "Echo " + std::string{message};
+  }
+};
+
+// Writes its reply into the transport's buffer instead of returning one
+class BufferedEchoReceiver : public Receiver {
+ public:
+  auto Receive(const std::string_view& /*message*/)
+      -> std::expected<std::string, common::Error> override {
+    return std::unexpected(common::Error::kInvalidOperation);
+  }
+  auto ReceiveInto(const std::string_view& message, std::string& reply)
+      -> std::expected<void, common::Error> override {
+    reply.append("Echo ");
+    reply.append(message);
+    return {};
+  }
+};
+
+TEST(ShmRingTest, FramesWrapAroundTheEnd) {
+  constexpr uint32_t kCapacity{64};
+  std::vector<std::byte> memory(ShmRing::SizeFor(kCapacity));
+  ShmRing ring{memory.data(), kCapacity};
+  std::string frame{};
+  bool more{false};
+  // 4 + 25 bytes per record never divides 64, so records straddle the end
+  for (char fill = 'a'; fill < 'k'; ++fill) {
+    const std::string sent(25, fill);
+    ASSERT_TRUE(ring.Write(sent, fill == 'b', Deadline(milliseconds{0})));
+    ASSERT_TRUE(ring.Read(frame, more, Deadline(milliseconds{0})));
+    EXPECT_EQ(frame, sent);
+    EXPECT_EQ(more, fill == 'b');
+  }
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(ShmRingTest, FullAndEmptyTimeOut) {
+  constexpr uint32_t kCapacity{64};
+  std::vector<std::byte> memory(ShmRing::SizeFor(kCapacity));
+  ShmRing ring{memory.data(), kCapacity};
+  std::string frame{};
+  bool more{false};
+  EXPECT_EQ(ring.Read(frame, more, Deadline(milliseconds{1})),
+            std::unexpected(common::Error::kTimeout));
+  ASSERT_TRUE(
+      ring.Write(std::string(40, 'x'), false, Deadline(milliseconds{0})));
+  EXPECT_EQ(ring.Write(std::string(40, 'y'), false, Deadline(milliseconds{1})),
+            std::unexpected(common::Error::kTimeout));
+  EXPECT_EQ(ring.Write(std::string(61, 'z'), false, Deadline(milliseconds{0})),
+            std::unexpected(common::Error::kMessageTooLarge));
+}
+
+TEST(ShmRingTest, ReadIntoBufferLeavesFramesThatDoNotFit) {
+  constexpr uint32_t kCapacity{64};
+  std::vector<std::byte> memory(ShmRing::SizeFor(kCapacity));
+  ShmRing ring{memory.data(), kCapacity};
+  std::array<char, 8> buffer{};
+  std::string frame{};
+  bool more{false};
+  ASSERT_TRUE(ring.Write("too long to fit", false, Deadline(milliseconds{0})));
+  ASSERT_TRUE(ring.Write("fits", true, Deadline(milliseconds{0})));
+  EXPECT_EQ(ring.Read(buffer, more, Deadline(milliseconds{0})),
+            std::unexpected(common::Error::kMessageTooLarge));
+  ASSERT_TRUE(ring.Read(frame, more, Deadline(milliseconds{0})));
+  EXPECT_EQ(frame, "too long to fit");
+  auto size{ring.Read(buffer, more, Deadline(milliseconds{0}))};
+  ASSERT_TRUE(size);
+  EXPECT_EQ(std::string_view(buffer.data(), size.value()), "fits");
+  EXPECT_TRUE(more);
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(ShmSegmentTest, OpenTimesOutWithoutCreator) {
+  auto segment{ShmSegment::Open("shm_segment_test_missing", milliseconds{20})};
+  EXPECT_EQ(segment.error(), common::Error::kTimeout);
+}
+
+TEST(ShmSegmentTest, CreateRejectsCapacityThatIsNotAPowerOfTwo) {
+  auto segment{ShmSegment::Create("shm_segment_test_capacity", 1000)};
+  EXPECT_EQ(segment.error(), common::Error::kInvalidArgument);
+}
+
+TEST_F(ShmTransportTest, SendReceive) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create("shm://" + name_, dispatcher);
+  ASSERT_TRUE(transport);
+  ASSERT_TRUE((*transport)->Send("Hello"));
+  auto response = (*transport)->Receive();
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.value(), "World");
+}
+
+TEST_F(ShmTransportTest, ReceiveIntoBuffer) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+  std::array<char, 8> buffer{};
+  ASSERT_TRUE((*transport)->Send("Hello"));
+  auto size = (*transport)->Receive(buffer);
+  ASSERT_TRUE(size);
+  EXPECT_EQ(std::string_view(buffer.data(), size.value()), "World");
+
+  ASSERT_TRUE((*transport)->Send("longer than the buffer"));
+  EXPECT_EQ((*transport)->Receive(buffer),
+            std::unexpected(common::Error::kMessageTooLarge));
+}
+
+TEST_F(ShmTransportTest, ReceiveIntoBufferCompletesLargeInFlightReplies) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+  auto& device = **transport;
+
+  const auto id{device.NextId()};
+  const std::string request{
+      R"({"type":"Response","object":"Uart","name":"UART 1","id":)" +
+      std::to_string(id) + "}"};
+  std::string completed{};
+  ASSERT_TRUE(device.SendAsync(
+      request, id,
+      [&completed](std::expected<std::string_view, common::Error> reply) {
+        ASSERT_TRUE(reply);
+        completed = reply.value();
+      }));
+  ASSERT_TRUE(device.Send("Hello"));
+
+  // The async reply does not fit, but is not the one being waited for
+  std::array<char, 8> buffer{};
+  auto size = device.Receive(buffer);
+  ASSERT_TRUE(size);
+  EXPECT_EQ(std::string_view(buffer.data(), size.value()), "World");
+  EXPECT_EQ(completed, request);
+}
+
+TEST_F(ShmTransportTest, SendRejectsFramesLargerThanTheRing) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+  EXPECT_EQ((*transport)->Send(std::string(kRingCapacity, 'x')),
+            std::unexpected(common::Error::kMessageTooLarge));
+}
+
+TEST_F(ShmTransportTest, FlushBatch) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+  ASSERT_TRUE((*transport)->Enqueue("Hello"));
+  ASSERT_TRUE((*transport)->Enqueue("one"));
+  ASSERT_TRUE((*transport)->Enqueue("two"));
+  auto replies = (*transport)->Flush();
+  ASSERT_TRUE(replies);
+  EXPECT_EQ(replies.value(),
+            (std::vector<std::string>{"World", "one", "two"}));
+
+  ASSERT_TRUE((*transport)->Send("Hello"));
+  auto response = (*transport)->Receive();
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.value(), "World");
+}
+
+TEST_F(ShmTransportTest, FlushAbandonsBatchThatFailsPartWay) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+  ASSERT_TRUE((*transport)->Enqueue("one"));
+  ASSERT_TRUE((*transport)->Enqueue(std::string(kRingCapacity, 'x')));
+  EXPECT_EQ((*transport)->Flush(),
+            std::unexpected(common::Error::kMessageTooLarge));
+
+  // Nothing of the failed batch is answered or merged into the next request
+  ASSERT_TRUE((*transport)->Send("Hello"));
+  auto response = (*transport)->Receive();
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.value(), "World");
+}
+
+TEST_F(ShmTransportTest, SendAsyncCompletesByCorrelationId) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+  auto& device = **transport;
+
+  auto make_request = [](uint32_t id) {
+    return R"({"type":"Response","object":"Pin","name":"LED 1","id":)" +
+           std::to_string(id) + "}";
+  };
+  std::vector<std::string> replies{};
+  auto on_reply =
+      [&replies](std::expected<std::string_view, common::Error> reply) {
+        ASSERT_TRUE(reply);
+        replies.emplace_back(reply.value());
+      };
+
+  const auto first_id{device.NextId()};
+  const auto second_id{device.NextId()};
+  ASSERT_TRUE(device.SendAsync(make_request(first_id), first_id, on_reply));
+  ASSERT_TRUE(device.SendAsync(make_request(second_id), second_id, on_reply));
+  EXPECT_FALSE(device.SendAsync(make_request(first_id), first_id, on_reply));
+
+  auto completed = device.Poll(milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 2U);
+  EXPECT_EQ(replies, (std::vector<std::string>{make_request(first_id),
+                                               make_request(second_id)}));
+}
+
+TEST_F(ShmTransportTest, CancelledRequestsDiscardTheirReply) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+  auto& device = **transport;
+
+  const auto id{device.NextId()};
+  const std::string request{
+      R"({"type":"Response","object":"Pin","name":"LED 1","id":)" +
+      std::to_string(id) + "}"};
+  bool called{false};
+  ASSERT_TRUE(device.SendAsync(
+      request, id,
+      [&called](std::expected<std::string_view, common::Error> /*reply*/) {
+        called = true;
+      }));
+  device.Cancel(id);
+  // Nothing waits on the reply any more, so an event loop need not poll
+  EXPECT_FALSE(device.HasInFlight());
+
+  // The cancelled reply is not mistaken for the blocking request's
+  ASSERT_TRUE(device.Send("Hello"));
+  auto response = device.Receive();
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.value(), "World");
+  EXPECT_FALSE(called);
+}
+
+TEST_F(ShmTransportTest, DispatchesEmulatorRequests) {
+  EchoReceiver receiver{};
+  const ReceiverMap receiver_map{
+      {[](const std::string_view&) { return true; }, std::ref(receiver)}};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+
+  auto requests{segment_->Ring(ShmRingId::kEmulatorRequest)};
+  auto replies{segment_->Ring(ShmRingId::kDeviceReply)};
+  ASSERT_TRUE(requests.Write("ping", false, Deadline(milliseconds{1000})));
+  std::string reply{};
+  bool more{true};
+  ASSERT_TRUE(replies.Read(reply, more, Deadline(milliseconds{1000})));
+  EXPECT_EQ(reply, "Echo ping");
+  EXPECT_FALSE(more);
+}
+
+TEST_F(ShmTransportTest, DispatchesEmulatorRequestsWithoutAllocating) {
+  BufferedEchoReceiver receiver{};
+  const ReceiverMap receiver_map{
+      {[](const std::string_view&) { return true; }, std::ref(receiver)}};
+  Dispatcher dispatcher{receiver_map};
+  auto transport = ShmTransport::Create(name_, dispatcher);
+  ASSERT_TRUE(transport);
+
+  auto requests{segment_->Ring(ShmRingId::kEmulatorRequest)};
+  auto replies{segment_->Ring(ShmRingId::kDeviceReply)};
+  // Longer than the small string buffer so the reply has to be heap-backed
+  const std::string request(64, 'x');
+  std::string reply{};
+  bool more{false};
+  // The first message sizes the transport's buffers, and ours
+  ASSERT_TRUE(requests.Write(request, false, Deadline(milliseconds{1000})));
+  ASSERT_TRUE(replies.Read(reply, more, Deadline(milliseconds{1000})));
+  EXPECT_EQ(reply, "Echo " + request);
+
+  constexpr size_t kMessages{100};
+  const size_t before{test::AllocationCount()};
+  size_t echoed{0};
+  for (size_t i = 0; i < kMessages; ++i) {
+    const auto deadline{Deadline(milliseconds{1000})};
+    if (requests.Write(request, false, deadline) &&
+        replies.Read(reply, more, deadline)) {
+      ++echoed;
+    }
+  }
+  const size_t allocations{test::AllocationCount() - before};
+  EXPECT_EQ(echoed, kMessages);
+  EXPECT_EQ(allocations, 0U);
+}
+
+}  // namespace
+}  // namespace mcu
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libs/common/error.hpp"
+#include "libs/common/event_loop.hpp"
+#include "libs/mcu/delay.hpp"
+#include "libs/mcu/host/emulator_message_codec.hpp"
+#include "libs/mcu/host/host_delay.hpp"
+#include "libs/mcu/host/host_emulator_messages.hpp"
+#include "libs/mcu/host/simulation_clock.hpp"
+#include "libs/mcu/host/transport.hpp"
+
+namespace mcu {
+namespace {
+using std::chrono::operator""h;
+using std::chrono::operator""ms;
+using std::chrono::operator""us;
+
+// Plays the emulator's side of the clock: records each advance and replies
+// with status
+class FakeEmulator : public Transport {
+ public:
+  auto Send(std::string_view data)
+      -> std::expected<void, common::Error> override {
+    auto request{DecodeMessage<ClockEmulatorRequest>(data)};
+    if (!request) {
+      return std::unexpected(request.error());
+    }
+    advances.push_back(request->advance_us);
+    return EncodeMessage(
+        ClockEmulatorResponse{.name = request->name, .status = status},
+        FormatOf(data), reply_);
+  }
+  auto Receive() -> std::expected<std::string, common::Error> override {
+    return reply_;
+  }
+  auto Receive(std::span<char> buffer)
+      -> std::expected<size_t, common::Error> override {
+    if (reply_.size() > buffer.size()) {
+      return std::unexpected(common::Error::kMessageTooLarge);
+    }
+    std::ranges::copy(reply_, buffer.begin());
+    return reply_.size();
+  }
+  auto Enqueue(std::string_view /*data*/)
+      -> std::expected<void, common::Error> override {
+    return std::unexpected(common::Error::kInvalidOperation);
+  }
+  auto Flush()
+      -> std::expected<std::vector<std::string>, common::Error> override {
+    return std::unexpected(common::Error::kInvalidOperation);
+  }
+  auto NextId() -> uint32_t override { return 0; }
+  auto SendAsync(std::string_view /*data*/, uint32_t /*id*/,
+                 ResponseHandler /*handler*/)
+      -> std::expected<void, common::Error> override {
+    return std::unexpected(common::Error::kInvalidOperation);
+  }
+  auto Poll(std::chrono::milliseconds /*timeout*/)
+      -> std::expected<size_t, common::Error> override {
+    return 0;
+  }
+  auto Cancel(uint32_t /*id*/) -> void override {}
+  [[nodiscard]] auto HasInFlight() const -> bool override { return false; }
+  auto StopServing() -> void override {}
+
+  std::vector<uint32_t> advances{};
+  common::Error status{common::Error::kOk};
+
+ private:
+  std::string reply_{};
+};
+
+TEST(SimulationClockTest, AdvanceReportsToTheEmulator) {
+  FakeEmulator emulator{};
+  SimulationClock clock{"Clock", emulator, WireFormat::kBinary};
+  EXPECT_EQ(clock.Elapsed(), 0us);
+
+  EXPECT_TRUE(clock.Advance(1500us));
+  EXPECT_TRUE(clock.Advance(0us));
+  EXPECT_EQ(clock.Elapsed(), 1500us);
+  EXPECT_EQ(emulator.advances, (std::vector<uint32_t>{1500}));
+
+  EXPECT_FALSE(clock.Advance(-1us));
+}
+
+TEST(SimulationClockTest, LongAdvancesAreSplit) {
+  FakeEmulator emulator{};
+  SimulationClock clock{"Clock", emulator, WireFormat::kBinary};
+  EXPECT_TRUE(clock.Advance(2h));
+  EXPECT_EQ(clock.Elapsed(), 2h);
+  ASSERT_EQ(emulator.advances.size(), 2U);
+  EXPECT_EQ(emulator.advances[0], UINT32_MAX);
+}
+
+TEST(SimulationClockTest, TimeMovesOnWhenTheEmulatorRefuses) {
+  FakeEmulator emulator{};
+  emulator.status = common::Error::kInvalidOperation;
+  SimulationClock clock{"Clock", emulator, WireFormat::kBinary};
+  EXPECT_EQ(clock.Advance(10ms),
+            std::unexpected(common::Error::kInvalidOperation));
+  EXPECT_EQ(clock.Elapsed(), 10ms);
+
+  clock.AdvanceTo(clock.Now() + 5ms);
+  clock.AdvanceTo(clock.Now() - 5ms);
+  EXPECT_EQ(clock.Elapsed(), 15ms);
+}
+
+TEST(SimulationClockTest, DelayAdvancesTheClock) {
+  FakeEmulator emulator{};
+  SimulationClock clock{"Clock", emulator, WireFormat::kBinary};
+  SetDelayTimeSource(&clock);
+  const auto start{std::chrono::steady_clock::now()};
+  Delay(std::chrono::hours{1});
+  SetDelayTimeSource(nullptr);
+
+  EXPECT_EQ(clock.Elapsed(), 1h);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1h);
+}
+
+TEST(SimulationClockTest, EventLoopTimersSkipAhead) {
+  FakeEmulator emulator{};
+  SimulationClock clock{"Clock", emulator, WireFormat::kBinary};
+  common::EventLoop loop{};
+  loop.SetTimeSource(clock);
+
+  // A day of blinking, one toggle every 200 ms
+  constexpr int kBlinks{24 * 60 * 60 * 5};
+  int blinks{0};
+  std::function<void()> blink{[&]() {
+    if (++blinks == kBlinks) {
+      loop.Stop();
+      return;
+    }
+    loop.PostAfter(200ms, blink);
+  }};
+  loop.PostAfter(200ms, blink);
+  loop.Run();
+
+  EXPECT_EQ(blinks, kBlinks);
+  EXPECT_EQ(clock.Elapsed(), std::chrono::hours{24});
+  EXPECT_EQ(emulator.advances.size(), static_cast<size_t>(kBlinks));
+}
+
+}  // namespace
+}  // namespace mcu
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "libs/common/spsc_ring.hpp"
+
+namespace common {
+namespace {
+
+TEST(SpscRingTest, PushPopPreservesOrder) {
+  SpscRing<int> ring{4};
+  const std::array<int, 3> input{1, 2, 3};
+  EXPECT_EQ(ring.Push(input), 3U);
+  EXPECT_EQ(ring.Size(), 3U);
+
+  std::array<int, 2> output{};
+  EXPECT_EQ(ring.Pop(output), 2U);
+  EXPECT_EQ(output, (std::array<int, 2>{1, 2}));
+  EXPECT_EQ(ring.Size(), 1U);
+}
+
+TEST(SpscRingTest, PushStopsWhenFull) {
+  SpscRing<int> ring{4};
+  const std::array<int, 6> input{1, 2, 3, 4, 5, 6};
+  EXPECT_EQ(ring.Push(input), 4U);
+  EXPECT_EQ(ring.Push(input), 0U);
+  EXPECT_EQ(ring.Size(), ring.Capacity());
+}
+
+TEST(SpscRingTest, WrapsAroundTheEnd) {
+  SpscRing<int> ring{5};
+  std::array<int, 3> output{};
+  for (int round = 0; round < 10; ++round) {
+    const std::array<int, 3> input{round, round + 1, round + 2};
+    ASSERT_EQ(ring.Push(input), 3U);
+    ASSERT_EQ(ring.Pop(output), 3U);
+    EXPECT_EQ(output, input);
+  }
+  EXPECT_EQ(ring.Size(), 0U);
+}
+
+TEST(SpscRingTest, ProducerAndConsumerThreads) {
+  constexpr int kCount{100000};
+  SpscRing<int> ring{64};
+  std::thread producer{[&ring]() {
+    for (int next = 0; next < kCount;) {
+      if (ring.Push(std::span{&next, 1}) == 0) {
+        std::this_thread::yield();  // Full
+      } else {
+        ++next;
+      }
+    }
+  }};
+
+  std::vector<int> received{};
+  received.reserve(kCount);
+  std::array<int, 16> chunk{};
+  while (received.size() < kCount) {
+    const size_t count{ring.Pop(chunk)};
+    if (count == 0) {
+      std::this_thread::yield();  // Empty
+    }
+    received.insert(received.end(), chunk.begin(),
+                    chunk.begin() + static_cast<std::ptrdiff_t>(count));
+  }
+  producer.join();
+
+  std::vector<int> expected(kCount);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(received, expected);
+}
+
+}  // namespace
+}  // namespace common
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <expected>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/stm32/stm32_gpio_port.hpp"
+
+namespace mcu {
+namespace {
+
+// The members of GPIO_TypeDef the driver uses, with a record of every
+// store to BSRR so a test can check how many accesses an operation took
+struct FakeGpioRegisters {
+  struct SetResetRegister {
+    auto operator=(uint32_t value) -> SetResetRegister& {
+      last = value;
+      ++stores;
+      return *this;
+    }
+    uint32_t last{0};
+    int stores{0};
+  };
+
+  uint32_t IDR{0};  // NOLINT(readability-identifier-naming)
+  uint32_t ODR{0};  // NOLINT(readability-identifier-naming)
+  SetResetRegister BSRR{};  // NOLINT(readability-identifier-naming)
+};
+
+TEST(Stm32GpioPortTest, WriteIsOneSetResetStore) {
+  FakeGpioRegisters registers{};
+  Stm32GpioPort port{registers};
+  ASSERT_TRUE(port.Write(0x00F0, 0x0050));
+  EXPECT_EQ(registers.BSRR.stores, 1);
+  EXPECT_EQ(registers.BSRR.last, 0x00A0'0050U);
+}
+
+TEST(Stm32GpioPortTest, WriteLeavesUnmaskedPinsOut) {
+  FakeGpioRegisters registers{};
+  Stm32GpioPort port{registers};
+  ASSERT_TRUE(port.Write(0x0001, 0xFFFF));
+  EXPECT_EQ(registers.BSRR.last, 0x0000'0001U);
+  ASSERT_TRUE(port.Write(0x0001, 0x0000));
+  EXPECT_EQ(registers.BSRR.last, 0x0001'0000U);
+}
+
+TEST(Stm32GpioPortTest, ToggleInvertsTheDrivenLevels) {
+  FakeGpioRegisters registers{.ODR = 0x0005};
+  Stm32GpioPort port{registers};
+  ASSERT_TRUE(port.Toggle(0x000F));
+  EXPECT_EQ(registers.BSRR.stores, 1);
+  EXPECT_EQ(registers.BSRR.last, 0x0005'000AU);
+}
+
+TEST(Stm32GpioPortTest, ReadReturnsTheInputLevels) {
+  FakeGpioRegisters registers{.IDR = 0x0001'8001, .ODR = 0x00FF};
+  Stm32GpioPort port{registers};
+  EXPECT_EQ(port.Read(), 0x8001U);
+}
+
+TEST(Stm32GpioPortTest, RejectsPinsThePortDoesNotHave) {
+  FakeGpioRegisters registers{};
+  Stm32GpioPort port{registers};
+  EXPECT_EQ(port.Write(0x1'0000, 0),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(port.Toggle(0x1'0000),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(registers.BSRR.stores, 0);
+}
+
+}  // namespace
+}  // namespace mcu
@@ -0,0 +1,324 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/stm32/stm32_i2c.hpp"
+
+namespace mcu {
+namespace {
+
+// What the fake HAL was last asked to do
+struct HalCalls {
+  enum class Call : uint8_t {
+    kNone,
+    kTransmit,
+    kReceive,
+    kTransmitIt,
+    kReceiveIt,
+    kTransmitDma,
+    kReceiveDma,
+    kMemRead,
+    kSeqTransmitIt,
+    kSeqReceiveIt,
+    kSeqTransmitDma,
+    kSeqReceiveDma
+  };
+
+  Call last{Call::kNone};
+  uint16_t address{0};
+  uint8_t* data{nullptr};
+  uint16_t size{0};
+  uint16_t mem_address{0};
+  uint16_t mem_size{0};
+  Stm32I2CFrame frame{};
+  Stm32HalStatus status{Stm32HalStatus::kOk};
+};
+
+// Records each call and answers with the status the test chose
+struct FakeHal {
+  HalCalls* calls;
+
+  auto Transmit(uint16_t address, uint8_t* data, uint16_t size,
+                uint32_t /*timeout_ms*/) -> Stm32HalStatus {
+    return Record(HalCalls::Call::kTransmit, address, data, size);
+  }
+  auto Receive(uint16_t address, uint8_t* data, uint16_t size,
+               uint32_t /*timeout_ms*/) -> Stm32HalStatus {
+    return Record(HalCalls::Call::kReceive, address, data, size);
+  }
+  auto TransmitIt(uint16_t address, uint8_t* data, uint16_t size)
+      -> Stm32HalStatus {
+    return Record(HalCalls::Call::kTransmitIt, address, data, size);
+  }
+  auto ReceiveIt(uint16_t address, uint8_t* data, uint16_t size)
+      -> Stm32HalStatus {
+    return Record(HalCalls::Call::kReceiveIt, address, data, size);
+  }
+  auto TransmitDma(uint16_t address, uint8_t* data, uint16_t size)
+      -> Stm32HalStatus {
+    return Record(HalCalls::Call::kTransmitDma, address, data, size);
+  }
+  auto ReceiveDma(uint16_t address, uint8_t* data, uint16_t size)
+      -> Stm32HalStatus {
+    return Record(HalCalls::Call::kReceiveDma, address, data, size);
+  }
+  auto MemRead(uint16_t address, uint16_t mem_address, uint16_t mem_size,
+               uint8_t* data, uint16_t size, uint32_t /*timeout_ms*/)
+      -> Stm32HalStatus {
+    calls->mem_address = mem_address;
+    calls->mem_size = mem_size;
+    return Record(HalCalls::Call::kMemRead, address, data, size);
+  }
+  auto SeqTransmitIt(uint16_t address, uint8_t* data, uint16_t size,
+                     Stm32I2CFrame frame) -> Stm32HalStatus {
+    calls->frame = frame;
+    return Record(HalCalls::Call::kSeqTransmitIt, address, data, size);
+  }
+  auto SeqReceiveIt(uint16_t address, uint8_t* data, uint16_t size,
+                    Stm32I2CFrame frame) -> Stm32HalStatus {
+    calls->frame = frame;
+    return Record(HalCalls::Call::kSeqReceiveIt, address, data, size);
+  }
+  auto SeqTransmitDma(uint16_t address, uint8_t* data, uint16_t size,
+                      Stm32I2CFrame frame) -> Stm32HalStatus {
+    calls->frame = frame;
+    return Record(HalCalls::Call::kSeqTransmitDma, address, data, size);
+  }
+  auto SeqReceiveDma(uint16_t address, uint8_t* data, uint16_t size,
+                     Stm32I2CFrame frame) -> Stm32HalStatus {
+    calls->frame = frame;
+    return Record(HalCalls::Call::kSeqReceiveDma, address, data, size);
+  }
+
+  auto Record(HalCalls::Call call, uint16_t address, uint8_t* data,
+              uint16_t size) -> Stm32HalStatus {
+    calls->last = call;
+    calls->address = address;
+    calls->data = data;
+    calls->size = size;
+    return calls->status;
+  }
+};
+
+class Stm32I2CTest : public ::testing::Test {
+ protected:
+  static constexpr uint16_t kAddress{0x50};
+
+  HalCalls calls_{};
+  Stm32I2CController<FakeHal> i2c_{FakeHal{&calls_}};
+  std::array<std::byte, 4> data_{std::byte{1}, std::byte{2}, std::byte{3},
+                                 std::byte{4}};
+};
+
+TEST_F(Stm32I2CTest, BlockingSendPassesTheShiftedAddress) {
+  ASSERT_TRUE(i2c_.SendData(kAddress, data_));
+  EXPECT_EQ(calls_.last, HalCalls::Call::kTransmit);
+  EXPECT_EQ(calls_.address, kAddress << 1U);
+  EXPECT_EQ(calls_.data, reinterpret_cast<uint8_t*>(data_.data()));
+  EXPECT_EQ(calls_.size, data_.size());
+}
+
+TEST_F(Stm32I2CTest, BlockingReceiveFillsTheWholeBuffer) {
+  EXPECT_EQ(i2c_.ReceiveData(kAddress, data_), data_.size());
+  EXPECT_EQ(calls_.last, HalCalls::Call::kReceive);
+}
+
+TEST_F(Stm32I2CTest, HalStatusesMapToErrors) {
+  calls_.status = Stm32HalStatus::kBusy;
+  EXPECT_EQ(i2c_.SendData(kAddress, data_),
+            std::unexpected(common::Error::kInvalidState));
+  calls_.status = Stm32HalStatus::kTimeout;
+  EXPECT_EQ(i2c_.ReceiveData(kAddress, data_),
+            std::unexpected(common::Error::kTimeout));
+  calls_.status = Stm32HalStatus::kError;
+  EXPECT_EQ(i2c_.SendData(kAddress, data_),
+            std::unexpected(common::Error::kOperationFailed));
+}
+
+TEST_F(Stm32I2CTest, InterruptSendCompletesFromTheCallback) {
+  std::optional<std::expected<void, common::Error>> result{};
+  ASSERT_TRUE(i2c_.SendDataInterrupt(
+      kAddress, data_,
+      [&result](std::expected<void, common::Error> sent) { result = sent; }));
+  EXPECT_EQ(calls_.last, HalCalls::Call::kTransmitIt);
+  EXPECT_FALSE(result);
+  i2c_.OnTransmitComplete();
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(result.value());
+}
+
+TEST_F(Stm32I2CTest, DmaReceiveReportsTheRequestedSize) {
+  std::optional<std::expected<size_t, common::Error>> result{};
+  ASSERT_TRUE(i2c_.ReceiveDataDma(
+      kAddress, std::span{data_}.first(3),
+      [&result](std::expected<size_t, common::Error> received) {
+        result = received;
+      }));
+  EXPECT_EQ(calls_.last, HalCalls::Call::kReceiveDma);
+  EXPECT_EQ(calls_.size, 3U);
+  i2c_.OnReceiveComplete();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), 3U);
+}
+
+TEST_F(Stm32I2CTest, OneTransferAtATime) {
+  ASSERT_TRUE(i2c_.SendDataDma(kAddress, data_, nullptr));
+  EXPECT_EQ(i2c_.ReceiveDataInterrupt(kAddress, data_, nullptr),
+            std::unexpected(common::Error::kInvalidState));
+  i2c_.OnTransmitComplete();
+  EXPECT_TRUE(i2c_.ReceiveDataInterrupt(kAddress, data_, nullptr));
+}
+
+TEST_F(Stm32I2CTest, FailedStartLeavesTheControllerIdle) {
+  calls_.status = Stm32HalStatus::kBusy;
+  bool called{false};
+  EXPECT_EQ(i2c_.SendDataDma(
+                kAddress, data_,
+                [&called](std::expected<void, common::Error>) {
+                  called = true;
+                }),
+            std::unexpected(common::Error::kInvalidState));
+  i2c_.OnTransmitComplete();
+  EXPECT_FALSE(called);
+  calls_.status = Stm32HalStatus::kOk;
+  EXPECT_TRUE(i2c_.SendDataDma(kAddress, data_, nullptr));
+}
+
+TEST_F(Stm32I2CTest, ErrorCallbackFailsTheTransfer) {
+  std::optional<std::expected<size_t, common::Error>> result{};
+  ASSERT_TRUE(i2c_.ReceiveDataInterrupt(
+      kAddress, data_,
+      [&result](std::expected<size_t, common::Error> received) {
+        result = received;
+      }));
+  i2c_.OnError();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), std::unexpected(common::Error::kOperationFailed));
+}
+
+TEST_F(Stm32I2CTest, BlockingWriteReadIsARegisterRead) {
+  const std::array<std::byte, 2> reg{std::byte{0x12}, std::byte{0x34}};
+  EXPECT_EQ(i2c_.WriteRead(kAddress, reg, data_), data_.size());
+  EXPECT_EQ(calls_.last, HalCalls::Call::kMemRead);
+  EXPECT_EQ(calls_.address, kAddress << 1U);
+  EXPECT_EQ(calls_.mem_address, 0x1234);
+  EXPECT_EQ(calls_.mem_size, 2);
+  EXPECT_EQ(calls_.data, reinterpret_cast<uint8_t*>(data_.data()));
+}
+
+TEST_F(Stm32I2CTest, BlockingWriteReadRejectsLongWrites) {
+  const std::array<std::byte, 3> write{};
+  EXPECT_EQ(i2c_.WriteRead(kAddress, write, data_),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(calls_.last, HalCalls::Call::kNone);
+}
+
+TEST_F(Stm32I2CTest, DmaWriteReadRestartsIntoTheRead) {
+  const std::array<std::byte, 1> reg{std::byte{0x0F}};
+  std::optional<std::expected<size_t, common::Error>> result{};
+  ASSERT_TRUE(i2c_.WriteReadDma(
+      kAddress, reg, data_,
+      [&result](std::expected<size_t, common::Error> received) {
+        result = received;
+      }));
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqTransmitDma);
+  EXPECT_EQ(calls_.frame, Stm32I2CFrame::kFirst);
+  EXPECT_EQ(calls_.size, reg.size());
+
+  i2c_.OnTransmitComplete();
+  EXPECT_FALSE(result);
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqReceiveDma);
+  EXPECT_EQ(calls_.frame, Stm32I2CFrame::kLast);
+  EXPECT_EQ(calls_.data, reinterpret_cast<uint8_t*>(data_.data()));
+
+  i2c_.OnReceiveComplete();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), data_.size());
+}
+
+TEST_F(Stm32I2CTest, FailedReadPhaseFailsTheWriteRead) {
+  const std::array<std::byte, 1> reg{std::byte{0x0F}};
+  std::optional<std::expected<size_t, common::Error>> result{};
+  ASSERT_TRUE(i2c_.WriteReadInterrupt(
+      kAddress, reg, data_,
+      [&result](std::expected<size_t, common::Error> received) {
+        result = received;
+      }));
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqTransmitIt);
+
+  calls_.status = Stm32HalStatus::kError;
+  i2c_.OnTransmitComplete();
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqReceiveIt);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), std::unexpected(common::Error::kOperationFailed));
+
+  calls_.status = Stm32HalStatus::kOk;
+  EXPECT_TRUE(i2c_.SendDataDma(kAddress, data_, nullptr));
+}
+
+TEST_F(Stm32I2CTest, TransactionChainsSegmentsByDma) {
+  const std::array<std::byte, 1> reg{std::byte{0x0F}};
+  std::array<std::byte, 2> first{};
+  const std::array<I2CSegment, 3> segments{{
+      {.address = kAddress, .write = reg, .read = first, .stop = false},
+      {.address = 0x51, .write = {}, .read = data_, .stop = true},
+      {.address = 0x52, .write = reg, .read = {}, .stop = true},
+  }};
+  std::optional<std::expected<void, common::Error>> result{};
+  ASSERT_TRUE(i2c_.Transact(
+      segments,
+      [&result](std::expected<void, common::Error> done) { result = done; }));
+
+  // Write, restart into the read, restart into the next segment's read
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqTransmitDma);
+  EXPECT_EQ(calls_.frame, Stm32I2CFrame::kFirst);
+  i2c_.OnTransmitComplete();
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqReceiveDma);
+  EXPECT_EQ(calls_.frame, Stm32I2CFrame::kNext);
+  EXPECT_EQ(calls_.data, reinterpret_cast<uint8_t*>(first.data()));
+  i2c_.OnReceiveComplete();
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqReceiveDma);
+  EXPECT_EQ(calls_.address, 0x51 << 1U);
+  EXPECT_EQ(calls_.frame, Stm32I2CFrame::kLast);
+
+  // After a stop, the last segment starts afresh
+  i2c_.OnReceiveComplete();
+  EXPECT_EQ(calls_.last, HalCalls::Call::kSeqTransmitDma);
+  EXPECT_EQ(calls_.frame, Stm32I2CFrame::kFirstAndLast);
+  EXPECT_FALSE(result);
+  i2c_.OnTransmitComplete();
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(result.value());
+}
+
+TEST_F(Stm32I2CTest, TransactionRejectsEmptySegments) {
+  const std::array<I2CSegment, 1> segments{{{.address = kAddress}}};
+  EXPECT_EQ(i2c_.Transact(segments, nullptr),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(i2c_.Transact({}, nullptr),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(calls_.last, HalCalls::Call::kNone);
+}
+
+TEST_F(Stm32I2CTest, ErrorEndsTheTransaction) {
+  const std::array<I2CSegment, 2> segments{{
+      {.address = kAddress, .write = data_},
+      {.address = kAddress, .write = data_},
+  }};
+  std::optional<std::expected<void, common::Error>> result{};
+  ASSERT_TRUE(i2c_.Transact(
+      segments,
+      [&result](std::expected<void, common::Error> done) { result = done; }));
+  i2c_.OnError();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), std::unexpected(common::Error::kOperationFailed));
+  EXPECT_TRUE(i2c_.SendDataDma(kAddress, data_, nullptr));
+}
+
+}  // namespace
+}  // namespace mcu
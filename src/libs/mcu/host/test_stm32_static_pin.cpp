@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <vector>
+
+#include "apps/blinky/blinky.hpp"
+#include "libs/board/stm32f3_discovery/static_board.hpp"
+#include "libs/board/stm32f767zi_nucleo/static_board.hpp"
+#include "libs/common/error.hpp"
+#include "libs/common/time_source.hpp"
+#include "libs/mcu/host/host_delay.hpp"
+#include "libs/mcu/pin.hpp"
+#include "libs/mcu/stm32/stm32_gpio.hpp"
+#include "libs/mcu/stm32/stm32_static_pin.hpp"
+
+namespace mcu {
+namespace {
+
+// Stands in for a port at a fixed address
+struct FakePort {
+  static auto Registers() -> Stm32GpioRegisters& { return registers; }
+  static inline Stm32GpioRegisters registers{};
+};
+
+using Led = StaticPin<FakePort, 9>;
+
+static_assert(OutputPinLike<Led>);
+static_assert(sizeof(Led) == 1);  // Empty: the pin lives in its type
+
+class StaticPinTest : public ::testing::Test {
+ protected:
+  void SetUp() override { FakePort::registers = Stm32GpioRegisters{}; }
+  static auto Registers() -> Stm32GpioRegisters& { return FakePort::registers; }
+};
+
+TEST_F(StaticPinTest, SetHighAndLowWriteOnlyTheirBit) {
+  ASSERT_TRUE(Led::SetHigh());
+  EXPECT_EQ(Registers().BSRR, 1U << 9U);
+  ASSERT_TRUE(Led::SetLow());
+  EXPECT_EQ(Registers().BSRR, 1U << 25U);
+}
+
+TEST_F(StaticPinTest, ToggleFollowsTheOutputLevel) {
+  Led led{};
+  Registers().ODR = 0xFFFF & ~(1U << 9U);
+  ASSERT_TRUE(led.Toggle());
+  EXPECT_EQ(Registers().BSRR, 1U << 9U);
+  Registers().ODR = 1U << 9U;
+  ASSERT_TRUE(led.Toggle());
+  EXPECT_EQ(Registers().BSRR, 1U << 25U);
+}
+
+TEST_F(StaticPinTest, GetReadsTheInputLevel) {
+  Registers().IDR = 1U << 9U;
+  EXPECT_EQ(Led::Get(), PinState::kHigh);
+  Registers().IDR = ~(1U << 9U);
+  EXPECT_EQ(Led::Get(), PinState::kLow);
+}
+
+TEST_F(StaticPinTest, ConfigureSetsOnlyItsModeBits) {
+  Registers().MODER = 0xFFFF'FFFF;
+  ASSERT_TRUE(Led::Configure(PinDirection::kInput));
+  EXPECT_EQ(Registers().MODER, 0xFFF3'FFFFU);
+  ASSERT_TRUE(Led::Configure(PinDirection::kOutput));
+  EXPECT_EQ(Registers().MODER, 0xFFF7'FFFFU);
+}
+
+TEST(StaticBoardTest, PinsAreBoundToTheBoardsPorts) {
+  using F3 = board::stm32f3_discovery::StaticBoard;
+  using F7 = board::stm32f767zi_nucleo::StaticBoard;
+  static_assert(std::same_as<F3::UserLed1, StaticPin<stm32f3::GpioE, 9>>);
+  static_assert(std::same_as<F7::UserButton1, StaticPin<stm32f7::GpioC, 13>>);
+  EXPECT_EQ(stm32f3::GpioE::kBaseAddress, 0x4800'1000U);
+  EXPECT_EQ(stm32f7::GpioB::kBaseAddress, 0x4002'0400U);
+}
+
+// The LED of a static board for RunStaticBlinky(), which only returns once a
+// toggle fails. Records the level after each write, as ODR would follow
+// BSRR, and fails the toggle after the last one allowed.
+struct CountedLed : StaticPin<FakePort, 9> {
+  static auto SetHigh() -> std::expected<void, common::Error> {
+    return StaticPin::SetHigh().transform([] { Latch(); });
+  }
+
+  static auto Toggle() -> std::expected<void, common::Error> {
+    if (toggles_left == 0) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    --toggles_left;
+    return StaticPin::Toggle().transform([] { Latch(); });
+  }
+
+  static auto Latch() -> void {
+    auto& registers{FakePort::registers};
+    const uint32_t bsrr{registers.BSRR};
+    registers.ODR = (registers.ODR | (bsrr & 0xFFFFU)) & ~(bsrr >> 16U);
+    levels.push_back((registers.ODR & kMask) != 0);
+  }
+
+  static inline int toggles_left{0};
+  static inline std::vector<bool> levels{};
+};
+
+struct FakeStaticBoard {
+  using UserLed1 = CountedLed;
+  using UserLed2 = StaticPin<FakePort, 8>;
+  using UserButton1 = StaticPin<FakePort, 0>;
+};
+
+static_assert(board::StaticBoardLike<FakeStaticBoard>);
+
+// Lets Delay() return at once, counting the time it would have slept
+class ManualTime final : public common::TimeSource {
+ public:
+  [[nodiscard]] auto Now() const -> Clock::time_point override {
+    return now_;
+  }
+  auto AdvanceTo(Clock::time_point when) -> void override {
+    now_ = std::max(now_, when);
+  }
+
+ private:
+  Clock::time_point now_{};
+};
+
+TEST_F(StaticPinTest, StaticBlinkyTogglesEachPeriod) {
+  ManualTime time{};
+  SetDelayTimeSource(&time);
+  CountedLed::toggles_left = 4;
+  CountedLed::levels.clear();
+
+  EXPECT_EQ(app::RunStaticBlinky<FakeStaticBoard>(),
+            std::unexpected(common::Error::kInvalidState));
+  SetDelayTimeSource(nullptr);
+
+  EXPECT_EQ(CountedLed::levels,
+            (std::vector<bool>{true, false, true, false, true}));
+  // Each toggle, including the failed one, waits a period first
+  EXPECT_EQ(time.Now().time_since_epoch(), 5 * app::kBlinkPeriod);
+}
+
+}  // namespace
+}  // namespace mcu
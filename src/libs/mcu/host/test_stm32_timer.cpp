@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <limits>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/stm32/stm32_timer.hpp"
+
+namespace mcu {
+namespace {
+using std::chrono::operator""ms;
+using std::chrono::operator""s;
+using std::chrono::operator""us;
+
+// Register block the driver programs instead of a real TIM6
+struct FakeHardware {
+  static constexpr uint32_t kClockHz{108'000'000};
+
+  static auto Timer() -> Stm32TimerRegisters& { return timer; }
+
+  static inline Stm32TimerRegisters timer{};
+};
+
+class Stm32TimerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { FakeHardware::timer = Stm32TimerRegisters{}; }
+
+  // Does what the counter would on reaching ARR, then calls the handler
+  auto Update() -> void {
+    FakeHardware::timer.SR = FakeHardware::timer.SR | tim::kSrUif;
+    if ((FakeHardware::timer.CR1 & tim::kCr1Opm) != 0) {
+      FakeHardware::timer.CR1 = FakeHardware::timer.CR1 & ~tim::kCr1Cen;
+    }
+    timer_.OnInterrupt();
+  }
+
+  Stm32Timer<FakeHardware> timer_{};
+  int fired_{0};
+};
+
+TEST(Stm32TimerDividerTest, SmallestPrescalerThatFits) {
+  EXPECT_EQ(tim::DividerFor(1000)->psc, 0U);
+  EXPECT_EQ(tim::DividerFor(1000)->arr, 999U);
+  // 200 ms at 108 MHz
+  const auto divider{tim::DividerFor(21'600'000)};
+  ASSERT_TRUE(divider);
+  EXPECT_EQ(divider->psc, 329U);
+  EXPECT_EQ(divider->arr, 65'453U);
+  EXPECT_EQ(tim::DividerFor(0)->arr, 0U);
+  EXPECT_TRUE(tim::DividerFor(tim::kMaxCount * tim::kMaxCount));
+  EXPECT_FALSE(tim::DividerFor(tim::kMaxCount * tim::kMaxCount + 1));
+}
+
+TEST(Stm32TimerDividerTest, TicksDoNotOverflow) {
+  EXPECT_EQ(tim::TicksFor(200ms, 108'000'000), 21'600'000U);
+  EXPECT_EQ(tim::TicksFor(1'000'001us, 108'000'000), 108'000'108U);
+  EXPECT_EQ(tim::TicksFor(3us, 1'000'000'000), 3'000U);
+  // Just over 2^64 once multiplied by the clock before dividing
+  EXPECT_EQ(tim::TicksFor(170'803'185'868us, 108'000'000),
+            18'446'744'073'744U);
+  EXPECT_EQ(tim::TicksFor(std::chrono::microseconds::max(), 108'000'000),
+            std::numeric_limits<uint64_t>::max());
+}
+
+TEST_F(Stm32TimerTest, PeriodicProgramsAFreeRunningCounter) {
+  ASSERT_TRUE(timer_.StartPeriodic(1ms, [this]() { ++fired_; }));
+  const auto& registers{FakeHardware::timer};
+  EXPECT_EQ(registers.PSC, 1U);
+  EXPECT_EQ(registers.ARR, 53'999U);
+  EXPECT_EQ(registers.DIER, tim::kDierUie);
+  EXPECT_NE(registers.CR1 & tim::kCr1Cen, 0U);
+  EXPECT_EQ(registers.CR1 & tim::kCr1Opm, 0U);
+  EXPECT_TRUE(timer_.IsRunning());
+
+  Update();
+  Update();
+  EXPECT_EQ(fired_, 2);
+  EXPECT_EQ(registers.SR & tim::kSrUif, 0U);
+  EXPECT_TRUE(timer_.IsRunning());
+
+  timer_.Stop();
+  EXPECT_EQ(registers.CR1, 0U);
+  EXPECT_FALSE(timer_.IsRunning());
+}
+
+TEST_F(Stm32TimerTest, OneShotStopsAfterOneUpdate) {
+  ASSERT_TRUE(timer_.StartOnce(10ms, [this]() { ++fired_; }));
+  EXPECT_NE(FakeHardware::timer.CR1 & tim::kCr1Opm, 0U);
+  Update();
+  EXPECT_EQ(fired_, 1);
+  EXPECT_FALSE(timer_.IsRunning());
+  EXPECT_EQ(FakeHardware::timer.DIER, 0U);
+}
+
+TEST_F(Stm32TimerTest, IgnoresInterruptsWithoutAnUpdate) {
+  ASSERT_TRUE(timer_.StartPeriodic(1ms, [this]() { ++fired_; }));
+  timer_.OnInterrupt();
+  EXPECT_EQ(fired_, 0);
+}
+
+TEST_F(Stm32TimerTest, CallbackMayRestartItsTimer) {
+  ASSERT_TRUE(timer_.StartPeriodic(1ms, [this]() {
+    ++fired_;
+    ASSERT_TRUE(timer_.StartOnce(5ms, [this]() { fired_ += 10; }));
+  }));
+  Update();
+  EXPECT_NE(FakeHardware::timer.CR1 & tim::kCr1Opm, 0U);
+  Update();
+  EXPECT_EQ(fired_, 11);
+  EXPECT_FALSE(timer_.IsRunning());
+}
+
+TEST_F(Stm32TimerTest, RejectsPeriodsItCannotCount) {
+  EXPECT_EQ(timer_.StartPeriodic(0us, []() {}),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(timer_.StartOnce(-1us, []() {}),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(timer_.StartPeriodic(60s, []() {}),
+            std::unexpected(common::Error::kInvalidArgument));
+  // Would come out as 34 ticks were the conversion to overflow
+  EXPECT_EQ(timer_.StartPeriodic(170'803'185'868us, []() {}),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(timer_.StartOnce(1ms, nullptr),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_FALSE(timer_.IsRunning());
+}
+
+}  // namespace
+}  // namespace mcu
@@ -0,0 +1,330 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/stm32/stm32_dma.hpp"
+#include "libs/mcu/stm32/stm32_uart.hpp"
+#include "libs/mcu/uart.hpp"
+
+namespace mcu {
+namespace {
+
+// Register blocks the driver programs instead of a real USART and DMA
+struct FakeHardware {
+  static constexpr uint32_t kRxStream{1};
+  static constexpr uint32_t kTxStream{3};
+  static constexpr uint32_t kDmaChannel{4};
+  static constexpr uint32_t kClockHz{54'000'000};
+
+  static auto Usart() -> Stm32UsartRegisters& { return usart; }
+  static auto Dma() -> Stm32DmaRegisters& { return dma; }
+  // Every read advances the clock, so timeouts expire without sleeping
+  static auto Milliseconds() -> uint32_t { return now_ms++; }
+  // Record the ranges the driver maintains
+  static auto CleanDCache(const std::byte* data, size_t size) -> void {
+    cleaned.emplace_back(data, size);
+  }
+  static auto InvalidateDCache(const std::byte* data, size_t size) -> void {
+    if (size > 0) {
+      invalidated.emplace_back(data, size);
+    }
+  }
+
+  using Range = std::pair<const std::byte*, size_t>;
+  static inline Stm32UsartRegisters usart{};
+  static inline Stm32DmaRegisters dma{};
+  static inline uint32_t now_ms{0};
+  static inline std::vector<Range> cleaned{};
+  static inline std::vector<Range> invalidated{};
+};
+
+using Range = FakeHardware::Range;
+
+constexpr size_t kRingSize{16};
+using TestUart = Stm32Uart<FakeHardware, 2>;
+
+class Stm32UartTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    FakeHardware::usart = Stm32UsartRegisters{};
+    FakeHardware::dma = Stm32DmaRegisters{};
+    FakeHardware::cleaned.clear();
+    FakeHardware::invalidated.clear();
+    // An idle transmitter: ready for data and done sending
+    FakeHardware::usart.ISR = usart::kIsrTxe | usart::kIsrTc;
+    ASSERT_TRUE(uart_.Init(UartConfig{}));
+  }
+
+  static auto RxStream() -> Stm32DmaStreamRegisters& {
+    return FakeHardware::dma.stream[FakeHardware::kRxStream];
+  }
+  static auto TxStream() -> Stm32DmaStreamRegisters& {
+    return FakeHardware::dma.stream[FakeHardware::kTxStream];
+  }
+
+  // Does what the circular RX stream would: writes at the DMA position,
+  // counts NDTR down and raises the half and full transfer flags
+  auto Arrive(const std::vector<uint8_t>& bytes) -> void {
+    for (const auto byte : bytes) {
+      const size_t position{kRingSize - RxStream().NDTR};
+      ring_[position] = std::byte{byte};
+      RxStream().NDTR = RxStream().NDTR - 1;
+      if (RxStream().NDTR == kRingSize / 2) {
+        FakeHardware::dma.LISR =
+            FakeHardware::dma.LISR |
+            (dma::kHtif << dma::FlagShift(FakeHardware::kRxStream));
+      }
+      if (RxStream().NDTR == 0) {
+        FakeHardware::dma.LISR =
+            FakeHardware::dma.LISR |
+            (dma::kTcif << dma::FlagShift(FakeHardware::kRxStream));
+        RxStream().NDTR = kRingSize;
+      }
+    }
+  }
+
+  auto LineGoesIdle() -> void {
+    FakeHardware::usart.ISR = FakeHardware::usart.ISR | usart::kIsrIdle;
+    uart_.OnUsartInterrupt();
+    FakeHardware::usart.ISR = FakeHardware::usart.ISR & ~usart::kIsrIdle;
+  }
+
+  auto TxComplete(uint32_t flag = dma::kTcif) -> void {
+    FakeHardware::dma.LISR = flag << dma::FlagShift(FakeHardware::kTxStream);
+    uart_.OnTxDmaInterrupt();
+    FakeHardware::dma.LISR = 0;
+  }
+
+  std::array<std::byte, kRingSize> ring_{};
+  TestUart uart_{ring_};
+};
+
+auto Bytes(const std::vector<uint8_t>& values) -> std::vector<std::byte> {
+  std::vector<std::byte> bytes{};
+  for (const auto value : values) {
+    bytes.push_back(std::byte{value});
+  }
+  return bytes;
+}
+
+TEST_F(Stm32UartTest, InitStartsCircularReceiveDma) {
+  EXPECT_EQ(FakeHardware::usart.BRR, 469U);  // 54 MHz / 115200, rounded
+  EXPECT_NE(FakeHardware::usart.CR1 & usart::kCr1Ue, 0U);
+  EXPECT_NE(FakeHardware::usart.CR1 & usart::kCr1Idleie, 0U);
+  EXPECT_EQ(FakeHardware::usart.CR3 & (usart::kCr3Dmar | usart::kCr3Dmat),
+            usart::kCr3Dmar | usart::kCr3Dmat);
+  EXPECT_EQ(RxStream().NDTR, kRingSize);
+  EXPECT_EQ(RxStream().M0AR, dma::Address(ring_.data()));
+  EXPECT_EQ(RxStream().PAR, dma::Address(&FakeHardware::usart.RDR));
+  const uint32_t expected_cr{(4U << dma::kCrChselShift) | dma::kCrMinc |
+                             dma::kCrCirc | dma::kCrHtie | dma::kCrTcie |
+                             dma::kCrEn};
+  EXPECT_EQ(RxStream().CR, expected_cr);
+}
+
+TEST_F(Stm32UartTest, InitProgramsTheFrameFormat) {
+  const UartConfig config{.baud_rate = 3'000'000,
+                          .parity = UartConfig::Parity::kOdd,
+                          .stop_bits = UartConfig::StopBits::k2Bits};
+  ASSERT_TRUE(uart_.Init(config));
+  EXPECT_EQ(FakeHardware::usart.BRR, 18U);
+  // 8 data bits plus parity is a 9-bit frame
+  EXPECT_NE(FakeHardware::usart.CR1 & usart::kCr1M0, 0U);
+  EXPECT_NE(FakeHardware::usart.CR1 & usart::kCr1Ps, 0U);
+  EXPECT_EQ(FakeHardware::usart.CR2, usart::kCr2Stop2);
+}
+
+TEST_F(Stm32UartTest, InitRejectsUnsupportedConfigurations) {
+  EXPECT_EQ(uart_.Init(UartConfig{.data_bits = UartConfig::DataBits::k9Bits}),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(uart_.Init(UartConfig{
+                .flow_control = UartConfig::FlowControl::kXonXoff}),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(uart_.Init(UartConfig{.baud_rate = 6'000'000}),
+            std::unexpected(common::Error::kInvalidArgument));
+  // More than NDTR can count
+  std::vector<std::byte> ring(0x10000);
+  TestUart uart{ring};
+  EXPECT_EQ(uart.Init(UartConfig{}),
+            std::unexpected(common::Error::kInvalidArgument));
+}
+
+TEST_F(Stm32UartTest, IdleLineDeliversTheBurstOnce) {
+  std::vector<std::byte> received{};
+  int calls{0};
+  ASSERT_TRUE(uart_.SetRxHandler([&](const std::byte* data, size_t size) {
+    received.insert(received.end(), data, data + size);
+    ++calls;
+  }));
+  Arrive({1, 2, 3, 4, 5});
+  LineGoesIdle();
+  EXPECT_EQ(received, Bytes({1, 2, 3, 4, 5}));
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(Stm32UartTest, RxHandlerSeesWrappedDataInOrder) {
+  std::vector<std::byte> received{};
+  ASSERT_TRUE(uart_.SetRxHandler([&](const std::byte* data, size_t size) {
+    received.insert(received.end(), data, data + size);
+  }));
+  Arrive({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+  LineGoesIdle();
+  Arrive({12, 13, 14, 15, 16, 17, 18, 19});
+  // The full-ring interrupt arrives before the line goes idle
+  uart_.OnRxDmaInterrupt();
+  EXPECT_EQ(FakeHardware::dma.LIFCR,
+            (dma::kHtif | dma::kTcif) << dma::FlagShift(1));
+  LineGoesIdle();
+  EXPECT_EQ(received, Bytes({0,  1,  2,  3,  4,  5,  6,  7,  8,  9,
+                             10, 11, 12, 13, 14, 15, 16, 17, 18, 19}));
+}
+
+TEST_F(Stm32UartTest, ReceivedBytesAreInvalidatedBeforeTheyAreRead) {
+  ASSERT_TRUE(uart_.SetRxHandler([](const std::byte*, size_t) {}));
+  Arrive({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+  LineGoesIdle();
+  EXPECT_EQ(FakeHardware::invalidated,
+            (std::vector<Range>{{ring_.data(), 12}}));
+  FakeHardware::invalidated.clear();
+  Arrive({12, 13, 14, 15, 16, 17});
+  LineGoesIdle();
+  // Both pieces of the wrapped burst
+  EXPECT_EQ(FakeHardware::invalidated,
+            (std::vector<Range>{{&ring_[12], 4}, {ring_.data(), 2}}));
+}
+
+TEST_F(Stm32UartTest, ReceiveAsyncCompletesWhenTheLineGoesIdle) {
+  std::array<std::byte, 8> buffer{};
+  std::optional<std::expected<size_t, common::Error>> result{};
+  ASSERT_TRUE(uart_.ReceiveAsync(
+      buffer, [&result](std::expected<size_t, common::Error> received) {
+        result = received;
+      }));
+  EXPECT_FALSE(result);
+  Arrive({0xAA, 0x55});
+  LineGoesIdle();
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), 2U);
+  EXPECT_EQ(buffer[1], std::byte{0x55});
+}
+
+TEST_F(Stm32UartTest, ReceiveAsyncTakesBufferedBytesAtOnce) {
+  Arrive({7, 8, 9});
+  LineGoesIdle();
+  EXPECT_EQ(uart_.Available(), 3U);
+  std::array<std::byte, 2> buffer{};
+  std::optional<size_t> count{};
+  ASSERT_TRUE(uart_.ReceiveAsync(
+      buffer, [&count](std::expected<size_t, common::Error> received) {
+        count = received.value();
+      }));
+  EXPECT_EQ(count, 2U);
+  EXPECT_EQ(uart_.Available(), 1U);
+}
+
+TEST_F(Stm32UartTest, ReceiveReadsTheRingAndTimesOut) {
+  Arrive({1, 2, 3});
+  std::array<std::byte, 8> buffer{};
+  EXPECT_EQ(uart_.Receive(buffer, 10), 3U);
+  EXPECT_EQ(buffer[2], std::byte{3});
+  EXPECT_EQ(uart_.Receive(buffer, 10),
+            std::unexpected(common::Error::kTimeout));
+}
+
+TEST_F(Stm32UartTest, SendAsyncQueuesTransfersBehindTheDma) {
+  const auto first{Bytes({1, 2, 3})};
+  const auto second{Bytes({4, 5})};
+  const auto third{Bytes({6})};
+  std::vector<int> completed{};
+  auto done = [&completed](int index) {
+    return [&completed, index](std::expected<void, common::Error> result) {
+      ASSERT_TRUE(result);
+      completed.push_back(index);
+    };
+  };
+
+  ASSERT_TRUE(uart_.SendAsync(first, done(1)));
+  ASSERT_TRUE(uart_.SendAsync(second, done(2)));
+  EXPECT_EQ(uart_.SendAsync(third, done(3)),
+            std::unexpected(common::Error::kWouldBlock));
+  EXPECT_TRUE(uart_.IsBusy());
+  EXPECT_EQ(TxStream().NDTR, 3U);
+  EXPECT_EQ(TxStream().M0AR, dma::Address(first.data()));
+  EXPECT_EQ(TxStream().PAR, dma::Address(&FakeHardware::usart.TDR));
+  EXPECT_NE(TxStream().CR & dma::kCrDirMemoryToPeripheral, 0U);
+
+  TxComplete();
+  EXPECT_EQ(completed, (std::vector<int>{1}));
+  EXPECT_EQ(TxStream().NDTR, 2U);
+  EXPECT_EQ(TxStream().M0AR, dma::Address(second.data()));
+  ASSERT_TRUE(uart_.SendAsync(third, done(3)));
+
+  TxComplete();
+  TxComplete();
+  EXPECT_EQ(completed, (std::vector<int>{1, 2, 3}));
+  EXPECT_FALSE(uart_.IsBusy());
+  // Each buffer was written back to memory before its DMA started
+  EXPECT_EQ(FakeHardware::cleaned,
+            (std::vector<Range>{{first.data(), 3},
+                                {second.data(), 2},
+                                {third.data(), 1}}));
+}
+
+TEST_F(Stm32UartTest, LongSendGoesOutInPiecesNdtrCanCount) {
+  const std::vector<std::byte> data(0xFFFF + 5);
+  int completed{0};
+  ASSERT_TRUE(uart_.SendAsync(
+      data, [&completed](std::expected<void, common::Error> result) {
+        ASSERT_TRUE(result);
+        ++completed;
+      }));
+  EXPECT_EQ(TxStream().NDTR, 0xFFFFU);
+  EXPECT_EQ(TxStream().M0AR, dma::Address(data.data()));
+
+  TxComplete();
+  EXPECT_EQ(completed, 0);
+  EXPECT_TRUE(uart_.IsBusy());
+  EXPECT_EQ(TxStream().NDTR, 5U);
+  EXPECT_EQ(TxStream().M0AR, dma::Address(&data[0xFFFF]));
+
+  TxComplete();
+  EXPECT_EQ(completed, 1);
+  EXPECT_FALSE(uart_.IsBusy());
+  EXPECT_EQ(FakeHardware::cleaned,
+            (std::vector<Range>{{data.data(), 0xFFFF}, {&data[0xFFFF], 5}}));
+}
+
+TEST_F(Stm32UartTest, TransferErrorFailsTheSend) {
+  const auto data{Bytes({1})};
+  std::optional<std::expected<void, common::Error>> result{};
+  ASSERT_TRUE(uart_.SendAsync(
+      data, [&result](std::expected<void, common::Error> sent) {
+        result = sent;
+      }));
+  TxComplete(dma::kTeif);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result.value(), std::unexpected(common::Error::kOperationFailed));
+  EXPECT_FALSE(uart_.IsBusy());
+}
+
+TEST_F(Stm32UartTest, BlockingSendPollsTheTransmitter) {
+  ASSERT_TRUE(uart_.Send(Bytes({0x41, 0x42})));
+  EXPECT_EQ(FakeHardware::usart.TDR, 0x42U);
+}
+
+TEST_F(Stm32UartTest, LineErrorsAreCountedAndCleared) {
+  FakeHardware::usart.ISR = FakeHardware::usart.ISR | usart::kIsrOre;
+  uart_.OnUsartInterrupt();
+  EXPECT_EQ(uart_.Errors(), 1U);
+  EXPECT_EQ(FakeHardware::usart.ICR, usart::kIsrOre);
+}
+
+}  // namespace
+}  // namespace mcu
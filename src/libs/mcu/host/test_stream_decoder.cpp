@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <vector>
+
+#include "emulator_message_binary_encoder.hpp"
+#include "emulator_message_json_encoder.hpp"
+#include "emulator_message_stream_decoder.hpp"
+#include "host_emulator_messages.hpp"
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
+
+namespace mcu {
+namespace {
+
+auto MakeUartResponse(size_t payload_size) -> UartEmulatorResponse {
+  std::vector<std::byte> payload(payload_size);
+  for (size_t i = 0; i < payload_size; ++i) {
+    payload[i] = static_cast<std::byte>(i & 0xFFU);
+  }
+  return UartEmulatorResponse{.name = "UART 1",
+                              .data = payload,
+                              .bytes_transferred = payload_size,
+                              .status = common::Error::kOk};
+}
+
+TEST(EmulatorMessageStreamDecoderTest, DecodePinRequest) {
+  const std::string json{
+      R"({"name":"PA0","object":"Pin","operation":"Set","state":"High","type":"Request"})"};
+  MessageView view{};
+  ASSERT_TRUE(DecodeInto(json, view));
+  EXPECT_EQ(view.type, MessageType::kRequest);
+  EXPECT_EQ(view.object, ObjectType::kPin);
+  EXPECT_EQ(view.name.View(), "PA0");
+  EXPECT_EQ(view.operation, OperationType::kSet);
+  EXPECT_EQ(view.state, PinState::kHigh);
+}
+
+TEST(EmulatorMessageStreamDecoderTest, DecodeMatchesDomDecoder) {
+  const I2CEmulatorResponse response{.name = "I2C 1",
+                                     .address = 0x50,
+                                     .data = {std::byte{0xDE}, std::byte{0xAD}},
+                                     .bytes_transferred = 2,
+                                     .status = common::Error::kOk};
+  std::array<std::byte, 8> payload{};
+  for (const auto& frame :
+       {Encode(response), EncodeBinary(response).value()}) {
+    MessageView view{.data = payload};
+    ASSERT_TRUE(DecodeInto(frame, view));
+    EXPECT_EQ(view.type, MessageType::kResponse);
+    EXPECT_EQ(view.object, ObjectType::kI2C);
+    EXPECT_EQ(view.name.View(), response.name);
+    EXPECT_EQ(view.address, response.address);
+    EXPECT_EQ(view.bytes_transferred, response.bytes_transferred);
+    EXPECT_EQ(view.status, response.status);
+    EXPECT_TRUE(std::ranges::equal(view.Payload(), response.data));
+  }
+}
+
+TEST(EmulatorMessageStreamDecoderTest, Decode4KUartReceiveWithoutAllocating) {
+  constexpr size_t kPayloadSize{4096};
+  const auto response{MakeUartResponse(kPayloadSize)};
+  const auto json{Encode(response)};
+  const auto binary{EncodeBinary(response).value()};
+  std::vector<std::byte> payload(kPayloadSize);
+
+  const size_t before{test::AllocationCount()};
+  MessageView json_view{.data = payload};
+  const auto json_result{DecodeInto(json, json_view)};
+  MessageView binary_view{.data = payload};
+  const auto binary_result{DecodeInto(binary, binary_view)};
+  const size_t after{test::AllocationCount()};
+
+  ASSERT_TRUE(json_result);
+  ASSERT_TRUE(binary_result);
+  EXPECT_EQ(after, before);
+  EXPECT_EQ(json_view.data_size, kPayloadSize);
+  EXPECT_EQ(binary_view.data_size, kPayloadSize);
+  EXPECT_TRUE(std::ranges::equal(binary_view.Payload(), response.data));
+}
+
+TEST(EmulatorMessageStreamDecoderTest, PayloadLargerThanBuffer) {
+  const auto json{Encode(MakeUartResponse(16))};
+  std::array<std::byte, 8> payload{};
+  MessageView view{.data = payload};
+  auto result{DecodeInto(json, view)};
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error(), common::Error::kMessageTooLarge);
+}
+
+TEST(EmulatorMessageStreamDecoderTest, SkipsUnknownFields) {
+  const std::string json{
+      R"({"type":"Response","extra":{"nested":[1,"}",{}]},"object":"Pin",)"
+      R"("name":"LED \"1\"","flag":true,"state":"Low","status":"Ok"})"};
+  MessageView view{};
+  ASSERT_TRUE(DecodeInto(json, view));
+  EXPECT_EQ(view.name.View(), "LED \"1\"");
+  EXPECT_EQ(view.state, PinState::kLow);
+  EXPECT_EQ(view.status, common::Error::kOk);
+}
+
+TEST(EmulatorMessageStreamDecoderTest, RejectsMalformedJson) {
+  MessageView view{};
+  EXPECT_FALSE(DecodeInto("not valid json", view));
+  EXPECT_FALSE(DecodeInto(R"({"type":"Request","object":"Pin"})", view));
+  EXPECT_FALSE(DecodeInto(R"({"type":"Bogus","object":"Pin","name":""})",
+                          view));
+  EXPECT_FALSE(
+      DecodeInto(R"({"type":"Request","object":"Pin","name":"A"} x)", view));
+}
+
+TEST(EmulatorMessageStreamDecoderTest, PortFieldsMatchAcrossFormats) {
+  const PortEmulatorRequest request{.name = "GPIOA",
+                                    .operation = OperationType::kSet,
+                                    .mask = 0x00F0,
+                                    .value = 0x0050};
+  const PortEmulatorResponse response{
+      .name = "GPIOA", .value = 0x1234, .status = common::Error::kOk};
+  for (const auto& frame :
+       {Encode(request), EncodeBinary(request).value()}) {
+    MessageView view{};
+    ASSERT_TRUE(DecodeInto(frame, view));
+    EXPECT_EQ(view.object, ObjectType::kPort);
+    EXPECT_EQ(view.operation, OperationType::kSet);
+    EXPECT_EQ(view.mask, request.mask);
+    EXPECT_EQ(view.value, request.value);
+    EXPECT_EQ(view.size, 0U);
+    EXPECT_EQ(view.timeout_ms, 0U);
+  }
+  for (const auto& frame :
+       {Encode(response), EncodeBinary(response).value()}) {
+    MessageView view{};
+    ASSERT_TRUE(DecodeInto(frame, view));
+    EXPECT_EQ(view.value, response.value);
+    EXPECT_EQ(view.status, response.status);
+  }
+}
+
+TEST(EmulatorMessageStreamDecoderTest, ClockFieldsMatchAcrossFormats) {
+  const ClockEmulatorRequest request{.name = "Clock", .advance_us = 2500};
+  for (const auto& frame :
+       {Encode(request), EncodeBinary(request).value()}) {
+    MessageView view{};
+    ASSERT_TRUE(DecodeInto(frame, view));
+    EXPECT_EQ(view.object, ObjectType::kClock);
+    EXPECT_EQ(view.operation, OperationType::kAdvance);
+    EXPECT_EQ(view.advance_us, request.advance_us);
+    EXPECT_EQ(view.timeout_ms, 0U);
+  }
+}
+
+TEST(EmulatorMessageStreamDecoderTest, RejectsNumbersTooLargeForTheField) {
+  std::array<std::byte, 4> payload{};
+  MessageView view{.data = payload};
+  // 65600 would otherwise wrap to 64 in the 16-bit address
+  EXPECT_EQ(DecodeInto(R"({"type":"Request","object":"I2C","name":"I2C 1",)"
+                       R"("address":65600})",
+                       view),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(DecodeInto(R"({"type":"Request","object":"Uart","name":"UART 1",)"
+                       R"("timeout_ms":4294967296})",
+                       view),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(DecodeInto(R"({"type":"Request","object":"Pin","name":"A",)"
+                       R"("id":99999999999999999999})",
+                       view),
+            std::unexpected(common::Error::kInvalidArgument));
+  EXPECT_EQ(DecodeInto(R"({"type":"Request","object":"I2C","name":"I2C 1",)"
+                       R"("data":[256]})",
+                       view),
+            std::unexpected(common::Error::kInvalidArgument));
+
+  MessageHeader header{};
+  EXPECT_FALSE(PeekHeader(
+      R"({"type":"Request","object":"Pin","name":"A","id":4294967296})",
+      header));
+
+  ASSERT_TRUE(DecodeInto(R"({"type":"Request","object":"I2C","name":"I2C 1",)"
+                         R"("address":65535,"id":4294967295})",
+                         view));
+  EXPECT_EQ(view.address, 0xFFFFU);
+  EXPECT_EQ(view.id, 0xFFFFFFFFU);
+}
+
+TEST(EmulatorMessageStreamDecoderTest, DecodeCorrelationId) {
+  auto response{MakeUartResponse(4)};
+  response.id = 99;
+  std::array<std::byte, 4> payload{};
+  for (const auto& frame :
+       {Encode(response), EncodeBinary(response).value()}) {
+    MessageView view{.data = payload};
+    ASSERT_TRUE(DecodeInto(frame, view));
+    EXPECT_EQ(view.id, 99U);
+  }
+}
+
+TEST(EmulatorMessageStreamDecoderTest, PeekHeader) {
+  auto response{MakeUartResponse(64)};
+  response.id = 7;
+  for (const auto& frame :
+       {Encode(response), EncodeBinary(response).value()}) {
+    MessageHeader header{};
+    ASSERT_TRUE(PeekHeader(frame, header));
+    EXPECT_EQ(header.type, MessageType::kResponse);
+    EXPECT_EQ(header.object, ObjectType::kUart);
+    EXPECT_EQ(header.name.View(), "UART 1");
+    EXPECT_EQ(header.id, 7U);
+  }
+
+  // The id is optional
+  MessageHeader header{};
+  ASSERT_TRUE(
+      PeekHeader(R"({"type":"Request","object":"Pin","name":"A"})", header));
+  EXPECT_EQ(header.id, 0U);
+  EXPECT_FALSE(PeekHeader(R"({"type":"Request","object":"Pin"})", header));
+}
+
+}  // namespace
+}  // namespace mcu
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "libs/common/error.hpp"
+#include "libs/common/timing_wheel.hpp"
+#include "libs/mcu/host/testing/allocation_counter.hpp"
+
+namespace common {
+namespace {
+
+TEST(TimingWheelTest, FiresOnTheTickItIsDue) {
+  TimingWheel<8> wheel{};
+  std::vector<uint64_t> fired{};
+  ASSERT_TRUE(wheel.Start(3, [&]() { fired.push_back(wheel.Now()); }));
+  ASSERT_TRUE(wheel.Start(1, [&]() { fired.push_back(wheel.Now()); }));
+  EXPECT_EQ(wheel.Size(), 2U);
+
+  EXPECT_EQ(wheel.Advance(), 1U);
+  EXPECT_EQ(wheel.Advance(), 0U);
+  EXPECT_EQ(wheel.Advance(), 1U);
+  EXPECT_EQ(fired, (std::vector<uint64_t>{1, 3}));
+  EXPECT_EQ(wheel.Size(), 0U);
+}
+
+TEST(TimingWheelTest, ZeroTicksFiresOnTheNextTick) {
+  TimingWheel<1> wheel{};
+  int fired{0};
+  ASSERT_TRUE(wheel.Start(0, [&fired]() { ++fired; }));
+  EXPECT_EQ(fired, 0);
+  wheel.Advance();
+  EXPECT_EQ(fired, 1);
+}
+
+TEST(TimingWheelTest, SameTickFiresInStartOrder) {
+  TimingWheel<4> wheel{};
+  std::vector<int> order{};
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(wheel.Start(100, [&order, i]() { order.push_back(i); }));
+  }
+  EXPECT_EQ(wheel.Advance(100), 4U);
+  EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+}
+
+TEST(TimingWheelTest, CancelledTimersDoNotFire) {
+  TimingWheel<4> wheel{};
+  int fired{0};
+  auto first{wheel.Start(5000, [&fired]() { fired += 1; })};
+  auto second{wheel.Start(5000, [&fired]() { fired += 10; })};
+  ASSERT_TRUE(first && second);
+
+  EXPECT_TRUE(wheel.Cancel(*first));
+  EXPECT_FALSE(wheel.Cancel(*first));
+  EXPECT_EQ(wheel.Size(), 1U);
+  wheel.Advance(5000);
+  EXPECT_EQ(fired, 10);
+  // Already fired, and its node may be reused by now
+  EXPECT_FALSE(wheel.Cancel(*second));
+  EXPECT_FALSE(wheel.Cancel(TimerId{}));
+}
+
+TEST(TimingWheelTest, PoolExhaustionIsAnError) {
+  TimingWheel<2> wheel{};
+  ASSERT_TRUE(wheel.Start(1, []() {}));
+  ASSERT_TRUE(wheel.Start(1, []() {}));
+  EXPECT_EQ(wheel.Start(1, []() {}), std::unexpected(Error::kWouldBlock));
+  EXPECT_EQ(wheel.Start(1, nullptr), std::unexpected(Error::kInvalidArgument));
+  wheel.Advance();
+  EXPECT_TRUE(wheel.Start(1, []() {}));
+}
+
+TEST(TimingWheelTest, CallbacksMayRestartThemselves) {
+  TimingWheel<1> wheel{};
+  std::vector<uint64_t> fired{};
+  std::function<void()> periodic{[&]() {
+    fired.push_back(wheel.Now());
+    if (fired.size() < 3) {
+      ASSERT_TRUE(wheel.Start(70, [&periodic]() { periodic(); }));
+    }
+  }};
+  ASSERT_TRUE(wheel.Start(70, [&periodic]() { periodic(); }));
+  wheel.Advance(1000);
+  EXPECT_EQ(fired, (std::vector<uint64_t>{70, 140, 210}));
+}
+
+TEST(TimingWheelTest, TimersBeyondTheRangeWaitInTheTopLevel) {
+  using Wheel = TimingWheel<2>;
+  Wheel wheel{};
+  uint64_t fired_at{0};
+  const uint64_t delay{(3 * Wheel::kRange) + 12345};
+  ASSERT_TRUE(wheel.Start(delay, [&]() { fired_at = wheel.Now(); }));
+  // A second timer keeps the wheel ticking rather than skipping ahead
+  ASSERT_TRUE(wheel.Start(delay + 1, []() {}));
+  wheel.Advance(delay + 1);
+  EXPECT_EQ(fired_at, delay);
+}
+
+// Starts and cancels timers at random and checks each fires on its due
+// tick, against a plain map of expected expiries
+TEST(TimingWheelTest, MatchesAReferenceModel) {
+  constexpr size_t kCapacity{256};
+  TimingWheel<kCapacity> wheel{};
+  std::mt19937 random{42};
+  std::uniform_int_distribution<uint64_t> delay{0, 300'000};
+  std::map<uint32_t, std::pair<TimerId, uint64_t>> pending{};
+  uint32_t next_tag{0};
+  size_t mismatches{0};
+  size_t fired{0};
+  const auto on_fire{[&](uint32_t tag) {
+    ++fired;
+    const auto found{pending.find(tag)};
+    if (found == pending.end() || found->second.second != wheel.Now()) {
+      ++mismatches;
+    }
+    pending.erase(tag);
+  }};
+
+  for (int step = 0; step < 200'000; ++step) {
+    const auto action{random() % 4};
+    if (action == 0 && pending.size() < kCapacity) {
+      const uint32_t tag{next_tag++};
+      const uint64_t ticks{std::max<uint64_t>(delay(random) >> (random() % 16),
+                                              1)};
+      auto id{wheel.Start(ticks, [&on_fire, tag]() { on_fire(tag); })};
+      ASSERT_TRUE(id);
+      pending.emplace(tag, std::pair{*id, wheel.Now() + ticks});
+    } else if (action == 1 && !pending.empty()) {
+      const auto victim{pending.begin()};
+      EXPECT_TRUE(wheel.Cancel(victim->second.first));
+      pending.erase(victim);
+    } else {
+      wheel.Advance(random() % 64);
+    }
+    ASSERT_EQ(wheel.Size(), pending.size());
+  }
+  EXPECT_EQ(mismatches, 0U);
+  EXPECT_GT(fired, 1000U);
+}
+
+TEST(TimingWheelTest, NeverAllocates) {
+  TimingWheel<64> wheel{};
+  int fired{0};
+  const auto allocations{mcu::test::AllocationCount()};
+  for (uint64_t i = 0; i < 64; ++i) {
+    ASSERT_TRUE(wheel.Start(i * 1000, [&fired]() { ++fired; }));
+  }
+  wheel.Advance(64 * 1000);
+  EXPECT_EQ(mcu::test::AllocationCount(), allocations);
+  EXPECT_EQ(fired, 64);
+}
+
+}  // namespace
+}  // namespace common
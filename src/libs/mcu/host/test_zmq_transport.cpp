@@ -1,7 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstdint>
+#include <expected>
 #include <libs/common/error.hpp>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 #include "dispatcher.hpp"
 #include "zmq_transport.hpp"
@@ -56,15 +62,26 @@ class ZmqTransportTest : public ::testing::Test {
           break;
         }
       } else if (ret > 0) {
-        zmq::message_t request{};
-        if (socket.recv(request, zmq::recv_flags::none)) {
-          const std::string_view request_str{
-              static_cast<const char*>(request.data()), request.size()};
-          if (request_str == "Hello") {
-            socket.send(zmq::str_buffer("World"), zmq::send_flags::none);
+        // Reply to every frame of a (possibly multipart) request: "Hello"
+        // gets "World", anything else is echoed back.
+        std::vector<std::string> replies{};
+        bool more{true};
+        while (more) {
+          zmq::message_t request{};
+          if (!socket.recv(request, zmq::recv_flags::none)) {
+            socket.send(zmq::str_buffer("Unknown"), zmq::send_flags::none);
+            replies.clear();
+            break;
           }
-        } else {
-          socket.send(zmq::str_buffer("Unknown"), zmq::send_flags::none);
+          more = request.more();
+          replies.push_back(request.to_string() == "Hello"
+                                ? std::string{"World"}
+                                : request.to_string());
+        }
+        for (size_t i = 0; i < replies.size(); ++i) {
+          socket.send(zmq::buffer(replies[i]), i + 1 < replies.size()
+                                                   ? zmq::send_flags::sndmore
+                                                   : zmq::send_flags::none);
         }
       }
     }
@@ -88,5 +105,131 @@ TEST_F(ZmqTransportTest, SendReceive) {
   ASSERT_EQ(response.value(), "World");
 }
 
+TEST_F(ZmqTransportTest, ReceiveIntoBuffer) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport =
+      mcu::ZmqTransport::Create("ipc:///tmp/device_emulator.ipc",
+                                "ipc:///tmp/emulator_device.ipc", dispatcher);
+  ASSERT_TRUE(transport);
+  std::array<char, 8> buffer{};
+  ASSERT_TRUE((*transport)->Send("Hello"));
+  auto size = (*transport)->Receive(buffer);
+  ASSERT_TRUE(size);
+  EXPECT_EQ(std::string_view(buffer.data(), size.value()), "World");
+
+  // A reply that does not fit is dropped rather than truncated
+  ASSERT_TRUE((*transport)->Send("longer than the buffer"));
+  EXPECT_EQ((*transport)->Receive(buffer),
+            std::unexpected(common::Error::kMessageTooLarge));
+  ASSERT_TRUE((*transport)->Send("Hello"));
+  size = (*transport)->Receive(buffer);
+  ASSERT_TRUE(size);
+  EXPECT_EQ(std::string_view(buffer.data(), size.value()), "World");
+}
+
+TEST_F(ZmqTransportTest, ReceiveIntoBufferCompletesLargeInFlightReplies) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport =
+      mcu::ZmqTransport::Create("ipc:///tmp/device_emulator.ipc",
+                                "ipc:///tmp/emulator_device.ipc", dispatcher);
+  ASSERT_TRUE(transport);
+  auto& device = **transport;
+
+  // The test emulator echoes the request, so the reply carries its id
+  const auto id{device.NextId()};
+  const std::string request{
+      R"({"type":"Response","object":"Uart","name":"UART 1","id":)" +
+      std::to_string(id) + "}"};
+  std::string completed{};
+  ASSERT_TRUE(device.SendAsync(
+      request, id,
+      [&completed](std::expected<std::string_view, common::Error> reply) {
+        ASSERT_TRUE(reply);
+        completed = reply.value();
+      }));
+  ASSERT_TRUE(device.Send("Hello"));
+
+  // The async reply does not fit, but is not the one being waited for
+  std::array<char, 8> buffer{};
+  auto size = device.Receive(buffer);
+  ASSERT_TRUE(size);
+  EXPECT_EQ(std::string_view(buffer.data(), size.value()), "World");
+  EXPECT_EQ(completed, request);
+}
+
+TEST_F(ZmqTransportTest, FlushBatch) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport =
+      mcu::ZmqTransport::Create("ipc:///tmp/device_emulator.ipc",
+                                "ipc:///tmp/emulator_device.ipc", dispatcher);
+  ASSERT_TRUE((*transport)->Enqueue("Hello"));
+  ASSERT_TRUE((*transport)->Enqueue("one"));
+  ASSERT_TRUE((*transport)->Enqueue("two"));
+  auto replies = (*transport)->Flush();
+  ASSERT_TRUE(replies);
+  EXPECT_EQ(replies.value(),
+            (std::vector<std::string>{"World", "one", "two"}));
+
+  // The batch is consumed by Flush
+  auto empty = (*transport)->Flush();
+  ASSERT_TRUE(empty);
+  EXPECT_TRUE(empty.value().empty());
+
+  // Single requests still work after a batch
+  ASSERT_TRUE((*transport)->Send("Hello"));
+  auto response = (*transport)->Receive();
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.value(), "World");
+}
+
+TEST_F(ZmqTransportTest, SendAsyncCompletesByCorrelationId) {
+  const ReceiverMap receiver_map{};
+  Dispatcher dispatcher{receiver_map};
+  auto transport =
+      mcu::ZmqTransport::Create("ipc:///tmp/device_emulator.ipc",
+                                "ipc:///tmp/emulator_device.ipc", dispatcher);
+  auto& device = **transport;
+
+  // The test emulator echoes each request, so the reply carries its id
+  auto make_request = [](uint32_t id) {
+    return R"({"type":"Response","object":"Pin","name":"LED 1","id":)" +
+           std::to_string(id) + "}";
+  };
+  std::vector<std::string> replies{};
+  auto on_reply =
+      [&replies](std::expected<std::string_view, common::Error> reply) {
+        ASSERT_TRUE(reply);
+        replies.emplace_back(reply.value());
+      };
+
+  const auto first_id{device.NextId()};
+  const auto second_id{device.NextId()};
+  EXPECT_NE(first_id, second_id);
+  ASSERT_TRUE(device.SendAsync(make_request(first_id), first_id, on_reply));
+  ASSERT_TRUE(device.SendAsync(make_request(second_id), second_id, on_reply));
+
+  // Ids must be non-zero and unique among in-flight requests
+  EXPECT_FALSE(device.SendAsync(make_request(0), 0, on_reply));
+  EXPECT_FALSE(device.SendAsync(make_request(first_id), first_id, on_reply));
+
+  auto completed = device.Poll(std::chrono::milliseconds{1000});
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed.value(), 2);
+  EXPECT_EQ(replies, (std::vector<std::string>{make_request(first_id),
+                                               make_request(second_id)}));
+
+  // A blocking exchange completes in-flight requests it reads past
+  const auto third_id{device.NextId()};
+  ASSERT_TRUE(device.SendAsync(make_request(third_id), third_id, on_reply));
+  ASSERT_TRUE(device.Send("Hello"));
+  auto response = device.Receive();
+  ASSERT_TRUE(response);
+  EXPECT_EQ(response.value(), "World");
+  EXPECT_EQ(replies.size(), 3);
+}
+
 }  // namespace
 }  // namespace mcu
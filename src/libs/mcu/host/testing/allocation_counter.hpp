@@ -0,0 +1,37 @@
+#pragma once
+
+// Counts heap allocations made through operator new, so tests can assert
+// that a hot path does not allocate. Replaces the global operator new and
+// delete: include it from exactly one translation unit of a test binary.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace mcu::test {
+
+inline std::atomic<size_t> allocation_count{0};
+
+// Allocations made by every thread since the program started
+inline auto AllocationCount() -> size_t {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+}  // namespace mcu::test
+
+auto operator new(size_t size) -> void* {
+  mcu::test::allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory{std::malloc(size == 0 ? 1 : size)}) {  // NOLINT
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+auto operator delete(void* memory) noexcept -> void {
+  std::free(memory);  // NOLINT
+}
+
+auto operator delete(void* memory, size_t /*size*/) noexcept -> void {
+  std::free(memory);  // NOLINT
+}
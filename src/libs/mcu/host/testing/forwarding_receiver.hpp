@@ -0,0 +1,47 @@
+#pragma once
+
+// Lets a test complete its route table before the transport's server
+// thread starts dispatching, although the peripheral the route leads to
+// needs the transport and so can only be made afterwards.
+
+#include <atomic>
+#include <expected>
+#include <string>
+#include <string_view>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/host/receiver.hpp"
+
+namespace mcu::test {
+
+// Passes messages on to the receiver attached to it; until then it
+// rejects them with kInvalidState
+class ForwardingReceiver final : public Receiver {
+ public:
+  auto Attach(Receiver& receiver) -> void {
+    receiver_.store(&receiver, std::memory_order_release);
+  }
+
+  auto Receive(const std::string_view& message)
+      -> std::expected<std::string, common::Error> override {
+    auto* receiver{receiver_.load(std::memory_order_acquire)};
+    if (receiver == nullptr) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    return receiver->Receive(message);
+  }
+
+  auto ReceiveInto(const std::string_view& message, std::string& reply)
+      -> std::expected<void, common::Error> override {
+    auto* receiver{receiver_.load(std::memory_order_acquire)};
+    if (receiver == nullptr) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    return receiver->ReceiveInto(message, reply);
+  }
+
+ private:
+  std::atomic<Receiver*> receiver_{nullptr};
+};
+
+}  // namespace mcu::test
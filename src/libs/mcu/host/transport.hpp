@@ -1,18 +1,94 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <functional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "libs/common/error.hpp"
 
 namespace mcu {
+
+// Completes a request sent with Transport::SendAsync(); receives the reply
+using ResponseHandler =
+    std::function<void(std::expected<std::string_view, common::Error>)>;
+
 class Transport {
  public:
   virtual ~Transport() = default;
   virtual auto Send(std::string_view data)
       -> std::expected<void, common::Error> = 0;
   virtual auto Receive() -> std::expected<std::string, common::Error> = 0;
+  // Copies the next reply into buffer instead of allocating a string, so a
+  // caller that reuses its buffer receives without allocating. Returns the
+  // reply's size; a reply larger than buffer is discarded and fails with
+  // kMessageTooLarge. Replies to in-flight requests are completed whatever
+  // their size, since they are not the caller's.
+  virtual auto Receive(std::span<char> buffer)
+      -> std::expected<size_t, common::Error> = 0;
+
+  // Batched requests: Enqueue() holds a request back and Flush() sends all
+  // held requests in a single exchange. Replies are returned in the order the
+  // requests were enqueued. A batch that fails part way through sending is
+  // dropped as a whole; the emulator answers none of it.
+  virtual auto Enqueue(std::string_view data)
+      -> std::expected<void, common::Error> = 0;
+  virtual auto Flush()
+      -> std::expected<std::vector<std::string>, common::Error> = 0;
+
+  // Correlated requests: any number may be in flight at once. The message
+  // sent with SendAsync() must carry the id, and handler runs with the reply
+  // carrying the same id whenever the transport next reads from the
+  // emulator, whether in Receive(), Flush() or Poll(). Only the application
+  // thread reads replies, so nothing completes unless it calls one of them;
+  // an owner that has no blocking requests to make calls Poll() while
+  // requests are in flight.
+  virtual auto NextId() -> uint32_t = 0;
+  virtual auto SendAsync(std::string_view data, uint32_t id,
+                         ResponseHandler handler)
+      -> std::expected<void, common::Error> = 0;
+  // Completes in-flight requests until none are left or timeout expires.
+  // Returns the number of requests completed.
+  virtual auto Poll(std::chrono::milliseconds timeout)
+      -> std::expected<size_t, common::Error> = 0;
+  // Makes sure the handler for id never runs, for an owner that goes away
+  // before the reply arrives. The reply is discarded when it does.
+  virtual auto Cancel(uint32_t id) -> void = 0;
+  // Whether any request is waiting for its reply, i.e. whether Poll() has
+  // anything to do
+  [[nodiscard]] virtual auto HasInFlight() const -> bool = 0;
+  // Stops handling requests from the emulator: once it returns, the
+  // dispatcher is never called again. Requests to the emulator still work,
+  // so an owner can take its receivers down, cancelling what they have in
+  // flight, before the transport itself goes. The destructor calls it too.
+  virtual auto StopServing() -> void = 0;
 
  private:
 };
+
+// Storage a peripheral reuses for the replies to its blocking requests. It
+// grows to the largest reply asked for so far, after which receiving a
+// reply does not allocate.
+class ReplyBuffer {
+ public:
+  // The view is valid until the next call
+  auto Receive(Transport& transport, size_t max_size)
+      -> std::expected<std::string_view, common::Error> {
+    if (storage_.size() < max_size) {
+      storage_.resize(max_size);
+    }
+    return transport.Receive(storage_).transform([this](size_t size) {
+      return std::string_view{storage_.data(), size};
+    });
+  }
+
+ private:
+  std::vector<char> storage_{};
+};
+
 }  // namespace mcu
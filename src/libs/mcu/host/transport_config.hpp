@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "libs/common/logger.hpp"
+
+namespace mcu {
+
+enum class TransportState {
+  kDisconnected,
+  kConnecting,
+  kConnected,
+  kError,
+};
+
+struct RetryConfig {
+  uint32_t max_attempts{3};
+  std::chrono::milliseconds retry_delay{10};
+  std::chrono::milliseconds total_timeout{1000};
+};
+
+struct TransportConfig {
+  std::chrono::milliseconds poll_timeout{50};
+  std::chrono::milliseconds connect_timeout{5000};
+  std::chrono::milliseconds shutdown_timeout{2000};
+  std::chrono::milliseconds send_timeout{1000};
+  std::chrono::milliseconds recv_timeout{5000};
+  int linger_ms{0};  // Discard pending messages on close
+  RetryConfig retry{};
+  common::Logger& logger;  // Logger reference (defaults to NullLogger)
+
+  // Default constructor uses NullLogger
+  TransportConfig() : logger(GetDefaultLogger()) {}
+
+  // Allow custom logger via dependency injection
+  explicit TransportConfig(common::Logger& custom_logger)
+      : logger(custom_logger) {}
+
+ private:
+  static auto GetDefaultLogger() -> common::Logger& {
+    static common::NullLogger null_logger{};
+    return null_logger;
+  }
+};
+
+}  // namespace mcu
@@ -1,8 +1,15 @@
 #include "zmq_transport.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <expected>
 #include <iostream>
+#include <span>
+#include <string>
 #include <thread>
+#include <vector>
 #include <zmq.hpp>
 
 #include "dispatcher.hpp"
@@ -100,17 +107,7 @@ ZmqTransport::~ZmqTransport() {
   try {
     LogDebug("Shutting down ZmqTransport");
 
-    // Signal shutdown
-    running_ = false;
-
-    // Shutdown context (will unblock recv/send operations in ServerThread)
-    from_emulator_context_.shutdown();
-
-    // Join thread - context.shutdown() will cause recv() to throw,
-    // which will exit the ServerThread loop
-    if (server_thread_.joinable()) {
-      server_thread_.join();
-    }
+    StopServing();
 
     // Close contexts after thread has finished
     from_emulator_context_.close();
@@ -132,7 +129,11 @@ auto ZmqTransport::Send(std::string_view data)
     LogWarning("Send failed: not connected");
     return std::unexpected(common::Error::kInvalidState);
   }
+  return SendFrame(data, zmq::send_flags::none);
+}
 
+auto ZmqTransport::SendFrame(std::string_view data, zmq::send_flags flags)
+    -> std::expected<void, common::Error> {
   // Calculate deadline for retry timeout
   const auto deadline{std::chrono::steady_clock::now() +
                       config_.retry.total_timeout};
@@ -141,7 +142,7 @@ auto ZmqTransport::Send(std::string_view data)
   for (uint32_t attempt = 0; attempt < config_.retry.max_attempts; ++attempt) {
     try {
       auto result{
-          to_emulator_socket_.send(zmq::buffer(data), zmq::send_flags::none)};
+          to_emulator_socket_.send(zmq::buffer(data), flags)};
       if (result) {
         if (attempt > 0) {
           LogDebug("Send succeeded after retry");
@@ -203,9 +204,11 @@ void ZmqTransport::ServerThread(const std::string& endpoint) {
 
     LogDebug("ServerThread bound and listening");
 
+    // Reused for every message so dispatch does not allocate per message
+    zmq::message_t request{};
+    std::string reply{};
     while (running_) {
       try {
-        zmq::message_t request{};
         auto result = socket.recv(request, zmq::recv_flags::none);
 
         if (!result) {
@@ -213,18 +216,16 @@ void ZmqTransport::ServerThread(const std::string& endpoint) {
           continue;
         }
 
+        // Receivers read the request straight out of the ZMQ frame
         const std::string_view request_str{
             static_cast<const char*>(request.data()), request.size()};
 
-        auto response = dispatcher_.Dispatch(request.to_string());
-        if (response) {
-          zmq::message_t reply{response.value().data(),
-                               response.value().size()};
-          socket.send(reply, zmq::send_flags::none);
+        auto handled = dispatcher_.DispatchInto(request_str, reply);
+        if (handled) {
+          socket.send(zmq::buffer(reply), zmq::send_flags::none);
         } else {
           LogWarning("Unhandled message in dispatcher");
-          zmq::message_t reply{"Unhandled", 9};
-          socket.send(reply, zmq::send_flags::none);
+          socket.send(zmq::str_buffer("Unhandled"), zmq::send_flags::none);
         }
 
       } catch (const zmq::error_t& e) {
@@ -247,6 +248,22 @@ void ZmqTransport::ServerThread(const std::string& endpoint) {
   }
 }
 
+auto ZmqTransport::StopServing() -> void {
+  if (!server_thread_.joinable()) {
+    return;
+  }
+
+  // Signal shutdown
+  running_ = false;
+
+  // Shutdown context (will unblock recv/send operations in ServerThread)
+  from_emulator_context_.shutdown();
+
+  // Join thread - context.shutdown() will cause recv() to throw,
+  // which will exit the ServerThread loop
+  server_thread_.join();
+}
+
 auto ZmqTransport::Receive() -> std::expected<std::string, common::Error> {
   if (state_ != TransportState::kConnected) {
     LogWarning("Receive failed: not connected");
@@ -254,13 +271,18 @@ auto ZmqTransport::Receive() -> std::expected<std::string, common::Error> {
   }
 
   try {
-    zmq::message_t msg{};
-    auto result{to_emulator_socket_.recv(msg, zmq::recv_flags::none)};
-    if (!result || result.value() != msg.size()) {
-      LogError("Receive operation failed");
-      return std::unexpected(common::Error::kOperationFailed);
+    while (true) {
+      zmq::message_t msg{};
+      auto result{to_emulator_socket_.recv(msg, zmq::recv_flags::none)};
+      if (!result || result.value() != msg.size()) {
+        LogError("Receive operation failed");
+        return std::unexpected(common::Error::kOperationFailed);
+      }
+      // Replies to in-flight requests may arrive ahead of the one we want
+      if (!in_flight_.Complete(msg.to_string_view())) {
+        return msg.to_string();
+      }
     }
-    return msg.to_string();
   } catch (const zmq::error_t& e) {
     if (e.num() == EAGAIN || e.num() == ETIMEDOUT) {
       LogDebug("Receive timeout");
@@ -271,4 +293,176 @@ auto ZmqTransport::Receive() -> std::expected<std::string, common::Error> {
   }
 }
 
+auto ZmqTransport::Receive(std::span<char> buffer)
+    -> std::expected<size_t, common::Error> {
+  if (state_ != TransportState::kConnected) {
+    LogWarning("Receive failed: not connected");
+    return std::unexpected(common::Error::kInvalidState);
+  }
+
+  try {
+    while (true) {
+      auto result{
+          to_emulator_socket_.recv(reply_frame_, zmq::recv_flags::none)};
+      if (!result || result.value() != reply_frame_.size()) {
+        LogError("Receive operation failed");
+        return std::unexpected(common::Error::kOperationFailed);
+      }
+      // Replies to in-flight requests may arrive ahead of the one we want
+      const auto frame{reply_frame_.to_string_view()};
+      if (in_flight_.Complete(frame)) {
+        continue;
+      }
+      if (frame.size() > buffer.size()) {
+        LogError("Receive buffer too small for reply");
+        return std::unexpected(common::Error::kMessageTooLarge);
+      }
+      std::ranges::copy(frame, buffer.begin());
+      return frame.size();
+    }
+  } catch (const zmq::error_t& e) {
+    if (e.num() == EAGAIN || e.num() == ETIMEDOUT) {
+      LogDebug("Receive timeout");
+      return std::unexpected(common::Error::kTimeout);
+    }
+    LogError("Receive failed with ZMQ error");
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+}
+
+auto ZmqTransport::Enqueue(std::string_view data)
+    -> std::expected<void, common::Error> {
+  if (state_ != TransportState::kConnected) {
+    LogWarning("Enqueue failed: not connected");
+    return std::unexpected(common::Error::kInvalidState);
+  }
+  batch_.emplace_back(data);
+  return {};
+}
+
+auto ZmqTransport::Flush()
+    -> std::expected<std::vector<std::string>, common::Error> {
+  if (state_ != TransportState::kConnected) {
+    LogWarning("Flush failed: not connected");
+    return std::unexpected(common::Error::kInvalidState);
+  }
+  if (batch_.empty()) {
+    return {};
+  }
+
+  // The batch is consumed whether or not the exchange succeeds
+  const size_t count{batch_.size()};
+  for (size_t i = 0; i < count; ++i) {
+    const auto flags{i + 1 < count ? zmq::send_flags::sndmore
+                                   : zmq::send_flags::none};
+    auto sent{SendFrame(batch_[i], flags)};
+    if (!sent) {
+      batch_.clear();
+      // The frames already sent form an unfinished multipart message that
+      // the next send would extend. End it with an empty frame, which the
+      // emulator takes as an abandoned batch and does not answer.
+      if (i > 0 && !SendFrame({}, zmq::send_flags::none)) {
+        LogError("Flush could not terminate the abandoned batch");
+      }
+      return std::unexpected(sent.error());
+    }
+  }
+  batch_.clear();
+
+  std::vector<std::string> replies{};
+  replies.reserve(count);
+  try {
+    bool more{true};
+    while (more) {
+      zmq::message_t msg{};
+      auto result{to_emulator_socket_.recv(msg, zmq::recv_flags::none)};
+      if (!result) {
+        LogError("Flush receive operation failed");
+        return std::unexpected(common::Error::kOperationFailed);
+      }
+      more = msg.more();
+      if (replies.empty() && !more &&
+          in_flight_.Complete(msg.to_string_view())) {
+        more = true;  // Not part of the batch; keep waiting for it
+        continue;
+      }
+      replies.push_back(msg.to_string());
+    }
+  } catch (const zmq::error_t& e) {
+    if (e.num() == EAGAIN || e.num() == ETIMEDOUT) {
+      LogDebug("Flush receive timeout");
+      return std::unexpected(common::Error::kTimeout);
+    }
+    LogError("Flush failed with ZMQ error");
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+
+  if (replies.size() != count) {
+    LogError("Flush reply count does not match request count");
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+  return replies;
+}
+
+auto ZmqTransport::NextId() -> uint32_t { return in_flight_.NextId(); }
+
+auto ZmqTransport::Cancel(uint32_t id) -> void { in_flight_.Cancel(id); }
+
+auto ZmqTransport::HasInFlight() const -> bool { return !in_flight_.Empty(); }
+
+auto ZmqTransport::SendAsync(std::string_view data, uint32_t id,
+                             ResponseHandler handler)
+    -> std::expected<void, common::Error> {
+  if (!in_flight_.CanAdd(id)) {
+    LogWarning("SendAsync failed: invalid correlation id");
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  auto sent{Send(data)};
+  if (!sent) {
+    return sent;
+  }
+  return in_flight_.Add(id, std::move(handler));
+}
+
+auto ZmqTransport::Poll(std::chrono::milliseconds timeout)
+    -> std::expected<size_t, common::Error> {
+  if (state_ != TransportState::kConnected) {
+    LogWarning("Poll failed: not connected");
+    return std::unexpected(common::Error::kInvalidState);
+  }
+
+  const auto deadline{std::chrono::steady_clock::now() + timeout};
+  size_t completed{0};
+  try {
+    while (!in_flight_.Empty()) {
+      const auto remaining{
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              deadline - std::chrono::steady_clock::now())};
+      std::array<zmq::pollitem_t, 1> items{
+          {{.socket = static_cast<void*>(to_emulator_socket_),
+            .fd = 0,
+            .events = ZMQ_POLLIN,
+            .revents = 0}}};
+      if (zmq::poll(items.data(), 1,
+                    std::max(remaining, std::chrono::milliseconds{0})) <= 0) {
+        break;  // Timed out
+      }
+
+      zmq::message_t msg{};
+      if (!to_emulator_socket_.recv(msg, zmq::recv_flags::dontwait)) {
+        break;
+      }
+      if (in_flight_.Complete(msg.to_string_view())) {
+        ++completed;
+      } else {
+        LogWarning("Poll discarded a reply with no request in flight");
+      }
+    }
+  } catch (const zmq::error_t& /*e*/) {
+    LogError("Poll failed with ZMQ error");
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+  return completed;
+}
+
 }  // namespace mcu
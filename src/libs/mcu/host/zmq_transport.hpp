@@ -1,54 +1,25 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <expected>
+#include <span>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 #include <zmq.hpp>
 
 #include "dispatcher.hpp"
+#include "in_flight_requests.hpp"
 #include "libs/common/error.hpp"
 #include "libs/common/logger.hpp"
 #include "transport.hpp"
+#include "transport_config.hpp"
 
 namespace mcu {
 
-enum class TransportState {
-  kDisconnected,
-  kConnecting,
-  kConnected,
-  kError,
-};
-
-struct RetryConfig {
-  uint32_t max_attempts{3};
-  std::chrono::milliseconds retry_delay{10};
-  std::chrono::milliseconds total_timeout{1000};
-};
-
-struct TransportConfig {
-  std::chrono::milliseconds poll_timeout{50};
-  std::chrono::milliseconds connect_timeout{5000};
-  std::chrono::milliseconds shutdown_timeout{2000};
-  std::chrono::milliseconds send_timeout{1000};
-  std::chrono::milliseconds recv_timeout{5000};
-  int linger_ms{0};  // Discard pending messages on close
-  RetryConfig retry{};
-  common::Logger& logger;  // Logger reference (defaults to NullLogger)
-
-  // Default constructor uses NullLogger
-  TransportConfig() : logger(GetDefaultLogger()) {}
-
-  // Allow custom logger via dependency injection
-  explicit TransportConfig(common::Logger& custom_logger)
-      : logger(custom_logger) {}
-
- private:
-  static auto GetDefaultLogger() -> common::Logger& {
-    static common::NullLogger null_logger{};
-    return null_logger;
-  }
-};
-
 class ZmqTransport : public Transport {
  public:
   ZmqTransport() = delete;
@@ -61,6 +32,22 @@ class ZmqTransport : public Transport {
   auto Send(std::string_view data)
       -> std::expected<void, common::Error> override;
   auto Receive() -> std::expected<std::string, common::Error> override;
+  auto Receive(std::span<char> buffer)
+      -> std::expected<size_t, common::Error> override;
+  // The batch goes out as one multipart message; the emulator answers with
+  // one reply frame per request frame.
+  auto Enqueue(std::string_view data)
+      -> std::expected<void, common::Error> override;
+  auto Flush()
+      -> std::expected<std::vector<std::string>, common::Error> override;
+  auto NextId() -> uint32_t override;
+  auto SendAsync(std::string_view data, uint32_t id, ResponseHandler handler)
+      -> std::expected<void, common::Error> override;
+  auto Poll(std::chrono::milliseconds timeout)
+      -> std::expected<size_t, common::Error> override;
+  auto Cancel(uint32_t id) -> void override;
+  [[nodiscard]] auto HasInFlight() const -> bool override;
+  auto StopServing() -> void override;
 
   // New methods for connection management
   auto State() const -> TransportState { return state_.load(); }
@@ -82,17 +69,21 @@ class ZmqTransport : public Transport {
  private:
   auto ServerThread(const std::string& endpoint) -> void;
   auto SetSocketOptions() -> void;
+  auto SendFrame(std::string_view data, zmq::send_flags flags)
+      -> std::expected<void, common::Error>;
 
   // Logging helpers to reduce cognitive complexity
   auto LogDebug(std::string_view msg) const -> void {
-    config_.logger.Debug(msg);
+    common::Log<common::LogLevel::kDebug>(config_.logger, msg);
+  }
+  auto LogInfo(std::string_view msg) const -> void {
+    common::Log<common::LogLevel::kInfo>(config_.logger, msg);
   }
-  auto LogInfo(std::string_view msg) const -> void { config_.logger.Info(msg); }
   auto LogWarning(std::string_view msg) const -> void {
-    config_.logger.Warning(msg);
+    common::Log<common::LogLevel::kWarning>(config_.logger, msg);
   }
   auto LogError(std::string_view msg) const -> void {
-    config_.logger.Error(msg);
+    common::Log<common::LogLevel::kError>(config_.logger, msg);
   }
 
   TransportConfig config_;
@@ -101,6 +92,14 @@ class ZmqTransport : public Transport {
   zmq::context_t to_emulator_context_{1};
   zmq::socket_t to_emulator_socket_{to_emulator_context_,
                                     zmq::socket_type::pair};
+  // Requests held back by Enqueue() until the next Flush()
+  std::vector<std::string> batch_{};
+  // Requests awaiting a reply. Like to_emulator_socket_, only used from the
+  // application thread.
+  InFlightRequests in_flight_{};
+  // Receive(std::span<char>) takes each frame from ZMQ into this message
+  // and copies it out once it knows the frame is the caller's reply
+  zmq::message_t reply_frame_{};
   zmq::context_t from_emulator_context_{1};
 
   std::atomic<bool> running_{true};
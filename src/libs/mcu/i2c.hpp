@@ -3,13 +3,23 @@
 #include <cstddef>
 #include <cstdint>
 #include <expected>
-#include <functional>
 #include <span>
 
 #include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
 
 namespace mcu {
 
+// One step of a batched I2C transaction: write, then read after a repeated
+// start. Either span may be empty.
+struct I2CSegment {
+  uint16_t address{0};
+  std::span<const std::byte> write{};
+  std::span<std::byte> read{};
+  // End with a stop; otherwise the next segment begins with a repeated start
+  bool stop{true};
+};
+
 class I2CController {
  public:
   virtual ~I2CController() = default;
@@ -26,22 +36,51 @@ class I2CController {
                                          std::span<std::byte> buffer)
       -> std::expected<size_t, common::Error> = 0;
 
+  /// @brief Write to an I2C device, then read from it after a repeated start
+  /// Used for register reads: the device keeps the register pointer set by
+  /// the write, as no stop condition separates the two phases.
+  /// @param address I2C device address
+  /// @param data Bytes to write, typically a register address
+  /// @param buffer Caller-provided buffer to store received data
+  /// @return Number of bytes actually received, or error
+  [[nodiscard]] virtual auto WriteRead(uint16_t address,
+                                       std::span<const std::byte> data,
+                                       std::span<std::byte> buffer)
+      -> std::expected<size_t, common::Error> = 0;
+
   [[nodiscard]] virtual auto SendDataInterrupt(
       uint16_t address, std::span<const std::byte> data,
-      std::function<void(std::expected<void, common::Error>)> callback)
+      CompletionCallback<void> callback)
       -> std::expected<void, common::Error> = 0;
   [[nodiscard]] virtual auto ReceiveDataInterrupt(
       uint16_t address, std::span<std::byte> buffer,
-      std::function<void(std::expected<size_t, common::Error>)> callback)
+      CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> = 0;
+  [[nodiscard]] virtual auto WriteReadInterrupt(
+      uint16_t address, std::span<const std::byte> data,
+      std::span<std::byte> buffer, CompletionCallback<size_t> callback)
       -> std::expected<void, common::Error> = 0;
 
   [[nodiscard]] virtual auto SendDataDma(
       uint16_t address, std::span<const std::byte> data,
-      std::function<void(std::expected<void, common::Error>)> callback)
+      CompletionCallback<void> callback)
       -> std::expected<void, common::Error> = 0;
   [[nodiscard]] virtual auto ReceiveDataDma(
       uint16_t address, std::span<std::byte> buffer,
-      std::function<void(std::expected<size_t, common::Error>)> callback)
+      CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> = 0;
+  [[nodiscard]] virtual auto WriteReadDma(
+      uint16_t address, std::span<const std::byte> data,
+      std::span<std::byte> buffer, CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> = 0;
+
+  /// @brief Run a list of segments as one transaction
+  /// Each segment's read buffer is filled in full before the callback runs.
+  /// @param segments Segments to run in order; they and their buffers must
+  ///        stay valid until the callback runs
+  /// @param callback Called once, when every segment completed or one failed
+  [[nodiscard]] virtual auto Transact(std::span<const I2CSegment> segments,
+                                      CompletionCallback<void> callback)
       -> std::expected<void, common::Error> = 0;
 };
 
@@ -1,9 +1,10 @@
 #pragma once
 
+#include <concepts>
 #include <expected>
-#include <functional>
 
 #include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
 
 namespace mcu {
 
@@ -16,7 +17,7 @@ class InputPin {
   virtual ~InputPin() = default;
   [[nodiscard]] virtual auto Get()
       -> std::expected<PinState, common::Error> = 0;
-  [[nodiscard]] virtual auto SetInterruptHandler(std::function<void()> handler,
+  [[nodiscard]] virtual auto SetInterruptHandler(InterruptHandler handler,
                                                  PinTransition transition)
       -> std::expected<void, common::Error> = 0;
 };
@@ -38,4 +39,24 @@ class BidirectionalPin : public virtual InputPin, public virtual OutputPin {
   [[nodiscard]] virtual auto Configure(PinDirection direction)
       -> std::expected<void, common::Error> = 0;
 };
+
+// What an application needs from a pin, without virtual dispatch. The
+// interfaces above model these concepts, and so do the zero-cost pins of
+// the target builds (see stm32/stm32_static_pin.hpp); code templated on
+// a concept works with either.
+template <typename T>
+concept InputPinLike = requires(T& pin) {
+  { pin.Get() } -> std::same_as<std::expected<PinState, common::Error>>;
+};
+
+template <typename T>
+concept OutputPinLike = InputPinLike<T> && requires(T& pin) {
+  { pin.SetHigh() } -> std::same_as<std::expected<void, common::Error>>;
+  { pin.SetLow() } -> std::same_as<std::expected<void, common::Error>>;
+  { pin.Toggle() } -> std::same_as<std::expected<void, common::Error>>;
+};
+
+static_assert(InputPinLike<InputPin>);
+static_assert(OutputPinLike<OutputPin>);
+static_assert(OutputPinLike<BidirectionalPin>);
 }  // namespace mcu
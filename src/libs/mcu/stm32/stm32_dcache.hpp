@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace mcu::dcache {
+
+// The Cortex-M7 L1 data cache, maintained by address through the SCB
+// (what CMSIS's SCB_CleanDCache_by_Addr and SCB_InvalidateDCache_by_Addr
+// do). A DMA stream reads and writes memory behind the cache, so the CPU
+// cleans a buffer before the DMA reads it and invalidates one before
+// reading what the DMA wrote. Buffers in a non-cacheable MPU region need
+// neither.
+
+inline constexpr uintptr_t kLineSize{32};
+
+// Invalidate and clean by address to the point of coherency
+inline constexpr uintptr_t kDcimvacAddress{0xE000'EF5C};
+inline constexpr uintptr_t kDccmvacAddress{0xE000'EF68};
+
+namespace detail {
+
+// Writes each cache line's address to one of the by-address registers,
+// then waits for the maintenance to finish
+template <uintptr_t RegisterAddress>
+auto ForEachLine(const volatile void* data, size_t size) -> void {
+  if (size == 0) {
+    return;
+  }
+  auto& operation{*reinterpret_cast<volatile uint32_t*>(  // NOLINT
+      RegisterAddress)};
+  const auto start{reinterpret_cast<uintptr_t>(data) & ~(kLineSize - 1)};
+  const auto end{reinterpret_cast<uintptr_t>(data) + size};
+  for (uintptr_t line{start}; line < end; line += kLineSize) {
+    operation = static_cast<uint32_t>(line);
+  }
+#if defined(__arm__)
+  asm volatile("dsb 0xF\n isb 0xF" ::: "memory");
+#else
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+}  // namespace detail
+
+// Writes dirty lines covering the range back to memory
+inline auto Clean(const volatile void* data, size_t size) -> void {
+  detail::ForEachLine<kDccmvacAddress>(data, size);
+}
+
+// Drops the lines covering the range, so that the next reads come from
+// memory. Whole lines go, so a range that shares a line with data the CPU
+// writes must not be invalidated: align DMA receive buffers to kLineSize
+// and size them in whole lines.
+inline auto Invalidate(const volatile void* data, size_t size) -> void {
+  detail::ForEachLine<kDcimvacAddress>(data, size);
+}
+
+}  // namespace mcu::dcache
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace mcu {
+
+// One stream of an STM32F7 DMA controller (DMA_Stream_TypeDef)
+struct Stm32DmaStreamRegisters {
+  volatile uint32_t CR;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t NDTR;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t PAR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t M0AR;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t M1AR;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t FCR;   // NOLINT(readability-identifier-naming)
+};
+
+// An STM32F7 DMA controller with its eight streams
+struct Stm32DmaRegisters {
+  volatile uint32_t LISR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t HISR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t LIFCR;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t HIFCR;  // NOLINT(readability-identifier-naming)
+  Stm32DmaStreamRegisters stream[8];  // NOLINT
+};
+
+static_assert(sizeof(Stm32DmaStreamRegisters) == 0x18);
+static_assert(offsetof(Stm32DmaRegisters, stream) == 0x10);
+
+namespace dma {
+
+// Stream CR bits
+inline constexpr uint32_t kCrEn{1U << 0U};
+inline constexpr uint32_t kCrTeie{1U << 2U};
+inline constexpr uint32_t kCrHtie{1U << 3U};
+inline constexpr uint32_t kCrTcie{1U << 4U};
+inline constexpr uint32_t kCrDirMemoryToPeripheral{1U << 6U};
+inline constexpr uint32_t kCrCirc{1U << 8U};
+inline constexpr uint32_t kCrMinc{1U << 10U};
+inline constexpr uint32_t kCrChselShift{25U};
+
+// Per-stream interrupt flags, before shifting into place with FlagShift()
+inline constexpr uint32_t kFeif{1U << 0U};
+inline constexpr uint32_t kDmeif{1U << 2U};
+inline constexpr uint32_t kTeif{1U << 3U};
+inline constexpr uint32_t kHtif{1U << 4U};
+inline constexpr uint32_t kTcif{1U << 5U};
+inline constexpr uint32_t kAllFlags{kFeif | kDmeif | kTeif | kHtif | kTcif};
+
+// Streams 0-3 report in LISR/LIFCR and 4-7 in HISR/HIFCR, each at one of
+// these offsets
+constexpr auto FlagShift(uint32_t stream) -> uint32_t {
+  constexpr std::array<uint32_t, 4> kShifts{0, 6, 16, 22};
+  return kShifts[stream % 4];
+}
+
+inline auto ReadFlags(Stm32DmaRegisters& dma, uint32_t stream) -> uint32_t {
+  const uint32_t status{stream < 4 ? dma.LISR : dma.HISR};
+  return (status >> FlagShift(stream)) & kAllFlags;
+}
+
+inline auto ClearFlags(Stm32DmaRegisters& dma, uint32_t stream,
+                       uint32_t flags) -> void {
+  const uint32_t clear{(flags & kAllFlags) << FlagShift(stream)};
+  if (stream < 4) {
+    dma.LIFCR = clear;
+  } else {
+    dma.HIFCR = clear;
+  }
+}
+
+// Disables a stream and waits until the controller lets go of it; its
+// registers may only be rewritten after that
+inline auto DisableStream(Stm32DmaStreamRegisters& stream) -> void {
+  stream.CR = stream.CR & ~kCrEn;
+  while ((stream.CR & kCrEn) != 0) {
+  }
+}
+
+// DMA address registers are 32 bits wide, as are pointers on the target
+inline auto Address(const volatile void* pointer) -> uint32_t {
+  return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer));
+}
+
+}  // namespace dma
+
+}  // namespace mcu
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mcu {
+
+// Layout of one GPIO port's registers, shared by the STM32F3 and STM32F7.
+// Member names follow GPIO_TypeDef so drivers templated on the register
+// block work with either.
+struct Stm32GpioRegisters {
+  volatile uint32_t MODER;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t OTYPER;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t OSPEEDR;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t PUPDR;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t IDR;      // NOLINT(readability-identifier-naming)
+  volatile uint32_t ODR;      // NOLINT(readability-identifier-naming)
+  volatile uint32_t BSRR;     // NOLINT(readability-identifier-naming)
+  volatile uint32_t LCKR;     // NOLINT(readability-identifier-naming)
+  volatile uint32_t AFR[2];   // NOLINT
+};
+
+static_assert(offsetof(Stm32GpioRegisters, IDR) == 0x10);
+static_assert(offsetof(Stm32GpioRegisters, BSRR) == 0x18);
+static_assert(offsetof(Stm32GpioRegisters, AFR) == 0x20);
+
+// A GPIO port at a fixed address. Ports are types rather than objects so
+// that pins bound to them need no storage and every register access
+// resolves at compile time.
+template <uintptr_t BaseAddress>
+struct Stm32GpioPortAt {
+  static constexpr uintptr_t kBaseAddress{BaseAddress};
+
+  static auto Registers() -> Stm32GpioRegisters& {
+    return *reinterpret_cast<Stm32GpioRegisters*>(kBaseAddress);  // NOLINT
+  }
+};
+
+namespace stm32f3 {
+// AHB2 on the STM32F303
+using GpioA = Stm32GpioPortAt<0x4800'0000>;
+using GpioB = Stm32GpioPortAt<0x4800'0400>;
+using GpioC = Stm32GpioPortAt<0x4800'0800>;
+using GpioD = Stm32GpioPortAt<0x4800'0C00>;
+using GpioE = Stm32GpioPortAt<0x4800'1000>;
+using GpioF = Stm32GpioPortAt<0x4800'1400>;
+}  // namespace stm32f3
+
+namespace stm32f7 {
+// AHB1 on the STM32F767
+using GpioA = Stm32GpioPortAt<0x4002'0000>;
+using GpioB = Stm32GpioPortAt<0x4002'0400>;
+using GpioC = Stm32GpioPortAt<0x4002'0800>;
+using GpioD = Stm32GpioPortAt<0x4002'0C00>;
+using GpioE = Stm32GpioPortAt<0x4002'1000>;
+using GpioF = Stm32GpioPortAt<0x4002'1400>;
+using GpioG = Stm32GpioPortAt<0x4002'1800>;
+}  // namespace stm32f7
+
+}  // namespace mcu
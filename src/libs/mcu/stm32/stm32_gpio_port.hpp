@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/gpio_port.hpp"
+
+namespace mcu {
+
+// GpioPort over an STM32 GPIO register block (GPIO_TypeDef on the target).
+// The register block is a template parameter so the driver can be tested
+// on the host against a plain struct with the same member names.
+//
+// Write() and Toggle() are a single store to BSRR, which the hardware
+// applies atomically: an interrupt driving other pins of the same port
+// cannot be lost the way it could with a read-modify-write of ODR.
+template <typename Registers>
+class Stm32GpioPort final : public GpioPort {
+ public:
+  static constexpr uint32_t kPinMask{0xFFFFU};
+
+  explicit Stm32GpioPort(Registers& registers) : registers_{registers} {}
+  Stm32GpioPort(const Stm32GpioPort&) = delete;
+  Stm32GpioPort(Stm32GpioPort&&) = delete;
+  auto operator=(const Stm32GpioPort&) -> Stm32GpioPort& = delete;
+  auto operator=(Stm32GpioPort&&) -> Stm32GpioPort& = delete;
+  ~Stm32GpioPort() override = default;
+
+  auto Write(uint32_t mask, uint32_t value)
+      -> std::expected<void, common::Error> override {
+    if ((mask & ~kPinMask) != 0) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    registers_.BSRR = SetResetWord(mask, value);
+    return {};
+  }
+
+  auto Read() -> std::expected<uint32_t, common::Error> override {
+    return registers_.IDR & kPinMask;
+  }
+
+  auto Toggle(uint32_t mask) -> std::expected<void, common::Error> override {
+    if ((mask & ~kPinMask) != 0) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    // Pins outside mask are left out of the store, so a concurrent change
+    // to them between the read and the write survives
+    const uint32_t driven{registers_.ODR};
+    registers_.BSRR = SetResetWord(mask, ~driven);
+    return {};
+  }
+
+ private:
+  // The low half of BSRR sets pins and the high half resets them
+  static constexpr auto SetResetWord(uint32_t mask, uint32_t value)
+      -> uint32_t {
+    return (mask & value) | ((mask & ~value) << 16U);
+  }
+
+  Registers& registers_;
+};
+
+}  // namespace mcu
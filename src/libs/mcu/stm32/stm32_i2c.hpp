@@ -0,0 +1,436 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
+#include "libs/mcu/i2c.hpp"
+
+namespace mcu {
+
+// HAL_StatusTypeDef, without pulling the vendor headers into this one
+enum class Stm32HalStatus : uint8_t { kOk = 0, kError, kBusy, kTimeout };
+
+// Position of a sequential transfer in a repeated-start sequence. A frame
+// starting a sequence generates a start, later ones a repeated start; the
+// last and only frames end with a stop.
+enum class Stm32I2CFrame : uint8_t { kFirst, kNext, kLast, kFirstAndLast };
+
+// The STM32Cube HAL I2C master calls for one I2C handle. On the target
+// each forwards to the HAL_I2C_Master_* function of the same name; tests
+// substitute a fake. Addresses are already in the HAL's 8-bit form.
+template <typename T>
+concept Stm32I2CHal = requires(T& hal, uint16_t address, uint8_t* data,
+                               uint16_t size, uint32_t timeout_ms,
+                               uint16_t mem_address, uint16_t mem_size,
+                               Stm32I2CFrame frame) {
+  { hal.Transmit(address, data, size, timeout_ms) }
+      -> std::same_as<Stm32HalStatus>;
+  { hal.Receive(address, data, size, timeout_ms) }
+      -> std::same_as<Stm32HalStatus>;
+  { hal.TransmitIt(address, data, size) } -> std::same_as<Stm32HalStatus>;
+  { hal.ReceiveIt(address, data, size) } -> std::same_as<Stm32HalStatus>;
+  { hal.TransmitDma(address, data, size) } -> std::same_as<Stm32HalStatus>;
+  { hal.ReceiveDma(address, data, size) } -> std::same_as<Stm32HalStatus>;
+  // mem_size is the register address width in bytes, 1 or 2
+  { hal.MemRead(address, mem_address, mem_size, data, size, timeout_ms) }
+      -> std::same_as<Stm32HalStatus>;
+  { hal.SeqTransmitIt(address, data, size, frame) }
+      -> std::same_as<Stm32HalStatus>;
+  { hal.SeqReceiveIt(address, data, size, frame) }
+      -> std::same_as<Stm32HalStatus>;
+  { hal.SeqTransmitDma(address, data, size, frame) }
+      -> std::same_as<Stm32HalStatus>;
+  { hal.SeqReceiveDma(address, data, size, frame) }
+      -> std::same_as<Stm32HalStatus>;
+};
+
+// I2CController over the STM32F3 HAL's I2C master API.
+//
+// The interrupt and DMA transfers return as soon as the HAL has started
+// them; the HAL's completion callbacks, which the board forwards to
+// OnTransmitComplete(), OnReceiveComplete() and OnError(), then run the
+// caller's callback from the ISR. One transfer may be in flight at a time,
+// as with the HAL handle underneath.
+//
+// Transact() chains one sequential DMA transfer per segment phase: each
+// completion interrupt starts the next, with a repeated start unless the
+// previous segment ended with a stop, and the caller's callback runs once
+// after the last. An asynchronous WriteRead is a one-segment transaction.
+// The blocking WriteRead uses the HAL's register read, so its write phase
+// is limited to a one or two byte register address.
+template <Stm32I2CHal Hal>
+class Stm32I2CController final : public I2CController {
+ public:
+  static constexpr uint32_t kBlockingTimeoutMs{100};
+  // The HAL counts transfers in 16 bits
+  static constexpr size_t kMaxTransferSize{0xFFFF};
+
+  explicit Stm32I2CController(Hal hal) : hal_{std::move(hal)} {}
+  Stm32I2CController(const Stm32I2CController&) = delete;
+  Stm32I2CController(Stm32I2CController&&) = delete;
+  auto operator=(const Stm32I2CController&) -> Stm32I2CController& = delete;
+  auto operator=(Stm32I2CController&&) -> Stm32I2CController& = delete;
+  ~Stm32I2CController() override = default;
+
+  auto SendData(uint16_t address, std::span<const std::byte> data)
+      -> std::expected<void, common::Error> override {
+    if (data.size() > kMaxTransferSize) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return Check(hal_.Transmit(HalAddress(address), Bytes(data),
+                               static_cast<uint16_t>(data.size()),
+                               kBlockingTimeoutMs));
+  }
+
+  auto ReceiveData(uint16_t address, std::span<std::byte> buffer)
+      -> std::expected<size_t, common::Error> override {
+    if (buffer.size() > kMaxTransferSize) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return Check(hal_.Receive(HalAddress(address), Bytes(buffer),
+                              static_cast<uint16_t>(buffer.size()),
+                              kBlockingTimeoutMs))
+        .transform([buffer]() { return buffer.size(); });
+  }
+
+  auto WriteRead(uint16_t address, std::span<const std::byte> data,
+                 std::span<std::byte> buffer)
+      -> std::expected<size_t, common::Error> override {
+    if (data.empty()) {
+      return ReceiveData(address, buffer);
+    }
+    if (buffer.empty()) {
+      return SendData(address, data).transform([]() { return size_t{0}; });
+    }
+    if (data.size() > 2 || buffer.size() > kMaxTransferSize) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    // The register address goes out most significant byte first
+    uint16_t mem_address{0};
+    for (const auto byte : data) {
+      mem_address = static_cast<uint16_t>((mem_address << 8U) |
+                                          std::to_integer<uint16_t>(byte));
+    }
+    return Check(hal_.MemRead(HalAddress(address), mem_address,
+                              static_cast<uint16_t>(data.size()), Bytes(buffer),
+                              static_cast<uint16_t>(buffer.size()),
+                              kBlockingTimeoutMs))
+        .transform([buffer]() { return buffer.size(); });
+  }
+
+  auto SendDataInterrupt(uint16_t address, std::span<const std::byte> data,
+                         CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    return StartSend(data.size(), std::move(callback), [&]() {
+      return hal_.TransmitIt(HalAddress(address), Bytes(data),
+                             static_cast<uint16_t>(data.size()));
+    });
+  }
+
+  auto ReceiveDataInterrupt(uint16_t address, std::span<std::byte> buffer,
+                            CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    return StartReceive(buffer.size(), std::move(callback), [&]() {
+      return hal_.ReceiveIt(HalAddress(address), Bytes(buffer),
+                            static_cast<uint16_t>(buffer.size()));
+    });
+  }
+
+  auto WriteReadInterrupt(uint16_t address, std::span<const std::byte> data,
+                          std::span<std::byte> buffer,
+                          CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    return StartWriteRead(address, data, buffer, false, std::move(callback));
+  }
+
+  auto SendDataDma(uint16_t address, std::span<const std::byte> data,
+                   CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    return StartSend(data.size(), std::move(callback), [&]() {
+      return hal_.TransmitDma(HalAddress(address), Bytes(data),
+                              static_cast<uint16_t>(data.size()));
+    });
+  }
+
+  auto ReceiveDataDma(uint16_t address, std::span<std::byte> buffer,
+                      CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    return StartReceive(buffer.size(), std::move(callback), [&]() {
+      return hal_.ReceiveDma(HalAddress(address), Bytes(buffer),
+                             static_cast<uint16_t>(buffer.size()));
+    });
+  }
+
+  auto WriteReadDma(uint16_t address, std::span<const std::byte> data,
+                    std::span<std::byte> buffer,
+                    CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    return StartWriteRead(address, data, buffer, true, std::move(callback));
+  }
+
+  auto Transact(std::span<const I2CSegment> segments,
+                CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    return StartTransaction(segments, true, std::move(callback));
+  }
+
+  // HAL callback entry points, called in interrupt context
+
+  auto OnTransmitComplete() -> void {
+    if (transaction_callback_) {
+      Advance();
+      return;
+    }
+    if (auto callback{std::exchange(send_callback_, {})}) {
+      callback({});
+    }
+  }
+
+  auto OnReceiveComplete() -> void {
+    if (transaction_callback_) {
+      Advance();
+      return;
+    }
+    if (auto callback{std::exchange(receive_callback_, {})}) {
+      callback(receive_size_);
+    }
+  }
+
+  auto OnError() -> void {
+    const auto error{common::Error::kOperationFailed};
+    if (transaction_callback_) {
+      Finish(std::unexpected(error));
+    }
+    if (auto callback{std::exchange(send_callback_, {})}) {
+      callback(std::unexpected(error));
+    }
+    if (auto callback{std::exchange(receive_callback_, {})}) {
+      callback(std::unexpected(error));
+    }
+  }
+
+ private:
+  static auto Check(Stm32HalStatus status)
+      -> std::expected<void, common::Error> {
+    switch (status) {
+      case Stm32HalStatus::kOk:
+        return {};
+      case Stm32HalStatus::kBusy:
+        return std::unexpected(common::Error::kInvalidState);
+      case Stm32HalStatus::kTimeout:
+        return std::unexpected(common::Error::kTimeout);
+      case Stm32HalStatus::kError:
+        break;
+    }
+    return std::unexpected(common::Error::kOperationFailed);
+  }
+
+  // The HAL takes the 7-bit address shifted into the top of a byte
+  static auto HalAddress(uint16_t address) -> uint16_t {
+    return static_cast<uint16_t>(address << 1U);
+  }
+
+  // The HAL's buffers are non-const even for transmit, which only reads
+  static auto Bytes(std::span<const std::byte> data) -> uint8_t* {
+    return const_cast<uint8_t*>(  // NOLINT
+        reinterpret_cast<const uint8_t*>(data.data()));
+  }
+
+  auto Busy() const -> bool {
+    return send_callback_ || receive_callback_ || transaction_callback_;
+  }
+
+  template <typename Start>
+  auto StartSend(size_t size, CompletionCallback<void> callback, Start start)
+      -> std::expected<void, common::Error> {
+    if (size > kMaxTransferSize) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    if (Busy()) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    // Stored first: the completion interrupt may fire before start returns.
+    // An empty callback would not mark the controller busy.
+    if (!callback) {
+      callback = [](std::expected<void, common::Error>) {};
+    }
+    send_callback_ = std::move(callback);
+    auto started{Check(start())};
+    if (!started) {
+      send_callback_ = {};
+    }
+    return started;
+  }
+
+  template <typename Start>
+  auto StartReceive(size_t size, CompletionCallback<size_t> callback,
+                    Start start) -> std::expected<void, common::Error> {
+    if (size > kMaxTransferSize) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    if (Busy()) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    receive_size_ = size;
+    if (!callback) {
+      callback = [](std::expected<size_t, common::Error>) {};
+    }
+    receive_callback_ = std::move(callback);
+    auto started{Check(start())};
+    if (!started) {
+      receive_callback_ = {};
+    }
+    return started;
+  }
+
+  // Progress through the segments of the transaction in flight
+  struct Transaction {
+    std::span<const I2CSegment> segments{};
+    size_t index{0};
+    bool reading{false};  // In the read phase of segments[index]
+    bool restart{false};  // The previous transfer ended without a stop
+    bool dma{false};
+  };
+
+  static auto Frame(bool start, bool stop) -> Stm32I2CFrame {
+    if (start) {
+      return stop ? Stm32I2CFrame::kFirstAndLast : Stm32I2CFrame::kFirst;
+    }
+    return stop ? Stm32I2CFrame::kLast : Stm32I2CFrame::kNext;
+  }
+
+  auto StartWriteRead(uint16_t address, std::span<const std::byte> data,
+                      std::span<std::byte> buffer, bool dma,
+                      CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> {
+    if (data.empty()) {
+      return StartReceive(buffer.size(), std::move(callback), [&]() {
+        return dma ? hal_.ReceiveDma(HalAddress(address), Bytes(buffer),
+                                     static_cast<uint16_t>(buffer.size()))
+                   : hal_.ReceiveIt(HalAddress(address), Bytes(buffer),
+                                    static_cast<uint16_t>(buffer.size()));
+      });
+    }
+    if (Busy()) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    write_read_segment_ = I2CSegment{
+        .address = address, .write = data, .read = buffer, .stop = true};
+    // Kept in a member so the transaction's callback captures only this
+    // and fits its inline storage
+    write_read_callback_ = std::move(callback);
+    auto started{StartTransaction(
+        std::span{&write_read_segment_, 1}, dma,
+        [this](std::expected<void, common::Error> result) {
+          if (auto done{std::exchange(write_read_callback_, {})}) {
+            done(result.transform(
+                [this]() { return write_read_segment_.read.size(); }));
+          }
+        })};
+    if (!started) {
+      write_read_callback_ = {};
+    }
+    return started;
+  }
+
+  auto StartTransaction(std::span<const I2CSegment> segments, bool dma,
+                        CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> {
+    if (segments.empty()) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    for (const auto& segment : segments) {
+      if ((segment.write.empty() && segment.read.empty()) ||
+          segment.write.size() > kMaxTransferSize ||
+          segment.read.size() > kMaxTransferSize) {
+        return std::unexpected(common::Error::kInvalidArgument);
+      }
+    }
+    if (Busy()) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    if (!callback) {
+      callback = [](std::expected<void, common::Error>) {};
+    }
+    transaction_ = Transaction{.segments = segments,
+                               .index = 0,
+                               .reading = segments.front().write.empty(),
+                               .restart = false,
+                               .dma = dma};
+    transaction_callback_ = std::move(callback);
+    auto started{StartStep()};
+    if (!started) {
+      transaction_callback_ = {};
+    }
+    return started;
+  }
+
+  // Starts the current phase of the current segment
+  auto StartStep() -> std::expected<void, common::Error> {
+    const auto& segment{transaction_.segments[transaction_.index]};
+    const bool last{transaction_.index + 1 == transaction_.segments.size()};
+    // A write followed by a read restarts into it; otherwise the segment
+    // decides, and the transaction always releases the bus at the end.
+    const bool stop{(transaction_.reading || segment.read.empty()) &&
+                    (segment.stop || last)};
+    const auto frame{Frame(!transaction_.restart, stop)};
+    transaction_.restart = !stop;
+
+    const auto address{HalAddress(segment.address)};
+    if (transaction_.reading) {
+      auto* data{Bytes(segment.read)};
+      const auto size{static_cast<uint16_t>(segment.read.size())};
+      return Check(transaction_.dma
+                       ? hal_.SeqReceiveDma(address, data, size, frame)
+                       : hal_.SeqReceiveIt(address, data, size, frame));
+    }
+    auto* data{Bytes(segment.write)};
+    const auto size{static_cast<uint16_t>(segment.write.size())};
+    return Check(transaction_.dma
+                     ? hal_.SeqTransmitDma(address, data, size, frame)
+                     : hal_.SeqTransmitIt(address, data, size, frame));
+  }
+
+  // Moves to the next phase once the current one completed
+  auto Advance() -> void {
+    const auto& segment{transaction_.segments[transaction_.index]};
+    if (!transaction_.reading && !segment.read.empty()) {
+      transaction_.reading = true;
+    } else if (++transaction_.index == transaction_.segments.size()) {
+      Finish({});
+      return;
+    } else {
+      transaction_.reading =
+          transaction_.segments[transaction_.index].write.empty();
+    }
+    if (auto started{StartStep()}; !started) {
+      Finish(started);
+    }
+  }
+
+  auto Finish(std::expected<void, common::Error> result) -> void {
+    transaction_ = {};
+    if (auto callback{std::exchange(transaction_callback_, {})}) {
+      callback(result);
+    }
+  }
+
+  Hal hal_;
+  CompletionCallback<void> send_callback_{};
+  CompletionCallback<size_t> receive_callback_{};
+  size_t receive_size_{0};
+  Transaction transaction_{};
+  CompletionCallback<void> transaction_callback_{};
+  // Storage for the single segment of an asynchronous WriteRead, and the
+  // caller's callback, which wants the number of bytes read
+  I2CSegment write_read_segment_{};
+  CompletionCallback<size_t> write_read_callback_{};
+};
+
+}  // namespace mcu
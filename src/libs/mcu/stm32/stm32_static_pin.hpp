@@ -0,0 +1,68 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <expected>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/pin.hpp"
+
+namespace mcu {
+
+// A GPIO port type: Registers() returns its register block
+template <typename T>
+concept Stm32GpioPortType = requires {
+  { T::Registers().IDR } -> std::convertible_to<uint32_t>;
+  { T::Registers().ODR } -> std::convertible_to<uint32_t>;
+  T::Registers().BSRR = uint32_t{};
+  T::Registers().MODER = uint32_t{};
+};
+
+// A pin fixed at compile time. It holds no state and calls no virtual
+// functions, so with the port at a constant address SetHigh() and SetLow()
+// compile to one store and Toggle() to a load and a store. It models
+// OutputPinLike for code templated on the pin type; code that needs a
+// run-time choice of pin keeps using the OutputPin interface.
+//
+// Interrupts and pull-ups are left to the board's startup code.
+template <Stm32GpioPortType Port, uint32_t Index>
+  requires(Index < 16)
+class StaticPin {
+ public:
+  static constexpr uint32_t kMask{1U << Index};
+
+  static auto Configure(PinDirection direction)
+      -> std::expected<void, common::Error> {
+    // MODER has two bits per pin: 00 input, 01 general purpose output
+    constexpr uint32_t kModeShift{Index * 2U};
+    const uint32_t mode{direction == PinDirection::kOutput ? 1U : 0U};
+    auto& registers{Port::Registers()};
+    registers.MODER = (registers.MODER & ~(3U << kModeShift)) |
+                      (mode << kModeShift);
+    return {};
+  }
+
+  static auto SetHigh() -> std::expected<void, common::Error> {
+    Port::Registers().BSRR = kMask;
+    return {};
+  }
+
+  static auto SetLow() -> std::expected<void, common::Error> {
+    Port::Registers().BSRR = kMask << 16U;
+    return {};
+  }
+
+  static auto Toggle() -> std::expected<void, common::Error> {
+    // Writing BSRR rather than ODR leaves the port's other pins alone
+    auto& registers{Port::Registers()};
+    registers.BSRR = (registers.ODR & kMask) != 0 ? kMask << 16U : kMask;
+    return {};
+  }
+
+  static auto Get() -> std::expected<PinState, common::Error> {
+    return (Port::Registers().IDR & kMask) != 0 ? PinState::kHigh
+                                                : PinState::kLow;
+  }
+};
+
+}  // namespace mcu
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
+#include "libs/mcu/timer.hpp"
+
+namespace mcu {
+
+// An STM32F7 general-purpose or basic timer (TIM_TypeDef, up to ARR). The
+// basic timers TIM6 and TIM7 leave SMCR and the capture/compare registers
+// reserved; the driver does not touch them.
+struct Stm32TimerRegisters {
+  volatile uint32_t CR1;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t CR2;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t SMCR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t DIER;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t SR;     // NOLINT(readability-identifier-naming)
+  volatile uint32_t EGR;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t CCMR1;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t CCMR2;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t CCER;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t CNT;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t PSC;    // NOLINT(readability-identifier-naming)
+  volatile uint32_t ARR;    // NOLINT(readability-identifier-naming)
+};
+
+static_assert(offsetof(Stm32TimerRegisters, DIER) == 0x0C);
+static_assert(offsetof(Stm32TimerRegisters, CNT) == 0x24);
+static_assert(offsetof(Stm32TimerRegisters, ARR) == 0x2C);
+
+namespace tim {
+
+inline constexpr uint32_t kCr1Cen{1U << 0U};
+inline constexpr uint32_t kCr1Urs{1U << 2U};
+inline constexpr uint32_t kCr1Opm{1U << 3U};
+inline constexpr uint32_t kCr1Arpe{1U << 7U};
+inline constexpr uint32_t kDierUie{1U << 0U};
+inline constexpr uint32_t kSrUif{1U << 0U};
+inline constexpr uint32_t kEgrUg{1U << 0U};
+
+// PSC and ARR are 16 bits wide on every timer the driver supports
+inline constexpr uint64_t kMaxCount{0x1'0000};
+
+// How a run of ticks splits into a prescaler and a reload value
+struct Divider {
+  uint32_t psc{0};
+  uint32_t arr{0};
+};
+
+// Clock ticks in interval, rounded down. Whole seconds and the rest are
+// scaled apart, so the product cannot overflow; past kMaxCount^2 seconds,
+// longer than any divider counts at any clock, it saturates instead.
+constexpr auto TicksFor(std::chrono::microseconds interval, uint32_t clock_hz)
+    -> uint64_t {
+  constexpr uint64_t kMicrosecondsPerSecond{1'000'000};
+  const auto microseconds{static_cast<uint64_t>(interval.count())};
+  const uint64_t seconds{microseconds / kMicrosecondsPerSecond};
+  if (seconds >= kMaxCount * kMaxCount) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return (seconds * clock_hz) + ((microseconds % kMicrosecondsPerSecond) *
+                                 clock_hz / kMicrosecondsPerSecond);
+}
+
+// Splits ticks into prescaler * reload with the smallest prescaler, which
+// keeps the rounding error under one prescaled tick
+constexpr auto DividerFor(uint64_t ticks)
+    -> std::expected<Divider, common::Error> {
+  ticks = std::max<uint64_t>(ticks, 1);
+  const uint64_t prescaler{(ticks + kMaxCount - 1) / kMaxCount};
+  if (prescaler > kMaxCount) {
+    return std::unexpected(common::Error::kInvalidArgument);
+  }
+  const uint64_t reload{std::max<uint64_t>(ticks / prescaler, 1)};
+  return Divider{.psc = static_cast<uint32_t>(prescaler - 1),
+                 .arr = static_cast<uint32_t>(reload - 1)};
+}
+
+}  // namespace tim
+
+// Where a timer's registers are and what clocks it. The board supplies
+// one per timer it hands out.
+template <typename T>
+concept Stm32TimerHardware = requires {
+  { T::Timer() } -> std::same_as<Stm32TimerRegisters&>;
+  { T::kClockHz } -> std::convertible_to<uint32_t>;
+};
+
+// Timer on an STM32F7 TIM peripheral, meant for the basic timers TIM6 and
+// TIM7.
+//
+// The period is split into a 16-bit prescaler and a 16-bit reload value,
+// so the longest period is 2^32 timer clocks (about 40 s at 108 MHz).
+// Periodic mode leaves the counter free-running, so the deadlines stay on
+// the period's grid however late the interrupt is served; one-shot mode
+// uses the timer's one-pulse mode, which stops the counter by itself.
+//
+// The board's TIMx interrupt handler calls OnInterrupt(). The callback
+// runs in interrupt context, between the core's sleeps.
+template <Stm32TimerHardware Hardware>
+class Stm32Timer final : public Timer {
+ public:
+  Stm32Timer() = default;
+  Stm32Timer(const Stm32Timer&) = delete;
+  Stm32Timer(Stm32Timer&&) = delete;
+  auto operator=(const Stm32Timer&) -> Stm32Timer& = delete;
+  auto operator=(Stm32Timer&&) -> Stm32Timer& = delete;
+  ~Stm32Timer() override = default;
+
+  auto StartOnce(std::chrono::microseconds delay, TimerCallback callback)
+      -> std::expected<void, common::Error> override {
+    if (delay.count() < 0) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return Start(delay, false, std::move(callback));
+  }
+
+  auto StartPeriodic(std::chrono::microseconds period, TimerCallback callback)
+      -> std::expected<void, common::Error> override {
+    if (period.count() <= 0) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    return Start(period, true, std::move(callback));
+  }
+
+  auto Stop() -> void override {
+    auto& registers{Hardware::Timer()};
+    registers.CR1 = 0;
+    registers.DIER = 0;
+    registers.SR = ~tim::kSrUif;
+    running_.store(false, std::memory_order_release);
+  }
+
+  [[nodiscard]] auto IsRunning() const -> bool override {
+    return running_.load(std::memory_order_acquire);
+  }
+
+  // Interrupt entry point
+
+  auto OnInterrupt() -> void {
+    auto& registers{Hardware::Timer()};
+    if ((registers.SR & tim::kSrUif) == 0) {
+      return;
+    }
+    // SR bits are cleared by writing 0; writing 1 leaves them alone
+    registers.SR = ~tim::kSrUif;
+    if (!periodic_) {
+      registers.DIER = 0;
+      running_.store(false, std::memory_order_release);
+    }
+    // The callback may restart the timer, replacing itself, so it runs
+    // from a local and goes back only if it did not
+    const uint32_t starts{starts_};
+    auto callback{std::move(callback_)};
+    callback();
+    if (starts == starts_ && periodic_) {
+      callback_ = std::move(callback);
+    }
+  }
+
+ private:
+  auto Start(std::chrono::microseconds interval, bool periodic,
+             TimerCallback callback) -> std::expected<void, common::Error> {
+    if (!callback) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    const auto divider{
+        tim::DividerFor(tim::TicksFor(interval, Hardware::kClockHz))};
+    if (!divider) {
+      return std::unexpected(divider.error());
+    }
+
+    // Stopped first, so no interrupt sees the callback half replaced
+    Stop();
+    ++starts_;
+    callback_ = std::move(callback);
+    periodic_ = periodic;
+
+    auto& registers{Hardware::Timer()};
+    registers.PSC = divider->psc;
+    registers.ARR = divider->arr;
+    // UG loads PSC and ARR and zeroes the counter; with URS set it does
+    // not raise UIF as well
+    registers.CR1 = tim::kCr1Urs;
+    registers.EGR = tim::kEgrUg;
+    registers.SR = ~tim::kSrUif;
+    registers.DIER = tim::kDierUie;
+    running_.store(true, std::memory_order_release);
+    registers.CR1 = tim::kCr1Urs | tim::kCr1Arpe |
+                    (periodic ? 0U : tim::kCr1Opm) | tim::kCr1Cen;
+    return {};
+  }
+
+  TimerCallback callback_{};
+  bool periodic_{false};
+  // Counts Start() calls, so OnInterrupt() can tell whether its callback
+  // restarted the timer
+  uint32_t starts_{0};
+  std::atomic<bool> running_{false};
+};
+
+}  // namespace mcu
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
+#include "libs/mcu/stm32/stm32_dma.hpp"
+#include "libs/mcu/uart.hpp"
+
+namespace mcu {
+
+// An STM32F7 USART (USART_TypeDef)
+struct Stm32UsartRegisters {
+  volatile uint32_t CR1;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t CR2;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t CR3;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t BRR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t GTPR;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t RTOR;  // NOLINT(readability-identifier-naming)
+  volatile uint32_t RQR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t ISR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t ICR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t RDR;   // NOLINT(readability-identifier-naming)
+  volatile uint32_t TDR;   // NOLINT(readability-identifier-naming)
+};
+
+static_assert(offsetof(Stm32UsartRegisters, ISR) == 0x1C);
+static_assert(offsetof(Stm32UsartRegisters, TDR) == 0x28);
+
+namespace usart {
+
+inline constexpr uint32_t kCr1Ue{1U << 0U};
+inline constexpr uint32_t kCr1Re{1U << 2U};
+inline constexpr uint32_t kCr1Te{1U << 3U};
+inline constexpr uint32_t kCr1Idleie{1U << 4U};
+inline constexpr uint32_t kCr1Ps{1U << 9U};
+inline constexpr uint32_t kCr1Pce{1U << 10U};
+inline constexpr uint32_t kCr1M0{1U << 12U};
+inline constexpr uint32_t kCr1M1{1U << 28U};
+inline constexpr uint32_t kCr2Stop2{2U << 12U};
+inline constexpr uint32_t kCr3Eie{1U << 0U};
+inline constexpr uint32_t kCr3Dmar{1U << 6U};
+inline constexpr uint32_t kCr3Dmat{1U << 7U};
+inline constexpr uint32_t kCr3Rtse{1U << 8U};
+inline constexpr uint32_t kCr3Ctse{1U << 9U};
+inline constexpr uint32_t kIsrFe{1U << 1U};
+inline constexpr uint32_t kIsrNf{1U << 2U};
+inline constexpr uint32_t kIsrOre{1U << 3U};
+inline constexpr uint32_t kIsrIdle{1U << 4U};
+inline constexpr uint32_t kIsrTc{1U << 6U};
+inline constexpr uint32_t kIsrTxe{1U << 7U};
+// ICR clear bits sit at the same positions as the ISR flags
+inline constexpr uint32_t kIcrTccf{kIsrTc};
+
+}  // namespace usart
+
+// Where a UART's registers are and how it is wired to DMA. The board
+// supplies one per UART, along with the millisecond tick used for
+// timeouts and the data cache maintenance the DMA buffers need (see
+// stm32_dcache.hpp; empty functions where the buffers are not cached).
+template <typename T>
+concept Stm32UartHardware = requires(const std::byte* data, size_t size) {
+  { T::Usart() } -> std::same_as<Stm32UsartRegisters&>;
+  { T::Dma() } -> std::same_as<Stm32DmaRegisters&>;
+  { T::kRxStream } -> std::convertible_to<uint32_t>;
+  { T::kTxStream } -> std::convertible_to<uint32_t>;
+  { T::kDmaChannel } -> std::convertible_to<uint32_t>;
+  { T::kClockHz } -> std::convertible_to<uint32_t>;
+  { T::Milliseconds() } -> std::convertible_to<uint32_t>;
+  T::CleanDCache(data, size);
+  T::InvalidateDCache(data, size);
+};
+
+// Uart for the STM32F7 USARTs, moving data with DMA in both directions.
+//
+// Reception runs continuously into rx_ring with a circular DMA stream, so
+// no byte depends on the CPU answering an interrupt in time. The driver is
+// told about new data by the half- and full-ring DMA interrupts and by the
+// USART's IDLE interrupt, which fires once the line goes quiet after a
+// burst. That is a few interrupts per ring lap rather than one per byte.
+// Received bytes go to the rx handler if one is set, otherwise to a
+// pending ReceiveAsync(), otherwise they wait in the ring for Receive().
+// The consumer must keep up: bytes more than one ring lap behind the DMA
+// are overwritten. The ring holds at most 65535 bytes, what NDTR can count,
+// and with the data cache on it must start and end on cache lines.
+//
+// SendAsync() queues up to TxQueueDepth transfers; each one is DMA straight
+// from the caller's buffer, which must stay valid until its callback runs.
+// Buffers longer than one DMA transfer go out in 65535-byte pieces.
+//
+// The board's interrupt handlers call OnUsartInterrupt(),
+// OnRxDmaInterrupt() and OnTxDmaInterrupt(). Callbacks and the rx handler
+// run in interrupt context.
+template <Stm32UartHardware Hardware, size_t TxQueueDepth = 4>
+class Stm32Uart final : public Uart {
+ public:
+  explicit Stm32Uart(std::span<std::byte> rx_ring) : rx_ring_{rx_ring} {}
+  Stm32Uart(const Stm32Uart&) = delete;
+  Stm32Uart(Stm32Uart&&) = delete;
+  auto operator=(const Stm32Uart&) -> Stm32Uart& = delete;
+  auto operator=(Stm32Uart&&) -> Stm32Uart& = delete;
+  ~Stm32Uart() override = default;
+
+  auto Init(const UartConfig& config)
+      -> std::expected<void, common::Error> override {
+    // Data moves a byte at a time, so the 9th data bit has nowhere to go
+    const bool parity{config.parity != UartConfig::Parity::kNone};
+    const auto frame_bits{static_cast<uint32_t>(config.data_bits) +
+                          (parity ? 1U : 0U)};
+    if (config.data_bits == UartConfig::DataBits::k9Bits || frame_bits > 9 ||
+        config.flow_control == UartConfig::FlowControl::kXonXoff ||
+        rx_ring_.empty() || rx_ring_.size() > kMaxDmaTransfer ||
+        config.baud_rate == 0) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+    // 16x oversampling: the divider is the clock ticks per bit
+    const uint32_t divider{(Hardware::kClockHz + (config.baud_rate / 2)) /
+                           config.baud_rate};
+    if (divider < 16 || divider > 0xFFFF) {
+      return std::unexpected(common::Error::kInvalidArgument);
+    }
+
+    auto& registers{Hardware::Usart()};
+    registers.CR1 = 0;
+    dma::DisableStream(RxStream());
+    dma::DisableStream(TxStream());
+
+    uint32_t cr1{usart::kCr1Re | usart::kCr1Te | usart::kCr1Idleie};
+    if (frame_bits == 7) {
+      cr1 |= usart::kCr1M1;
+    } else if (frame_bits == 9) {
+      cr1 |= usart::kCr1M0;
+    }
+    if (parity) {
+      cr1 |= usart::kCr1Pce;
+      if (config.parity == UartConfig::Parity::kOdd) {
+        cr1 |= usart::kCr1Ps;
+      }
+    }
+    uint32_t cr3{usart::kCr3Eie | usart::kCr3Dmar | usart::kCr3Dmat};
+    if (config.flow_control == UartConfig::FlowControl::kRtsCts) {
+      cr3 |= usart::kCr3Rtse | usart::kCr3Ctse;
+    }
+    registers.BRR = divider;
+    registers.CR2 = config.stop_bits == UartConfig::StopBits::k2Bits
+                    ? usart::kCr2Stop2
+                    : 0U;
+    registers.CR3 = cr3;
+
+    // The receive stream runs from here on and never stops
+    auto& rx{RxStream()};
+    dma::ClearFlags(Hardware::Dma(), Hardware::kRxStream, dma::kAllFlags);
+    rx.PAR = dma::Address(&registers.RDR);
+    rx.M0AR = dma::Address(rx_ring_.data());
+    rx.NDTR = static_cast<uint32_t>(rx_ring_.size());
+    rx.CR = (Hardware::kDmaChannel << dma::kCrChselShift) | dma::kCrMinc |
+            dma::kCrCirc | dma::kCrHtie | dma::kCrTcie | dma::kCrEn;
+    read_position_ = 0;
+
+    registers.CR1 = cr1 | usart::kCr1Ue;
+    initialized_ = true;
+    return {};
+  }
+
+  auto Send(std::span<const std::byte> data)
+      -> std::expected<void, common::Error> override {
+    if (!initialized_) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    // Queued transfers go first; then poll the bytes out
+    std::ignore = Flush();
+    auto& registers{Hardware::Usart()};
+    for (const auto byte : data) {
+      while ((registers.ISR & usart::kIsrTxe) == 0) {
+      }
+      registers.TDR = std::to_integer<uint32_t>(byte);
+    }
+    return Flush();
+  }
+
+  auto Receive(std::span<std::byte> buffer, uint32_t timeout_ms)
+      -> std::expected<size_t, common::Error> override {
+    if (!initialized_) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    // Received bytes already have a consumer
+    if (rx_handler_ || rx_pending_.load(std::memory_order_acquire)) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    const uint32_t start{Hardware::Milliseconds()};
+    while (true) {
+      const size_t count{PopRx(buffer)};
+      if (count > 0 || buffer.empty()) {
+        return count;
+      }
+      if (timeout_ms != 0 && Hardware::Milliseconds() - start >= timeout_ms) {
+        return std::unexpected(common::Error::kTimeout);
+      }
+    }
+  }
+
+  auto SendAsync(std::span<const std::byte> data,
+                 CompletionCallback<void> callback)
+      -> std::expected<void, common::Error> override {
+    if (!initialized_) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    if (data.empty()) {
+      callback({});
+      return {};
+    }
+    const size_t head{tx_head_.load(std::memory_order_relaxed)};
+    if (head - tx_tail_.load(std::memory_order_acquire) == TxQueueDepth) {
+      return std::unexpected(common::Error::kWouldBlock);
+    }
+    tx_queue_[head % TxQueueDepth] = {data, std::move(callback)};
+    // Sequentially consistent, like StartTxIfIdle()'s claim and release of
+    // the line, so that one of them always sees the other
+    tx_head_.store(head + 1);
+    StartTxIfIdle();
+    return {};
+  }
+
+  auto ReceiveAsync(std::span<std::byte> buffer,
+                    CompletionCallback<size_t> callback)
+      -> std::expected<void, common::Error> override {
+    if (!initialized_) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    if (rx_handler_ || rx_pending_.load(std::memory_order_acquire)) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    rx_request_ = buffer;
+    rx_callback_ = std::move(callback);
+    rx_pending_.store(true, std::memory_order_release);
+    // Data that arrived before the request completes it straight away
+    CompleteRxRequest();
+    return {};
+  }
+
+  [[nodiscard]] auto IsBusy() const -> bool override {
+    return tx_active_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] auto Available() const -> size_t override {
+    return (DmaPosition() + rx_ring_.size() - read_position_) %
+           rx_ring_.size();
+  }
+
+  auto Flush() -> std::expected<void, common::Error> override {
+    if (!initialized_) {
+      return std::unexpected(common::Error::kInvalidState);
+    }
+    while (IsBusy()) {
+    }
+    // The last byte has left the shift register once TC is set
+    while ((Hardware::Usart().ISR & usart::kIsrTc) == 0) {
+    }
+    return {};
+  }
+
+  auto SetRxHandler(RxHandler handler)
+      -> std::expected<void, common::Error> override {
+    rx_handler_ = std::move(handler);
+    return {};
+  }
+
+  // Bytes lost to receiver overruns, framing and noise errors
+  [[nodiscard]] auto Errors() const -> size_t {
+    return errors_.load(std::memory_order_relaxed);
+  }
+
+  // Interrupt entry points
+
+  auto OnUsartInterrupt() -> void {
+    auto& registers{Hardware::Usart()};
+    const uint32_t status{registers.ISR};
+    const uint32_t errors{status &
+                          (usart::kIsrOre | usart::kIsrFe | usart::kIsrNf)};
+    if (errors != 0) {
+      registers.ICR = errors;
+      errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if ((status & usart::kIsrIdle) != 0) {
+      registers.ICR = usart::kIsrIdle;
+      DeliverRx();
+    }
+  }
+
+  auto OnRxDmaInterrupt() -> void {
+    const uint32_t flags{dma::ReadFlags(Hardware::Dma(), Hardware::kRxStream)};
+    dma::ClearFlags(Hardware::Dma(), Hardware::kRxStream, flags);
+    DeliverRx();
+  }
+
+  auto OnTxDmaInterrupt() -> void {
+    const uint32_t flags{dma::ReadFlags(Hardware::Dma(), Hardware::kTxStream)};
+    dma::ClearFlags(Hardware::Dma(), Hardware::kTxStream, flags);
+    if ((flags & (dma::kTcif | dma::kTeif)) == 0) {
+      return;
+    }
+    std::expected<void, common::Error> result{};
+    if ((flags & dma::kTeif) != 0) {
+      result = std::unexpected(common::Error::kOperationFailed);
+    }
+    const size_t tail{tx_tail_.load(std::memory_order_relaxed)};
+    auto& request{tx_queue_[tail % TxQueueDepth]};
+    if (result && request.data.size() > kMaxDmaTransfer) {
+      // Only a piece of a long buffer has gone; send the next one
+      request.data = request.data.subspan(kMaxDmaTransfer);
+      tx_active_.store(false, std::memory_order_release);
+      StartTxIfIdle();
+      return;
+    }
+    auto callback{std::move(request.callback)};
+    tx_tail_.store(tail + 1, std::memory_order_release);
+    tx_active_.store(false, std::memory_order_release);
+    // Keep the line busy before running the callback
+    StartTxIfIdle();
+    if (callback) {
+      callback(result);
+    }
+  }
+
+ private:
+  // NDTR is 16 bits wide
+  static constexpr size_t kMaxDmaTransfer{0xFFFF};
+
+  struct TxRequest {
+    std::span<const std::byte> data;
+    CompletionCallback<void> callback;
+  };
+
+  static auto RxStream() -> Stm32DmaStreamRegisters& {
+    return Hardware::Dma().stream[Hardware::kRxStream];
+  }
+
+  static auto TxStream() -> Stm32DmaStreamRegisters& {
+    return Hardware::Dma().stream[Hardware::kTxStream];
+  }
+
+  // Where the DMA will write the next byte. NDTR counts down and reloads
+  // when it reaches 0, so 0 and the ring size both mean the start.
+  [[nodiscard]] auto DmaPosition() const -> size_t {
+    return (rx_ring_.size() - RxStream().NDTR) % rx_ring_.size();
+  }
+
+  // Starts the transfer at the head of the queue unless one is running.
+  // Called from both thread and interrupt context; the exchange makes
+  // sure only one of them starts it. Whoever claims the line with nothing
+  // to send gives it back and looks again: a Write() whose own claim
+  // failed meanwhile relies on it to start the request it queued.
+  auto StartTxIfIdle() -> void {
+    size_t tail{};
+    for (;;) {
+      if (tx_active_.exchange(true)) {
+        return;
+      }
+      tail = tx_tail_.load(std::memory_order_acquire);
+      if (tx_head_.load() != tail) {
+        break;
+      }
+      tx_active_.store(false);
+      if (tx_head_.load() == tail) {
+        return;
+      }
+    }
+    const auto& request{tx_queue_[tail % TxQueueDepth]};
+    const size_t size{std::min(request.data.size(), kMaxDmaTransfer)};
+    // The DMA reads memory, not what the CPU left in the cache
+    Hardware::CleanDCache(request.data.data(), size);
+    auto& tx{TxStream()};
+    dma::DisableStream(tx);
+    dma::ClearFlags(Hardware::Dma(), Hardware::kTxStream, dma::kAllFlags);
+    tx.PAR = dma::Address(&Hardware::Usart().TDR);
+    tx.M0AR = dma::Address(request.data.data());
+    tx.NDTR = static_cast<uint32_t>(size);
+    Hardware::Usart().ICR = usart::kIcrTccf;
+    tx.CR = (Hardware::kDmaChannel << dma::kCrChselShift) | dma::kCrMinc |
+            dma::kCrDirMemoryToPeripheral | dma::kCrTcie | dma::kCrTeie |
+            dma::kCrEn;
+  }
+
+  // Makes the CPU see what the DMA wrote to count ring bytes from the read
+  // position on, which may wrap
+  auto InvalidateRx(size_t count) -> void {
+    const size_t first{std::min(count, rx_ring_.size() - read_position_)};
+    Hardware::InvalidateDCache(&rx_ring_[read_position_], first);
+    Hardware::InvalidateDCache(rx_ring_.data(), count - first);
+  }
+
+  // Copies up to out.size() received bytes out of the ring
+  auto PopRx(std::span<std::byte> out) -> size_t {
+    const size_t count{std::min(out.size(), Available())};
+    InvalidateRx(count);
+    const size_t first{std::min(count, rx_ring_.size() - read_position_)};
+    std::copy_n(rx_ring_.begin() + static_cast<ptrdiff_t>(read_position_),
+                first, out.begin());
+    std::copy_n(rx_ring_.begin(), count - first,
+                out.begin() + static_cast<ptrdiff_t>(first));
+    read_position_ = (read_position_ + count) % rx_ring_.size();
+    return count;
+  }
+
+  auto DeliverRx() -> void {
+    if (rx_handler_) {
+      // Hand the bytes over where the DMA left them, in at most two pieces
+      const size_t end{DmaPosition()};
+      InvalidateRx((end + rx_ring_.size() - read_position_) % rx_ring_.size());
+      while (read_position_ != end) {
+        const size_t stop{end > read_position_ ? end : rx_ring_.size()};
+        rx_handler_(&rx_ring_[read_position_], stop - read_position_);
+        read_position_ = stop % rx_ring_.size();
+      }
+      return;
+    }
+    CompleteRxRequest();
+  }
+
+  // Finishes a pending ReceiveAsync() if there is data for it. Thread and
+  // interrupt context race to claim the request; only one wins.
+  auto CompleteRxRequest() -> void {
+    if (Available() == 0 ||
+        !rx_pending_.exchange(false, std::memory_order_acq_rel)) {
+      return;
+    }
+    const size_t count{PopRx(rx_request_)};
+    auto callback{std::move(rx_callback_)};
+    if (callback) {
+      callback(count);
+    }
+  }
+
+  std::span<std::byte> rx_ring_;
+  // Next ring index the driver hands out; the DMA position is the writer's
+  size_t read_position_{0};
+  bool initialized_{false};
+  RxHandler rx_handler_{};
+  std::span<std::byte> rx_request_{};
+  CompletionCallback<size_t> rx_callback_{};
+  std::atomic<bool> rx_pending_{false};
+  std::atomic<size_t> errors_{0};
+
+  // Single-producer (SendAsync) single-consumer (TX DMA interrupt) queue
+  std::array<TxRequest, TxQueueDepth> tx_queue_{};
+  std::atomic<size_t> tx_head_{0};
+  std::atomic<size_t> tx_tail_{0};
+  std::atomic<bool> tx_active_{false};
+};
+
+}  // namespace mcu
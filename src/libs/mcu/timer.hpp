@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <expected>
+
+#include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
+
+namespace mcu {
+
+/// @brief A hardware timer that calls back after a delay or periodically
+///
+/// Apps wait on a timer instead of looping around Delay(), so the core is
+/// free, or asleep, in between. The callback runs in interrupt context on
+/// target and on the board's event loop on the host.
+class Timer {
+ public:
+  virtual ~Timer() = default;
+
+  /// @brief Call callback once, after delay
+  /// Restarts the timer if it is already running.
+  /// @return Error if the timer cannot count that long
+  [[nodiscard]] virtual auto StartOnce(std::chrono::microseconds delay,
+                                       TimerCallback callback)
+      -> std::expected<void, common::Error> = 0;
+
+  /// @brief Call callback every period until Stop()
+  /// Deadlines are kept on the period's grid, so a late callback does not
+  /// push back the ones after it. Restarts the timer if it is running.
+  /// @return Error if the timer cannot count that long
+  [[nodiscard]] virtual auto StartPeriodic(std::chrono::microseconds period,
+                                           TimerCallback callback)
+      -> std::expected<void, common::Error> = 0;
+
+  /// @brief Cancel the pending callback, if any
+  virtual auto Stop() -> void = 0;
+
+  /// @brief Whether a callback is still to come
+  [[nodiscard]] virtual auto IsRunning() const -> bool = 0;
+};
+
+}  // namespace mcu
@@ -3,10 +3,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <expected>
-#include <functional>
 #include <span>
 
 #include "libs/common/error.hpp"
+#include "libs/mcu/callback.hpp"
 
 namespace mcu {
 
@@ -69,9 +69,8 @@ class Uart {
   /// @param data Span of bytes to send
   /// @param callback Called when transfer completes
   /// @return Success or error code
-  [[nodiscard]] virtual auto SendAsync(
-      std::span<const std::byte> data,
-      std::function<void(std::expected<void, common::Error>)> callback)
+  [[nodiscard]] virtual auto SendAsync(std::span<const std::byte> data,
+                                       CompletionCallback<void> callback)
       -> std::expected<void, common::Error> = 0;
 
   /// @brief Receive data asynchronously
@@ -79,9 +78,8 @@ class Uart {
   /// @param buffer Buffer to store received data
   /// @param callback Called when data is received (with number of bytes)
   /// @return Success or error code
-  [[nodiscard]] virtual auto ReceiveAsync(
-      std::span<std::byte> buffer,
-      std::function<void(std::expected<size_t, common::Error>)> callback)
+  [[nodiscard]] virtual auto ReceiveAsync(std::span<std::byte> buffer,
+                                          CompletionCallback<size_t> callback)
       -> std::expected<void, common::Error> = 0;
 
   /// @brief Check if UART is busy transmitting
@@ -101,8 +99,7 @@ class Uart {
   /// application when data arrives asynchronously (e.g., from external source)
   /// @param handler Callback invoked when data arrives (data pointer and size)
   /// @return Success or error code
-  [[nodiscard]] virtual auto SetRxHandler(
-      std::function<void(const std::byte*, size_t)> handler)
+  [[nodiscard]] virtual auto SetRxHandler(RxHandler handler)
       -> std::expected<void, common::Error> = 0;
 };
 